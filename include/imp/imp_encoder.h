@@ -571,6 +571,9 @@ int IMP_Encoder_GetStream(int encChn, IMPEncoderStream *stream, int block);
 /**
  * Release encoded stream
  * 
+ * Streams fetched with IMP_Encoder_GetStream may be released in any order;
+ * the stream is identified by its seq.
+ *
  * @param encChn Encoder channel number
  * @param stream Pointer to stream structure
  * @return 0 on success, negative on error
@@ -706,6 +709,10 @@ int IMP_Encoder_SetChnEntropyMode(int encChn, IMPEncoderEntropyMode mode);
 /**
  * Set maximum stream count
  *
+ * Depth of the channel's output stream queue: encoded streams waiting for
+ * GetStream plus those held by the application, 1..IMP_ENC_STREAM_MAX_DEPTH.
+ * Must be called before IMP_Encoder_CreateChn.
+ *
  * @param encChn Encoder channel number
  * @param cnt Maximum stream count
  * @return 0 on success, negative on error
@@ -745,6 +752,129 @@ int IMP_Encoder_SetChnQpIPDelta(int encChn, int delta);
 int IMP_Encoder_GetChnEncType(int encChn, IMPEncoderEncType *encType);
 int IMP_Encoder_GetChnAveBitrate(int encChn, IMPEncoderStream *stream, int frames, int *bitrate);
 
+/**
+ * Input frame queue overflow policy (OpenIMP extension)
+ */
+typedef enum {
+    IMP_ENC_QUEUE_DROP_OLDEST = 0,      /**< Replace the oldest queued frame (default) */
+    IMP_ENC_QUEUE_DROP_NEWEST = 1,      /**< Discard the incoming frame */
+    IMP_ENC_QUEUE_BLOCK       = 2,      /**< Wait up to blockTimeoutMs, then drop the incoming frame */
+} IMPEncoderQueuePolicy;
+
+#define IMP_ENC_QUEUE_MAX_DEPTH 8
+
+/**
+ * Input frame queue attributes (OpenIMP extension)
+ */
+typedef struct {
+    uint32_t depth;                     /**< Frames waiting for the encoder, 1..IMP_ENC_QUEUE_MAX_DEPTH */
+    IMPEncoderQueuePolicy policy;       /**< What to do when the queue is full */
+    uint32_t blockTimeoutMs;            /**< Deadline for IMP_ENC_QUEUE_BLOCK */
+} IMPEncoderQueueAttr;
+
+/**
+ * Input frame queue counters (OpenIMP extension)
+ */
+typedef struct {
+    uint32_t queued;                    /**< Frames accepted into the queue */
+    uint32_t dropped;                   /**< Frames discarded (any reason) */
+    uint32_t droppedFull;               /**< ...because the queue was full */
+    uint32_t droppedNoSlot;             /**< ...because no encoder frame slot was free */
+    uint32_t blockTimeouts;             /**< IMP_ENC_QUEUE_BLOCK waits that hit the deadline */
+    uint32_t curDepth;                  /**< Frames currently queued */
+    uint32_t maxDepth;                  /**< High-water mark of curDepth */
+    uint32_t encoded;                   /**< Frames handed to the encoder */
+    uint32_t latencyAvgUs;              /**< Mean queue-entry to encode-done latency */
+    uint32_t latencyMaxUs;              /**< Worst queue-entry to encode-done latency */
+} IMPEncoderQueueStat;
+
+/**
+ * Configure the channel's input frame queue (OpenIMP extension)
+ *
+ * May be called before or after IMP_Encoder_CreateChn. Shrinking a live
+ * queue drops the oldest excess frames. Every frame held in the queue keeps
+ * a FrameSource buffer locked, so the useful depth is bounded by the
+ * channel's frame-source buffer count.
+ *
+ * @param encChn Encoder channel number
+ * @param attr Queue attributes
+ * @return 0 on success, negative on error
+ */
+int IMP_Encoder_SetChnQueueAttr(int encChn, const IMPEncoderQueueAttr *attr);
+int IMP_Encoder_GetChnQueueAttr(int encChn, IMPEncoderQueueAttr *attr);
+
+/**
+ * Read the channel's input frame queue counters (OpenIMP extension)
+ *
+ * IMP_Encoder_Query reports the queue occupancy in leftPics; this call
+ * returns the full counter set.
+ *
+ * @param encChn Encoder channel number
+ * @param stat Output counters
+ * @return 0 on success, negative on error
+ */
+int IMP_Encoder_GetChnQueueStat(int encChn, IMPEncoderQueueStat *stat);
+
+#define IMP_ENC_STREAM_MAX_DEPTH 16
+
+/**
+ * Output stream queue counters (OpenIMP extension)
+ *
+ * Encoded streams wait in a per-channel queue of IMP_Encoder_SetMaxStreamCnt
+ * entries (at most IMP_ENC_STREAM_MAX_DEPTH) until GetStream, and stay in it
+ * until ReleaseStream. Streams may be released in any order.
+ */
+typedef struct {
+    uint32_t ready;                     /**< Streams waiting for GetStream */
+    uint32_t held;                      /**< Streams fetched and not yet released */
+    uint32_t maxOccupancy;              /**< High-water mark of ready + held */
+    uint32_t delivered;                 /**< Streams returned by GetStream */
+    uint32_t released;                  /**< Streams returned by ReleaseStream */
+    uint32_t releasedOutOfOrder;        /**< ...that were not the oldest held stream */
+    uint32_t queueFull;                 /**< Dispatch passes that found the queue full */
+    uint32_t lagAvgUs;                  /**< Mean encode-done to GetStream time */
+    uint32_t lagMaxUs;                  /**< Worst encode-done to GetStream time */
+    uint32_t holdAvgUs;                 /**< Mean GetStream to ReleaseStream time */
+    uint32_t holdMaxUs;                 /**< Worst GetStream to ReleaseStream time */
+} IMPEncoderStreamStat;
+
+/**
+ * Read the channel's output stream queue counters (OpenIMP extension)
+ *
+ * @param encChn Encoder channel number
+ * @param stat Output counters
+ * @return 0 on success, negative on error
+ */
+int IMP_Encoder_GetChnStreamStat(int encChn, IMPEncoderStreamStat *stat);
+
+/**
+ * AVPU core sharing counters (OpenIMP extension)
+ *
+ * Channels that encode on the AVPU take turns on its one core: main stream
+ * (the first channel created) before sub streams before JPEG, and by frame
+ * deadline (one frame interval after the frame asks for the core) within
+ * a class.
+ */
+typedef struct {
+    uint32_t jobs;                      /**< Frames encoded on the core */
+    uint32_t deadlineMiss;              /**< ...that completed past their deadline */
+    uint32_t timeouts;                  /**< Frames dropped waiting for the core */
+    uint32_t waitAvgUs;                 /**< Mean wait for the core */
+    uint32_t waitMaxUs;                 /**< Worst wait for the core */
+    uint32_t runAvgUs;                  /**< Mean time from push to completion */
+    uint32_t runMaxUs;                  /**< Worst time from push to completion */
+} IMPEncoderAvpuStat;
+
+/**
+ * Read the channel's AVPU core sharing counters (OpenIMP extension)
+ *
+ * @param encChn Encoder channel number
+ * @param stat Output counters
+ * @return 0 on success, negative on error or if the channel does not
+ *         encode on the AVPU
+ */
+int IMP_Encoder_GetChnAvpuStat(int encChn, IMPEncoderAvpuStat *stat);
+
 #ifdef __cplusplus
 }
 #endif
@@ -21,6 +21,32 @@ extern "C" {
  */
 typedef struct IMPIVSInterface IMPIVSInterface;
 
+/**
+ * IVS channel scheduling attributes
+ *
+ * Channels are analysed by one worker pool. A channel takes frames at no
+ * more than targetFps; once its queue + processing latency passes
+ * budgetMs it backs off to the rate it sustains, and frames that waited
+ * longer than budgetMs for a worker are dropped unanalysed, their frame
+ * released at once.
+ */
+typedef struct {
+    uint32_t targetFps;                 /**< Analysis rate, 0 for every frame */
+    uint32_t budgetMs;                  /**< Latency budget, 0 for 200 ms */
+} IMPIVSSchedAttr;
+
+/**
+ * IVS channel analysis statistics
+ */
+typedef struct {
+    uint32_t analysedFrames;            /**< Frames handed to processAsync */
+    uint32_t skippedRate;               /**< Skipped to hold targetFps */
+    uint32_t skippedLoad;               /**< Skipped: channel busy or over budget */
+    uint32_t skippedLate;               /**< Dropped after waiting past budgetMs */
+    uint32_t fpsX100;                   /**< Achieved analysis rate x 100 */
+    uint32_t latencyUs;                 /**< Smoothed queue + processing time */
+} IMPIVSChnStat;
+
 /**
  * Create IVS group
  * 
@@ -99,6 +125,10 @@ int IMP_IVS_PollingResult(int chnNum, int timeoutMs);
 /**
  * Get result
  * 
+ * Hands out the oldest result in place; it stays valid until it is given
+ * back with IMP_IVS_ReleaseResult. While every result slot is held, new
+ * results are dropped rather than written over held ones.
+ *
  * @param chnNum Channel number
  * @param result Pointer to result pointer
  * @return 0 on success, negative on error
@@ -114,6 +144,49 @@ int IMP_IVS_GetResult(int chnNum, void **result);
  */
 int IMP_IVS_ReleaseResult(int chnNum, void *result);
 
+/**
+ * Get the result-ready eventfd
+ *
+ * The fd polls readable while IMP_IVS_PollingResult(chnNum, 0) would
+ * succeed, so IVS channels can share an epoll loop with encoder streams
+ * (see IMP_Encoder_GetFd): on readiness call IMP_IVS_PollingResult with a
+ * timeout of 0, then IMP_IVS_GetResult and IMP_IVS_ReleaseResult. The fd
+ * belongs to the channel; do not read or close it.
+ *
+ * @param chnNum Channel number
+ * @return File descriptor, or negative on error
+ */
+int IMP_IVS_GetFd(int chnNum);
+
+/**
+ * Set channel scheduling attributes
+ *
+ * @param chnNum Channel number
+ * @param attr Scheduling attributes
+ * @return 0 on success, negative on error
+ */
+int IMP_IVS_SetSchedAttr(int chnNum, const IMPIVSSchedAttr *attr);
+
+/**
+ * Get channel scheduling attributes
+ *
+ * @param chnNum Channel number
+ * @param attr Scheduling attributes
+ * @return 0 on success, negative on error
+ */
+int IMP_IVS_GetSchedAttr(int chnNum, IMPIVSSchedAttr *attr);
+
+/**
+ * Get channel analysis statistics
+ *
+ * Counters run from IMP_IVS_CreateChn.
+ *
+ * @param chnNum Channel number
+ * @param stat Statistics
+ * @return 0 on success, negative on error
+ */
+int IMP_IVS_GetChnStat(int chnNum, IMPIVSChnStat *stat);
+
 int IMP_IVS_ReleaseData(void *vaddr);
 int IMP_IVS_GetParam(int chnNum, void *param);
 int IMP_IVS_SetParam(int chnNum, void *param);
@@ -24,7 +24,8 @@ typedef enum {
     OSD_REG_RECT = 2,                   /**< Rectangle */
     OSD_REG_BITMAP = 3,                 /**< Bitmap */
     OSD_REG_COVER = 4,                  /**< Cover */
-    OSD_REG_PIC = 5                     /**< Picture */
+    OSD_REG_PIC = 5,                    /**< Picture */
+    OSD_REG_TEXT = 7                    /**< Text drawn from the region font (6 is used internally) */
 } IMPOSDRgnType;
 
 /**
@@ -62,6 +63,23 @@ typedef struct {
     IMPRect rect;                       /**< Rectangle */
 } IMPOSDRgnAttrPicData;
 
+/**
+ * Text region font
+ *
+ * Glyphs are laid out side by side in one picture, glyph i covering
+ * columns [i * glyphWidth, (i + 1) * glyphWidth) and drawn for the
+ * character chars[i]. The picture is converted once when the font is set;
+ * chars and pData must stay valid while the region uses the font.
+ */
+typedef struct {
+    const char *chars;                  /**< Character of each glyph, NUL terminated */
+    const void *pData;                  /**< Glyph strip */
+    IMPPixelFormat pixelFormat;         /**< Same formats as bitmap regions */
+    int glyphWidth;                     /**< Cell width, even */
+    int glyphHeight;                    /**< Cell and strip height */
+    int stripWidth;                     /**< Strip width in pixels */
+} IMPOSDFont;
+
 /**
  * OSD region attribute data
  */
@@ -71,6 +89,7 @@ typedef struct {
     IMPPixelFormat fmt;                 /**< Pixel format */
     union {
         void *bitmapData;               /**< Bitmap data */
+        const char *textData;           /**< Text, NUL terminated (OSD_REG_TEXT) */
         IMPOSDRgnAttrLineRectData lineRectData;  /**< Line/rect data */
         IMPOSDRgnAttrCoverData coverData;        /**< Cover data */
         IMPOSDRgnAttrPicData picData;            /**< Picture data */
@@ -209,6 +228,21 @@ int IMP_OSD_GetGrpRgnAttr(IMPRgnHandle handle, int grpNum, IMPOSDGrpRgnAttr *pgr
  */
 int IMP_OSD_UpdateRgnAttrData(IMPRgnHandle handle, IMPOSDRgnAttrData *prAttrData);
 
+/**
+ * Set the font of a text region
+ *
+ * Text regions (OSD_REG_TEXT) draw their string from a glyph atlas built
+ * here, so updating the text with IMP_OSD_UpdateRgnAttrData() only maps
+ * characters to glyphs instead of uploading and converting a bitmap.
+ * The text starts at the region's top-left corner and is cut at the
+ * region width.
+ *
+ * @param handle Region handle
+ * @param font Font, NULL to drop the current one
+ * @return 0 on success, negative on error
+ */
+int IMP_OSD_SetRgnFont(IMPRgnHandle handle, const IMPOSDFont *font);
+
 /**
  * Show or hide region
  * 
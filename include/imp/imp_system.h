@@ -114,6 +114,46 @@ void *IMP_System_PhysToVirt(uint32_t phys_addr);
  */
 uint32_t IMP_System_VirtToPhys(void *virt_addr);
 
+/**
+ * How a source module hands frames to its bound modules (OpenIMP extension)
+ */
+typedef enum {
+    IMP_OBSERVER_DISPATCH_INLINE = 0,  /**< Call every bound module in turn on the source thread (default) */
+    IMP_OBSERVER_DISPATCH_ASYNC  = 1,  /**< Queue to a per-binding mailbox served by its own thread */
+} IMPObserverDispatchMode;
+
+/**
+ * Per-binding async dispatch counters (OpenIMP extension)
+ */
+typedef struct {
+    uint32_t delivered;     /**< Frames passed to the bound module */
+    uint32_t dropped;       /**< Frames skipped because the mailbox was full */
+    uint32_t queued;        /**< Frames currently waiting in the mailbox */
+    uint32_t maxQueued;     /**< Mailbox high-water mark */
+} IMPObserverDispatchStat;
+
+/**
+ * Select the observer dispatch mode (OpenIMP extension)
+ *
+ * In async mode the source thread only posts the frame (holding a VBM
+ * reference) to each binding's mailbox, so its per-frame cost does not grow
+ * with the number or speed of bound modules. Frames reach each module in
+ * capture order; when a module falls depth frames behind, new frames are
+ * dropped for that module only. Applies to bindings made after the call.
+ *
+ * @param mode  Dispatch mode
+ * @param depth Mailbox depth for async mode (0 = default of 4)
+ * @return 0 on success, negative on error
+ */
+int IMP_System_SetObserverDispatch(IMPObserverDispatchMode mode, int depth);
+
+/**
+ * Read the async dispatch counters of the binding feeding dstCell (OpenIMP extension)
+ *
+ * @return 0 on success, negative if dstCell has no async binding
+ */
+int IMP_System_GetObserverDispatchStat(IMPCell *dstCell, IMPObserverDispatchStat *stat);
+
 #ifdef __cplusplus
 }
 #endif
@@ -41,6 +41,21 @@ typedef struct AvpuDMABuf {
     int from_rmem;       /* 1 if allocated via rmem/IMP_Alloc (do not munmap) */
 } AvpuDMABuf;
 
+/* ---- Completion-path cache maintenance (ALAvpuContext.cache_mode) ---- */
+enum {
+    AVPU_CACHE_RANGE    = 0,   /* CL entry + [0, hw_end) of the stream buffer */
+    AVPU_CACHE_FULL     = 1,   /* 1 MB BIDIRECTIONAL per buffer, i.e. the whole L1 */
+    AVPU_CACHE_UNCACHED = 2,   /* CL rings read through /dev/mem uncached mirrors */
+};
+
+/* Deepest submit pipeline (ALAvpuContext.inflight_max): a P frame takes two
+ * CL entries, and the ring of 0x13 must hold every queued frame plus the one
+ * being prepared */
+#define AVPU_INFLIGHT_MAX 8
+
+/* Stream buffers per channel (ALAvpuContext.stream_buf_count upper bound) */
+#define AVPU_STREAM_BUF_MAX 16
+
 /* ---- LinuxIpControl vtable (OEM: LinuxIpControlVtable at AL_Board_Create) ----
  *
  * OEM struct layout (0x100 bytes, calloc'd):
@@ -138,14 +153,15 @@ typedef struct ALAvpuContext {
     int frame_buf_size;
 
     /* Stream buffers */
-    AvpuDMABuf stream_bufs[16];
+    AvpuDMABuf stream_bufs[AVPU_STREAM_BUF_MAX];
     int stream_bufs_used;
-    unsigned char stream_in_hw[16];
-    unsigned char stream_buf_state[16];
-    uint32_t stream_enc2_cl_idx[16];  /* Enc2 CL index used for each stream buf */
+    unsigned char stream_in_hw[AVPU_STREAM_BUF_MAX];
+    unsigned char stream_buf_state[AVPU_STREAM_BUF_MAX];
+    uint32_t stream_enc2_cl_idx[AVPU_STREAM_BUF_MAX];  /* Enc2 CL index used for each stream buf */
     int next_stream_submit;
     void *codec_owner;
     void *stream_queue_mutex;
+    void *complete_mutex;      /* serializes completion producers (IRQ + sticky recovery) */
     AvpuPendingStream pending_streams[16];
     int pending_stream_read;
     int pending_stream_write;
@@ -216,11 +232,10 @@ typedef struct ALAvpuContext {
     volatile uint32_t init_top_read_val;
 
     /* Sticky diagnostics for the direct codec.c IRQ path. These let us tell
-     * whether WaitInterruptThread ever started, whether WAIT_IRQ failed, and
-     * whether any IRQ IDs were ever observed before the encoder got stuck. */
+     * whether WaitInterruptThread ever served this channel and whether any
+     * IRQ IDs were ever observed before the encoder got stuck. */
     volatile int irq_thread_started;
     volatile int irq_thread_exited;
-    volatile int irq_wait_errno;
     volatile int last_irq_id;
 
     /* OEM parity: frame counter and stream header tracking.
@@ -239,8 +254,7 @@ typedef struct ALAvpuContext {
      * In OEM these fields live in AL_IpCtrl (+0x10..+0xF0), not in the encoder context. */
     long irq_callbacks[60];       /* 20 IRQs × 3 longs: [callback, user_data, flag] */
     void *irq_mutex;              /* pthread_mutex_t* for callback access */
-    long irq_thread;              /* pthread_t stored as long */
-    int irq_thread_running;
+    int sched_chn;                /* avpu_sched channel, -1 when not attached */
 
     /* Session state */
     int session_ready;
@@ -266,6 +280,21 @@ typedef struct ALAvpuContext {
     uint32_t interm_ep2_size;
     uint32_t interm_map_size;
     uint32_t interm_data_size;
+
+    /* Cache maintenance: how completed CL entries and stream bytes are made
+     * CPU-visible, and the bytes written back/invalidated per frame */
+    int cache_mode;                        /* AVPU_CACHE_* */
+    volatile uint32_t cache_bytes_frame;   /* frame in flight */
+    uint32_t cache_bytes_last;             /* last completed frame */
+    uint64_t cache_bytes_total;
+
+    /* Submit pipeline (OPENIMP_AVPU_INFLIGHT). 0: frames are submitted as
+     * they come and rec/ref swap on completion. N > 0: up to N frames are
+     * queued on the CL ring; the next one is prepared (headers, CL entries,
+     * cache maintenance) while they encode and pushed once the core scheduler
+     * has room for it, and rec/ref swap at submit since the core runs Enc1
+     * jobs in order. */
+    int inflight_max;
 } ALAvpuContext;
 
 /* ---- Board / IP Controller API (OEM parity) ---- */
@@ -0,0 +1,130 @@
+/**
+ * Annex B NAL unit indexer
+ *
+ * A start code begins with a zero byte, so a word without one cannot hold
+ * the start of a start code and is skipped whole. A start code straddling
+ * two words is still found: its first zero lies in the word being tested
+ * and the bytes after it are read past the word.
+ */
+
+#include <stdint.h>
+#include <string.h>
+
+#include "annexb.h"
+
+#define WORD_SIZE  sizeof(uintptr_t)
+#define WORD_ONES  ((uintptr_t)-1 / 0xFF)
+#define WORD_HIGHS (WORD_ONES << 7)
+
+static inline int word_has_zero(uintptr_t v)
+{
+    return ((v - WORD_ONES) & ~v & WORD_HIGHS) != 0;
+}
+
+static inline uintptr_t load_word(const uint8_t *p)
+{
+    uintptr_t v;
+
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* 00 00 01 at i with at least one byte after it; the zero_byte before it
+ * makes it a 4-byte start code */
+static inline int match_start(const uint8_t *buf, size_t i, size_t off, size_t len, size_t *pos, int *sc)
+{
+    if (i + 3 >= len || buf[i] != 0 || buf[i + 1] != 0 || buf[i + 2] != 1) {
+        return 0;
+    }
+
+    if (i > off && buf[i - 1] == 0) {
+        *pos = i - 1;
+        if (sc) *sc = 4;
+    } else {
+        *pos = i;
+        if (sc) *sc = 3;
+    }
+    return 1;
+}
+
+size_t annexb_find_start(const uint8_t *buf, size_t off, size_t len, int *sc)
+{
+    size_t i = off, pos;
+
+    if (buf == NULL || len < 4) {
+        if (sc) *sc = 0;
+        return len;
+    }
+
+    for (; i < len && ((uintptr_t)(buf + i) & (WORD_SIZE - 1)) != 0; i++) {
+        if (match_start(buf, i, off, len, &pos, sc)) {
+            return pos;
+        }
+    }
+
+    for (; i + WORD_SIZE <= len; i += WORD_SIZE) {
+        if (!word_has_zero(load_word(buf + i))) {
+            continue;
+        }
+        for (size_t j = i; j < i + WORD_SIZE; j++) {
+            if (match_start(buf, j, off, len, &pos, sc)) {
+                return pos;
+            }
+        }
+    }
+
+    for (; i + 3 < len; i++) {
+        if (match_start(buf, i, off, len, &pos, sc)) {
+            return pos;
+        }
+    }
+
+    if (sc) *sc = 0;
+    return len;
+}
+
+int annexb_index(const uint8_t *buf, size_t len, AnnexbCodec codec, AnnexbNal *nals, int max)
+{
+    int sc = 0, count = 0;
+    size_t pos = annexb_find_start(buf, 0, len, &sc);
+
+    while (pos < len) {
+        int sc_next = 0;
+        size_t hdr = pos + (size_t)sc;
+        size_t next = annexb_find_start(buf, hdr, len, &sc_next);
+
+        if (count < max) {
+            nals[count].offset = (uint32_t)pos;
+            nals[count].length = (uint32_t)(next - pos);
+            nals[count].sc_len = (uint8_t)sc;
+            nals[count].type = annexb_nal_type(buf[hdr], codec);
+        }
+        count++;
+        pos = next;
+        sc = sc_next;
+    }
+
+    return count;
+}
+
+size_t annexb_trim_zeros(const uint8_t *buf, size_t len)
+{
+    if (buf == NULL) {
+        return 0;
+    }
+
+    while (len > 0 && ((uintptr_t)(buf + len) & (WORD_SIZE - 1)) != 0) {
+        if (buf[len - 1] != 0) {
+            return len;
+        }
+        len--;
+    }
+    while (len >= WORD_SIZE && load_word(buf + len - WORD_SIZE) == 0) {
+        len -= WORD_SIZE;
+    }
+    while (len > 0 && buf[len - 1] == 0) {
+        len--;
+    }
+
+    return len;
+}
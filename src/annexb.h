@@ -0,0 +1,54 @@
+/**
+ * Annex B NAL unit indexer
+ *
+ * Splits an encoded access unit into NAL units in one forward pass. The
+ * start code search reads a machine word at a time and only looks at
+ * single bytes inside words that contain a zero, so the long runs of slice
+ * data between start codes cost one load and a few ALU ops per word.
+ */
+
+#ifndef ANNEXB_H
+#define ANNEXB_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef enum {
+    ANNEXB_H264 = 0,
+    ANNEXB_HEVC = 1,
+} AnnexbCodec;
+
+typedef struct {
+    uint32_t offset;                /* Start code position in the buffer */
+    uint32_t length;                /* Start code + NAL, up to the next start code */
+    uint8_t sc_len;                 /* 3 or 4 */
+    uint8_t type;                   /* nal_unit_type for the codec */
+} AnnexbNal;
+
+/* Next start code at or after off: its position (the leading zero of a
+ * 4-byte code), or len if none. *sc gets 3 or 4, 0 when none is found. */
+size_t annexb_find_start(const uint8_t *buf, size_t off, size_t len, int *sc);
+
+/* NAL type from the first header byte */
+static inline uint8_t annexb_nal_type(uint8_t hdr, AnnexbCodec codec)
+{
+    return codec == ANNEXB_HEVC ? (uint8_t)((hdr >> 1) & 0x3F) : (uint8_t)(hdr & 0x1F);
+}
+
+/* Index the NAL units of buf[0, len). Fills up to max entries of nals and
+ * returns the total count, which may exceed max; bytes before the first
+ * start code are not part of any NAL. */
+int annexb_index(const uint8_t *buf, size_t len, AnnexbCodec codec, AnnexbNal *nals, int max);
+
+/* Length of buf once trailing zero bytes are dropped */
+size_t annexb_trim_zeros(const uint8_t *buf, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* ANNEXB_H */
@@ -13,6 +13,7 @@
 #include <fcntl.h>
 
 #include "imp/imp_common.h"
+#include "audio_gain.h"
 
 typedef enum {
     AUDIO_SAMPLE_RATE_8000 = 8000,
@@ -131,6 +132,8 @@ static int32_t data_11b7e0;
 static int32_t data_11b7e8 = -30;
 static int32_t data_11b7ec = 120;
 static double data_11b7f0 = 1.0;
+/* Q15 playback gain, ramped by IMP_AO_SendFrame when the volume changes */
+static AudioGain ao_gain = AUDIO_GAIN_INITIALIZER(AUDIO_GAIN_UNITY);
 static int32_t data_11b7f8;
 static int32_t data_11b828;
 static int32_t data_11b82c;
@@ -487,6 +490,12 @@ exit_err:
     pthread_exit(NULL);
 }
 
+static void _ao_set_gain_db(int32_t db)
+{
+    data_11b7f0 = pow(10.0, (double)db / 20.0);
+    audio_gain_set(&ao_gain, audio_gain_from_db(db));
+}
+
 static void * _ao_play_mute_thread(void *arg1)
 {
     char var_70[0x70];
@@ -498,7 +507,7 @@ static void * _ao_play_mute_thread(void *arg1)
     i = *(uint32_t *)((char *)arg1 + 0x80);
     if ((int32_t)i >= -29) {
         do {
-            data_11b7f0 = pow(10.0, (double)(int32_t)i / 20.0);
+            _ao_set_gain_db((int32_t)i);
             data_11b7d8.linear = data_11b7f0;
             i -= 3;
             usleep(0x249f0);
@@ -523,7 +532,7 @@ static void * _ao_play_unmute_thread(void *arg1)
     if ((int32_t)v0 >= -29) {
         s6_1 = -30;
         do {
-            data_11b7f0 = pow(10.0, (double)s6_1 / 20.0);
+            _ao_set_gain_db(s6_1);
             data_11b7d8.linear = data_11b7f0;
             s6_1 += 3;
             usleep(0x249f0);
@@ -531,7 +540,7 @@ static void * _ao_play_unmute_thread(void *arg1)
         } while (s6_1 < (int32_t)v0);
     }
 
-    data_11b7f0 = pow(10.0, (double)(int32_t)v0 / 20.0);
+    _ao_set_gain_db((int32_t)v0);
     data_11b7d8.linear = data_11b7f0;
     return NULL;
 }
@@ -1892,11 +1901,12 @@ int32_t IMP_AO_SetVolMute(int32_t arg1, int32_t arg2, int32_t arg3)
     }
     if (arg3 == 1) {
         data_11b7f0 = 0.0;
+        audio_gain_set(&ao_gain, 0);
         data_11b7f8 = arg3;
         return 0;
     }
     if (arg3 == 0) {
-        data_11b7f0 = pow(10.0, (double)data_11b858 / 20.0);
+        _ao_set_gain_db(data_11b858);
         data_11b7f8 = arg3;
         return 0;
     }
@@ -1949,7 +1959,7 @@ int32_t IMP_AO_SetVol(int32_t arg1, int32_t arg2, uint32_t arg3)
         data_11b7ec = 0x78;
         pthread_mutex_unlock(&data_11b834);
         data_11b858 = (int32_t)s1_1;
-        data_11b7f0 = pow(10.0, (double)(int32_t)s1_1 / 20.0);
+        _ao_set_gain_db((int32_t)s1_1);
         return 0;
     }
 
@@ -2225,11 +2235,9 @@ int32_t IMP_AO_SendFrame(int32_t arg1, int32_t arg2, void *arg3, int32_t arg4)
                 int32_t *v0_9 = (int32_t *)(intptr_t)audio_buf_node_get_info((void *)(intptr_t)v0_8);
                 int32_t var_28 = 0;
                 char var_24 = 0;
-                int32_t var_40 = 0;
                 int32_t var_38;
                 char *var_3c;
                 int32_t *var_44;
-                int32_t var_48;
 
                 *(v0_9 + 1) = audio_buf_node_get_data((void *)(intptr_t)v0_8);
                 *v0_9 = data_11b8fc;
@@ -2260,7 +2268,6 @@ int32_t IMP_AO_SendFrame(int32_t arg1, int32_t arg2, void *arg3, int32_t arg4)
                         var_38 = data_11b8fc;
                         var_3c = &var_24;
                         var_44 = &var_28;
-                        var_48 = 0x7f;
                         if (_ao_Agc_Process((int32_t)a0_5, (int32_t)(intptr_t)data_11b900,
                                 (int16_t)agc_sample_o, (int32_t)(intptr_t)data_11b900,
                                 0x7f, (int32_t)(intptr_t)var_44, 0, (int32_t)(intptr_t)var_3c, var_38) != 0) {
@@ -2272,8 +2279,7 @@ int32_t IMP_AO_SendFrame(int32_t arg1, int32_t arg2, void *arg3, int32_t arg4)
                     }
                 }
                 pthread_mutex_unlock(&data_11b8cc);
-                _audio_set_volume(data_11b900, (uint8_t *)(intptr_t)*((v0_9 + 1)), *v0_9,
-                    0x10, (double)var_48, (double)(intptr_t)var_44, (double)var_40);
+                audio_gain_apply(&ao_gain, data_11b900, (int16_t *)(intptr_t)*((v0_9 + 1)), *v0_9 / 2);
                 if (*(int32_t *)((char *)arg3 + 0x1c) == data_11b904) {
                     data_11b908 = (uint8_t *)data_11b900;
                     data_11b904 = data_11b8fc;
@@ -1,37 +1,7 @@
 #include <stdint.h>
+#include <string.h>
 
-typedef struct {
-    int32_t bitstream;
-    int32_t residue;
-} BitstreamState;
-
-typedef struct {
-    int16_t valprev;
-    int8_t index;
-    int8_t pad;
-} AdpcmState;
-
-typedef struct G726State G726State;
-
-struct G726State {
-    int32_t rate;
-    int32_t code_size;
-    int32_t yl;
-    int16_t yu;
-    int16_t dms;
-    int16_t dml;
-    int16_t ap;
-    int16_t a[2];
-    int16_t b[6];
-    int16_t pk[2];
-    int16_t dq[6];
-    int16_t sr[2];
-    int8_t td;
-    uint8_t pad_39[3];
-    BitstreamState bs;
-    int32_t (*encoder)(G726State *state, int32_t sample);
-    int32_t (*decoder)(G726State *state, char code);
-};
+#include "audio_common.h"
 
 _Static_assert(__builtin_offsetof(G726State, yl) == 0x08, "G726State.yl");
 _Static_assert(__builtin_offsetof(G726State, yu) == 0x0c, "G726State.yu");
@@ -166,49 +136,76 @@ uint32_t linear2ulaw(int32_t arg1)
     return (uint32_t)((uint8_t)v0 ^ 0x7f);
 }
 
+/* Single-sample expanders; the frame decoders below read tables built from these */
+int32_t alaw2linear(uint8_t arg1)
+{
+    int32_t v1 = (int32_t)arg1 ^ 0x55;
+    int32_t seg = ((uint32_t)v1 >> 4) & 7;
+    int32_t t = (int32_t)(uint8_t)(v1 << 4);
+
+    if (seg == 0) {
+        t += 8;
+    } else {
+        t += 0x108;
+        if (seg != 1) {
+            t <<= seg - 1;
+        }
+    }
+
+    return (int16_t)(((uint32_t)v1 >> 7) == 0 ? -t : t);
+}
+
+int32_t ulaw2linear(uint8_t arg1)
+{
+    uint32_t v1 = (uint8_t)~arg1;
+    int16_t t = (int16_t)(((int32_t)((v1 & 0x0f) << 3) + 0x84) << ((v1 >> 4) & 7));
+
+    return (int16_t)((int8_t)v1 >= 0 ? t - 0x84 : 0x84 - t);
+}
+
+/* A-law only looks at sample >> 3 and u-law at sample >> 2, so the encode
+ * tables are indexed by those 13/14-bit values (8 KB + 16 KB). */
+#define G711A_ENC_BITS 13
+#define G711U_ENC_BITS 14
+
+static uint8_t g711a_enc_tab[1 << G711A_ENC_BITS];
+static uint8_t g711u_enc_tab[1 << G711U_ENC_BITS];
+static int16_t g711a_dec_tab[256];
+static int16_t g711u_dec_tab[256];
+
+static __attribute__((constructor)) void g711_build_tables(void)
+{
+    for (int32_t i = 0; i < (1 << G711A_ENC_BITS); i++) {
+        g711a_enc_tab[i] = (uint8_t)linear2alaw((int16_t)(i << (16 - G711A_ENC_BITS)));
+    }
+    for (int32_t i = 0; i < (1 << G711U_ENC_BITS); i++) {
+        g711u_enc_tab[i] = (uint8_t)linear2ulaw((int16_t)(i << (16 - G711U_ENC_BITS)));
+    }
+    for (int32_t i = 0; i < 256; i++) {
+        g711a_dec_tab[i] = (int16_t)alaw2linear((uint8_t)i);
+        g711u_dec_tab[i] = (int16_t)ulaw2linear((uint8_t)i);
+    }
+}
+
+#define G711A_ENC(s) g711a_enc_tab[(uint16_t)(s) >> (16 - G711A_ENC_BITS)]
+#define G711U_ENC(s) g711u_enc_tab[(uint16_t)(s) >> (16 - G711U_ENC_BITS)]
+
 int32_t g711a_decode(int16_t *arg1, uint8_t *arg2, int32_t arg3)
 {
-    uint8_t *t2 = &arg2[arg3];
+    int32_t i = 0;
 
     if (arg3 <= 0) {
         return 0;
     }
 
-    while (1) {
-        int32_t v1_3 = (int32_t)(*arg2) ^ 0x55;
-        int32_t a3_3 = ((uint32_t)v1_3 >> 4) & 7;
-        uint32_t t0_3 = (uint32_t)((uint8_t)(v1_3 << 4));
-
-        if (a3_3 != 0) {
-            int32_t t0_1 = (int32_t)t0_3 + 0x108;
-            if (a3_3 != 1) {
-                t0_1 <<= (a3_3 - 1) & 0x1f;
-            }
-
-            {
-                int16_t v1_1 = (int16_t)t0_1;
-                if (((uint32_t)v1_3 >> 7) == 0) {
-                    v1_1 = (int16_t)(-t0_1);
-                }
-                arg2 = &arg2[1];
-                *arg1 = v1_1;
-                arg1 = &arg1[1];
-                if (arg2 == t2) {
-                    break;
-                }
-            }
-        } else {
-            int16_t v1_4 = (int16_t)(t0_3 + 8);
-            if (((uint32_t)v1_3 >> 7) == 0) {
-                v1_4 = (int16_t)(-(int32_t)(t0_3 + 8));
-            }
-            arg2 = &arg2[1];
-            *arg1 = v1_4;
-            arg1 = &arg1[1];
-            if (arg2 == t2) {
-                break;
-            }
-        }
+    for (; i + 4 <= arg3; i += 4) {
+        arg1[i] = g711a_dec_tab[arg2[i]];
+        arg1[i + 1] = g711a_dec_tab[arg2[i + 1]];
+        arg1[i + 2] = g711a_dec_tab[arg2[i + 2]];
+        arg1[i + 3] = g711a_dec_tab[arg2[i + 3]];
+    }
+    for (; i < arg3; i++) {
+        arg1[i] = g711a_dec_tab[arg2[i]];
     }
 
     return arg3 << 1;
@@ -216,45 +213,37 @@ int32_t g711a_decode(int16_t *arg1, uint8_t *arg2, int32_t arg3)
 
 int32_t g711u_decode(int16_t *arg1, uint8_t *arg2, int32_t arg3)
 {
-    uint8_t *end;
+    int32_t i = 0;
 
     if (arg3 <= 0) {
         return 0;
     }
 
-    end = &arg2[arg3];
-    do {
-        uint32_t v1_1 = (uint32_t)(*arg2);
-        uint32_t v1_3;
-        int16_t t0_4;
-        int16_t v1_4;
-
-        arg1 += 1;
-        arg2 = &arg2[1];
-        v1_3 = (uint32_t)(uint8_t)(~v1_1);
-        t0_4 = (int16_t)(((((int32_t)(v1_3 & 0x0f) << 3) + 0x84) << (((uint32_t)v1_3 >> 4) & 7)));
-        v1_4 = (int16_t)(0x84 - t0_4);
-        if ((int8_t)v1_3 >= 0) {
-            v1_4 = (int16_t)(t0_4 - 0x84);
-        }
-        *(arg1 - 1) = v1_4;
-    } while (arg2 != end);
+    for (; i + 4 <= arg3; i += 4) {
+        arg1[i] = g711u_dec_tab[arg2[i]];
+        arg1[i + 1] = g711u_dec_tab[arg2[i + 1]];
+        arg1[i + 2] = g711u_dec_tab[arg2[i + 2]];
+        arg1[i + 3] = g711u_dec_tab[arg2[i + 3]];
+    }
+    for (; i < arg3; i++) {
+        arg1[i] = g711u_dec_tab[arg2[i]];
+    }
 
     return arg3 << 1;
 }
 
 int32_t g711a_encode(uint8_t *arg1, int16_t *arg2, int32_t arg3)
 {
-    if (arg3 > 0) {
-        uint8_t *i = arg1;
-        int16_t *s1_1 = arg2;
+    int32_t i = 0;
 
-        do {
-            int32_t a0 = (int32_t)(*s1_1);
-            i += 1;
-            s1_1 = &s1_1[1];
-            *(i - 1) = (uint8_t)linear2alaw(a0);
-        } while (i != arg1 + arg3);
+    for (; i + 4 <= arg3; i += 4) {
+        arg1[i] = G711A_ENC(arg2[i]);
+        arg1[i + 1] = G711A_ENC(arg2[i + 1]);
+        arg1[i + 2] = G711A_ENC(arg2[i + 2]);
+        arg1[i + 3] = G711A_ENC(arg2[i + 3]);
+    }
+    for (; i < arg3; i++) {
+        arg1[i] = G711A_ENC(arg2[i]);
     }
 
     return arg3;
@@ -262,16 +251,16 @@ int32_t g711a_encode(uint8_t *arg1, int16_t *arg2, int32_t arg3)
 
 int32_t g711u_encode(uint8_t *arg1, int16_t *arg2, int32_t arg3)
 {
-    if (arg3 > 0) {
-        uint8_t *i = arg1;
-        int16_t *s1_1 = arg2;
+    int32_t i = 0;
 
-        do {
-            int32_t a0 = (int32_t)(*s1_1);
-            i += 1;
-            s1_1 = &s1_1[1];
-            *(i - 1) = (uint8_t)linear2ulaw(a0);
-        } while (i != arg1 + arg3);
+    for (; i + 4 <= arg3; i += 4) {
+        arg1[i] = G711U_ENC(arg2[i]);
+        arg1[i + 1] = G711U_ENC(arg2[i + 1]);
+        arg1[i + 2] = G711U_ENC(arg2[i + 2]);
+        arg1[i + 3] = G711U_ENC(arg2[i + 3]);
+    }
+    for (; i < arg3; i++) {
+        arg1[i] = G711U_ENC(arg2[i]);
     }
 
     return arg3;
@@ -1295,7 +1284,7 @@ G726State *g726_init(G726State *arg1, int32_t arg2)
     return arg1;
 }
 
-int32_t g726_decode(G726State *arg1, int16_t *arg2, uint8_t *arg3, int32_t arg4)
+int32_t g726_decode_ref(G726State *arg1, int16_t *arg2, uint8_t *arg3, int32_t arg4)
 {
     int16_t *s5 = arg2;
     int32_t result = 0;
@@ -1329,7 +1318,7 @@ int32_t g726_decode(G726State *arg1, int16_t *arg2, uint8_t *arg3, int32_t arg4)
     }
 }
 
-int32_t g726_encode(G726State *arg1, uint8_t *arg2, int16_t *arg3, int32_t arg4)
+int32_t g726_encode_ref(G726State *arg1, uint8_t *arg2, int16_t *arg3, int32_t arg4)
 {
     if (arg4 <= 0) {
         return 0;
@@ -1360,7 +1349,7 @@ int32_t g726_encode(G726State *arg1, uint8_t *arg2, int16_t *arg3, int32_t arg4)
     }
 }
 
-int32_t adpcm_coder(int16_t *arg1, char *arg2, int32_t arg3, AdpcmState *arg4)
+int32_t adpcm_coder_ref(int16_t *arg1, char *arg2, int32_t arg3, AdpcmState *arg4)
 {
     int32_t t4 = (int32_t)arg4->index;
     int32_t v1 = stepsizeTable[t4];
@@ -1460,7 +1449,7 @@ int32_t adpcm_coder(int16_t *arg1, char *arg2, int32_t arg3, AdpcmState *arg4)
     return result;
 }
 
-int32_t adpcm_decoder(char *arg1, int16_t *arg2, int32_t arg3, AdpcmState *arg4)
+int32_t adpcm_decoder_ref(char *arg1, int16_t *arg2, int32_t arg3, AdpcmState *arg4)
 {
     int32_t t2 = (int32_t)arg4->index;
     int32_t v1 = (int32_t)arg4->valprev;
@@ -1542,3 +1531,502 @@ int32_t adpcm_decoder(char *arg1, int16_t *arg2, int32_t arg3, AdpcmState *arg4)
     arg4->index = (int8_t)t2;
     return result;
 }
+
+/*
+ * Optimized G.726 / IMA-ADPCM frame coders
+ *
+ * Same arithmetic as the reference coders above, reorganized for speed:
+ * fmult takes its exponent from clz and its mantissa product from a table,
+ * the quantizer counts table hits instead of walking them, and the G.726
+ * state is copied to the stack for the whole frame. The reference port has
+ * a few deviations from the ITU text (the short exponent search in
+ * quantize and for positive sr, td never set from a2, the a1 limits);
+ * they are reproduced here so both paths stay bit-exact.
+ */
+
+/* (anmant * srnmant + 0x30) >> 4 for anmant 32..63, srnmant 0..63 */
+static uint8_t g726_fmult_tab[32 * 64];
+static int32_t adpcm_vpdiff_tab[89][8];
+static uint8_t adpcm_next_index[89][16];
+
+static __attribute__((constructor)) void audio_codec_build_tables(void)
+{
+    for (int32_t m = 0; m < 32; m++) {
+        for (int32_t s = 0; s < 64; s++) {
+            g726_fmult_tab[(m << 6) | s] = (uint8_t)(((m + 32) * s + 0x30) >> 4);
+        }
+    }
+    for (int32_t i = 0; i < 89; i++) {
+        int32_t step = stepsizeTable[i];
+
+        for (int32_t c = 0; c < 16; c++) {
+            int32_t next = i + indexTable[c];
+
+            adpcm_next_index[i][c] = (uint8_t)(next < 0 ? 0 : (next > 88 ? 88 : next));
+            if (c < 8) {
+                adpcm_vpdiff_tab[i][c] = (step >> 3) + ((c & 4) ? step : 0) + ((c & 2) ? step >> 1 : 0) +
+                                         ((c & 1) ? step >> 2 : 0);
+            }
+        }
+    }
+}
+
+/* Exponent search of the reference quantize() and positive-sr path: values
+ * below 0x100 all come out as 1. Valid for x <= 0xffff and negative x. */
+static inline int32_t g726_quan_short(int32_t x)
+{
+    if (x == 0) {
+        return 0;
+    }
+    if ((uint32_t)x < 0x100) {
+        return 1;
+    }
+    return 32 - __builtin_clz((uint32_t)x);
+}
+
+static inline int32_t g726_fmult(int32_t an, int32_t srn)
+{
+    int32_t mag = an > 0 ? an : (-an) & 0x1fff;
+    int32_t anexp = -6;
+    int32_t anmant = 32;
+    int32_t wanexp, wanmant, r;
+
+    if (mag != 0) {
+        anexp = 26 - __builtin_clz((uint32_t)mag);
+        anmant = anexp >= 0 ? mag >> anexp : mag << -anexp;
+    }
+    wanexp = anexp + ((srn >> 6) & 0xf) - 13;
+    wanmant = g726_fmult_tab[((anmant - 32) << 6) | (srn & 0x3f)];
+    r = wanexp >= 0 ? (wanmant << wanexp) & 0x7fff : wanmant >> -wanexp;
+    return (an ^ srn) < 0 ? (int16_t)-r : r;
+}
+
+static inline int32_t g726_quantize(int32_t d, int32_t y, const int32_t *qtab, int32_t nq)
+{
+    int32_t n = (nq - 1) >> 1;
+    int32_t dqm = (int16_t)(d < 0 ? -d : d);
+    int32_t exp = g726_quan_short(dqm >> 1);
+    int32_t dln = (int16_t)((((int16_t)((dqm << 7) >> (exp & 0x1f))) & 0x7f) + (uint16_t)(exp << 7) -
+                            (int16_t)(y >> 2));
+    int32_t i = 0;
+
+    /* qtab is ascending, so the hit count is the reference's search index */
+    for (int32_t k = 0; k < n; k++) {
+        i += dln >= qtab[k];
+    }
+    if (i == 0) {
+        return (d >= 0 && (nq & 1)) ? nq : 0;
+    }
+    return d >= 0 ? i : 2 * n + 1 - i;
+}
+
+static inline int32_t g726_step_size(const G726State *st)
+{
+    int32_t yl6 = st->yl >> 6;
+    int32_t dif = st->yu - yl6;
+    int32_t al = st->ap >> 2;
+
+    if (st->ap >= 0x100) {
+        return st->yu;
+    }
+    if (dif > 0) {
+        return ((dif * al) >> 6) + yl6;
+    }
+    if (dif != 0) {
+        return ((dif * al + 0x3f) >> 6) + yl6;
+    }
+    return yl6;
+}
+
+/* Zero-section (sixth order) prediction */
+static inline int32_t g726_predict_zero(const G726State *st)
+{
+    int32_t s = 0;
+
+    for (int32_t k = 0; k < 6; k++) {
+        s += g726_fmult((int16_t)(st->b[k] >> 2), st->dq[k]);
+    }
+    return s;
+}
+
+static inline void g726_update(G726State *st, int32_t wide_b, int32_t y, int32_t wi, int32_t fi,
+                               int32_t dq, int32_t sr, int32_t dqsez)
+{
+    int32_t pk0 = dqsez < 0;
+    int32_t mag = dq & 0x7fff;
+    int32_t ylint = (int16_t)(st->yl >> 15);
+    int32_t dqthr = 0x5d00;
+    int32_t tr, yu;
+
+    if (ylint < 10) {
+        int32_t thr = (int16_t)((((st->yl >> 10) & 0x1f) + 0x20) << (ylint & 0x1f));
+        dqthr = ((thr >> 1) + thr) >> 1;
+    }
+    tr = st->td != 0 && dqthr < mag;
+
+    yu = (int16_t)(((wi - y) >> 5) + (int16_t)y);
+    yu = yu < 0x220 ? 0x220 : (yu > 0x1400 ? 0x1400 : yu);
+    st->yu = (int16_t)yu;
+    st->yl = ((-st->yl) >> 6) + yu + st->yl;
+
+    if (tr) {
+        memset(st->a, 0, sizeof(st->a));
+        memset(st->b, 0, sizeof(st->b));
+    } else {
+        int32_t a2p = (st->a[1] - (st->a[1] >> 7)) & 0xff80;
+        int32_t a1 = st->a[0];
+        int32_t a2, a1ul, lo, hi;
+
+        if (dqsez != 0) {
+            int32_t pks1 = (int16_t)(pk0 ^ st->pk[0]);
+            int32_t fa1 = pks1 ? a1 : (int16_t)-a1;
+
+            if (fa1 < -0x1fff) {
+                a2p = (int16_t)(a2p - 0x100);
+            } else if (fa1 < 0x2000) {
+                a2p = (int16_t)(a2p + (fa1 >> 5));
+            } else {
+                a2p = (int16_t)(a2p + 0xff);
+            }
+
+            if (st->pk[1] != pk0) {
+                if (a2p < -0x2f7f) {
+                    a2 = -0x3000;
+                    a1ul = 0x6c00;
+                } else if (a2p >= 0x3080) {
+                    a2 = 0x3000;
+                    a1ul = 0xc00;
+                } else {
+                    a2 = (int16_t)(a2p - 0x80);
+                    a1ul = (0x3c00 - (a2 & 0xffff)) & 0xffff;
+                }
+            } else if (a2p < -0x307f) {
+                a2 = -0x3000;
+                a1ul = 0xc00;
+            } else if (a2p >= 0x2f80) {
+                a2 = 0x3000;
+                a1ul = 0xc00;
+            } else {
+                a2 = (int16_t)(a2p + 0x80);
+                a1ul = (0x3c00 - (a2 & 0xffff)) & 0xffff;
+            }
+            lo = -a1ul;
+            hi = (int16_t)a1ul;
+
+            a1 = (int16_t)((a1 & 0xffff) - (a1 >> 8));
+            if (pks1) {
+                a1 = (int16_t)(a1 - 0xc0);
+            } else {
+                a1 = (int16_t)(a1 + 0xc0);
+                if (a1 < lo) {
+                    a1 = (int16_t)lo;
+                } else if (hi < a1) {
+                    a1 = hi;
+                }
+            }
+        } else {
+            a2 = (int16_t)a2p;
+            a1ul = (0x3c00 - a2p) & 0xffff;
+            hi = (int16_t)a1ul;
+            a1 = (int16_t)(a1 - (a1 >> 8));
+            if (a1 < -hi) {
+                a1 = (int16_t)-a1ul;
+            } else if (hi < a1) {
+                a1 = hi;
+            }
+        }
+        st->a[1] = (int16_t)a2;
+        st->a[0] = (int16_t)a1;
+
+        for (int32_t k = 0; k < 6; k++) {
+            int32_t bk = (int16_t)(st->b[k] - (st->b[k] >> (wide_b ? 9 : 8)));
+
+            if (mag != 0) {
+                bk += ((st->dq[k] ^ dq) < 0) ? -0x80 : 0x80;
+            }
+            st->b[k] = (int16_t)bk;
+        }
+    }
+
+    memmove(&st->dq[1], &st->dq[0], 5 * sizeof(st->dq[0]));
+    if (mag != 0) {
+        int32_t exp = 32 - __builtin_clz((uint32_t)mag);
+        st->dq[0] = (int16_t)(((mag << 6) >> exp) + (exp << 6) - (dq < 0 ? 0x400 : 0));
+    } else {
+        st->dq[0] = (int16_t)(dq >= 0 ? 0x20 : -0x3e0);
+    }
+
+    st->sr[1] = st->sr[0];
+    if (sr == 0) {
+        st->sr[0] = 0x20;
+    } else if (sr > 0) {
+        int32_t exp = g726_quan_short(sr);
+        st->sr[0] = (int16_t)(((sr << 6) >> (exp & 0x1f)) + (exp << 6));
+    } else if (sr < -0x7fff) {
+        st->sr[0] = (int16_t)0xfc20;
+    } else {
+        int32_t m = (-sr) & 0xffff;
+        int32_t exp = 32 - __builtin_clz((uint32_t)m);
+        st->sr[0] = (int16_t)(((m << 6) >> exp) + (exp << 6) - 0x400);
+    }
+
+    st->pk[1] = st->pk[0];
+    st->pk[0] = (int16_t)pk0;
+    st->td = (int8_t)!tr;
+
+    st->dms = (int16_t)((int16_t)(((int16_t)fi - st->dms) >> 5) + st->dms);
+    st->dml = (int16_t)((((int16_t)(fi << 2) - st->dml) >> 7) + st->dml);
+
+    /* td is always 1 here, so the slow-adaptation branch never runs */
+    st->ap = tr ? 0x100 : (int16_t)(((0x200 - st->ap) >> 4) + st->ap);
+}
+
+typedef struct {
+    int32_t bits;
+    int32_t nq;                 /* size argument of quantize() */
+    int32_t dq_mask;
+    const int32_t *qtab;
+    const int32_t *witab;
+    const int32_t *fitab;
+    const int32_t *dqlntab;
+} G726Rate;
+
+static const G726Rate g726_rates[4] = {
+    { 2, 4, 0x3fff, qtab_726_16, g726_16_witab, g726_16_fitab, g726_16_dqlntab },
+    { 3, 7, 0x3fff, qtab_726_24, g726_24_witab, g726_24_fitab, g726_24_dqlntab },
+    { 4, 15, 0x3fff, qtab_726_32, g726_32_witab, g726_32_fitab, g726_32_dqlntab },
+    { 5, 31, 0x7fff, qtab_726_40, g726_40_witab, g726_40_fitab, g726_40_dqlntab },
+};
+
+static inline __attribute__((always_inline)) int32_t
+g726_encode_sample(G726State *st, const G726Rate *r, int32_t sl)
+{
+    int32_t sezi = g726_predict_zero(st);
+    int32_t sei = (int16_t)(g726_fmult((int16_t)(st->a[1] >> 2), st->sr[1]) +
+                            g726_fmult((int16_t)(st->a[0] >> 2), st->sr[0]) + (int16_t)sezi);
+    int32_t y = g726_step_size(st);
+    int32_t se = (int16_t)(((uint32_t)sei >> 1) & 0xffff);
+    int32_t i = g726_quantize((int16_t)(sl - se), y, r->qtab, r->nq);
+    int32_t dq = reconstruct(i & (1 << (r->bits - 1)), r->dqlntab[i], y);
+    int32_t sr = (int16_t)(dq < 0 ? se - (dq & r->dq_mask) : se + dq);
+
+    g726_update(st, r->bits == 5, y, r->witab[i], r->fitab[i], dq, sr,
+                (int16_t)((int16_t)(sezi >> 1) - se + sr));
+    return i & 0xff;
+}
+
+static inline __attribute__((always_inline)) int32_t
+g726_decode_sample(G726State *st, const G726Rate *r, int32_t i)
+{
+    int32_t sezi = g726_predict_zero(st);
+    int32_t p2 = (int16_t)g726_fmult((int16_t)(st->a[1] >> 2), st->sr[1]);
+    int32_t p1 = (int16_t)g726_fmult((int16_t)(st->a[0] >> 2), st->sr[0]);
+    int32_t y = g726_step_size(st);
+    int32_t dq = reconstruct(i & (1 << (r->bits - 1)), r->dqlntab[i], y);
+    int32_t se = (int16_t)((p2 + p1 + (int16_t)sezi) >> 1);
+    int32_t sr = (int16_t)(dq < 0 ? se - (dq & r->dq_mask) : se + dq);
+
+    g726_update(st, r->bits == 5, y, r->witab[i], r->fitab[i], dq, sr,
+                (int16_t)((int16_t)(sezi >> 1) + sr - se));
+    return (int16_t)(sr << 2);
+}
+
+static inline __attribute__((always_inline)) int32_t
+g726_encode_frame(G726State *state, const G726Rate *r, uint8_t *out, const int16_t *in, int32_t n)
+{
+    G726State st = *state;
+    uint32_t bits = (uint32_t)st.bs.bitstream;
+    int32_t residue = st.bs.residue;
+    int32_t result = 0;
+
+    for (int32_t k = 0; k < n; k++) {
+        bits = (bits << r->bits) | (uint32_t)g726_encode_sample(&st, r, in[k] >> 2);
+        residue += r->bits;
+        if (residue >= 8) {
+            out[result++] = (uint8_t)(bits >> (residue - 8));
+            residue -= 8;
+        }
+    }
+
+    st.bs.bitstream = (int32_t)bits;
+    st.bs.residue = residue;
+    *state = st;
+    return result;
+}
+
+static inline __attribute__((always_inline)) int32_t
+g726_decode_frame(G726State *state, const G726Rate *r, int16_t *out, const uint8_t *in, int32_t n)
+{
+    G726State st = *state;
+    uint32_t bits = (uint32_t)st.bs.bitstream;
+    int32_t residue = st.bs.residue;
+    int32_t result = 0;
+    int32_t k = 0;
+
+    while (1) {
+        if (residue < r->bits) {
+            if (k >= n) {
+                break;
+            }
+            bits = (bits << 8) | in[k++];
+            residue += 8;
+        }
+        residue -= r->bits;
+        out[result++] = (int16_t)g726_decode_sample(&st, r, (int32_t)((bits >> residue) & ((1u << r->bits) - 1)));
+    }
+
+    st.bs.bitstream = (int32_t)bits;
+    st.bs.residue = residue;
+    *state = st;
+    return result;
+}
+
+int32_t g726_encode_fast(G726State *arg1, uint8_t *arg2, int16_t *arg3, int32_t arg4)
+{
+    if (arg4 <= 0) {
+        return 0;
+    }
+
+    switch (arg1->code_size) {
+    case 2:
+        return g726_encode_frame(arg1, &g726_rates[0], arg2, arg3, arg4);
+    case 3:
+        return g726_encode_frame(arg1, &g726_rates[1], arg2, arg3, arg4);
+    case 5:
+        return g726_encode_frame(arg1, &g726_rates[3], arg2, arg3, arg4);
+    default:
+        return g726_encode_frame(arg1, &g726_rates[2], arg2, arg3, arg4);
+    }
+}
+
+int32_t g726_decode_fast(G726State *arg1, int16_t *arg2, uint8_t *arg3, int32_t arg4)
+{
+    switch (arg1->code_size) {
+    case 2:
+        return g726_decode_frame(arg1, &g726_rates[0], arg2, arg3, arg4);
+    case 3:
+        return g726_decode_frame(arg1, &g726_rates[1], arg2, arg3, arg4);
+    case 5:
+        return g726_decode_frame(arg1, &g726_rates[3], arg2, arg3, arg4);
+    default:
+        return g726_decode_frame(arg1, &g726_rates[2], arg2, arg3, arg4);
+    }
+}
+
+/* One IMA step; the delta is accumulated alongside the magnitude compare so
+ * the loop-carried chain stays a compare/subtract ladder */
+static inline __attribute__((always_inline)) int32_t adpcm_encode_sample(int32_t sample, int32_t *valpred,
+                                                                         int32_t *index)
+{
+    int32_t step = stepsizeTable[*index];
+    int32_t diff = sample - *valpred;
+    int32_t vpdiff = step >> 3;
+    int32_t code = 0;
+    int32_t vp;
+
+    if (diff < 0) {
+        diff = -diff;
+        code = 8;
+    }
+    if (diff >= step) {
+        diff -= step;
+        vpdiff += step;
+        code |= 4;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        diff -= step;
+        vpdiff += step;
+        code |= 2;
+    }
+    step >>= 1;
+    if (diff >= step) {
+        vpdiff += step;
+        code |= 1;
+    }
+
+    vp = (code & 8) ? *valpred - vpdiff : *valpred + vpdiff;
+    *valpred = vp < -0x8000 ? -0x8000 : (vp > 0x7fff ? 0x7fff : vp);
+    *index = adpcm_next_index[*index][code];
+    return code;
+}
+
+int32_t adpcm_coder_fast(int16_t *arg1, char *arg2, int32_t arg3, AdpcmState *arg4)
+{
+    int32_t index = arg4->index;
+    int32_t valpred = arg4->valprev;
+    int32_t result = 0;
+    int32_t k = 0;
+
+    /* Two samples per output byte, high nibble first */
+    for (; k + 2 <= arg3; k += 2) {
+        int32_t hi = adpcm_encode_sample(arg1[k], &valpred, &index);
+        int32_t lo = adpcm_encode_sample(arg1[k + 1], &valpred, &index);
+
+        arg2[result++] = (char)((hi << 4) | lo);
+    }
+    if (k < arg3) {
+        arg2[result++] = (char)(adpcm_encode_sample(arg1[k], &valpred, &index) << 4);
+    }
+
+    arg4->valprev = (int16_t)valpred;
+    arg4->index = (int8_t)index;
+    return result;
+}
+
+int32_t adpcm_decoder_fast(char *arg1, int16_t *arg2, int32_t arg3, AdpcmState *arg4)
+{
+    int32_t index = arg4->index;
+    int32_t valpred = arg4->valprev;
+
+    for (int32_t k = 0; k < arg3; k++) {
+        int32_t code = (k & 1) ? arg1[k >> 1] & 0x0f : ((uint8_t)arg1[k >> 1] >> 4) & 0x0f;
+        int32_t vpdiff = adpcm_vpdiff_tab[index][code & 7];
+
+        valpred += (code & 8) ? -vpdiff : vpdiff;
+        valpred = valpred < -0x8000 ? -0x8000 : (valpred > 0x7fff ? 0x7fff : valpred);
+        index = adpcm_next_index[index][code];
+        arg2[k] = (int16_t)valpred;
+    }
+
+    arg4->valprev = (int16_t)valpred;
+    arg4->index = (int8_t)index;
+    return arg3 > 0 ? arg3 : 0;
+}
+
+/* Build with -DAUDIO_CODEC_REFERENCE to run the literal ports instead */
+int32_t g726_encode(G726State *arg1, uint8_t *arg2, int16_t *arg3, int32_t arg4)
+{
+#ifdef AUDIO_CODEC_REFERENCE
+    return g726_encode_ref(arg1, arg2, arg3, arg4);
+#else
+    return g726_encode_fast(arg1, arg2, arg3, arg4);
+#endif
+}
+
+int32_t g726_decode(G726State *arg1, int16_t *arg2, uint8_t *arg3, int32_t arg4)
+{
+#ifdef AUDIO_CODEC_REFERENCE
+    return g726_decode_ref(arg1, arg2, arg3, arg4);
+#else
+    return g726_decode_fast(arg1, arg2, arg3, arg4);
+#endif
+}
+
+int32_t adpcm_coder(int16_t *arg1, char *arg2, int32_t arg3, AdpcmState *arg4)
+{
+#ifdef AUDIO_CODEC_REFERENCE
+    return adpcm_coder_ref(arg1, arg2, arg3, arg4);
+#else
+    return adpcm_coder_fast(arg1, arg2, arg3, arg4);
+#endif
+}
+
+int32_t adpcm_decoder(char *arg1, int16_t *arg2, int32_t arg3, AdpcmState *arg4)
+{
+#ifdef AUDIO_CODEC_REFERENCE
+    return adpcm_decoder_ref(arg1, arg2, arg3, arg4);
+#else
+    return adpcm_decoder_fast(arg1, arg2, arg3, arg4);
+#endif
+}
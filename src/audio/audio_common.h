@@ -0,0 +1,92 @@
+/**
+ * Audio codec helpers shared by AENC/ADEC
+ *
+ * The G.711 frame coders are table-driven: encode looks up the sample's
+ * significant bits in an 8 KB (A-law) / 16 KB (u-law) table, decode reads a
+ * 256-entry table. The tables are built at load time from the single-sample
+ * routines, so both forms produce identical output.
+ *
+ * G.726 and IMA-ADPCM keep the literal per-sample port as a reference next
+ * to an optimized frame coder with the same output.
+ */
+
+#ifndef AUDIO_COMMON_H
+#define AUDIO_COMMON_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+    int32_t bitstream;
+    int32_t residue;
+} BitstreamState;
+
+typedef struct {
+    int16_t valprev;
+    int8_t index;
+    int8_t pad;
+} AdpcmState;
+
+typedef struct G726State G726State;
+
+struct G726State {
+    int32_t rate;
+    int32_t code_size;
+    int32_t yl;
+    int16_t yu;
+    int16_t dms;
+    int16_t dml;
+    int16_t ap;
+    int16_t a[2];
+    int16_t b[6];
+    int16_t pk[2];
+    int16_t dq[6];
+    int16_t sr[2];
+    int8_t td;
+    uint8_t pad_39[3];
+    BitstreamState bs;
+    int32_t (*encoder)(G726State *state, int32_t sample);
+    int32_t (*decoder)(G726State *state, char code);
+};
+
+/* Single sample */
+uint32_t linear2alaw(int32_t arg1);
+uint32_t linear2ulaw(int32_t arg1);
+int32_t alaw2linear(uint8_t arg1);
+int32_t ulaw2linear(uint8_t arg1);
+
+/* Whole frame: encode returns bytes written, decode returns PCM bytes written */
+int32_t g711a_encode(uint8_t *arg1, int16_t *arg2, int32_t arg3);
+int32_t g711u_encode(uint8_t *arg1, int16_t *arg2, int32_t arg3);
+int32_t g711a_decode(int16_t *arg1, uint8_t *arg2, int32_t arg3);
+int32_t g711u_decode(int16_t *arg1, uint8_t *arg2, int32_t arg3);
+
+/* G.726 at 16/24/32/40 kbit/s (rate in bit/s); NULL on an unsupported rate */
+G726State *g726_init(G726State *arg1, int32_t arg2);
+
+/* Frame coders. These run the optimized implementation unless the library
+ * is built with -DAUDIO_CODEC_REFERENCE; _ref and _fast pick one
+ * explicitly and are bit-exact with each other. */
+int32_t g726_encode(G726State *arg1, uint8_t *arg2, int16_t *arg3, int32_t arg4);
+int32_t g726_decode(G726State *arg1, int16_t *arg2, uint8_t *arg3, int32_t arg4);
+int32_t adpcm_coder(int16_t *arg1, char *arg2, int32_t arg3, AdpcmState *arg4);
+int32_t adpcm_decoder(char *arg1, int16_t *arg2, int32_t arg3, AdpcmState *arg4);
+
+int32_t g726_encode_ref(G726State *arg1, uint8_t *arg2, int16_t *arg3, int32_t arg4);
+int32_t g726_decode_ref(G726State *arg1, int16_t *arg2, uint8_t *arg3, int32_t arg4);
+int32_t adpcm_coder_ref(int16_t *arg1, char *arg2, int32_t arg3, AdpcmState *arg4);
+int32_t adpcm_decoder_ref(char *arg1, int16_t *arg2, int32_t arg3, AdpcmState *arg4);
+
+int32_t g726_encode_fast(G726State *arg1, uint8_t *arg2, int16_t *arg3, int32_t arg4);
+int32_t g726_decode_fast(G726State *arg1, int16_t *arg2, uint8_t *arg3, int32_t arg4);
+int32_t adpcm_coder_fast(int16_t *arg1, char *arg2, int32_t arg3, AdpcmState *arg4);
+int32_t adpcm_decoder_fast(char *arg1, int16_t *arg2, int32_t arg3, AdpcmState *arg4);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_COMMON_H */
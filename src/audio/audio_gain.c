@@ -0,0 +1,164 @@
+#include <stdint.h>
+#include <string.h>
+
+#include "audio_gain.h"
+
+/* round(32768 * 10^(dB / 20)) for dB = -30 .. 120 */
+static const int32_t gain_db_tab[AUDIO_GAIN_MAX_DB - AUDIO_GAIN_MIN_DB + 1] = {
+    1036, 1163, 1305, 1464, 1642, 1843,
+    2068, 2320, 2603, 2920, 3277, 3677,
+    4125, 4629, 5193, 5827, 6538, 7336,
+    8231, 9235, 10362, 11627, 13045, 14637,
+    16423, 18427, 20675, 23198, 26029, 29205,
+    32768, 36766, 41252, 46286, 51934, 58271,
+    65381, 73358, 82309, 92353, 103622, 116265,
+    130452, 146369, 164229, 184268, 206752, 231980,
+    260285, 292045, 327680, 367663, 412525, 462860,
+    519338, 582707, 653808, 733584, 823095, 923528,
+    1036215, 1162653, 1304518, 1463693, 1642290, 1842680,
+    2067521, 2319797, 2602855, 2920451, 3276800, 3676630,
+    4125247, 4628603, 5193378, 5827066, 6538076, 7335841,
+    8230949, 9235277, 10362151, 11626525, 13045176, 14636928,
+    16422903, 18426801, 20675210, 23197967, 26028548, 29204511,
+    32768000, 36766301, 41252468, 46286030, 51933780, 58270660,
+    65380756, 73358414, 82309495, 92352772, 103621514, 116265251,
+    130451758, 146369279, 164229033, 184268005, 206752103, 231979675,
+    260285476, 292045107, 327680000, 367663007, 412524679, 462860303,
+    519337801, 582706597, 653807555, 733584143, 823094946, 923527719,
+    1036215144, 1162652514, 1304517576, 1463692795, 1642290327, 1842680054,
+    2067521026, 2147483647, 2147483647, 2147483647, 2147483647, 2147483647,
+    2147483647, 2147483647, 2147483647, 2147483647, 2147483647, 2147483647,
+    2147483647, 2147483647, 2147483647, 2147483647, 2147483647, 2147483647,
+    2147483647, 2147483647, 2147483647, 2147483647, 2147483647, 2147483647,
+    2147483647,
+};
+
+int32_t audio_gain_from_db(int32_t db)
+{
+    if (db < AUDIO_GAIN_MIN_DB) {
+        db = AUDIO_GAIN_MIN_DB;
+    }
+    if (db > AUDIO_GAIN_MAX_DB) {
+        db = AUDIO_GAIN_MAX_DB;
+    }
+    return gain_db_tab[db - AUDIO_GAIN_MIN_DB];
+}
+
+int32_t audio_gain_from_linear(double linear)
+{
+    double q = linear * AUDIO_GAIN_UNITY + 0.5;
+
+    if (!(q > 0.0)) {
+        return 0;
+    }
+    if (q >= (double)INT32_MAX) {
+        return INT32_MAX;
+    }
+    return (int32_t)q;
+}
+
+void audio_gain_init(AudioGain *gain, int32_t q15)
+{
+    memset(gain, 0, sizeof(*gain));
+    gain->target = q15;
+    gain->cur = q15;
+    gain->ramp_to = q15;
+}
+
+void audio_gain_set(AudioGain *gain, int32_t q15)
+{
+    __atomic_store_n(&gain->target, q15, __ATOMIC_RELAXED);
+}
+
+static inline int32_t gain_clamp(int32_t v)
+{
+    return v > 0x7fff ? 0x7fff : (v < -0x7fff ? -0x7fff : v);
+}
+
+/* Any gain: 32x32->64 multiply. Truncates toward zero like the (int) cast
+ * of the double path. */
+static inline int32_t gain_scale(int32_t sample, int32_t q15)
+{
+    int64_t p = (int64_t)sample * q15;
+
+    if (p < 0) {
+        p += AUDIO_GAIN_UNITY - 1;
+    }
+    p >>= AUDIO_GAIN_Q;
+    return p > 0x7fff ? 0x7fff : (p < -0x7fff ? -0x7fff : (int32_t)p);
+}
+
+/* Gains below 2.0: the product fits in 32 bits */
+static inline int32_t gain_scale_lo(int32_t sample, int32_t q15)
+{
+    int32_t p = sample * q15;
+
+    p += (p >> 31) & (AUDIO_GAIN_UNITY - 1);
+    return gain_clamp(p >> AUDIO_GAIN_Q);
+}
+
+/* Two samples per 32-bit word; lanes are unpacked and repacked the same way,
+ * so the result does not depend on byte order. */
+#define GAIN_SCALE_PAIR(scale, w, q15) \
+    ((uint32_t)(uint16_t)scale((int16_t)((w) & 0xffff), q15) | \
+     ((uint32_t)(uint16_t)scale((int16_t)((w) >> 16), q15) << 16))
+
+void audio_gain_apply_fixed(int32_t q15, const int16_t *in, int16_t *out, int32_t samples)
+{
+    int32_t i = 0;
+
+    if (q15 == AUDIO_GAIN_UNITY) {
+        if (in != out && samples > 0) {
+            memmove(out, in, (size_t)samples * sizeof(int16_t));
+        }
+        return;
+    }
+
+    if (q15 < 2 * AUDIO_GAIN_UNITY) {
+        for (; i + 4 <= samples; i += 4) {
+            uint32_t w[2];
+
+            memcpy(w, in + i, sizeof(w));
+            w[0] = GAIN_SCALE_PAIR(gain_scale_lo, w[0], q15);
+            w[1] = GAIN_SCALE_PAIR(gain_scale_lo, w[1], q15);
+            memcpy(out + i, w, sizeof(w));
+        }
+    } else {
+        for (; i + 4 <= samples; i += 4) {
+            uint32_t w[2];
+
+            memcpy(w, in + i, sizeof(w));
+            w[0] = GAIN_SCALE_PAIR(gain_scale, w[0], q15);
+            w[1] = GAIN_SCALE_PAIR(gain_scale, w[1], q15);
+            memcpy(out + i, w, sizeof(w));
+        }
+    }
+    for (; i < samples; i++) {
+        out[i] = (int16_t)gain_scale(in[i], q15);
+    }
+}
+
+void audio_gain_apply(AudioGain *gain, const int16_t *in, int16_t *out, int32_t samples)
+{
+    int32_t target = __atomic_load_n(&gain->target, __ATOMIC_RELAXED);
+    int32_t i = 0;
+
+    if (target != gain->ramp_to) {
+        gain->ramp_to = target;
+        gain->step = (int32_t)(((int64_t)target - gain->cur) / AUDIO_GAIN_RAMP_SAMPLES);
+        gain->ramp_left = AUDIO_GAIN_RAMP_SAMPLES;
+    }
+
+    for (; gain->ramp_left > 0 && i < samples; i++) {
+        out[i] = (int16_t)gain_scale(in[i], gain->cur);
+        if (--gain->ramp_left == 0) {
+            gain->cur = gain->ramp_to;
+        } else {
+            gain->cur += gain->step;
+        }
+    }
+
+    if (i < samples) {
+        audio_gain_apply_fixed(gain->cur, in + i, out + i, samples - i);
+    }
+}
@@ -0,0 +1,60 @@
+/**
+ * Fixed-point audio gain stage
+ *
+ * Gains are linear Q15 factors held in an int32 (0x8000 is unity), so the
+ * volume range above 0 dB fits as well as attenuation. Samples are scaled
+ * with a 32x32->64 multiply, truncated toward zero and clamped to
+ * [-0x7fff, 0x7fff], which is what the old double-precision path did.
+ *
+ * AudioGain adds click-free volume changes: audio_gain_set() only records
+ * the new target, and the next audio_gain_apply() on the audio thread
+ * ramps linearly to it over AUDIO_GAIN_RAMP_SAMPLES samples.
+ */
+
+#ifndef AUDIO_GAIN_H
+#define AUDIO_GAIN_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AUDIO_GAIN_Q            15
+#define AUDIO_GAIN_UNITY        (1 << AUDIO_GAIN_Q)
+#define AUDIO_GAIN_MIN_DB       (-30)
+#define AUDIO_GAIN_MAX_DB       120
+#define AUDIO_GAIN_RAMP_SAMPLES 256
+
+typedef struct {
+    int32_t target;             /* Q15, written by audio_gain_set() from any thread */
+    int32_t cur;                /* Q15 gain of the next sample */
+    int32_t ramp_to;            /* Target the running ramp heads for */
+    int32_t step;               /* Q15 change per sample while ramping */
+    int32_t ramp_left;          /* Samples left in the ramp */
+} AudioGain;
+
+#define AUDIO_GAIN_INITIALIZER(q15) { (q15), (q15), (q15), 0, 0 }
+
+/* Q15 gain of a dB step, from a precomputed table clamped to [-30, 120] */
+int32_t audio_gain_from_db(int32_t db);
+
+/* Q15 gain of a linear factor; for callers that still hold a double */
+int32_t audio_gain_from_linear(double linear);
+
+void audio_gain_init(AudioGain *gain, int32_t q15);
+
+/* Set a new target; the change is ramped in by the next apply */
+void audio_gain_set(AudioGain *gain, int32_t q15);
+
+/* Scale samples with ramping. in and out may alias. */
+void audio_gain_apply(AudioGain *gain, const int16_t *in, int16_t *out, int32_t samples);
+
+/* Scale samples by a constant gain. in and out may alias. */
+void audio_gain_apply_fixed(int32_t q15, const int16_t *in, int16_t *out, int32_t samples);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AUDIO_GAIN_H */
@@ -6,6 +6,8 @@
 #include <string.h>
 #include <unistd.h>
 
+#include "audio_gain.h"
+
 int32_t IMP_Log_Get_Option(void); /* forward decl, ported by T<N> later */
 int32_t imp_log_fun(int32_t level, int32_t option, int32_t type, ...); /* forward decl, ported by T<N> later */
 
@@ -46,35 +48,9 @@ uint32_t _audio_set_volume(int16_t *arg1, uint8_t *arg2, int32_t arg3,
                 "_audio_set_volume", "error pcmbit \n", NULL);
         }
 
-        v0 = (uint32_t)arg3 >> 0x1f;
-        {
-            int32_t a3_1 = ((int32_t)v0 + arg3) >> 1;
-
-            if (a3_1 != 0) {
-                uint16_t v0_3 = 0;
-
-                do {
-                    int32_t v0_1 = (int32_t)(*arg1);
-                    uint16_t v1_1 = 0x7fff;
-                    uint32_t v0_2;
-
-                    arg1 = &arg1[1];
-                    arg5 = (double)(float)v0_1 * arg6;
-                    v0_2 = (uint32_t)((int32_t)arg5);
-                    v0_3 = (uint16_t)v0_2;
-                    if ((int32_t)v0_2 < 0x8000) {
-                        if ((int32_t)v0_2 < -0x7fff) {
-                            v0_3 = (uint16_t)-0x7fff;
-                        }
-                        v1_1 = v0_3;
-                    }
-                    *(uint16_t *)arg2 = v1_1;
-                    arg2 = &arg2[2];
-                } while (&arg1[a3_1] != arg1);
-
-                return v0_3;
-            }
-        }
+        /* arg6 is the linear gain; scale in Q15 instead of per-sample doubles */
+        v0 = (uint32_t)(arg3 / 2);
+        audio_gain_apply_fixed(audio_gain_from_linear(arg6), arg1, (int16_t *)arg2, (int32_t)v0);
     }
 
     return v0;
@@ -0,0 +1,385 @@
+/**
+ * AVPU core scheduler
+ *
+ * The frames on the core always belong to one channel: a grant to another
+ * channel needs the core drained first, so the run list is a plain FIFO of
+ * that channel's frames in push order, and a completion retires its head.
+ * Everything is under one lock; the IRQ callback runs outside it, since it
+ * comes back in through avpu_sched_complete().
+ */
+
+#include <errno.h>
+#include <pthread.h>
+#include <stdint.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <time.h>
+
+#include "avpu_sched.h"
+
+typedef struct {
+    int32_t attached;
+    int32_t prio;
+    uint32_t period_us;
+    int32_t depth;
+    void *owner;
+    int32_t waiting;
+    uint64_t want_us;               /* Pending request */
+    uint64_t deadline_us;
+    AvpuSchedStat stat;
+    uint32_t grants;
+    uint64_t wait_sum_us;
+    uint64_t run_sum_us;
+} AvpuSchedChn;
+
+typedef struct {
+    int32_t chn;
+    uint64_t grant_us;
+    uint64_t deadline_us;
+} AvpuSchedRun;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    int32_t cond_ready;
+    AvpuSchedChn chn[AVPU_SCHED_MAX_CHN];
+    int32_t attached;
+    AvpuSchedRun run[AVPU_SCHED_MAX_RUN];
+    int32_t run_count;
+    int32_t last_chn;               /* Gets interrupts while the core is idle */
+    int32_t dispatching;            /* Channel an interrupt is being delivered to */
+    pthread_t irq_thread;
+    int32_t irq_running;
+    AvpuSchedWait wait;
+    AvpuSchedUnblock unblock;
+    void *wait_arg;
+    AvpuSchedIrq irq;
+} sched = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .last_chn = -1,
+    .dispatching = -1,
+};
+
+uint64_t avpu_sched_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/* Waits use CLOCK_MONOTONIC deadlines; called with the lock held */
+static void cond_init_locked(void)
+{
+    pthread_condattr_t attr;
+
+    if (sched.cond_ready) {
+        return;
+    }
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    pthread_cond_init(&sched.cond, &attr);
+    pthread_condattr_destroy(&attr);
+    sched.cond_ready = 1;
+}
+
+static int32_t better(const AvpuSchedChn *a, const AvpuSchedChn *b)
+{
+    return a->prio < b->prio || (a->prio == b->prio && a->deadline_us < b->deadline_us);
+}
+
+static int32_t can_grant(int32_t chn)
+{
+    const AvpuSchedChn *c = &sched.chn[chn];
+
+    if (sched.run_count >= AVPU_SCHED_MAX_RUN) {
+        return 0;
+    }
+    if (sched.run_count > 0 && (sched.run[0].chn != chn || sched.run_count >= c->depth)) {
+        return 0;
+    }
+    for (int32_t i = 0; i < AVPU_SCHED_MAX_CHN; i++) {
+        if (i != chn && sched.chn[i].waiting && better(&sched.chn[i], c)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static void run_remove(int32_t idx)
+{
+    memmove(&sched.run[idx], &sched.run[idx + 1],
+            (size_t)(sched.run_count - idx - 1) * sizeof(sched.run[0]));
+    sched.run_count--;
+}
+
+static void *irq_thread(void *arg)
+{
+    (void)arg;
+    prctl(PR_SET_NAME, (unsigned long)"AVPU-irq", 0UL, 0UL, 0UL);
+
+    while (1) {
+        uint32_t irq_id = 0;
+        int32_t chn;
+        void *owner;
+        AvpuSchedIrq deliver;
+
+        pthread_mutex_lock(&sched.lock);
+        if (!sched.irq_running) {
+            pthread_mutex_unlock(&sched.lock);
+            break;
+        }
+        pthread_mutex_unlock(&sched.lock);
+
+        if (sched.wait(sched.wait_arg, &irq_id) < 0) {
+            break;
+        }
+
+        pthread_mutex_lock(&sched.lock);
+        chn = sched.run_count > 0 ? sched.run[0].chn : sched.last_chn;
+        if (!sched.irq_running || chn < 0 || !sched.chn[chn].attached) {
+            pthread_mutex_unlock(&sched.lock);
+            continue;
+        }
+        owner = sched.chn[chn].owner;
+        deliver = sched.irq;
+        sched.dispatching = chn;
+        pthread_mutex_unlock(&sched.lock);
+
+        deliver(owner, irq_id);
+
+        pthread_mutex_lock(&sched.lock);
+        sched.dispatching = -1;
+        pthread_cond_broadcast(&sched.cond);
+        pthread_mutex_unlock(&sched.lock);
+    }
+    return NULL;
+}
+
+int32_t avpu_sched_attach(int32_t chn, int32_t prio, uint32_t period_us, int32_t depth,
+                          void *owner, AvpuSchedWait wait, AvpuSchedUnblock unblock,
+                          void *wait_arg, AvpuSchedIrq irq)
+{
+    AvpuSchedChn *c;
+
+    if (chn < 0 || chn >= AVPU_SCHED_MAX_CHN || wait == NULL || irq == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&sched.lock);
+    cond_init_locked();
+    c = &sched.chn[chn];
+    if (c->attached) {
+        pthread_mutex_unlock(&sched.lock);
+        return -1;
+    }
+
+    memset(c, 0, sizeof(*c));
+    c->prio = prio;
+    c->period_us = period_us;
+    c->depth = depth < 1 ? 1 : depth;
+    c->owner = owner;
+    c->attached = 1;
+    sched.attached++;
+
+    if (!sched.irq_running) {
+        sched.wait = wait;
+        sched.unblock = unblock;
+        sched.wait_arg = wait_arg;
+        sched.irq = irq;
+        sched.irq_running = 1;
+        if (pthread_create(&sched.irq_thread, NULL, irq_thread, NULL) != 0) {
+            sched.irq_running = 0;
+            c->attached = 0;
+            sched.attached--;
+            pthread_mutex_unlock(&sched.lock);
+            return -1;
+        }
+    }
+    pthread_mutex_unlock(&sched.lock);
+    return 0;
+}
+
+void avpu_sched_detach(int32_t chn)
+{
+    pthread_t tid;
+    AvpuSchedUnblock unblock;
+    void *arg;
+
+    if (chn < 0 || chn >= AVPU_SCHED_MAX_CHN) {
+        return;
+    }
+
+    pthread_mutex_lock(&sched.lock);
+    if (!sched.chn[chn].attached) {
+        pthread_mutex_unlock(&sched.lock);
+        return;
+    }
+
+    sched.chn[chn].attached = 0;
+    for (int32_t i = sched.run_count - 1; i >= 0; i--) {
+        if (sched.run[i].chn == chn) {
+            run_remove(i);
+        }
+    }
+    if (sched.last_chn == chn) {
+        sched.last_chn = -1;
+    }
+    while (sched.dispatching == chn) {
+        pthread_cond_wait(&sched.cond, &sched.lock);
+    }
+    memset(&sched.chn[chn], 0, sizeof(sched.chn[chn]));
+    sched.attached--;
+    pthread_cond_broadcast(&sched.cond);
+
+    if (sched.attached > 0 || !sched.irq_running) {
+        pthread_mutex_unlock(&sched.lock);
+        return;
+    }
+
+    sched.irq_running = 0;
+    tid = sched.irq_thread;
+    unblock = sched.unblock;
+    arg = sched.wait_arg;
+    pthread_mutex_unlock(&sched.lock);
+
+    if (unblock != NULL) {
+        unblock(arg);
+    }
+    pthread_join(tid, NULL);
+}
+
+int32_t avpu_sched_acquire(int32_t chn, int32_t timeout_ms)
+{
+    AvpuSchedChn *c;
+    struct timespec deadline;
+    uint64_t now, wait_us;
+    int32_t granted = 1;
+
+    if (chn < 0 || chn >= AVPU_SCHED_MAX_CHN) {
+        return 0;
+    }
+
+    now = avpu_sched_now_us();
+    deadline.tv_sec = (time_t)((now + (uint64_t)timeout_ms * 1000ULL) / 1000000ULL);
+    deadline.tv_nsec = (long)((now + (uint64_t)timeout_ms * 1000ULL) % 1000000ULL) * 1000L;
+
+    pthread_mutex_lock(&sched.lock);
+    c = &sched.chn[chn];
+    if (!c->attached) {
+        pthread_mutex_unlock(&sched.lock);
+        return 0;
+    }
+
+    c->waiting = 1;
+    c->want_us = now;
+    c->deadline_us = now + c->period_us;
+    while (c->attached && !can_grant(chn)) {
+        if (pthread_cond_timedwait(&sched.cond, &sched.lock, &deadline) == ETIMEDOUT &&
+            !can_grant(chn)) {
+            granted = 0;
+            break;
+        }
+    }
+    c->waiting = 0;
+
+    if (!c->attached) {
+        pthread_cond_broadcast(&sched.cond);
+        pthread_mutex_unlock(&sched.lock);
+        return 0;
+    }
+    if (!granted) {
+        c->stat.timeouts++;
+        /* Whoever this request held back may go now */
+        pthread_cond_broadcast(&sched.cond);
+        pthread_mutex_unlock(&sched.lock);
+        return -1;
+    }
+
+    now = avpu_sched_now_us();
+    sched.run[sched.run_count].chn = chn;
+    sched.run[sched.run_count].grant_us = now;
+    sched.run[sched.run_count].deadline_us = c->deadline_us;
+    sched.run_count++;
+
+    wait_us = now - c->want_us;
+    c->grants++;
+    c->wait_sum_us += wait_us;
+    if (wait_us > c->stat.wait_max_us) {
+        c->stat.wait_max_us = (uint32_t)wait_us;
+    }
+    pthread_mutex_unlock(&sched.lock);
+    return 0;
+}
+
+void avpu_sched_abort(int32_t chn)
+{
+    if (chn < 0 || chn >= AVPU_SCHED_MAX_CHN) {
+        return;
+    }
+
+    pthread_mutex_lock(&sched.lock);
+    for (int32_t i = sched.run_count - 1; i >= 0; i--) {
+        if (sched.run[i].chn == chn) {
+            run_remove(i);
+            break;
+        }
+    }
+    pthread_cond_broadcast(&sched.cond);
+    pthread_mutex_unlock(&sched.lock);
+}
+
+void avpu_sched_complete(int32_t chn)
+{
+    AvpuSchedChn *c;
+    uint64_t now, run_us;
+
+    if (chn < 0 || chn >= AVPU_SCHED_MAX_CHN) {
+        return;
+    }
+
+    now = avpu_sched_now_us();
+    pthread_mutex_lock(&sched.lock);
+    c = &sched.chn[chn];
+    for (int32_t i = 0; i < sched.run_count; i++) {
+        if (sched.run[i].chn != chn) {
+            continue;
+        }
+
+        run_us = now - sched.run[i].grant_us;
+        c->stat.jobs++;
+        c->run_sum_us += run_us;
+        if (run_us > c->stat.run_max_us) {
+            c->stat.run_max_us = (uint32_t)run_us;
+        }
+        if (now > sched.run[i].deadline_us) {
+            c->stat.deadline_miss++;
+        }
+        run_remove(i);
+        sched.last_chn = chn;
+        break;
+    }
+    pthread_cond_broadcast(&sched.cond);
+    pthread_mutex_unlock(&sched.lock);
+}
+
+int32_t avpu_sched_get_stat(int32_t chn, AvpuSchedStat *stat)
+{
+    const AvpuSchedChn *c;
+
+    if (chn < 0 || chn >= AVPU_SCHED_MAX_CHN || stat == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&sched.lock);
+    c = &sched.chn[chn];
+    *stat = c->stat;
+    if (c->stat.jobs > 0) {
+        stat->run_avg_us = (uint32_t)(c->run_sum_us / c->stat.jobs);
+    }
+    if (c->grants > 0) {
+        stat->wait_avg_us = (uint32_t)(c->wait_sum_us / c->grants);
+    }
+    pthread_mutex_unlock(&sched.lock);
+    return 0;
+}
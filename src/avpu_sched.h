@@ -0,0 +1,88 @@
+/**
+ * AVPU core scheduler
+ *
+ * Every encoder channel that runs on the AVPU shares one core. Instead of
+ * each channel pushing command lists whenever its encoder thread gets to
+ * them, a channel asks for the core with avpu_sched_acquire() right before
+ * it programs the source registers and pushes its CL, and hands it back
+ * with avpu_sched_complete() when the frame's completion arrives. The core
+ * only ever holds frames of one channel; it is passed on when it drains,
+ * to the waiting channel of the highest priority class (main, sub, JPEG)
+ * and, within a class, the earliest deadline. A channel keeps the core for
+ * its next frame only while nobody better is waiting.
+ *
+ * One IRQ thread serves every channel: it waits for interrupts through the
+ * wait callback and hands each to the channel whose frame is oldest on the
+ * core, or to the last one that ran when the core is idle.
+ */
+
+#ifndef AVPU_SCHED_H
+#define AVPU_SCHED_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define AVPU_SCHED_MAX_CHN 8
+#define AVPU_SCHED_MAX_RUN 16       /* Frames on the core at once */
+
+enum {
+    AVPU_SCHED_PRIO_MAIN = 0,
+    AVPU_SCHED_PRIO_SUB  = 1,
+    AVPU_SCHED_PRIO_JPEG = 2,
+};
+
+typedef struct {
+    uint32_t jobs;                  /* Frames that ran on the core */
+    uint32_t deadline_miss;         /* ...that completed past their deadline */
+    uint32_t timeouts;              /* Acquires that gave up waiting */
+    uint32_t wait_avg_us;           /* Request to grant */
+    uint32_t wait_max_us;
+    uint32_t run_avg_us;            /* Grant to completion */
+    uint32_t run_max_us;
+} AvpuSchedStat;
+
+/* Blocks for the next interrupt; 0 with *irq_id set, -1 on error */
+typedef int (*AvpuSchedWait)(void *arg, uint32_t *irq_id);
+/* Wakes a blocked wait so the IRQ thread can exit */
+typedef void (*AvpuSchedUnblock)(void *arg);
+/* Delivers one interrupt to a channel, with the owner given at attach.
+ * Runs on the IRQ thread every channel shares, so it must not block:
+ * a wait here holds back the interrupts of all channels, and detach. */
+typedef void (*AvpuSchedIrq)(void *owner, uint32_t irq_id);
+
+/* Register channel chn. period_us is its frame interval, which sets the
+ * deadline of each request; depth is how many of its frames may be on the
+ * core at once. The first channel starts the IRQ thread. */
+int32_t avpu_sched_attach(int32_t chn, int32_t prio, uint32_t period_us, int32_t depth,
+                          void *owner, AvpuSchedWait wait, AvpuSchedUnblock unblock,
+                          void *wait_arg, AvpuSchedIrq irq);
+
+/* Unregister chn, dropping any of its frames still counted on the core.
+ * Returns once no interrupt is being delivered to it, which is only as
+ * long as a delivery runs (see AvpuSchedIrq); the last channel stops the
+ * IRQ thread. */
+void avpu_sched_detach(int32_t chn);
+
+/* Wait until chn may push its next frame, at most timeout_ms. 0 once the
+ * frame is counted on the core, -1 on timeout. */
+int32_t avpu_sched_acquire(int32_t chn, int32_t timeout_ms);
+
+/* Take back the frame acquire just counted, when it was never pushed */
+void avpu_sched_abort(int32_t chn);
+
+/* chn's oldest frame on the core has completed (or was given up) */
+void avpu_sched_complete(int32_t chn);
+
+int32_t avpu_sched_get_stat(int32_t chn, AvpuSchedStat *stat);
+
+/* Monotonic clock in microseconds */
+uint64_t avpu_sched_now_us(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* AVPU_SCHED_H */
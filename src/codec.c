@@ -14,6 +14,8 @@
 #include <imp/imp_encoder.h>
 #include <imp/imp_system.h>
 #include "codec.h"
+#include "annexb.h"
+#include "avpu_sched.h"
 #include "fifo.h"
 #include "hw_encoder.h"
 
@@ -27,6 +29,7 @@
 #include <errno.h>
 #include <sys/mman.h>
 #include <sys/syscall.h> /* for SYS_ioctl */
+#include <time.h>
 
 enum {
     AVPU_STREAM_BUF_FREE = 0,
@@ -34,6 +37,12 @@ enum {
     AVPU_STREAM_BUF_READY = 2,
 };
 
+/* Longest a submit waits for the shared core (avpu_sched_acquire) */
+#define AVPU_CORE_WAIT_MS 500
+
+/* Last WAIT_IRQ failure on the shared fd, 0 after a good wait */
+static volatile int avpu_irq_wait_errno;
+
 /* Throttled logging: only emit per-frame logs on every Nth frame.
  * Use LOG_CODEC_THROTTLE(ctx, ...) in hot paths instead of LOG_CODEC. */
 #define AVPU_LOG_INTERVAL 50
@@ -352,6 +361,82 @@ static inline uint8_t *avpu_cl_submit_entry_ptr(ALAvpuContext *ctx, uint32_t idx
     return base + ((size_t)(idx % ctx->cl_count) * ctx->cl_entry_size);
 }
 
+/* Completion-path cache maintenance. The AVPU writes status words into the
+ * CL entry it ran and the encoded bytes into [0, hw_end) of the stream
+ * buffer; nothing else it touches is read back by the CPU, so only those
+ * ranges need invalidating. BIDIRECTIONAL is kept for the invalidate: the
+ * lines were written back clean before submit, so the writeback half is
+ * free, and it is the direction proven on this kernel. AVPU_CACHE_FULL
+ * restores the 1 MB flushes for bring-up. */
+#define AVPU_CACHE_LINE       32
+#define AVPU_FULL_FLUSH_SIZE  0x100000
+
+static int avpu_cache_sync(ALAvpuContext *ctx, void *addr, size_t size, unsigned int dir)
+{
+    uintptr_t start = (uintptr_t)addr & ~(uintptr_t)(AVPU_CACHE_LINE - 1);
+    uintptr_t end = ((uintptr_t)addr + size + AVPU_CACHE_LINE - 1) & ~(uintptr_t)(AVPU_CACHE_LINE - 1);
+
+    if (!addr || size == 0)
+        return -1;
+    if (ctx->cache_mode == AVPU_CACHE_FULL) {
+        start = (uintptr_t)addr;
+        end = start + AVPU_FULL_FLUSH_SIZE;
+    }
+
+    __sync_fetch_and_add(&ctx->cache_bytes_frame, (uint32_t)(end - start));
+    return avpu_flush_cache(ctx->fd, (void *)start, (unsigned int)(end - start), dir);
+}
+
+/* Invalidate CL entry idx in both rings, unless read through an uncached mirror */
+static void avpu_cache_inv_cl_entry(ALAvpuContext *ctx, uint32_t idx)
+{
+    if (!ctx->cl_ring.uncached_map && avpu_cl_ring_base(ctx))
+        avpu_cache_sync(ctx, avpu_cl_entry_ptr(ctx, idx), ctx->cl_entry_size, 0 /*BIDIRECTIONAL*/);
+    if (!ctx->cl_submit_ring.uncached_map && avpu_cl_submit_ring_base(ctx))
+        avpu_cache_sync(ctx, avpu_cl_submit_entry_ptr(ctx, idx), ctx->cl_entry_size, 0 /*BIDIRECTIONAL*/);
+}
+
+/* Invalidate the bytes the AVPU produced; end == 0 when unknown */
+static int avpu_cache_inv_stream(ALAvpuContext *ctx, int buf_idx, uint32_t end)
+{
+    if (end == 0 || end > (uint32_t)ctx->stream_buf_size)
+        end = (uint32_t)ctx->stream_buf_size;
+    return avpu_cache_sync(ctx, ctx->stream_bufs[buf_idx].map, end, 0 /*BIDIRECTIONAL*/);
+}
+
+/* Close the per-frame flush count */
+static void avpu_cache_frame_done(ALAvpuContext *ctx)
+{
+    ctx->cache_bytes_last = __sync_fetch_and_and(&ctx->cache_bytes_frame, 0);
+    ctx->cache_bytes_total += ctx->cache_bytes_last;
+    if (ctx->frames_encoded % 50 == 0)
+        LOG_CODEC("AVPU cache: mode=%d %u bytes last frame, %llu total",
+                  ctx->cache_mode, ctx->cache_bytes_last, (unsigned long long)ctx->cache_bytes_total);
+}
+
+/* Point the CL rings at uncached /dev/mem mirrors. The cached lines left
+ * by the ring memset are written back and dropped first so they cannot
+ * land on top of later uncached writes. */
+static void avpu_cache_map_cl_uncached(ALAvpuContext *ctx)
+{
+    AvpuDMABuf *rings[2] = { &ctx->cl_ring, &ctx->cl_submit_ring };
+
+    for (int i = 0; i < 2; i++) {
+        AvpuDMABuf *b = rings[i];
+
+        /* /dev/mem maps whole pages from a page-aligned offset */
+        if (b->uncached_map || !b->map || b->phy_addr == 0 ||
+            (b->phy_addr & ((uint32_t)sysconf(_SC_PAGESIZE) - 1)) != 0)
+            continue;
+        avpu_flush_cache(ctx->fd, b->map, (unsigned int)b->size, 0 /*BIDIRECTIONAL*/);
+        b->uncached_map = avpu_remap_uncached(b->phy_addr, b->size);
+    }
+    if (!ctx->cl_ring.uncached_map || !ctx->cl_submit_ring.uncached_map) {
+        LOG_CODEC("AVPU cache: uncached CL rings unavailable, using range invalidates");
+        ctx->cache_mode = AVPU_CACHE_RANGE;
+    }
+}
+
 static void avpu_log_dma_range(const char *name, const AvpuDMABuf *buf)
 {
     uint64_t start;
@@ -2045,7 +2130,7 @@ static void avpu_promote_reference(ALAvpuContext *ctx)
     ctx->reference_valid = 1;
 
     if (ctx->frames_encoded % 50 == 0)
-    LOG_CODEC("EndEncoding: promoted rec->ref ref=0x%08x next_rec=0x%08x trace_ref=0x%08x next_trace=0x%08x",
+    LOG_CODEC("AVPU: promoted rec->ref ref=0x%08x next_rec=0x%08x trace_ref=0x%08x next_trace=0x%08x",
               ctx->ref_buf.phy_addr, ctx->rec_buf.phy_addr,
               ctx->ref_trace_buf.phy_addr, ctx->rec_trace_buf.phy_addr);
 }
@@ -2247,16 +2332,31 @@ static void avpu_complete_frame(ALAvpuContext *ctx, const char *source)
     if (!ctx)
         return;
 
+    /* fifo_streams is single-producer: the IRQ thread and the sticky-recovery
+     * paths (encoder/stream threads) must not push concurrently, and the
+     * pending pop + push must stay in hardware completion order. */
+    if (ctx->complete_mutex)
+        pthread_mutex_lock((pthread_mutex_t *)ctx->complete_mutex);
+
     if (!avpu_complete_next_stream(ctx, &buf_idx, &frame_user_data)) {
         LOG_CODEC("%s: completion without pending stream (frame_number=%u enc=%d cons=%d)",
                   source ? source : "EndEncoding",
                   ctx->frame_number, ctx->frames_encoded, ctx->frames_consumed);
+    } else {
+        avpu_sched_complete(ctx->sched_chn);
     }
 
     if (buf_idx >= 0)
         queued = avpu_queue_completed_stream(ctx, buf_idx, frame_user_data, source, &frame_size, &flush_ret);
 
+    if (ctx->complete_mutex)
+        pthread_mutex_unlock((pthread_mutex_t *)ctx->complete_mutex);
+
     if (!queued) {
+        /* Frames submitted after this one already reference its
+         * reconstruction; restart the chain at the next IDR */
+        if (ctx->inflight_max > 0)
+            ctx->reference_valid = 0;
         if (buf_idx >= 0) {
             avpu_mark_stream_buffer_released(ctx, buf_idx);
             LOG_CODEC("%s: released unqueued stream buf[%d] len=%u flush_ret=%d",
@@ -2266,7 +2366,8 @@ static void avpu_complete_frame(ALAvpuContext *ctx, const char *source)
         return;
     }
 
-    avpu_promote_reference(ctx);
+    if (ctx->inflight_max == 0)
+        avpu_promote_reference(ctx);
     frames_encoded = __sync_add_and_fetch(&ctx->frames_encoded, 1);
 
     if (frames_encoded % 50 == 0)
@@ -2405,117 +2506,14 @@ static void avpu_turn_off_gc(int fd, int core)
     avpu_write_reg(fd, AVPU_REG_CORE_CLKCMD(core), new_val);
 }
 
-/* Fifo_Init - based on decompilation at 0x7af28 */
-static int fifo_init(long *fifo, int max_elements)
-{
-    fifo[0] = max_elements + 1;
-    fifo[1] = 0; /* write_idx */
-    fifo[2] = 0; /* read_idx */
-    fifo[6] = 0; /* count */
-    fifo[7] = 0; /* flag (stored as long, but OEM uses byte) */
-
-    /* Allocate buffer */
-    void *buf = malloc((max_elements + 1) * sizeof(void*));
-    if (!buf) return 0;
-    memset(buf, 0xcd, (max_elements + 1) * sizeof(void*));
-    fifo[3] = (long)buf;
-
-    /* Create synchronization primitives */
-    pthread_mutex_t *mutex = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
-    pthread_cond_t *cond = (pthread_cond_t*)malloc(sizeof(pthread_cond_t));
-
-    if (!mutex || !cond) {
-        free(buf);
-        free(mutex);
-        free(cond);
-        return 0;
-    }
-
-    pthread_mutex_init(mutex, NULL);
-    pthread_cond_init(cond, NULL);
-
-    fifo[4] = (long)mutex;
-    fifo[5] = (long)cond;  /* OEM uses event, we use cond var */
-    fifo[8] = 0; /* semaphore - not used in our implementation */
-
-    return 1;
-}
-
-/* Fifo_Queue - based on decompilation at 0x7b254 */
-static int fifo_queue(long *fifo, void *item, unsigned int timeout_ms)
-{
-    pthread_mutex_t *mutex = (pthread_mutex_t*)fifo[4];
-    pthread_cond_t *cond = (pthread_cond_t*)fifo[5];
-
-    pthread_mutex_lock(mutex);
-
-    int max = (int)fifo[0];
-    int write_idx = (int)fifo[1];
-    void **buf = (void**)fifo[3];
-
-    buf[write_idx] = item;
-    fifo[6]++; /* increment count */
-    fifo[1] = (write_idx + 1) % max;
-
-    pthread_cond_signal(cond);
-    pthread_mutex_unlock(mutex);
-
-    return 1;
-}
-
-/* Fifo_Dequeue - based on decompilation at 0x7b384 */
-static void* fifo_dequeue(long *fifo, unsigned int timeout_ms)
-{
-    pthread_mutex_t *mutex = (pthread_mutex_t*)fifo[4];
-    pthread_cond_t *cond = (pthread_cond_t*)fifo[5];
-
-    pthread_mutex_lock(mutex);
-
-    int count = (int)fifo[6];
-
-    /* Wait for data if empty */
-    while (count <= 0) {
-        if (timeout_ms == 0xffffffff) {
-            /* Infinite wait */
-            pthread_cond_wait(cond, mutex);
-        } else {
-            /* Timed wait */
-            struct timespec ts;
-            clock_gettime(CLOCK_REALTIME, &ts);
-            ts.tv_sec += timeout_ms / 1000;
-            ts.tv_nsec += (timeout_ms % 1000) * 1000000;
-            if (ts.tv_nsec >= 1000000000) {
-                ts.tv_sec++;
-                ts.tv_nsec -= 1000000000;
-            }
-
-            if (pthread_cond_timedwait(cond, mutex, &ts) != 0) {
-                pthread_mutex_unlock(mutex);
-                return NULL;
-            }
-        }
-        count = (int)fifo[6];
-    }
-
-    int max = (int)fifo[0];
-    int read_idx = (int)fifo[2];
-    void **buf = (void**)fifo[3];
-
-    void *result = buf[read_idx];
-    fifo[6]--; /* decrement count */
-    fifo[2] = (read_idx + 1) % max;
-
-    pthread_mutex_unlock(mutex);
-
-    return result;
-}
-
 /* EndEncoding callback - based on OEM's EndEncoding at 0x443b0
  * Called when encoding completes for a frame.
  * This is the callback registered for encoding interrupts.
  *
- * IMPORTANT: This runs in the IRQ thread context (NOT interrupt context),
- * so it's safe to do blocking operations like malloc and FIFO operations.
+ * IMPORTANT: This runs on the IRQ thread every channel shares (NOT
+ * interrupt context). malloc is fine, but nothing here may wait: every
+ * lock taken below is held only briefly and the stream push never waits
+ * for room.
  */
 static void avpu_end_encoding_callback(void *user_data)
 {
@@ -2550,10 +2548,7 @@ static void avpu_end_encoding_callback(void *user_data)
     have_pending = avpu_pending_peek(ctx, &buf_idx, NULL);
     if (have_pending && buf_idx >= 0 && buf_idx < 16) {
         cl_idx = ctx->stream_enc2_cl_idx[buf_idx];
-        if (!ctx->cl_ring.uncached_map && avpu_cl_ring_base(ctx))
-            avpu_flush_cache(ctx->fd, ctx->cl_ring.map, 0x100000, 0 /* BIDIRECTIONAL */);
-        if (!ctx->cl_submit_ring.uncached_map && avpu_cl_submit_ring_base(ctx))
-            avpu_flush_cache(ctx->fd, ctx->cl_submit_ring.map, 0x100000, 0 /* BIDIRECTIONAL */);
+        avpu_cache_inv_cl_entry(ctx, cl_idx);
         status_regs_ptr = avpu_cl_entry_ptr(ctx, cl_idx);
         if (!status_regs_ptr)
             status_regs_ptr = avpu_cl_submit_entry_ptr(ctx, cl_idx);
@@ -2688,10 +2683,10 @@ static void avpu_log_busy_snapshot(ALAvpuContext *ctx, uint32_t idx, unsigned in
     int have_status_8230 = (avpu_read_reg_quiet(ctx->fd, AVPU_REG_CORE_STATUS_8230(0), &status_8230) == 0);
     int have_status_8234 = (avpu_read_reg_quiet(ctx->fd, AVPU_REG_CORE_STATUS_8234(0), &status_8234) == 0);
     int have_status_8238 = (avpu_read_reg_quiet(ctx->fd, AVPU_REG_CORE_STATUS_8238(0), &status_8238) == 0);
-    int wait_errno = ctx->irq_wait_errno;
+    int wait_errno = avpu_irq_wait_errno;
 
     LOG_CODEC(
-        "AVPU: busy snapshot CL[%u] core_status=0x%08x irq_mask=%s0x%08x irq_pending=%s0x%08x clkcmd=%s0x%08x cl_addr=%s0x%08x wpp_reset=%s0x%08x stat8230=%s0x%08x stat8234=%s0x%08x stat8238=%s0x%08x session_ready=%d frames_encoded=%d irq_thread_running=%d irq_thread_started=%d irq_thread_exited=%d last_irq=%d wait_irq_errno=%d (%s) init_trace=%d stream_flush_failures=%d interm_flush_ret=%d cl_flush_ret=%d",
+        "AVPU: busy snapshot CL[%u] core_status=0x%08x irq_mask=%s0x%08x irq_pending=%s0x%08x clkcmd=%s0x%08x cl_addr=%s0x%08x wpp_reset=%s0x%08x stat8230=%s0x%08x stat8234=%s0x%08x stat8238=%s0x%08x session_ready=%d frames_encoded=%d sched_chn=%d irq_thread_started=%d irq_thread_exited=%d last_irq=%d wait_irq_errno=%d (%s) init_trace=%d stream_flush_failures=%d interm_flush_ret=%d cl_flush_ret=%d",
         idx,
         core_status,
         have_irq_mask ? "" : "ERR:", irq_mask,
@@ -2704,7 +2699,7 @@ static void avpu_log_busy_snapshot(ALAvpuContext *ctx, uint32_t idx, unsigned in
         have_status_8238 ? "" : "ERR:", status_8238,
         ctx->session_ready,
         ctx->frames_encoded,
-        ctx->irq_thread_running,
+        ctx->sched_chn,
         ctx->irq_thread_started,
         ctx->irq_thread_exited,
         ctx->last_irq_id,
@@ -2828,28 +2823,22 @@ static void avpu_register_callback(ALAvpuContext *ctx, void (*callback)(void*),
 }
 
 /* WaitInterruptThread - based on decompilation at 0x35e28
- * This thread waits for AVPU interrupts and dispatches registered callbacks.
- * The OEM uses this for encoding completion notifications.
+ * The OEM runs one such thread per board; every channel shares the one
+ * /dev/avpu fd, so here the thread lives in avpu_sched and these hooks
+ * wait on the fd and hand each interrupt to the channel whose frame it
+ * belongs to, which looks up its registered callback.
  */
-static void* avpu_irq_thread(void* arg)
+static int avpu_sched_wait_irq(void *arg, uint32_t *irq_id)
 {
-    ALAvpuContext* ctx = (ALAvpuContext*)arg;
-    int fd = ctx->fd;
-
-    ctx->irq_thread_started = 1;
-    ctx->irq_thread_exited = 0;
-    ctx->irq_wait_errno = 0;
-    ctx->last_irq_id = -1;
+    int fd = (int)(intptr_t)arg;
 
-    LOG_CODEC("IRQ thread: started for fd=%d", fd);
-
-    while (ctx->irq_thread_running) {
+    while (1) {
         /* Use heap buffer with slack for WAIT_IRQ return value to avoid over-copy issues */
         size_t buf_sz = sizeof(uint32_t) + 0x40;
         void *raw = NULL;
         if (posix_memalign(&raw, 16, buf_sz) != 0 || !raw) {
             LOG_CODEC("IRQ thread: posix_memalign failed");
-            break;
+            return -1;
         }
         memset(raw, 0xFF, buf_sz);
         uint32_t *p_irq = (uint32_t*)raw;
@@ -2857,100 +2846,78 @@ static void* avpu_irq_thread(void* arg)
 
         /* ioctl($a0_2, 0xc004710c, &var_28) - AL_CMD_IP_WAIT_IRQ */
         if (avpu_sys_ioctl(fd, AL_CMD_IP_WAIT_IRQ, p_irq) == -1) {
-            if (errno == EINTR) {
-                free(raw);
-                continue; /* interrupted by signal, retry */
-            }
-            if (errno != EINTR) {
-                ctx->irq_wait_errno = errno;
-                LOG_CODEC("IRQ thread: WAIT_IRQ failed: %s (%d)", strerror(errno), errno);
-            }
             free(raw);
-            break;
+            if (errno == EINTR)
+                continue; /* interrupted by signal, retry */
+            avpu_irq_wait_errno = errno;
+            LOG_CODEC("IRQ thread: WAIT_IRQ failed: %s (%d)", strerror(errno), errno);
+            return -1;
         }
 
-        uint32_t irq_id = *p_irq;
+        *irq_id = *p_irq;
         free(raw);
-        ctx->irq_wait_errno = 0;
+        avpu_irq_wait_errno = 0;
+        return 0;
+    }
+}
 
-        /* OEM: if (var_28 u>= 0x14) fprintf(stderr, ...) */
-        if (irq_id >= 20) {
-            LOG_CODEC("IRQ thread: invalid IRQ ID %d", irq_id);
-            continue;
-        }
+static void avpu_sched_unblock_irq(void *arg)
+{
+    avpu_sys_ioctl((int)(intptr_t)arg, AL_CMD_UNBLOCK_CHANNEL, NULL);
+}
 
-        ctx->last_irq_id = (int)irq_id;
-        { static unsigned int irq_count = 0; unsigned int c = __sync_add_and_fetch(&irq_count, 1);
-          if (c <= 5 || (c % 50) == 0)
-            LOG_CODEC("IRQ thread: IRQ %d received [#%u]", irq_id, c);
-        }
+static void avpu_dispatch_irq(void *owner, uint32_t irq_id)
+{
+    ALAvpuContext *ctx = (ALAvpuContext *)owner;
 
-        /* OEM: Rtos_GetMutex(*(arg1 + 0xc)) */
-        pthread_mutex_lock((pthread_mutex_t*)ctx->irq_mutex);
+    /* OEM: if (var_28 u>= 0x14) fprintf(stderr, ...) */
+    if (irq_id >= 20) {
+        LOG_CODEC("IRQ thread: invalid IRQ ID %d", irq_id);
+        return;
+    }
 
-        /* OEM: Calculate callback offset: arg1 + (irq_id * 16 - irq_id * 4) + 0x10
-         * This is: arg1 + (irq_id * 12) + 0x10
-         * Array of 20 entries, each 12 bytes: [callback_fn, user_data, flag]
-         */
-        int idx = irq_id * 3; /* 3 ints per entry */
-        void (*callback)(void*) = (void(*)(void*))ctx->irq_callbacks[idx];
-        void *user_data = (void*)ctx->irq_callbacks[idx + 1];
-        int flag = ctx->irq_callbacks[idx + 2];
-
-        /* OEM: if ($t9_1 != 0) $t9_1(...) else if (flag == 0) fprintf(stderr, ...) */
-        if (callback != NULL) {
-            callback(user_data);
-        } else if (flag == 0) {
-            LOG_CODEC("IRQ thread: Interrupt %d doesn't have a handler", irq_id);
-        }
+    ctx->last_irq_id = (int)irq_id;
+    { static unsigned int irq_count = 0; unsigned int c = __sync_add_and_fetch(&irq_count, 1);
+      if (c <= 5 || (c % 50) == 0)
+        LOG_CODEC("IRQ thread: IRQ %d received for channel %d [#%u]", irq_id, ctx->sched_chn, c);
+    }
+
+    /* OEM: Rtos_GetMutex(*(arg1 + 0xc)) */
+    pthread_mutex_lock((pthread_mutex_t*)ctx->irq_mutex);
 
-        /* OEM: Rtos_ReleaseMutex(*(arg1 + 0xc)) */
-        pthread_mutex_unlock((pthread_mutex_t*)ctx->irq_mutex);
+    /* OEM: Calculate callback offset: arg1 + (irq_id * 16 - irq_id * 4) + 0x10
+     * This is: arg1 + (irq_id * 12) + 0x10
+     * Array of 20 entries, each 12 bytes: [callback_fn, user_data, flag]
+     */
+    int idx = irq_id * 3; /* 3 ints per entry */
+    void (*callback)(void*) = (void(*)(void*))ctx->irq_callbacks[idx];
+    void *user_data = (void*)ctx->irq_callbacks[idx + 1];
+    int flag = ctx->irq_callbacks[idx + 2];
+
+    /* OEM: if ($t9_1 != 0) $t9_1(...) else if (flag == 0) fprintf(stderr, ...) */
+    if (callback != NULL) {
+        callback(user_data);
+    } else if (flag == 0) {
+        LOG_CODEC("IRQ thread: Interrupt %d doesn't have a handler", irq_id);
     }
 
-    ctx->irq_thread_exited = 1;
-    LOG_CODEC("IRQ thread: exiting");
-    return NULL;
+    /* OEM: Rtos_ReleaseMutex(*(arg1 + 0xc)) */
+    pthread_mutex_unlock((pthread_mutex_t*)ctx->irq_mutex);
 }
 
 /* Compute effective AnnexB stream size (trim trailing zeros) */
 static size_t annexb_effective_size(const uint8_t *buf, size_t maxlen)
 {
     if (!buf || maxlen < 4) return 0;
-    size_t first = (size_t)-1;
-    size_t last = 0;
-    for (size_t i = 0; i + 3 < maxlen; ++i) {
-        if ((buf[i] == 0 && buf[i+1] == 0 && buf[i+2] == 1) ||
-            (i + 4 < maxlen && buf[i] == 0 && buf[i+1] == 0 && buf[i+2] == 0 && buf[i+3] == 1)) {
-            if (first == (size_t)-1) first = i;
-            last = i;
-        }
-    }
-    if (first == (size_t)-1) return 0;
-    size_t end = maxlen;
-    for (size_t i = last + 3; i + 3 < maxlen; ++i) {
-        if ((buf[i] == 0 && buf[i+1] == 0 && buf[i+2] == 1) ||
-            (i + 4 < maxlen && buf[i] == 0 && buf[i+1] == 0 && buf[i+2] == 0 && buf[i+3] == 1)) {
-            end = i; break;
-        }
-    }
-    if (end == maxlen) {
-        while (end > first && buf[end-1] == 0) end--;
-    }
+    size_t first = annexb_find_start(buf, 0, maxlen, NULL);
+    if (first >= maxlen) return 0;
+    size_t end = annexb_trim_zeros(buf, maxlen);
     return (end > first) ? (end - first) : 0;
 }
 
 static uint32_t avpu_stream_buffer_raw_end(const uint8_t *buf, size_t maxlen)
 {
-    size_t end = maxlen;
-
-    if (!buf)
-        return 0;
-
-    while (end > 0 && buf[end - 1] == 0)
-        end--;
-
-    return (uint32_t)end;
+    return (uint32_t)annexb_trim_zeros(buf, maxlen);
 }
 
 static void avpu_format_hex_preview(const uint8_t *buf, size_t len, char *out, size_t out_sz)
@@ -3084,12 +3051,10 @@ static uint32_t avpu_read_hw_stream_end(ALAvpuContext *ctx, int buf_idx)
 
     cl_idx = ctx->stream_enc2_cl_idx[buf_idx];
 
-    /* Cache-invalidate both mirrored CL rings so we can prefer the CPU-visible
-     * readback copy but still compare against the submit copy if needed. */
-    if (!ctx->cl_ring.uncached_map && avpu_cl_ring_base(ctx))
-        avpu_flush_cache(ctx->fd, ctx->cl_ring.map, 0x100000, 0 /*BIDIRECTIONAL*/);
-    if (!ctx->cl_submit_ring.uncached_map)
-        avpu_flush_cache(ctx->fd, ctx->cl_submit_ring.map, 0x100000, 0 /*BIDIRECTIONAL*/);
+    /* Cache-invalidate the entry in both mirrored CL rings so we can prefer
+     * the CPU-visible readback copy but still compare against the submit
+     * copy if needed. */
+    avpu_cache_inv_cl_entry(ctx, cl_idx);
 
     readback_cmd = (const uint32_t *)avpu_cl_entry_ptr(ctx, cl_idx);
     submit_cmd = (const uint32_t *)avpu_cl_submit_entry_ptr(ctx, cl_idx);
@@ -3120,24 +3085,24 @@ static uint32_t avpu_stream_buffer_effective_size(ALAvpuContext *ctx, int buf_id
     if (!ctx->stream_bufs[buf_idx].map)
         return 0;
 
-    /* Invalidate CPU cache for the stream buffer so we read fresh data
-     * written by AVPU DMA. Use dir=0 (DMA_BIDIRECTIONAL = writeback +
-     * invalidate) with a 1MB size to flush the ENTIRE L1 D-cache on
-     * T31's MIPS core (~32KB). dir=2 (invalidate-only) may not work
-     * reliably on this kernel; dir=0 with large size is the proven
-     * full-cache-flush path from the pre-submit code. */
-    {
-        int inv_ret = avpu_flush_cache(ctx->fd, ctx->stream_bufs[buf_idx].map,
-                                       0x100000, 0 /*BIDIRECTIONAL*/);
-        if (flush_ret_out)
-            *flush_ret_out = inv_ret;
-    }
-
     /* OEM parity: read the hardware-updated stream end position from the CL.
      * This is the authoritative byte count — it matches exactly what the OEM
      * OutputSlice reads at *(cl + 0xf8) or *(cl + 0xc8). */
     hw_end = avpu_read_hw_stream_end(ctx, buf_idx);
 
+    /* Invalidate CPU cache for the bytes the AVPU wrote so we read fresh
+     * data. Without a sane hw_end the whole buffer is needed for the
+     * trailing-zero scan below. dir=2 (invalidate-only) may not work
+     * reliably on this kernel, hence dir=0 (DMA_BIDIRECTIONAL). */
+    {
+        uint32_t hdr_off = ctx->stream_header_offset;
+        if (buf_idx < 16 && ctx->stream_header_offset_by_buf[buf_idx] != 0)
+            hdr_off = ctx->stream_header_offset_by_buf[buf_idx];
+        int inv_ret = avpu_cache_inv_stream(ctx, buf_idx, hw_end > hdr_off ? hw_end : 0);
+        if (flush_ret_out)
+            *flush_ret_out = inv_ret;
+    }
+
     /* Diagnostic: also read cmd[0x3e] and cmd[0x52] from the CL — the AVPU
      * might update a different word for inline Enc2. */
     {
@@ -3234,9 +3199,12 @@ struct AL_CodecEncode {
     int stream_buf_size;            /* 0x7b0: Stream buffer size */
     uint8_t stream_pool[0x44];      /* 0x7b4-0x7f7: Stream buffer pool */
 
-    /* FIFOs (control structures allocated dynamically to ensure proper size) */
+    /* FIFOs (control structures allocated dynamically to ensure proper size).
+     * Both are SpscFifo: frames go encoder thread -> stream thread, streams go
+     * IRQ thread (or SW encode) -> stream thread. */
     void *fifo_frames;              /* Frame FIFO control block */
     void *fifo_streams;             /* Stream FIFO control block */
+    void *stream_desc_pool;         /* ObjPool of HWStreamBuffer descriptors */
 
     /* Frame buffer pool config */
     uint8_t frame_pool_config[0x60]; /* 0x840-0x89f: Frame pool config */
@@ -3263,8 +3231,71 @@ struct AL_CodecEncode {
     int loop_filter_beta_offset;
     int loop_filter_tc_offset;
     ALAvpuContext avpu;            /* Vendor-like AL over /dev/avpu (scaffolding) */
+    int stream_held;               /* Streams the consumer may hold (SetStreamPoolDepth) */
 };
 
+/* Streams a GetStream caller may hold before SetStreamPoolDepth is called */
+#define CODEC_STREAM_DESC_HELD_DEFAULT 2
+
+/* fifo_streams holds every completed stream of either path: up to
+ * stream_buf_count software streams, or one per AVPU stream buffer, whose
+ * count is only settled when the core is opened on the first frame. Sized
+ * for the larger so the AVPU producer never finds it full. */
+static int codec_stream_fifo_depth(const AL_CodecEncode *enc)
+{
+    return enc->stream_buf_count > AVPU_STREAM_BUF_MAX ? enc->stream_buf_count
+                                                       : AVPU_STREAM_BUF_MAX;
+}
+
+/* HWStreamBuffer descriptors live in fifo_streams, in the hands of the
+ * consumer ('held') and with the two producers (encoder thread and AVPU
+ * IRQ thread) while they fill one in. */
+static int codec_stream_desc_pool_init(AL_CodecEncode *enc, int held)
+{
+    int count = codec_stream_fifo_depth(enc) + 2 + held;
+
+    if (ObjPool_Init(enc->stream_desc_pool, count, (int)sizeof(HWStreamBuffer)) < 0) {
+        LOG_CODEC("stream descriptor pool init failed (count=%d), using heap", count);
+        return -1;
+    }
+    return 0;
+}
+
+/* Per-frame descriptor allocation. Falls back to the heap when the pool is
+ * exhausted so a slow consumer degrades to the old behaviour instead of
+ * dropping frames; ObjPool counts every fallback. */
+static HWStreamBuffer *codec_stream_desc_get(AL_CodecEncode *enc)
+{
+    HWStreamBuffer *hw_stream = (HWStreamBuffer *)ObjPool_Get(enc->stream_desc_pool);
+
+    if (hw_stream == NULL) {
+        static unsigned int miss_log = 0;
+        unsigned int c = __sync_add_and_fetch(&miss_log, 1);
+        if (c <= 3 || (c % 50) == 0)
+            LOG_CODEC("stream descriptor pool exhausted on channel %d, using heap [#%u]",
+                      enc->channel_id - 1, c);
+        hw_stream = (HWStreamBuffer *)calloc(1, sizeof(HWStreamBuffer));
+    }
+    return hw_stream;
+}
+
+static void codec_stream_desc_put(AL_CodecEncode *enc, HWStreamBuffer *hw_stream)
+{
+    if (hw_stream != NULL && !ObjPool_Put(enc->stream_desc_pool, hw_stream))
+        free(hw_stream);
+}
+
+/* Bump the stream-ready eventfd after a push to fifo_streams so an epoll
+ * waiter on AL_Codec_Encode_GetStreamFd wakes without polling. */
+static void codec_signal_stream(AL_CodecEncode *enc)
+{
+    if (enc->event) {
+        uint64_t one = 1;
+        ssize_t n = write((int)(uintptr_t)enc->event, &one, sizeof(one));
+        (void)n;
+    }
+}
+
 static int avpu_can_use_high_profile_template(const AL_CodecEncode *enc)
 {
     if (!enc)
@@ -3390,7 +3421,7 @@ static void codec_sync_rc_cache(AL_CodecEncode *enc)
 static void codec_queue_frame_metadata(AL_CodecEncode *enc, void *user_data)
 {
     if (enc == NULL || user_data == NULL || enc->fifo_frames == NULL) return;
-    if (Fifo_Queue(enc->fifo_frames, user_data, -1) == 0) {
+    if (SpscFifo_Queue(enc->fifo_frames, user_data, -1) == 0) {
         LOG_CODEC("Process: failed to queue frame metadata %p", user_data);
     }
 }
@@ -3398,7 +3429,7 @@ static void codec_queue_frame_metadata(AL_CodecEncode *enc, void *user_data)
 static void *codec_dequeue_frame_metadata(AL_CodecEncode *enc)
 {
     if (enc == NULL || enc->fifo_frames == NULL) return NULL;
-    return Fifo_Dequeue(enc->fifo_frames, 0);
+    return SpscFifo_Dequeue(enc->fifo_frames, 0);
 }
 
 static void avpu_hw_stream_set_user_data(HWStreamBuffer *hw_stream, void *user_data)
@@ -3453,6 +3484,7 @@ static int avpu_queue_completed_stream(ALAvpuContext *ctx, int buf_idx, void *us
         return 0;
 
     frame_size = avpu_stream_buffer_effective_size(ctx, buf_idx, &flush_ret);
+    avpu_cache_frame_done(ctx);
     if (frame_size_out)
         *frame_size_out = frame_size;
     if (flush_ret_out)
@@ -3477,7 +3509,7 @@ static int avpu_queue_completed_stream(ALAvpuContext *ctx, int buf_idx, void *us
         }
     }
 
-    hw_stream = (HWStreamBuffer *)calloc(1, sizeof(HWStreamBuffer));
+    hw_stream = codec_stream_desc_get(enc);
     if (!hw_stream) {
         LOG_CODEC("%s: failed to allocate HWStreamBuffer for completed buf[%d]",
                   source ? source : "EndEncoding", buf_idx);
@@ -3497,11 +3529,15 @@ static int avpu_queue_completed_stream(ALAvpuContext *ctx, int buf_idx, void *us
               buf_idx, (void *)hw_stream, phys_addr, virt_addr, frame_size,
               flush_ret, user_data);
 
-    if (Fifo_Queue(enc->fifo_streams, hw_stream, -1) == 0) {
+    /* Runs on the shared IRQ thread under complete_mutex: never wait for
+     * room. A full or aborted fifo drops the stream and the caller hands
+     * the buffer back as FREE. */
+    if (SpscFifo_Queue(enc->fifo_streams, hw_stream, 0) == 0) {
         LOG_CODEC("%s: failed to queue completed stream buf[%d]", source ? source : "EndEncoding", buf_idx);
-        free(hw_stream);
+        codec_stream_desc_put(enc, hw_stream);
         return 0;
     }
+    codec_signal_stream(enc);
 
     if (ctx->frames_encoded % 50 == 0)
     LOG_CODEC("%s: queued completed stream buf[%d] stream=%p phys=0x%08x virt=0x%08x len=%u flush_ret=%d",
@@ -3684,6 +3720,7 @@ int AL_Codec_Encode_Create(void **codec, void *params) {
      * which causes every 'if (enc->avpu.fd >= 0)' check to be true
      * even when /dev/avpu was never opened. Set to -1 explicitly. */
     enc->avpu.fd = -1;
+    enc->avpu.sched_chn = -1;
     enc->avpu.event_fd = -1;
     enc->avpu.cl_ring.dmabuf_fd = -1;
     enc->avpu.interm_buf.dmabuf_fd = -1;
@@ -3713,18 +3750,22 @@ int AL_Codec_Encode_Create(void **codec, void *params) {
     enc->stream_buf_size = 0x28000;     /* OEM-parity default: 160KB stream buffer */
 
     /* Allocate and initialize FIFO control structures safely */
-    int fifo_size = Fifo_SizeOf();
+    int fifo_size = SpscFifo_SizeOf();
     enc->fifo_frames = malloc(fifo_size);
     enc->fifo_streams = malloc(fifo_size);
-    if (enc->fifo_frames == NULL || enc->fifo_streams == NULL) {
+    enc->stream_desc_pool = malloc(ObjPool_SizeOf());
+    if (enc->fifo_frames == NULL || enc->fifo_streams == NULL || enc->stream_desc_pool == NULL) {
         LOG_CODEC("Create: FIFO alloc failed");
         if (enc->fifo_frames) free(enc->fifo_frames);
         if (enc->fifo_streams) free(enc->fifo_streams);
+        if (enc->stream_desc_pool) free(enc->stream_desc_pool);
         free(enc);
         return -1;
     }
-    Fifo_Init(enc->fifo_frames, enc->frame_buf_count);
-    Fifo_Init(enc->fifo_streams, enc->stream_buf_count);
+    SpscFifo_Init(enc->fifo_frames, enc->frame_buf_count);
+    SpscFifo_Init(enc->fifo_streams, codec_stream_fifo_depth(enc));
+    enc->stream_held = CODEC_STREAM_DESC_HELD_DEFAULT;
+    codec_stream_desc_pool_init(enc, enc->stream_held);
 
     /* Set source FourCC to NV12 */
     enc->src_fourcc = 0x3231564e;  /* 'NV12' */
@@ -3769,10 +3810,12 @@ int AL_Codec_Encode_Create(void **codec, void *params) {
     pthread_mutex_unlock(&g_codec_mutex);
 
     /* No free slots */
-    Fifo_Deinit(enc->fifo_frames);
-    Fifo_Deinit(enc->fifo_streams);
+    SpscFifo_Deinit(enc->fifo_frames);
+    SpscFifo_Deinit(enc->fifo_streams);
+    ObjPool_Deinit(enc->stream_desc_pool);
     free(enc->fifo_frames);
     free(enc->fifo_streams);
+    free(enc->stream_desc_pool);
     free(enc);
     LOG_CODEC("Create: no free slots");
     return -1;
@@ -3793,6 +3836,19 @@ int AL_Codec_Encode_Destroy(void *codec) {
 
     /* Deinitialize hardware encoder(s) - OEM parity: no separate deinit function */
     if (enc->use_hardware == 2 && enc->avpu.fd >= 0) {
+        /* Stop taking interrupts before the buffers they complete into go
+         * away; the last channel to leave unblocks and joins
+         * WaitInterruptThread (OEM parity) */
+        if (enc->avpu.sched_chn >= 0) {
+            /* A completion in flight on the IRQ thread must not wait on
+             * fifo_streams while detach waits for it */
+            SpscFifo_Abort(enc->fifo_streams);
+            avpu_sched_detach(enc->avpu.sched_chn);
+            enc->avpu.sched_chn = -1;
+            enc->avpu.irq_thread_exited = 1;
+            LOG_CODEC("AVPU: channel=%d detached from core scheduler", enc->channel_id - 1);
+        }
+
         /* Clean up stream buffers and command-list mappings */
         for (int i = 0; i < enc->avpu.stream_bufs_used; ++i) {
             if (enc->avpu.stream_bufs[i].map) {
@@ -3849,21 +3905,8 @@ int AL_Codec_Encode_Destroy(void *codec) {
             enc->avpu.interm_buf.dmabuf_fd = -1;
         }
 
-        /* OEM parity: unblock WaitInterruptThread before close/join */
-        enc->avpu.irq_thread_running = 0;
-        if (enc->avpu.fd >= 0) {
-            avpu_sys_ioctl(enc->avpu.fd, AL_CMD_UNBLOCK_CHANNEL, NULL);
-        }
         AL_DevicePool_Close(enc->avpu.fd);
         enc->avpu.fd = -1;
-
-        /* Join IRQ thread if it was started */
-        if (enc->avpu.irq_thread) {
-            pthread_t tid = (pthread_t)enc->avpu.irq_thread;
-            pthread_join(tid, NULL);
-            enc->avpu.irq_thread = 0;
-            LOG_CODEC("AVPU: IRQ thread joined");
-        }
         /* Destroy IRQ mutex if allocated */
         if (enc->avpu.irq_mutex) {
             pthread_mutex_destroy((pthread_mutex_t*)enc->avpu.irq_mutex);
@@ -3875,6 +3918,11 @@ int AL_Codec_Encode_Destroy(void *codec) {
             free(enc->avpu.stream_queue_mutex);
             enc->avpu.stream_queue_mutex = NULL;
         }
+        if (enc->avpu.complete_mutex) {
+            pthread_mutex_destroy((pthread_mutex_t*)enc->avpu.complete_mutex);
+            free(enc->avpu.complete_mutex);
+            enc->avpu.complete_mutex = NULL;
+        }
 
     }
     if (enc->hw_encoder_fd >= 0) {
@@ -3893,12 +3941,21 @@ int AL_Codec_Encode_Destroy(void *codec) {
     pthread_mutex_unlock(&g_codec_mutex);
 
     /* Deinitialize FIFOs */
-    Fifo_Deinit(enc->fifo_frames);
-    Fifo_Deinit(enc->fifo_streams);
+    SpscFifo_Deinit(enc->fifo_frames);
+    SpscFifo_Deinit(enc->fifo_streams);
+
+    {
+        ObjPoolStats st;
+        ObjPool_GetStats(enc->stream_desc_pool, &st);
+        LOG_CODEC("Destroy: stream pool cap=%d peak=%d gets=%u exhausted=%u",
+                  st.capacity, st.peak, st.gets, st.exhausted);
+    }
+    ObjPool_Deinit(enc->stream_desc_pool);
 
     /* Free FIFO control blocks */
     free(enc->fifo_frames);
     free(enc->fifo_streams);
+    free(enc->stream_desc_pool);
 
     /* Close OEM-like event if created */
     if (enc->event) {
@@ -3941,7 +3998,7 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
     }
 
     /* Encode frame using hardware or software */
-    HWStreamBuffer *hw_stream = (HWStreamBuffer*)malloc(sizeof(HWStreamBuffer));
+    HWStreamBuffer *hw_stream = codec_stream_desc_get(enc);
     if (hw_stream == NULL) {
         LOG_CODEC("Process: failed to allocate stream buffer");
         return -1;
@@ -4075,7 +4132,7 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
                         enc->avpu.init_top_read_val = 0;
                         enc->avpu.irq_thread_started = 0;
                         enc->avpu.irq_thread_exited = 0;
-                        enc->avpu.irq_wait_errno = 0;
+                        enc->avpu.sched_chn = -1;
                         enc->avpu.last_irq_id = -1;
                         enc->avpu.reference_valid = 0;
                         enc->avpu.codec_owner = enc;
@@ -4096,25 +4153,69 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
                             pthread_mutex_init(stream_mutex, NULL);
                             enc->avpu.stream_queue_mutex = stream_mutex;
                         }
+                        pthread_mutex_t *complete_mutex = (pthread_mutex_t*)malloc(sizeof(pthread_mutex_t));
+                        if (complete_mutex) {
+                            pthread_mutex_init(complete_mutex, NULL);
+                            enc->avpu.complete_mutex = complete_mutex;
+                        }
                         memset(enc->avpu.irq_callbacks, 0, sizeof(enc->avpu.irq_callbacks));
 
+                        /* Cache live encode state for OEM-shaped command-list population. */
+                        avpu_sync_runtime_encode_state(enc);
+
+                        /* OPENIMP_AVPU_INFLIGHT=N queues up to N frames on the
+                         * core and prepares the next meanwhile; unset or 0
+                         * keeps the one-frame-at-a-time submit path */
+                        {
+                            const char *inflight_env = getenv("OPENIMP_AVPU_INFLIGHT");
+                            int depth = inflight_env ? atoi(inflight_env) : 0;
+
+                            if (depth < 0)
+                                depth = 0;
+                            if (depth > AVPU_INFLIGHT_MAX)
+                                depth = AVPU_INFLIGHT_MAX;
+                            enc->avpu.inflight_max = depth;
+                            LOG_CODEC("AVPU: submit pipeline depth %d", depth);
+                        }
+
+                        /* Share the core with the other channels: the first
+                         * channel created is the main stream, JPEG comes last.
+                         * The deadline of each frame is one frame interval
+                         * after it asks for the core. Without a pipeline depth
+                         * frames are not held back, as before. */
                         if (enc->avpu.irq_mutex) {
-                            enc->avpu.irq_thread_running = 1;
-                            pthread_t tid;
-                            if (pthread_create(&tid, NULL, avpu_irq_thread, &enc->avpu) == 0) {
-                                enc->avpu.irq_thread = (long)tid;
-                                LOG_CODEC("AVPU: WaitInterruptThread started during open");
+                            int prio = codec_type == IMP_ENC_TYPE_JPEG ? AVPU_SCHED_PRIO_JPEG
+                                     : enc->channel_id == 1 ? AVPU_SCHED_PRIO_MAIN
+                                     : AVPU_SCHED_PRIO_SUB;
+                            uint32_t period_us = (uint32_t)(1000000ULL * enc->hw_params.fps_den
+                                                            / enc->hw_params.fps_num);
+
+                            if (avpu_sched_attach(enc->channel_id - 1, prio, period_us,
+                                                  enc->avpu.inflight_max > 0 ? enc->avpu.inflight_max
+                                                                             : AVPU_INFLIGHT_MAX,
+                                                  &enc->avpu, avpu_sched_wait_irq,
+                                                  avpu_sched_unblock_irq, (void *)(intptr_t)fd,
+                                                  avpu_dispatch_irq) == 0) {
+                                enc->avpu.sched_chn = enc->channel_id - 1;
+                                enc->avpu.irq_thread_started = 1;
+                                LOG_CODEC("AVPU: channel=%d on core scheduler prio=%d period=%uus",
+                                          enc->avpu.sched_chn, prio, period_us);
                             } else {
-                                LOG_CODEC("AVPU: failed to start WaitInterruptThread during open");
-                                enc->avpu.irq_thread_running = 0;
+                                LOG_CODEC("AVPU: channel=%d failed to attach to core scheduler",
+                                          enc->channel_id - 1);
                             }
                         }
 
-                        /* Cache live encode state for OEM-shaped command-list population. */
-                        avpu_sync_runtime_encode_state(enc);
-
-                        /* Allocate stream buffers via IMP_Alloc (OEM parity) */
-                        enc->avpu.stream_buf_count = 4;
+                        /* Allocate stream buffers via IMP_Alloc (OEM parity): one
+                         * per stream the consumer may hold plus one for each frame
+                         * queued on the core and the one being prepared, so the
+                         * AVPU keeps going while the application sits on earlier
+                         * access units */
+                        enc->avpu.stream_buf_count = enc->stream_held + 1 + enc->avpu.inflight_max;
+                        if (enc->avpu.stream_buf_count < 4)
+                            enc->avpu.stream_buf_count = 4;
+                        if (enc->avpu.stream_buf_count > AVPU_STREAM_BUF_MAX)
+                            enc->avpu.stream_buf_count = AVPU_STREAM_BUF_MAX;
                         enc->avpu.stream_buf_size = enc->stream_buf_size > 0
                             ? enc->stream_buf_size
                             : 0x28000;
@@ -4162,6 +4263,17 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
                                     LOG_CODEC("AVPU: cmdlist ring phys=0x%08x size=%zu entries=%u", phys, cl_bytes, enc->avpu.cl_count);
                                     LOG_CODEC("AVPU: submit cmdlist ring phys=0x%08x size=%zu entries=%u",
                                               submit_phys, cl_bytes, enc->avpu.cl_count);
+
+                                    /* OPENIMP_AVPU_CACHE=full|uncached|range (default) */
+                                    const char *cache_env = getenv("OPENIMP_AVPU_CACHE");
+                                    enc->avpu.cache_mode = AVPU_CACHE_RANGE;
+                                    if (cache_env && strcmp(cache_env, "full") == 0) {
+                                        enc->avpu.cache_mode = AVPU_CACHE_FULL;
+                                    } else if (cache_env && strcmp(cache_env, "uncached") == 0) {
+                                        enc->avpu.cache_mode = AVPU_CACHE_UNCACHED;
+                                        avpu_cache_map_cl_uncached(&enc->avpu);
+                                    }
+                                    LOG_CODEC("AVPU: completion cache mode %d", enc->avpu.cache_mode);
                                 }
                             } else {
                                 LOG_CODEC("AVPU: failed to allocate submit cmdlist ring via IMP_Alloc (size=%zu)", cl_bytes);
@@ -4334,12 +4446,12 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
         }
         if (HW_Encoder_Encode(enc->hw_encoder_fd, &hw_frame) < 0) {
             LOG_CODEC("Process: legacy hardware encoding failed");
-            free(hw_stream);
+            codec_stream_desc_put(enc, hw_stream);
             return -1;
         }
         if (HW_Encoder_GetStream(enc->hw_encoder_fd, hw_stream, 100) < 0) {
             LOG_CODEC("Process: legacy HW get stream timed out");
-            free(hw_stream);
+            codec_stream_desc_put(enc, hw_stream);
             return 0; /* no stream yet */
         }
     } else if (enc->use_hardware == 2 && enc->avpu.fd >= 0) {
@@ -4347,6 +4459,7 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
         ALAvpuContext *ctx = &enc->avpu;
         int fd = ctx->fd;
         int submitted = 0;
+        int granted = 0;
         int force_idr = __sync_lock_test_and_set(&enc->force_next_idr, 0);
 
         /* Keep the AVPU shadow aligned with live control-plane state before
@@ -4369,6 +4482,16 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
          * the AXI bus on T31.
          */
         if (!ctx->session_ready) {
+            /* The core reset below must not hit another channel's frames */
+            if (avpu_sched_acquire(ctx->sched_chn, AVPU_CORE_WAIT_MS) < 0) {
+                LOG_CODEC("Process: channel=%d AVPU core busy for %d ms; deferring init",
+                          enc->channel_id - 1, AVPU_CORE_WAIT_MS);
+                codec_stream_desc_put(enc, hw_stream);
+                errno = EAGAIN;
+                return -1;
+            }
+            granted = 1;
+
             LOG_CODEC("AVPU: AL_EncCore_Init (OEM-exact sequence)");
 
             /* Stock register write sequence (captured via patched avpu.ko):
@@ -4436,7 +4559,9 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
             /* Verify entry alignment */
             if (((uintptr_t)entry & 3) != 0) {
                 LOG_CODEC("ERROR: CL entry not 4-byte aligned: %p", (void*)entry);
-                free(hw_stream);
+                if (granted)
+                    avpu_sched_abort(ctx->sched_chn);
+                codec_stream_desc_put(enc, hw_stream);
 
 
                 return -1;
@@ -4505,13 +4630,17 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
                         LOG_CODEC("Process: pending AVPU stream not yet drained; skipping CL[%u] submit (skip_count=%u enc=%d cons=%d)",
                                   idx, skip_count, ctx->frames_encoded, ctx->frames_consumed);
                     }
-                    free(hw_stream);
+                    if (granted)
+                        avpu_sched_abort(ctx->sched_chn);
+                    codec_stream_desc_put(enc, hw_stream);
                     return -1;
                 }
 
                 if (avpu_is_enc1_running(fd, 0, &core_status)) {
                     if (avpu_try_recover_sticky_completion(ctx, core_status, "Process[AVPU]")) {
-                        free(hw_stream);
+                        if (granted)
+                            avpu_sched_abort(ctx->sched_chn);
+                        codec_stream_desc_put(enc, hw_stream);
                         return -1;
                     }
 
@@ -4525,7 +4654,9 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
                         }
                         avpu_log_busy_snapshot(ctx, idx, core_status);
                     }
-                    free(hw_stream);
+                    if (granted)
+                        avpu_sched_abort(ctx->sched_chn);
+                    codec_stream_desc_put(enc, hw_stream);
                     return -1;
                 }
             } else if (ctx->busy_skip_count != 0) {
@@ -4539,7 +4670,9 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
                 LOG_CODEC("Process: no free AVPU stream buffer (enc=%d cons=%d pending=%d used=%d)",
                           ctx->frames_encoded, ctx->frames_consumed,
                           ctx->pending_stream_count, ctx->stream_bufs_used);
-                free(hw_stream);
+                if (granted)
+                    avpu_sched_abort(ctx->sched_chn);
+                codec_stream_desc_put(enc, hw_stream);
                 errno = EAGAIN;
                 return -1;
             }
@@ -4600,8 +4733,10 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
             int submit_flush_ret;
             if (!submit_entry) {
                 LOG_CODEC("Process: submit CL[%u] missing", idx);
+                if (granted)
+                    avpu_sched_abort(ctx->sched_chn);
                 avpu_mark_stream_buffer_released(ctx, buf_idx);
-                free(hw_stream);
+                codec_stream_desc_put(enc, hw_stream);
                 errno = EAGAIN;
                 return -1;
             }
@@ -4624,10 +4759,23 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
                 ? (idx + 1) % ctx->cl_count   /* P: Enc2 CL at idx+1, read cmd[0x3e] */
                 : idx;                         /* IDR: inline Enc2, read cmd[0x32] from Enc1 CL */
 
+            /* Everything above ran while the core was busy with earlier
+             * frames, ours or another channel's; push only once it is ours */
+            if (!granted && avpu_sched_acquire(ctx->sched_chn, AVPU_CORE_WAIT_MS) < 0) {
+                LOG_CODEC("Process: channel=%d no AVPU core within %d ms (pending=%d depth=%d)",
+                          enc->channel_id - 1, AVPU_CORE_WAIT_MS,
+                          ctx->pending_stream_count, ctx->inflight_max);
+                avpu_mark_stream_buffer_released(ctx, buf_idx);
+                codec_stream_desc_put(enc, hw_stream);
+                errno = EAGAIN;
+                return -1;
+            }
+
             if (!avpu_track_submitted_stream(ctx, buf_idx, user_data)) {
                 LOG_CODEC("Process: failed to track submitted AVPU stream buf[%d]", buf_idx);
+                avpu_sched_abort(ctx->sched_chn);
                 avpu_mark_stream_buffer_released(ctx, buf_idx);
-                free(hw_stream);
+                codec_stream_desc_put(enc, hw_stream);
                 errno = EAGAIN;
                 return -1;
             }
@@ -4760,7 +4908,7 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
                 if (!enc2_submit_entry) {
                     LOG_CODEC("Process: submit Enc2 CL[%u] missing", enc2_idx);
                     avpu_mark_stream_buffer_released(ctx, buf_idx);
-                    free(hw_stream);
+                    codec_stream_desc_put(enc, hw_stream);
                     errno = EAGAIN;
                     return -1;
                 }
@@ -4786,13 +4934,20 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
             ctx->frame_number++;
             submitted = 1;
 
+            /* Pipelined: the next frame references this one's reconstruction
+             * and writes into the other buffer */
+            if (ctx->inflight_max > 0)
+                avpu_promote_reference(ctx);
+
             if (ctx->frame_number % 50 == 0)
             LOG_CODEC("Process: AVPU queued frame %ux%u phys=0x%x CL[%u] hdr=%u - encoding triggered",
                       width, height, phys_addr, idx, hdr_offset);
         }
 
         /* Do not dequeue here; GetStream() will handle stream retrieval */
-        free(hw_stream);
+        if (granted && !submitted)
+            avpu_sched_abort(ctx->sched_chn);
+        codec_stream_desc_put(enc, hw_stream);
         return submitted ? 0 : -1;
     } else {
         /* Software fallback */
@@ -4815,18 +4970,19 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data) {
         }
         if (HW_Encoder_Encode_Software(&hw_frame, hw_stream, codec_type) < 0) {
             LOG_CODEC("Process: software encoding failed");
-            free(hw_stream);
+            codec_stream_desc_put(enc, hw_stream);
             return -1;
         }
     }
 
     /* Queue encoded stream to FIFO */
-    if (Fifo_Queue(enc->fifo_streams, hw_stream, -1) == 0) {
+    if (SpscFifo_Queue(enc->fifo_streams, hw_stream, -1) == 0) {
         LOG_CODEC("Process: failed to queue stream");
-        free(hw_stream);
+        codec_stream_desc_put(enc, hw_stream);
         return -1;
     }
     codec_queue_frame_metadata(enc, user_data);
+    codec_signal_stream(enc);
 
     /* Throttled: per-frame "encoded and queued" log suppressed */
     return 0;
@@ -4863,7 +5019,7 @@ int AL_Codec_Encode_GetStream(void *codec, void **stream, void **user_data) {
         }
 
         for (int retry = 0; retry < 20; ++retry) {
-            void *s = Fifo_Dequeue(enc->fifo_streams, 100);
+            void *s = SpscFifo_Dequeue(enc->fifo_streams, 100);
             if (s != NULL) {
                 HWStreamBuffer *hw_stream = (HWStreamBuffer *)s;
                 *stream = s;
@@ -4892,7 +5048,7 @@ int AL_Codec_Encode_GetStream(void *codec, void **stream, void **user_data) {
      * Use 100ms timeout instead of blocking forever — the stream_thread
      * needs to retry so it can see use_hardware transition from 1→2
      * when the AVPU path activates on the first frame. */
-    void *s = Fifo_Dequeue(enc->fifo_streams, 100);
+    void *s = SpscFifo_Dequeue(enc->fifo_streams, 100);
     if (s == NULL) {
         return -1;
     }
@@ -4921,6 +5077,75 @@ int AL_Codec_Encode_GetStream(void *codec, void **stream, void **user_data) {
     return 0;
 }
 
+int AL_Codec_Encode_GetStreamFd(void *codec)
+{
+    if (codec == NULL)
+        return -1;
+
+    AL_CodecEncode *enc = (AL_CodecEncode*)codec;
+    return enc->event ? (int)(uintptr_t)enc->event : -1;
+}
+
+/* Non-blocking counterpart of AL_Codec_Encode_GetStream for callers that
+ * wait on the stream fd themselves. */
+int AL_Codec_Encode_TryGetStream(void *codec, void **stream, void **user_data)
+{
+    if (codec == NULL || stream == NULL || user_data == NULL) {
+        return -1;
+    }
+
+    AL_CodecEncode *enc = (AL_CodecEncode*)codec;
+    void *s;
+
+    *user_data = NULL;
+
+    if (enc->use_hardware == 2 && enc->avpu.fd >= 0) {
+        ALAvpuContext *ctx = &enc->avpu;
+
+        if (!ctx->session_ready || (s = SpscFifo_Dequeue(enc->fifo_streams, 0)) == NULL) {
+            errno = EAGAIN;
+            return -1;
+        }
+
+        *stream = s;
+        *user_data = avpu_hw_stream_get_user_data((HWStreamBuffer *)s);
+        ctx->frames_consumed++;
+        return 0;
+    }
+
+    s = SpscFifo_Dequeue(enc->fifo_streams, 0);
+    if (s == NULL) {
+        errno = EAGAIN;
+        return -1;
+    }
+
+    *stream = s;
+    *user_data = avpu_hw_stream_get_user_data((HWStreamBuffer *)s);
+    if (*user_data == NULL)
+        *user_data = codec_dequeue_frame_metadata(enc);
+    return 0;
+}
+
+/* Re-check the core for a completion whose interrupt went missing. Returns
+ * 1 if a stream was recovered (the stream fd is signalled), 0 otherwise. */
+int AL_Codec_Encode_RecoverStream(void *codec)
+{
+    if (codec == NULL)
+        return 0;
+
+    AL_CodecEncode *enc = (AL_CodecEncode*)codec;
+    ALAvpuContext *ctx = &enc->avpu;
+    unsigned int core_status = 0;
+
+    if (enc->use_hardware != 2 || ctx->fd < 0 || !ctx->session_ready)
+        return 0;
+    if (ctx->frame_number <= (unsigned int)ctx->frames_encoded)
+        return 0;
+    if (avpu_read_reg_quiet(ctx->fd, AVPU_REG_CORE_STATUS(0), &core_status) != 0)
+        return 0;
+    return avpu_try_recover_sticky_completion(ctx, core_status, "RecoverStream[AVPU]");
+}
+
 /**
  * AL_Codec_Encode_ReleaseStream - based on decompilation at 0x7a624
  * Release an encoded stream
@@ -4962,7 +5187,7 @@ int AL_Codec_Encode_ReleaseStream(void *codec, void *stream, void *user_data) {
             }
         }
 
-        free(hw_stream);
+        codec_stream_desc_put(enc, hw_stream);
         return 0;
     }
 
@@ -4979,10 +5204,53 @@ int AL_Codec_Encode_ReleaseStream(void *codec, void *stream, void *user_data) {
         free(data_ptr);
         /* Throttled: per-frame SW ReleaseStream free log suppressed */
     }
-    free(hw_stream);
+    codec_stream_desc_put(enc, hw_stream);
+    return 0;
+}
+
+int AL_Codec_Encode_SetStreamPoolDepth(void *codec, int held)
+{
+    AL_CodecEncode *enc;
+    ObjPoolStats st;
+
+    if (codec == NULL || held < 0)
+        return -1;
+
+    enc = (AL_CodecEncode *)codec;
+    ObjPool_GetStats(enc->stream_desc_pool, &st);
+    if (st.in_use != 0) {
+        LOG_CODEC("SetStreamPoolDepth: %d streams outstanding, keeping cap=%d",
+                  st.in_use, st.capacity);
+        return -1;
+    }
+
+    ObjPool_Deinit(enc->stream_desc_pool);
+    if (codec_stream_desc_pool_init(enc, held) < 0)
+        return -1;
+    enc->stream_held = held;
+
+    LOG_CODEC("SetStreamPoolDepth: codec=%p held=%d cap=%d",
+              codec, held, codec_stream_fifo_depth(enc) + 2 + held);
+    return 0;
+}
+
+int AL_Codec_Encode_GetStreamPoolStats(void *codec, ObjPoolStats *stats)
+{
+    if (codec == NULL || stats == NULL)
+        return -1;
+
+    ObjPool_GetStats(((AL_CodecEncode *)codec)->stream_desc_pool, stats);
     return 0;
 }
 
+int AL_Codec_Encode_GetSchedStat(void *codec, AvpuSchedStat *stat)
+{
+    if (codec == NULL || stat == NULL)
+        return -1;
+
+    return avpu_sched_get_stat(((AL_CodecEncode *)codec)->avpu.sched_chn, stat);
+}
+
 int AL_Codec_Encode_SetQpBounds(void *codec, int minQp, int maxQp)
 {
     AL_CodecEncode *enc;
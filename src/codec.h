@@ -6,6 +6,9 @@
 #ifndef CODEC_H
 #define CODEC_H
 
+#include "fifo.h"
+#include "avpu_sched.h"
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -67,6 +70,30 @@ int AL_Codec_Encode_Process(void *codec, void *frame, void *user_data);
  */
 int AL_Codec_Encode_GetStream(void *codec, void **stream, void **user_data);
 
+/**
+ * Get the stream-ready eventfd. It becomes readable whenever an encoded
+ * stream is queued; the waiter reads it to re-arm, then drains streams
+ * with AL_Codec_Encode_TryGetStream.
+ * @param codec Codec instance
+ * @return File descriptor, or -1 if unavailable
+ */
+int AL_Codec_Encode_GetStreamFd(void *codec);
+
+/**
+ * Get an encoded stream without blocking
+ * @param codec Codec instance
+ * @param stream Output stream buffer
+ * @return 0 on success, -1 if no stream is queued (errno = EAGAIN)
+ */
+int AL_Codec_Encode_TryGetStream(void *codec, void **stream, void **user_data);
+
+/**
+ * Recover a completed frame whose interrupt was missed
+ * @param codec Codec instance
+ * @return 1 if a stream was recovered, 0 otherwise
+ */
+int AL_Codec_Encode_RecoverStream(void *codec);
+
 /**
  * Release an encoded stream
  * @param codec Codec instance
@@ -76,6 +103,32 @@ int AL_Codec_Encode_GetStream(void *codec, void **stream, void **user_data);
  */
 int AL_Codec_Encode_ReleaseStream(void *codec, void *stream, void *user_data);
 
+/**
+ * Size the stream descriptor pool for a consumer that keeps up to 'held'
+ * streams between GetStream and ReleaseStream. Must be called while no
+ * stream is outstanding (normally right after Create).
+ * @param codec Codec instance
+ * @param held Streams the caller may hold at once
+ * @return 0 on success, -1 on failure
+ */
+int AL_Codec_Encode_SetStreamPoolDepth(void *codec, int held);
+
+/**
+ * Get stream descriptor pool statistics
+ * @param codec Codec instance
+ * @param stats Output statistics ('exhausted' counts heap fallbacks)
+ * @return 0 on success, -1 on failure
+ */
+int AL_Codec_Encode_GetStreamPoolStats(void *codec, ObjPoolStats *stats);
+
+/**
+ * Get the AVPU core scheduler statistics of this codec's channel
+ * @param codec Codec instance
+ * @param stat Output statistics
+ * @return 0 on success, -1 if the codec does not run on the AVPU
+ */
+int AL_Codec_Encode_GetSchedStat(void *codec, AvpuSchedStat *stat);
+
 /**
  * Set QP (Quantization Parameter) for encoder
  * @param codec Codec instance
@@ -0,0 +1,338 @@
+/**
+ * NV12 software scaler
+ *
+ * Each plane is scaled separably: a vertical pass combines source rows into
+ * a 16-bit row buffer, then a horizontal pass produces output samples. The
+ * vertical passes (and the whole 2:1 box case) run through a small table of
+ * row kernels, which has a scalar and a vector flavour. The vector kernels
+ * use GCC generic vectors, so they become MSA code on MIPS built with -mmsa
+ * and SSE2/NEON on a host; the arithmetic is the same integer math as the
+ * scalar kernels, which keeps the two paths bit-exact.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "nv12_resize.h"
+
+/* forward decl, from core/sys_core.c */
+int32_t is_cpu_has_msa(void);
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9 && \
+    (defined(__mips_msa) || defined(__SSE2__) || defined(__ARM_NEON))
+#define NV12_RESIZE_VECTOR 1
+#endif
+
+/* Box sums are accumulated in 16 bits: at most 257 rows of 255 */
+#define NV12_AREA_MAX_ROWS 257
+
+typedef struct {
+    /* out[i] = a[i] * (256 - fy) + b[i] * fy */
+    void (*blend_rows)(const uint8_t *a, const uint8_t *b, uint16_t *out, int32_t n, int32_t fy);
+    /* acc[i] += row[i] */
+    void (*acc_row)(uint16_t *acc, const uint8_t *row, int32_t n);
+    /* 2x2 box average of rows a/b into dw samples of ch interleaved channels */
+    void (*half_rows)(const uint8_t *a, const uint8_t *b, uint8_t *out, int32_t dw, int32_t ch);
+} Nv12RowKernels;
+
+/* ---- Scalar kernels ---- */
+
+static void blend_rows_c(const uint8_t *a, const uint8_t *b, uint16_t *out, int32_t n, int32_t fy)
+{
+    for (int32_t i = 0; i < n; i++)
+        out[i] = (uint16_t)(a[i] * (256 - fy) + b[i] * fy);
+}
+
+static void acc_row_c(uint16_t *acc, const uint8_t *row, int32_t n)
+{
+    for (int32_t i = 0; i < n; i++)
+        acc[i] = (uint16_t)(acc[i] + row[i]);
+}
+
+static void half_rows_tail(const uint8_t *a, const uint8_t *b, uint8_t *out,
+                           int32_t from, int32_t dw, int32_t ch)
+{
+    for (int32_t j = from; j < dw * ch; j++) {
+        int32_t x = j / ch, c = j % ch;
+        int32_t s0 = 2 * x * ch + c, s1 = s0 + ch;
+        out[j] = (uint8_t)((a[s0] + a[s1] + b[s0] + b[s1] + 2) >> 2);
+    }
+}
+
+static void half_rows_c(const uint8_t *a, const uint8_t *b, uint8_t *out, int32_t dw, int32_t ch)
+{
+    half_rows_tail(a, b, out, 0, dw, ch);
+}
+
+static const Nv12RowKernels g_kernels_c = { blend_rows_c, acc_row_c, half_rows_c };
+
+/* ---- Vector kernels ---- */
+
+#ifdef NV12_RESIZE_VECTOR
+
+typedef uint8_t  v8u8  __attribute__((vector_size(8)));
+typedef uint8_t  v4u8  __attribute__((vector_size(4)));
+typedef uint16_t v8u16 __attribute__((vector_size(16)));
+typedef uint32_t v4u32 __attribute__((vector_size(16)));
+typedef uint64_t v2u64 __attribute__((vector_size(16)));
+
+static inline v8u16 load_u8x8(const uint8_t *p)
+{
+    v8u8 v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_convertvector(v, v8u16);
+}
+
+static void blend_rows_v(const uint8_t *a, const uint8_t *b, uint16_t *out, int32_t n, int32_t fy)
+{
+    const v8u16 wa = (v8u16){0} + (uint16_t)(256 - fy);
+    const v8u16 wb = (v8u16){0} + (uint16_t)fy;
+    int32_t i = 0;
+
+    for (; i + 16 <= n; i += 16) {
+        v8u16 r0 = load_u8x8(a + i) * wa + load_u8x8(b + i) * wb;
+        v8u16 r1 = load_u8x8(a + i + 8) * wa + load_u8x8(b + i + 8) * wb;
+        memcpy(out + i, &r0, sizeof(r0));
+        memcpy(out + i + 8, &r1, sizeof(r1));
+    }
+    blend_rows_c(a + i, b + i, out + i, n - i, fy);
+}
+
+static void acc_row_v(uint16_t *acc, const uint8_t *row, int32_t n)
+{
+    int32_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        v8u16 s;
+        memcpy(&s, acc + i, sizeof(s));
+        s += load_u8x8(row + i);
+        memcpy(acc + i, &s, sizeof(s));
+    }
+    acc_row_c(acc + i, row + i, n - i);
+}
+
+static void half_rows_v(const uint8_t *a, const uint8_t *b, uint8_t *out, int32_t dw, int32_t ch)
+{
+    /* 16 source bytes -> 8 output bytes. The column pairs are added inside
+     * wider lanes (neighbouring u16 for luma, u16 two apart for CbCr), which
+     * needs no byte shuffle and cannot carry: a 2x2 sum is at most 1020. */
+    const int32_t src_bytes = 2 * dw * ch;
+    int32_t i = 0;
+
+    for (; i + 16 <= src_bytes; i += 16) {
+        v8u16 lo = load_u8x8(a + i) + load_u8x8(b + i);
+        v8u16 hi = load_u8x8(a + i + 8) + load_u8x8(b + i + 8);
+
+        if (ch == 1) {
+            v4u32 w0 = (v4u32)lo, w1 = (v4u32)hi;
+            v4u8 o0 = __builtin_convertvector(((w0 & 0xffff) + (w0 >> 16) + 2) >> 2, v4u8);
+            v4u8 o1 = __builtin_convertvector(((w1 & 0xffff) + (w1 >> 16) + 2) >> 2, v4u8);
+            memcpy(out + i / 2, &o0, sizeof(o0));
+            memcpy(out + i / 2 + 4, &o1, sizeof(o1));
+        } else {
+            /* each 64-bit lane ends up as {Cb, 0, Cr, 0, ...} */
+            v2u64 q0 = (v2u64)lo, q1 = (v2u64)hi;
+            v2u64 r0 = (((q0 & 0xffffffffu) + (q0 >> 32) + 0x00020002u) >> 2) & 0x00ff00ffu;
+            v2u64 r1 = (((q1 & 0xffffffffu) + (q1 >> 32) + 0x00020002u) >> 2) & 0x00ff00ffu;
+            uint8_t t[8] = {
+                (uint8_t)r0[0], (uint8_t)(r0[0] >> 16), (uint8_t)r0[1], (uint8_t)(r0[1] >> 16),
+                (uint8_t)r1[0], (uint8_t)(r1[0] >> 16), (uint8_t)r1[1], (uint8_t)(r1[1] >> 16),
+            };
+            memcpy(out + i / 2, t, sizeof(t));
+        }
+    }
+    half_rows_tail(a, b, out, i / 2, dw, ch);
+}
+
+static const Nv12RowKernels g_kernels_v = { blend_rows_v, acc_row_v, half_rows_v };
+
+#endif /* NV12_RESIZE_VECTOR */
+
+/* ---- Plane scalers ---- */
+
+/* Map destination sample i to a source position in 1/256 units, with pixel
+ * centres aligned, clamped to the last sample. */
+static void bilinear_map(int32_t dst_n, int32_t src_n, int32_t *idx, uint8_t *frac)
+{
+    for (int32_t i = 0; i < dst_n; i++) {
+        int64_t pos = ((int64_t)(2 * i + 1) * src_n * 256) / (2 * dst_n) - 128;
+        if (pos < 0)
+            pos = 0;
+        idx[i] = (int32_t)(pos >> 8);
+        frac[i] = (uint8_t)(pos & 0xff);
+        if (idx[i] >= src_n - 1) {
+            idx[i] = src_n - 1;
+            frac[i] = 0;
+        }
+    }
+}
+
+static int32_t resize_plane_bilinear(const uint8_t *src, int32_t sw, int32_t sh, int32_t sstride,
+                                     uint8_t *dst, int32_t dw, int32_t dh, int32_t dstride,
+                                     int32_t ch, const Nv12RowKernels *k)
+{
+    int32_t row_bytes = sw * ch;
+    size_t size = (size_t)dw * (sizeof(int32_t) + 1) + (size_t)dh * (sizeof(int32_t) + 1) +
+                  (size_t)row_bytes * sizeof(uint16_t) + 16;
+    uint8_t *scratch = (uint8_t *)malloc(size);
+
+    if (scratch == NULL)
+        return -1;
+
+    uint16_t *tmp = (uint16_t *)scratch;
+    int32_t *xi = (int32_t *)(tmp + row_bytes + (row_bytes & 1));
+    int32_t *yi = xi + dw;
+    uint8_t *xf = (uint8_t *)(yi + dh);
+    uint8_t *yf = xf + dw;
+    int32_t last_y = -1, last_f = -1;
+
+    bilinear_map(dw, sw, xi, xf);
+    bilinear_map(dh, sh, yi, yf);
+
+    for (int32_t y = 0; y < dh; y++) {
+        int32_t y0 = yi[y], fy = yf[y];
+        int32_t y1 = (y0 + 1 < sh) ? y0 + 1 : y0;
+
+        /* Upscaling revisits the same source pair; keep the blended row */
+        if (y0 != last_y || fy != last_f) {
+            k->blend_rows(src + (size_t)y0 * sstride, src + (size_t)y1 * sstride, tmp, row_bytes, fy);
+            last_y = y0;
+            last_f = fy;
+        }
+
+        uint8_t *out = dst + (size_t)y * dstride;
+        for (int32_t x = 0; x < dw; x++) {
+            int32_t o0 = xi[x] * ch;
+            int32_t o1 = (xi[x] + 1 < sw) ? o0 + ch : o0;
+            uint32_t fx = xf[x];
+            for (int32_t c = 0; c < ch; c++)
+                out[x * ch + c] = (uint8_t)((tmp[o0 + c] * (256u - fx) + tmp[o1 + c] * fx + 32768u) >> 16);
+        }
+    }
+
+    free(scratch);
+    return 0;
+}
+
+static int32_t resize_plane_area(const uint8_t *src, int32_t sw, int32_t sh, int32_t sstride,
+                                 uint8_t *dst, int32_t dw, int32_t dh, int32_t dstride,
+                                 int32_t ch, const Nv12RowKernels *k)
+{
+    if (sw == 2 * dw && sh == 2 * dh) {
+        for (int32_t y = 0; y < dh; y++) {
+            const uint8_t *a = src + (size_t)(2 * y) * sstride;
+            k->half_rows(a, a + sstride, dst + (size_t)y * dstride, dw, ch);
+        }
+        return 0;
+    }
+
+    int32_t row_bytes = sw * ch;
+    uint16_t *acc = (uint16_t *)malloc((size_t)row_bytes * sizeof(uint16_t));
+    if (acc == NULL)
+        return -1;
+
+    for (int32_t y = 0; y < dh; y++) {
+        int32_t ys = (int32_t)((int64_t)y * sh / dh);
+        int32_t ye = (int32_t)((int64_t)(y + 1) * sh / dh);
+
+        memset(acc, 0, (size_t)row_bytes * sizeof(uint16_t));
+        for (int32_t r = ys; r < ye; r++)
+            k->acc_row(acc, src + (size_t)r * sstride, row_bytes);
+
+        uint8_t *out = dst + (size_t)y * dstride;
+        for (int32_t x = 0; x < dw; x++) {
+            int32_t xs = (int32_t)((int64_t)x * sw / dw);
+            int32_t xe = (int32_t)((int64_t)(x + 1) * sw / dw);
+            uint32_t area = (uint32_t)((xe - xs) * (ye - ys));
+            for (int32_t c = 0; c < ch; c++) {
+                uint32_t sum = 0;
+                for (int32_t i = xs; i < xe; i++)
+                    sum += acc[i * ch + c];
+                out[x * ch + c] = (uint8_t)((sum + area / 2) / area);
+            }
+        }
+    }
+
+    free(acc);
+    return 0;
+}
+
+static int32_t resize_plane(const uint8_t *src, int32_t sw, int32_t sh, int32_t sstride,
+                            uint8_t *dst, int32_t dw, int32_t dh, int32_t dstride,
+                            int32_t ch, int32_t mode, const Nv12RowKernels *k)
+{
+    /* Area only applies when shrinking on both axes and the box height
+     * fits the 16-bit accumulator */
+    if (mode == NV12_RESIZE_AREA && dw <= sw && dh <= sh && (sh + dh - 1) / dh <= NV12_AREA_MAX_ROWS)
+        return resize_plane_area(src, sw, sh, sstride, dst, dw, dh, dstride, ch, k);
+    return resize_plane_bilinear(src, sw, sh, sstride, dst, dw, dh, dstride, ch, k);
+}
+
+static int32_t nv12_resize_with(const Nv12Image *src, const Nv12Image *dst, int32_t mode,
+                                const Nv12RowKernels *k)
+{
+    if (src == NULL || dst == NULL || src->y == NULL || src->uv == NULL ||
+        dst->y == NULL || dst->uv == NULL ||
+        src->width < 2 || src->height < 2 || dst->width < 2 || dst->height < 2 ||
+        ((src->width | src->height | dst->width | dst->height) & 1) ||
+        src->stride < src->width || dst->stride < dst->width ||
+        (mode != NV12_RESIZE_BILINEAR && mode != NV12_RESIZE_AREA)) {
+        return -1;
+    }
+
+    if (resize_plane(src->y, src->width, src->height, src->stride,
+                     dst->y, dst->width, dst->height, dst->stride, 1, mode, k) < 0)
+        return -1;
+
+    return resize_plane(src->uv, src->width / 2, src->height / 2, src->stride,
+                        dst->uv, dst->width / 2, dst->height / 2, dst->stride, 2, mode, k);
+}
+
+int32_t nv12_resize_c(const Nv12Image *src, const Nv12Image *dst, int32_t mode)
+{
+    return nv12_resize_with(src, dst, mode, &g_kernels_c);
+}
+
+int32_t nv12_resize_simd(const Nv12Image *src, const Nv12Image *dst, int32_t mode)
+{
+#ifdef NV12_RESIZE_VECTOR
+    return nv12_resize_with(src, dst, mode, &g_kernels_v);
+#else
+    return nv12_resize_with(src, dst, mode, &g_kernels_c);
+#endif
+}
+
+int32_t nv12_resize_has_simd(void)
+{
+#ifdef NV12_RESIZE_VECTOR
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+int32_t nv12_resize_accelerated(void)
+{
+    static int32_t use_simd = -1;
+
+    if (use_simd < 0) {
+#if defined(NV12_RESIZE_VECTOR) && defined(__mips__)
+        /* A -mmsa build can still land on a core without MSA (the T31's
+         * XBurst1 only has MXU), where MSA opcodes raise SIGILL */
+        use_simd = is_cpu_has_msa() != 0;
+#elif defined(NV12_RESIZE_VECTOR)
+        use_simd = 1;
+#else
+        use_simd = 0;
+#endif
+    }
+
+    return use_simd;
+}
+
+int32_t nv12_resize(const Nv12Image *src, const Nv12Image *dst, int32_t mode)
+{
+    return nv12_resize_accelerated() ? nv12_resize_simd(src, dst, mode)
+                                     : nv12_resize_c(src, dst, mode);
+}
@@ -0,0 +1,49 @@
+/**
+ * NV12 software scaler
+ *
+ * Bilinear and area (box) scaling of NV12 images. Every mode has a scalar
+ * implementation and a 128-bit vector one; both share the same fixed-point
+ * math so their output is bit-identical.
+ */
+
+#ifndef NV12_RESIZE_H
+#define NV12_RESIZE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    NV12_RESIZE_BILINEAR = 0,   /* 8-bit fractional weights, pixel-centre aligned */
+    NV12_RESIZE_AREA     = 1,   /* Box average when shrinking, bilinear when growing */
+};
+
+typedef struct {
+    uint8_t *y;                 /* Luma plane */
+    uint8_t *uv;                /* Interleaved CbCr plane, height / 2 rows */
+    int32_t width;              /* Pixels, even */
+    int32_t height;             /* Rows, even */
+    int32_t stride;             /* Bytes per row of both planes */
+} Nv12Image;
+
+/* Scale with the vector kernels when the CPU has them, scalar otherwise.
+ * Returns 0 on success, -1 on invalid geometry or allocation failure. */
+int32_t nv12_resize(const Nv12Image *src, const Nv12Image *dst, int32_t mode);
+
+/* Force one implementation (benchmarks and the bit-exactness check) */
+int32_t nv12_resize_c(const Nv12Image *src, const Nv12Image *dst, int32_t mode);
+int32_t nv12_resize_simd(const Nv12Image *src, const Nv12Image *dst, int32_t mode);
+
+/* 1 if nv12_resize_simd runs real vector code in this build */
+int32_t nv12_resize_has_simd(void);
+
+/* 1 if nv12_resize picks the vector kernels on this CPU */
+int32_t nv12_resize_accelerated(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* NV12_RESIZE_H */
@@ -1,5 +1,14 @@
+#include <stddef.h>
 #include <stdint.h>
 
+#include "nv12_resize.h"
+
+/* forward decl, from codec_c/resize_scalar.c */
+const char *c_resize_c(char *arg1, uint32_t *arg2, char *arg3, int32_t arg4, double arg5,
+                       float arg6, double arg7, double arg8, double arg9, float arg10,
+                       uint32_t arg11, int32_t arg12, char arg13, int32_t arg14, char *arg15,
+                       int32_t arg16, int16_t *arg17);
+
 int32_t nv12_scaler_16(
     void *arg1,
     void *arg2,
@@ -387,7 +396,32 @@ static int32_t AL_Unimplemented_SIMD128(void)
     return 0;
 }
 
-static int32_t c_resize_simd(void) { return AL_Unimplemented_SIMD128(); }
+/* Same contract as c_resize_c: arg1/arg2 are packed NV12 source and
+ * destination, arg3 x arg4 the source size, arg11 x arg12 the destination
+ * size. Uncropped frames go through the NV12 vector scaler; crops (arg13,
+ * arg14) keep the scalar path, which knows the OEM crop layout. */
+const char *c_resize_simd(char *arg1, uint32_t *arg2, char *arg3, int32_t arg4, double arg5,
+                          float arg6, double arg7, double arg8, double arg9, float arg10,
+                          uint32_t arg11, int32_t arg12, char arg13, int32_t arg14, char *arg15,
+                          int32_t arg16, int16_t *arg17)
+{
+    int32_t src_w = (int32_t)(intptr_t)arg3;
+
+    if ((uint8_t)arg13 == 0 && arg14 == 0) {
+        Nv12Image src = {
+            (uint8_t *)arg1, (uint8_t *)arg1 + (size_t)src_w * arg4, src_w, arg4, src_w
+        };
+        Nv12Image dst = {
+            (uint8_t *)arg2, (uint8_t *)arg2 + (size_t)arg11 * arg12, (int32_t)arg11, arg12, (int32_t)arg11
+        };
+
+        if (nv12_resize(&src, &dst, NV12_RESIZE_AREA) == 0)
+            return (const char *)(intptr_t)src_w;
+    }
+
+    return c_resize_c(arg1, arg2, arg3, arg4, arg5, arg6, arg7, arg8, arg9, arg10,
+                      arg11, arg12, arg13, arg14, arg15, arg16, arg17);
+}
 static int32_t c_resize_simd_nv12_up(void) { return AL_Unimplemented_SIMD128(); }
 static int32_t c_resize_simd_nv12_down(void) { return AL_Unimplemented_SIMD128(); }
 
@@ -249,6 +249,8 @@ int32_t add_observer(Module *arg1, Module *arg2, void *arg3)
     return -1;
 }
 
+/* Every module's update: the frame goes to the module's own queue and
+ * module_thread, never run on the notifying source's thread */
 static int32_t update(Module *arg1, void *arg2)
 {
     int32_t value = *(int32_t *)arg2;
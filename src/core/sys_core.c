@@ -258,6 +258,46 @@ int32_t is_video_has_simd128_proc(void)
     return 0;
 }
 
+/* MIPS SIMD Architecture (MSA), the 128-bit unit GCC targets with -mmsa.
+ * Distinct from the XBurst MXU that is_video_has_simd128_proc() reports:
+ * the T31's XBurst1 core has MXU and no MSA. Matches "msa" as a whole word
+ * of the cpuinfo "ASEs implemented" line. */
+int32_t is_cpu_has_msa(void)
+{
+    static int32_t has_msa = -1;
+    FILE *stream;
+    char line[0x200];
+
+    if (has_msa >= 0)
+        return has_msa;
+
+    has_msa = 0;
+    stream = fopen("/proc/cpuinfo", "r");
+    if (stream == NULL)
+        return 0;
+
+    while (fgets(line, sizeof(line), stream) != NULL) {
+        char *field = strstr(line, "ASEs implemented");
+        char *save = NULL;
+        char *tok;
+
+        if (field == NULL || (field = strchr(field, ':')) == NULL)
+            continue;
+
+        for (tok = strtok_r(field + 1, " \t\n", &save); tok != NULL;
+             tok = strtok_r(NULL, " \t\n", &save)) {
+            if (strcmp(tok, "msa") == 0) {
+                has_msa = 1;
+                break;
+            }
+        }
+        break;
+    }
+
+    fclose(stream);
+    return has_msa;
+}
+
 uint64_t system_gettime(int32_t arg1)
 {
     struct timespec var_10;
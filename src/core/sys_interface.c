@@ -239,6 +239,32 @@ int32_t IMP_System_GetBindbyDest(IMPCell *arg1, IMPCell *arg2)
     return -1;
 }
 
+/* OpenIMP extension. Here every module's update (module.c) only queues the
+ * frame for the module's own thread, so notify never runs a bound module
+ * on the source thread: that is already the async mode, with one 16-deep
+ * queue per bound module in place of per-binding mailboxes. Both modes are
+ * accepted and behave the same; there are no mailbox counters to report. */
+int32_t IMP_System_SetObserverDispatch(int32_t arg1, int32_t arg2)
+{
+    /* IMP_OBSERVER_DISPATCH_INLINE / _ASYNC */
+    if (arg1 != 0 && arg1 != 1) {
+        return -1;
+    }
+
+    if (arg2 < 0 || arg2 > 0x40) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int32_t IMP_System_GetObserverDispatchStat(IMPCell *arg1, void *arg2)
+{
+    (void)arg1;
+    (void)arg2;
+    return -1;
+}
+
 const char *IMP_System_GetCPUInfo(void)
 {
     int32_t v0 = get_cpu_id();
@@ -14,6 +14,7 @@
 #include <sys/ioctl.h>
 #include <errno.h>
 #include <pthread.h>
+#include <sched.h>
 
 #include "dma_alloc.h"
 #include "imp_log_int.h"
@@ -39,6 +40,7 @@ typedef struct {
     uint32_t size;              /* 0x88: Buffer size */
     uint32_t flags;             /* 0x8c: Flags */
     uint32_t pool_id;           /* 0x90: Pool ID */
+    void *rmem_block;           /* RmemBlock backing an RMEM allocation (flags & 0x2) */
 } DMABufferRecord;
 
 /* ioctl commands for memory allocation */
@@ -55,9 +57,31 @@ typedef struct {
     uint32_t flags;             /* Allocation flags */
 } mem_alloc_req_t;
 
-/* Global buffer registry */
-#define MAX_DMA_BUFFERS 128
-static DMABufferRecord *g_buffer_registry[MAX_DMA_BUFFERS] = {NULL};
+/* Global buffer registry.
+ *
+ * The registry is published as an immutable index holding the live records
+ * sorted by phys and by virt start address, so the hot translation paths
+ * (DMA_PhysToVirt, DMA_VirtToPhys, IMP_FlushCache, VBM lock-by-vaddr) do a
+ * binary search without taking g_registry_mutex.
+ *
+ * Writers (alloc/free) serialize on g_registry_mutex, build the next index
+ * in the spare of two static buffers and publish it with a release store.
+ * Readers pin the published index with a per-index reader count and
+ * re-check that it is still current; a writer only reuses a buffer once
+ * its reader count has drained to zero.
+ */
+#define MAX_DMA_BUFFERS 512
+
+typedef struct {
+    int count;                                  /* records in by_phys */
+    int virt_count;                             /* records with a virt mapping */
+    volatile int readers;
+    DMABufferRecord *by_phys[MAX_DMA_BUFFERS];  /* sorted by phys_addr */
+    DMABufferRecord *by_virt[MAX_DMA_BUFFERS];  /* sorted by virt_addr */
+} DMARegistryIndex;
+
+static DMARegistryIndex g_registry_index[2];
+static DMARegistryIndex *g_registry_cur = &g_registry_index[0];
 static pthread_mutex_t g_registry_mutex = PTHREAD_MUTEX_INITIALIZER;
 
 /* Global state */
@@ -66,49 +90,500 @@ static pthread_mutex_t g_dma_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int g_dma_initialized = 0;
 static int g_rmem_supported = 0;  /* set to 1 when /dev/rmem accepts our ioctls */
 
-/* RMEM-specific globals (for /dev/rmem bump allocator) */
+/* RMEM-specific globals (for the /dev/rmem heap) */
 static int g_is_rmem = 0;
 static uint32_t g_rmem_base_phys = 0x06300000; /* 29MB region base (from RE notes) */
 static size_t g_rmem_size = (size_t)(29 * 1024 * 1024);
 static void *g_rmem_virt_base = NULL;
-static size_t g_rmem_offset = 0; /* bump pointer */
 static char g_chosen_dev_path[64] = {0};
 
+/* RMEM heap.
+ *
+ * Allocations inside the /dev/rmem window come from a TLSF-style allocator:
+ * free blocks are binned by a two-level size class (power-of-two first
+ * level, 16 linear second-level steps) with bitmaps, so alloc and free are
+ * O(1). Neighbouring free blocks are coalesced on free. Block descriptors
+ * live out-of-band in a fixed table so the heap never writes into the DMA
+ * memory itself.
+ */
+#define RMEM_GRANULE       64u          /* minimum block size / size rounding */
+#define RMEM_SL_LOG2       4
+#define RMEM_SL_COUNT      (1 << RMEM_SL_LOG2)
+#define RMEM_FL_COUNT      26           /* covers up to 4 GB in granules */
+#define RMEM_MAX_BLOCKS    (2 * MAX_DMA_BUFFERS + 2) /* pad + block per buffer, + tail */
+
+typedef struct RmemBlock {
+    uint32_t off;                       /* offset from g_rmem_base_phys */
+    uint32_t size;                      /* bytes, multiple of RMEM_GRANULE */
+    int is_free;
+    struct RmemBlock *prev_phys;        /* address-ordered neighbours */
+    struct RmemBlock *next_phys;
+    struct RmemBlock *prev_free;        /* size-class free list */
+    struct RmemBlock *next_free;
+} RmemBlock;
+
+typedef struct {
+    uint32_t fl_bitmap;
+    uint32_t sl_bitmap[RMEM_FL_COUNT];
+    RmemBlock *free_lists[RMEM_FL_COUNT][RMEM_SL_COUNT];
+    RmemBlock blocks[RMEM_MAX_BLOCKS];
+    RmemBlock *spare;                   /* unused descriptors, linked by next_free */
+    RmemBlock *first;                   /* block at offset 0 */
+    size_t used_bytes;
+    size_t high_water;
+    uint32_t alloc_count;
+    uint32_t fail_count;
+    int ready;
+} RmemHeap;
+
+static RmemHeap g_rmem_heap;
+static pthread_mutex_t g_rmem_heap_mutex = PTHREAD_MUTEX_INITIALIZER;
+
+static int rmem_fls(uint32_t v)
+{
+    return 31 - __builtin_clz(v);
+}
+
+static void rmem_mapping(uint32_t size, int *fl, int *sl)
+{
+    uint32_t units = size / RMEM_GRANULE;
+
+    if (units < RMEM_SL_COUNT) {
+        *fl = 0;
+        *sl = (int)units;
+    } else {
+        int msb = rmem_fls(units);
+        *fl = msb - (RMEM_SL_LOG2 - 1);
+        *sl = (int)((units >> (msb - RMEM_SL_LOG2)) & (RMEM_SL_COUNT - 1));
+    }
+}
+
+static RmemBlock *rmem_desc_get(RmemHeap *h)
+{
+    RmemBlock *b = h->spare;
+    if (b != NULL) {
+        h->spare = b->next_free;
+        memset(b, 0, sizeof(*b));
+    }
+    return b;
+}
+
+static void rmem_desc_put(RmemHeap *h, RmemBlock *b)
+{
+    b->next_free = h->spare;
+    h->spare = b;
+}
+
+static void rmem_free_insert(RmemHeap *h, RmemBlock *b)
+{
+    int fl, sl;
+    rmem_mapping(b->size, &fl, &sl);
+
+    b->is_free = 1;
+    b->prev_free = NULL;
+    b->next_free = h->free_lists[fl][sl];
+    if (b->next_free != NULL) {
+        b->next_free->prev_free = b;
+    }
+    h->free_lists[fl][sl] = b;
+    h->fl_bitmap |= 1u << fl;
+    h->sl_bitmap[fl] |= 1u << sl;
+}
+
+static void rmem_free_remove(RmemHeap *h, RmemBlock *b)
+{
+    int fl, sl;
+    rmem_mapping(b->size, &fl, &sl);
+
+    if (b->prev_free != NULL) {
+        b->prev_free->next_free = b->next_free;
+    } else {
+        h->free_lists[fl][sl] = b->next_free;
+    }
+    if (b->next_free != NULL) {
+        b->next_free->prev_free = b->prev_free;
+    }
+    if (h->free_lists[fl][sl] == NULL) {
+        h->sl_bitmap[fl] &= ~(1u << sl);
+        if (h->sl_bitmap[fl] == 0) {
+            h->fl_bitmap &= ~(1u << fl);
+        }
+    }
+    b->is_free = 0;
+    b->prev_free = NULL;
+    b->next_free = NULL;
+}
+
+/* Smallest non-empty class whose every block is >= size. */
+static RmemBlock *rmem_find_free(RmemHeap *h, uint32_t size)
+{
+    uint32_t units = size / RMEM_GRANULE;
+    int fl, sl;
+
+    if (units >= RMEM_SL_COUNT) {
+        /* Round up to the next class boundary so any block in it fits. */
+        size += (1u << (rmem_fls(units) - RMEM_SL_LOG2)) * RMEM_GRANULE - RMEM_GRANULE;
+    }
+    rmem_mapping(size, &fl, &sl);
+    if (fl >= RMEM_FL_COUNT) {
+        return NULL;
+    }
+
+    uint32_t sl_map = h->sl_bitmap[fl] & (~0u << sl);
+    if (sl_map == 0) {
+        uint32_t fl_map = (fl + 1 < 32) ? (h->fl_bitmap & (~0u << (fl + 1))) : 0;
+        if (fl_map == 0) {
+            return NULL;
+        }
+        fl = __builtin_ctz(fl_map);
+        sl_map = h->sl_bitmap[fl];
+    }
+    sl = __builtin_ctz(sl_map);
+    return h->free_lists[fl][sl];
+}
+
+/* Split b so that it is exactly size bytes; the tail goes back free. */
+static void rmem_split_tail(RmemHeap *h, RmemBlock *b, uint32_t size)
+{
+    if (b->size - size < RMEM_GRANULE) {
+        return;
+    }
+    RmemBlock *tail = rmem_desc_get(h);
+    if (tail == NULL) {
+        return; /* out of descriptors: keep the slack inside b */
+    }
+    tail->off = b->off + size;
+    tail->size = b->size - size;
+    tail->prev_phys = b;
+    tail->next_phys = b->next_phys;
+    if (b->next_phys != NULL) {
+        b->next_phys->prev_phys = tail;
+    }
+    b->next_phys = tail;
+    b->size = size;
+    rmem_free_insert(h, tail);
+}
+
+static void rmem_heap_init(size_t size)
+{
+    RmemHeap *h = &g_rmem_heap;
+
+    pthread_mutex_lock(&g_rmem_heap_mutex);
+    memset(h, 0, sizeof(*h));
+    for (int i = RMEM_MAX_BLOCKS - 1; i >= 0; i--) {
+        rmem_desc_put(h, &h->blocks[i]);
+    }
+    RmemBlock *b = rmem_desc_get(h);
+    b->off = 0;
+    b->size = (uint32_t)(size & ~(size_t)(RMEM_GRANULE - 1));
+    rmem_free_insert(h, b);
+    h->first = b;
+    h->ready = 1;
+    pthread_mutex_unlock(&g_rmem_heap_mutex);
+}
+
+/* Returns the allocated block (offset in blk->off) or NULL. align must be a
+ * power of two. */
+static RmemBlock *rmem_heap_alloc(uint32_t size, uint32_t align)
+{
+    RmemHeap *h = &g_rmem_heap;
+    RmemBlock *b;
+    uint32_t need;
+
+    if (align < RMEM_GRANULE) {
+        align = RMEM_GRANULE;
+    }
+    size = (size + RMEM_GRANULE - 1) & ~(RMEM_GRANULE - 1);
+    /* Worst-case padding so the aligned start still leaves size bytes. */
+    need = size + align - RMEM_GRANULE;
+    if (need < size) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&g_rmem_heap_mutex);
+    if (!h->ready) {
+        pthread_mutex_unlock(&g_rmem_heap_mutex);
+        return NULL;
+    }
+
+    b = rmem_find_free(h, need);
+    if (b == NULL) {
+        h->fail_count++;
+        pthread_mutex_unlock(&g_rmem_heap_mutex);
+        return NULL;
+    }
+    rmem_free_remove(h, b);
+
+    uint32_t phys = g_rmem_base_phys + b->off;
+    uint32_t pad = ((phys + align - 1) & ~(align - 1)) - phys;
+    if (pad != 0) {
+        RmemBlock *head = rmem_desc_get(h);
+        if (head == NULL) {
+            rmem_free_insert(h, b);
+            h->fail_count++;
+            pthread_mutex_unlock(&g_rmem_heap_mutex);
+            return NULL;
+        }
+        /* Leading pad stays free as its own block. */
+        head->off = b->off;
+        head->size = pad;
+        head->prev_phys = b->prev_phys;
+        head->next_phys = b;
+        if (b->prev_phys != NULL) {
+            b->prev_phys->next_phys = head;
+        } else {
+            h->first = head;
+        }
+        b->prev_phys = head;
+        b->off += pad;
+        b->size -= pad;
+        rmem_free_insert(h, head);
+    }
+    rmem_split_tail(h, b, size);
+
+    h->used_bytes += b->size;
+    if (h->used_bytes > h->high_water) {
+        h->high_water = h->used_bytes;
+    }
+    h->alloc_count++;
+    pthread_mutex_unlock(&g_rmem_heap_mutex);
+    return b;
+}
+
+static void rmem_heap_free(RmemBlock *b)
+{
+    RmemHeap *h = &g_rmem_heap;
+
+    if (b == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&g_rmem_heap_mutex);
+    h->used_bytes -= b->size;
+
+    RmemBlock *prev = b->prev_phys;
+    if (prev != NULL && prev->is_free) {
+        rmem_free_remove(h, prev);
+        prev->size += b->size;
+        prev->next_phys = b->next_phys;
+        if (b->next_phys != NULL) {
+            b->next_phys->prev_phys = prev;
+        }
+        rmem_desc_put(h, b);
+        b = prev;
+    }
+
+    RmemBlock *next = b->next_phys;
+    if (next != NULL && next->is_free) {
+        rmem_free_remove(h, next);
+        b->size += next->size;
+        b->next_phys = next->next_phys;
+        if (next->next_phys != NULL) {
+            next->next_phys->prev_phys = b;
+        }
+        rmem_desc_put(h, next);
+    }
+
+    rmem_free_insert(h, b);
+    pthread_mutex_unlock(&g_rmem_heap_mutex);
+}
+
+typedef struct {
+    size_t total;
+    size_t used;
+    size_t high_water;
+    size_t free_bytes;
+    size_t largest_free;
+    int free_blocks;
+    int used_blocks;
+    uint32_t alloc_count;
+    uint32_t fail_count;
+} RmemHeapStats;
+
+static int rmem_heap_stats(RmemHeapStats *st)
+{
+    RmemHeap *h = &g_rmem_heap;
+    RmemBlock *b;
+
+    memset(st, 0, sizeof(*st));
+    pthread_mutex_lock(&g_rmem_heap_mutex);
+    if (!h->ready) {
+        pthread_mutex_unlock(&g_rmem_heap_mutex);
+        return -1;
+    }
+    for (b = h->first; b != NULL; b = b->next_phys) {
+        st->total += b->size;
+        if (b->is_free) {
+            st->free_bytes += b->size;
+            st->free_blocks++;
+            if (b->size > st->largest_free) {
+                st->largest_free = b->size;
+            }
+        } else {
+            st->used_blocks++;
+        }
+    }
+    st->used = h->used_bytes;
+    st->high_water = h->high_water;
+    st->alloc_count = h->alloc_count;
+    st->fail_count = h->fail_count;
+    pthread_mutex_unlock(&g_rmem_heap_mutex);
+    return 0;
+}
+
+/* Share of free space not usable by a single allocation. */
+static unsigned rmem_fragmentation_pct(const RmemHeapStats *st)
+{
+    if (st->free_bytes == 0) {
+        return 0;
+    }
+    return (unsigned)(100 - (st->largest_free * 100) / st->free_bytes);
+}
+
 static const uint32_t kCompatMaxAllocSize = 256u * 1024u * 1024u;
 
 int IMP_FlushCache(void *virt_addr, uint32_t size);
 
+static DMARegistryIndex *registry_read_lock(void)
+{
+    DMARegistryIndex *idx;
+
+    for (;;) {
+        idx = __atomic_load_n(&g_registry_cur, __ATOMIC_ACQUIRE);
+        __atomic_add_fetch(&idx->readers, 1, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&g_registry_cur, __ATOMIC_SEQ_CST) == idx) {
+            return idx;
+        }
+        __atomic_sub_fetch(&idx->readers, 1, __ATOMIC_RELEASE);
+    }
+}
+
+static void registry_read_unlock(DMARegistryIndex *idx)
+{
+    __atomic_sub_fetch(&idx->readers, 1, __ATOMIC_RELEASE);
+}
+
+/* Caller holds g_registry_mutex. Returns the spare index once no reader
+ * still has it pinned. */
+static DMARegistryIndex *registry_next_index(void)
+{
+    DMARegistryIndex *next = (g_registry_cur == &g_registry_index[0])
+        ? &g_registry_index[1] : &g_registry_index[0];
+
+    while (__atomic_load_n(&next->readers, __ATOMIC_ACQUIRE) != 0) {
+        sched_yield();
+    }
+    return next;
+}
+
+/* Insert rec into a sorted array of n entries, keyed by key(). */
+#define REGISTRY_SORTED_INSERT(arr, n, rec, key) do {                   \
+    int _i = (n);                                                       \
+    while (_i > 0 && key((arr)[_i - 1]) > key(rec)) {                   \
+        (arr)[_i] = (arr)[_i - 1];                                      \
+        _i--;                                                           \
+    }                                                                   \
+    (arr)[_i] = (rec);                                                  \
+} while (0)
+
+#define REC_PHYS(r) ((r)->phys_addr)
+#define REC_VIRT(r) ((uintptr_t)(r)->virt_addr)
+
+/* Index of the last entry whose start is <= addr, or -1. */
+static int registry_floor_phys(const DMARegistryIndex *idx, uint32_t addr)
+{
+    int lo = 0, hi = idx->count - 1, found = -1;
+
+    while (lo <= hi) {
+        int mid = (lo + hi) >> 1;
+        if (idx->by_phys[mid]->phys_addr <= addr) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return found;
+}
+
+static int registry_floor_virt(const DMARegistryIndex *idx, uintptr_t addr)
+{
+    int lo = 0, hi = idx->virt_count - 1, found = -1;
+
+    while (lo <= hi) {
+        int mid = (lo + hi) >> 1;
+        if ((uintptr_t)idx->by_virt[mid]->virt_addr <= addr) {
+            found = mid;
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return found;
+}
+
 /**
  * Register buffer in global registry
  */
 static int register_buffer(DMABufferRecord *buf) {
     pthread_mutex_lock(&g_registry_mutex);
 
-    for (int i = 0; i < MAX_DMA_BUFFERS; i++) {
-        if (g_buffer_registry[i] == NULL) {
-            g_buffer_registry[i] = buf;
-            pthread_mutex_unlock(&g_registry_mutex);
-            return 0;
-        }
+    DMARegistryIndex *cur = g_registry_cur;
+    if (cur->count >= MAX_DMA_BUFFERS) {
+        pthread_mutex_unlock(&g_registry_mutex);
+        LOG_DMA("register_buffer: registry full");
+        return -1;
     }
 
+    DMARegistryIndex *next = registry_next_index();
+    memcpy(next->by_phys, cur->by_phys, (size_t)cur->count * sizeof(next->by_phys[0]));
+    memcpy(next->by_virt, cur->by_virt, (size_t)cur->virt_count * sizeof(next->by_virt[0]));
+    next->count = cur->count;
+    next->virt_count = cur->virt_count;
+
+    REGISTRY_SORTED_INSERT(next->by_phys, next->count, buf, REC_PHYS);
+    next->count++;
+    if (buf->virt_addr != NULL) {
+        REGISTRY_SORTED_INSERT(next->by_virt, next->virt_count, buf, REC_VIRT);
+        next->virt_count++;
+    }
+
+    __atomic_store_n(&g_registry_cur, next, __ATOMIC_RELEASE);
     pthread_mutex_unlock(&g_registry_mutex);
-    LOG_DMA("register_buffer: registry full");
-    return -1;
+    return 0;
 }
 
 /**
- * Unregister buffer from global registry
+ * Unregister buffer from global registry. On return no reader can still
+ * reach buf through the index, so the caller may free it.
  */
 static void unregister_buffer(DMABufferRecord *buf) {
     pthread_mutex_lock(&g_registry_mutex);
 
-    for (int i = 0; i < MAX_DMA_BUFFERS; i++) {
-        if (g_buffer_registry[i] == buf) {
-            g_buffer_registry[i] = NULL;
-            break;
+    DMARegistryIndex *cur = g_registry_cur;
+    DMARegistryIndex *next = registry_next_index();
+    int n = 0;
+
+    for (int i = 0; i < cur->count; i++) {
+        if (cur->by_phys[i] != buf) {
+            next->by_phys[n++] = cur->by_phys[i];
+        }
+    }
+    next->count = n;
+    n = 0;
+    for (int i = 0; i < cur->virt_count; i++) {
+        if (cur->by_virt[i] != buf) {
+            next->by_virt[n++] = cur->by_virt[i];
         }
     }
+    next->virt_count = n;
+
+    __atomic_store_n(&g_registry_cur, next, __ATOMIC_RELEASE);
+
+    /* Grace period: wait out readers still walking the old index. */
+    while (__atomic_load_n(&cur->readers, __ATOMIC_ACQUIRE) != 0) {
+        sched_yield();
+    }
 
     pthread_mutex_unlock(&g_registry_mutex);
 }
@@ -117,66 +592,49 @@ static void unregister_buffer(DMABufferRecord *buf) {
  * Lookup buffer by physical address
  */
 static DMABufferRecord* lookup_buffer_by_phys(uint32_t phys_addr) {
-    pthread_mutex_lock(&g_registry_mutex);
+    DMARegistryIndex *idx = registry_read_lock();
+    DMABufferRecord *buf = NULL;
 
-    for (int i = 0; i < MAX_DMA_BUFFERS; i++) {
-        if (g_buffer_registry[i] != NULL &&
-            g_buffer_registry[i]->phys_addr == phys_addr) {
-            DMABufferRecord *buf = g_buffer_registry[i];
-            pthread_mutex_unlock(&g_registry_mutex);
-            return buf;
-        }
+    int i = registry_floor_phys(idx, phys_addr);
+    if (i >= 0 && idx->by_phys[i]->phys_addr == phys_addr) {
+        buf = idx->by_phys[i];
     }
 
-    pthread_mutex_unlock(&g_registry_mutex);
-    return NULL;
+    registry_read_unlock(idx);
+    return buf;
 }
 
 static DMABufferRecord* lookup_buffer_containing_phys(uint32_t phys_addr, uint32_t *offset_out) {
-    pthread_mutex_lock(&g_registry_mutex);
+    DMARegistryIndex *idx = registry_read_lock();
+    DMABufferRecord *buf = NULL;
 
-    for (int i = 0; i < MAX_DMA_BUFFERS; i++) {
-        DMABufferRecord *buf = g_buffer_registry[i];
-        if (buf == NULL) {
-            continue;
-        }
-        if (phys_addr >= buf->phys_addr && phys_addr < buf->phys_addr + buf->size) {
-            if (offset_out != NULL) {
-                *offset_out = phys_addr - buf->phys_addr;
-            }
-            pthread_mutex_unlock(&g_registry_mutex);
-            return buf;
+    int i = registry_floor_phys(idx, phys_addr);
+    if (i >= 0 && phys_addr - idx->by_phys[i]->phys_addr < idx->by_phys[i]->size) {
+        buf = idx->by_phys[i];
+        if (offset_out != NULL) {
+            *offset_out = phys_addr - buf->phys_addr;
         }
     }
 
-    pthread_mutex_unlock(&g_registry_mutex);
-    return NULL;
+    registry_read_unlock(idx);
+    return buf;
 }
 
 static DMABufferRecord* lookup_buffer_containing_virt(const void *virt_addr, uint32_t *offset_out) {
     uintptr_t virt = (uintptr_t)virt_addr;
+    DMARegistryIndex *idx = registry_read_lock();
+    DMABufferRecord *buf = NULL;
 
-    pthread_mutex_lock(&g_registry_mutex);
-
-    for (int i = 0; i < MAX_DMA_BUFFERS; i++) {
-        DMABufferRecord *buf = g_buffer_registry[i];
-        if (buf == NULL || buf->virt_addr == NULL) {
-            continue;
-        }
-
-        uintptr_t base = (uintptr_t)buf->virt_addr;
-        uintptr_t end = base + buf->size;
-        if (virt >= base && virt < end) {
-            if (offset_out != NULL) {
-                *offset_out = (uint32_t)(virt - base);
-            }
-            pthread_mutex_unlock(&g_registry_mutex);
-            return buf;
+    int i = registry_floor_virt(idx, virt);
+    if (i >= 0 && virt - (uintptr_t)idx->by_virt[i]->virt_addr < idx->by_virt[i]->size) {
+        buf = idx->by_virt[i];
+        if (offset_out != NULL) {
+            *offset_out = (uint32_t)(virt - (uintptr_t)buf->virt_addr);
         }
     }
 
-    pthread_mutex_unlock(&g_registry_mutex);
-    return NULL;
+    registry_read_unlock(idx);
+    return buf;
 }
 
 static void fill_dma_info(IMPDMABufferInfo *info_out, const DMABufferRecord *buf)
@@ -305,12 +763,13 @@ static int dma_init(void) {
         g_rmem_supported = 0;
         LOG_DMA("DMA init: no DMA device found; using malloc fallback only");
     } else if (strcmp(g_chosen_dev_path, "/dev/rmem") == 0) {
-        /* rmem requires mmap; set up a single mapping and bump allocator */
+        /* rmem requires mmap; set up a single mapping and the RMEM heap */
         void *base = mmap(NULL, g_rmem_size, PROT_READ | PROT_WRITE, MAP_SHARED, g_mem_fd, 0);
         if (base == MAP_FAILED) {
             LOG_DMA("DMA init: mmap of /dev/rmem failed (%s); will fall back per-alloc", strerror(errno));
         } else {
             g_rmem_virt_base = base;
+            rmem_heap_init(g_rmem_size);
             g_is_rmem = 1;
             LOG_DMA("DMA init: /dev/rmem mapped at %p size=%zu base_phys=0x%08x", base, g_rmem_size, g_rmem_base_phys);
         }
@@ -321,6 +780,57 @@ static int dma_init(void) {
     return 0;
 }
 
+/* Per-buffer allocation attributes (OEM stores alignment, cache policy, etc.) */
+typedef struct {
+    uint32_t alignment;
+    uint32_t cache_policy;  /* 0=cached, 1=uncached */
+} AllocAttr;
+
+static AllocAttr g_alloc_attr = {0x1000, 0}; /* Default: 4K alignment, cached */
+static AllocAttr g_pool_alloc_attr = {0x1000, 0};
+
+/* RMEM alignment for the next allocation, from IMP_Alloc_Set_Attr /
+ * IMP_PoolAlloc_Set_Attr. Non-power-of-two values round up. */
+static uint32_t dma_alloc_alignment(int pool_id)
+{
+    uint32_t align = (pool_id >= 0) ? g_pool_alloc_attr.alignment : g_alloc_attr.alignment;
+
+    if (align < RMEM_GRANULE) {
+        return RMEM_GRANULE;
+    }
+    if ((align & (align - 1)) != 0) {
+        align = 1u << (rmem_fls(align) + 1);
+    }
+    return align;
+}
+
+/* Return a record's memory to where it came from. The record must not be
+ * reachable through the registry any more: once an rmem block is back in
+ * the heap, the next allocation may get the same addresses. */
+static void dma_release_memory(DMABufferRecord *buf)
+{
+    if (buf->virt_addr == NULL) {
+        return;
+    }
+
+    if ((buf->flags & 0x2) && g_is_rmem) {
+        rmem_heap_free((RmemBlock *)buf->rmem_block);
+        buf->rmem_block = NULL;
+    } else if ((buf->flags & 0x1) && g_rmem_supported && g_mem_fd >= 0) {
+        mem_alloc_req_t req;
+        munmap(buf->virt_addr, buf->size);
+        memset(&req, 0, sizeof(req));
+        req.size = buf->size;
+        req.phys_addr = buf->phys_addr;
+        if (ioctl(g_mem_fd, IOCTL_MEM_FREE, &req) != 0) {
+            LOG_DMA("Free: IOCTL_MEM_FREE failed for phys=0x%x (%s)", buf->phys_addr, strerror(errno));
+        }
+    } else {
+        free(buf->virt_addr);
+    }
+    buf->virt_addr = NULL;
+}
+
 static int dma_free_buffer(DMABufferRecord *buf)
 {
     if (buf == NULL) {
@@ -329,24 +839,10 @@ static int dma_free_buffer(DMABufferRecord *buf)
 
     LOG_DMA("Free: phys=0x%x virt=%p", buf->phys_addr, buf->virt_addr);
 
-    if (buf->virt_addr != NULL) {
-        if ((buf->flags & 0x2) && g_is_rmem) {
-            /* RMEM bump allocations are not individually freed (no-op) */
-        } else if ((buf->flags & 0x1) && g_rmem_supported && g_mem_fd >= 0) {
-            mem_alloc_req_t req;
-            munmap(buf->virt_addr, buf->size);
-            memset(&req, 0, sizeof(req));
-            req.size = buf->size;
-            req.phys_addr = buf->phys_addr;
-            if (ioctl(g_mem_fd, IOCTL_MEM_FREE, &req) != 0) {
-                LOG_DMA("Free: IOCTL_MEM_FREE failed for phys=0x%x (%s)", buf->phys_addr, strerror(errno));
-            }
-        } else {
-            free(buf->virt_addr);
-        }
-    }
-
+    /* Unpublish first: lookups must not find this record once its
+     * addresses can be handed out again */
     unregister_buffer(buf);
+    dma_release_memory(buf);
     free(buf);
     return 0;
 }
@@ -380,18 +876,21 @@ static int dma_alloc_descriptor_internal(int pool_id, IMPDMABufferInfo *info_out
 
     if (g_rmem_supported && g_mem_fd >= 0) {
         if (g_is_rmem && g_rmem_virt_base != NULL) {
-            size_t align = 4096;
-            size_t off = (g_rmem_offset + (align - 1)) & ~(align - 1);
-            if (off + (size_t)size <= g_rmem_size) {
-                buf->virt_addr = (void*)((uintptr_t)g_rmem_virt_base + off);
-                buf->phys_addr = g_rmem_base_phys + (uint32_t)off;
+            uint32_t align = dma_alloc_alignment(pool_id);
+            RmemBlock *blk = rmem_heap_alloc((uint32_t)size, align);
+            if (blk != NULL) {
+                buf->virt_addr = (void*)((uintptr_t)g_rmem_virt_base + blk->off);
+                buf->phys_addr = g_rmem_base_phys + blk->off;
                 buf->flags |= 0x2;
-                g_rmem_offset = off + (size_t)size;
-                LOG_DMA("Alloc: %s size=%d phys=0x%x virt=%p (rmem off=0x%zx)",
-                        buf->name[0] ? buf->name : "(unnamed)", size, buf->phys_addr, buf->virt_addr, off);
+                buf->rmem_block = blk;
+                LOG_DMA("Alloc: %s size=%d phys=0x%x virt=%p (rmem off=0x%x align=0x%x)",
+                        buf->name[0] ? buf->name : "(unnamed)", size, buf->phys_addr, buf->virt_addr,
+                        blk->off, align);
             } else {
-                LOG_DMA("Alloc: /dev/rmem out of memory (requested=%d, used=%zu/%zu); falling back",
-                        size, g_rmem_offset, g_rmem_size);
+                RmemHeapStats st;
+                rmem_heap_stats(&st);
+                LOG_DMA("Alloc: /dev/rmem out of memory (requested=%d, used=%zu/%zu, largest_free=%zu); falling back",
+                        size, st.used, st.total, st.largest_free);
             }
         } else {
             mem_alloc_req_t req;
@@ -427,13 +926,8 @@ static int dma_alloc_descriptor_internal(int pool_id, IMPDMABufferInfo *info_out
 
     if (register_buffer(buf) < 0) {
         LOG_DMA("Alloc: failed to register buffer");
-        if ((buf->flags & 0x2) && g_is_rmem) {
-            /* RMEM bump allocations cannot be individually rolled back. */
-        } else if ((buf->flags & 0x1) && g_rmem_supported && g_mem_fd >= 0) {
-            munmap(buf->virt_addr, buf->size);
-        } else {
-            free(buf->virt_addr);
-        }
+        /* Never published, so nothing to unregister */
+        dma_release_memory(buf);
         free(buf);
         return -1;
     }
@@ -569,9 +1063,22 @@ void *DMA_PhysToVirt(uint32_t phys_addr)
         return NULL;
     }
 
-    buf = lookup_buffer_containing_phys(phys_addr, &offset);
-    if (buf != NULL && buf->virt_addr != NULL) {
-        return (void*)((uintptr_t)buf->virt_addr + offset);
+    {
+        DMARegistryIndex *idx = registry_read_lock();
+        int i = registry_floor_phys(idx, phys_addr);
+        void *virt = NULL;
+
+        if (i >= 0) {
+            buf = idx->by_phys[i];
+            offset = phys_addr - buf->phys_addr;
+            if (offset < buf->size && buf->virt_addr != NULL) {
+                virt = (void*)((uintptr_t)buf->virt_addr + offset);
+            }
+        }
+        registry_read_unlock(idx);
+        if (virt != NULL) {
+            return virt;
+        }
     }
 
     if (dma_init() == 0 && g_is_rmem && g_rmem_virt_base != NULL &&
@@ -593,12 +1100,25 @@ uint32_t DMA_VirtToPhys(const void *virt_addr)
         return 0;
     }
 
-    buf = lookup_buffer_containing_virt(virt_addr, &offset);
-    if (buf != NULL) {
-        return buf->phys_addr + offset;
+    virt = (uintptr_t)virt_addr;
+    {
+        DMARegistryIndex *idx = registry_read_lock();
+        int i = registry_floor_virt(idx, virt);
+        uint32_t phys = 0;
+
+        if (i >= 0) {
+            buf = idx->by_virt[i];
+            offset = (uint32_t)(virt - (uintptr_t)buf->virt_addr);
+            if (offset < buf->size) {
+                phys = buf->phys_addr + offset;
+            }
+        }
+        registry_read_unlock(idx);
+        if (phys != 0) {
+            return phys;
+        }
     }
 
-    virt = (uintptr_t)virt_addr;
     if (dma_init() == 0 && g_is_rmem && g_rmem_virt_base != NULL) {
         uintptr_t base = (uintptr_t)g_rmem_virt_base;
         uintptr_t end = base + g_rmem_size;
@@ -812,15 +1332,6 @@ int IMP_MemPool_GetById(int pool_id, void *info_out) {
 
 /* ========== IMP_Alloc debug/attr functions (from OEM BN audit) ========== */
 
-/* Per-buffer allocation attributes (OEM stores alignment, cache policy, etc.) */
-typedef struct {
-    uint32_t alignment;
-    uint32_t cache_policy;  /* 0=cached, 1=uncached */
-} AllocAttr;
-
-static AllocAttr g_alloc_attr = {0x1000, 0}; /* Default: 4K alignment, cached */
-static AllocAttr g_pool_alloc_attr = {0x1000, 0};
-
 uintptr_t IMP_Sp_Alloc(int size, char *tag) {
     /* OEM: special-purpose allocation — same as IMP_Alloc but with specific flags.
      * Routes through the same DMA allocator. */
@@ -847,8 +1358,8 @@ int IMP_Alloc_Dump(void) {
     size_t total_size = 0;
 
     LOG_DMA("===== IMP_Alloc_Dump =====");
-    for (int i = 0; i < MAX_DMA_BUFFERS; i++) {
-        DMABufferRecord *buf = g_buffer_registry[i];
+    for (int i = 0; i < g_registry_cur->count; i++) {
+        DMABufferRecord *buf = g_registry_cur->by_phys[i];
         if (buf != NULL) {
             LOG_DMA("  [%d] phys=0x%08x virt=%p size=%u tag=%s",
                     i, buf->phys_addr, buf->virt_addr, buf->size, buf->tag);
@@ -857,6 +1368,16 @@ int IMP_Alloc_Dump(void) {
         }
     }
     LOG_DMA("  Total: %d buffers, %zu bytes", count, total_size);
+    {
+        RmemHeapStats st;
+        if (rmem_heap_stats(&st) == 0) {
+            LOG_DMA("  RMEM: used=%zu/%zu high_water=%zu allocs=%u failures=%u",
+                    st.used, st.total, st.high_water, st.alloc_count, st.fail_count);
+            LOG_DMA("  RMEM: free=%zu in %d blocks, largest=%zu, fragmentation=%u%%",
+                    st.free_bytes, st.free_blocks, st.largest_free,
+                    rmem_fragmentation_pct(&st));
+        }
+    }
     LOG_DMA("==========================");
 
     pthread_mutex_unlock(&g_registry_mutex);
@@ -877,8 +1398,8 @@ int IMP_Alloc_Dump_To_File(const char *path) {
     size_t total_size = 0;
 
     fprintf(fp, "===== IMP_Alloc_Dump =====\n");
-    for (int i = 0; i < MAX_DMA_BUFFERS; i++) {
-        DMABufferRecord *buf = g_buffer_registry[i];
+    for (int i = 0; i < g_registry_cur->count; i++) {
+        DMABufferRecord *buf = g_registry_cur->by_phys[i];
         if (buf != NULL) {
             fprintf(fp, "[%d] phys=0x%08x virt=%p size=%u pool=%u tag=%s name=%s\n",
                     i, buf->phys_addr, buf->virt_addr, buf->size,
@@ -888,6 +1409,16 @@ int IMP_Alloc_Dump_To_File(const char *path) {
         }
     }
     fprintf(fp, "Total: %d buffers, %zu bytes\n", count, total_size);
+    {
+        RmemHeapStats st;
+        if (rmem_heap_stats(&st) == 0) {
+            fprintf(fp, "RMEM: used=%zu/%zu high_water=%zu allocs=%u failures=%u\n",
+                    st.used, st.total, st.high_water, st.alloc_count, st.fail_count);
+            fprintf(fp, "RMEM: free=%zu in %d blocks, largest=%zu, fragmentation=%u%%\n",
+                    st.free_bytes, st.free_blocks, st.largest_free,
+                    rmem_fragmentation_pct(&st));
+        }
+    }
 
     pthread_mutex_unlock(&g_registry_mutex);
     fclose(fp);
@@ -924,8 +1455,8 @@ int IMP_PoolAlloc_Dump(void) {
     /* Also dump pool-allocated buffers from the registry */
     pthread_mutex_lock(&g_registry_mutex);
     int count = 0;
-    for (int i = 0; i < MAX_DMA_BUFFERS; i++) {
-        DMABufferRecord *buf = g_buffer_registry[i];
+    for (int i = 0; i < g_registry_cur->count; i++) {
+        DMABufferRecord *buf = g_registry_cur->by_phys[i];
         if (buf != NULL && buf->pool_id > 0) {
             LOG_DMA("  Buf[%d] pool=%u phys=0x%08x size=%u tag=%s",
                     i, buf->pool_id, buf->phys_addr, buf->size, buf->tag);
@@ -72,14 +72,14 @@ int IMP_FrameSource_GetPool(int chn);
 int IMP_Flush_Cache(uint32_t phys_addr, uint32_t size);
 
 /**
- * Get RMEM base physical address if using /dev/rmem bump allocator
+ * Get RMEM base physical address if using the /dev/rmem heap
  * @param base_phys_out Output pointer for base physical address
  * @return 0 if RMEM is active and base is valid, -1 otherwise
  */
 int DMA_Get_RMEM_Base(uint32_t *base_phys_out);
 
 /**
- * Check if RMEM bump allocator is active
+ * Check if the RMEM heap is active
  * @return 1 if RMEM is active, 0 otherwise
  */
 int DMA_Is_RMEM(void);
@@ -12,6 +12,12 @@
 #include <semaphore.h>
 #include <errno.h>
 #include <time.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/syscall.h>
+#include <linux/futex.h>
+
+#include "fifo.h"
 
 #define LOG_FIFO(fmt, ...) fprintf(stderr, "[Fifo] " fmt "\n", ##__VA_ARGS__)
 
@@ -276,6 +282,388 @@ int Fifo_GetMaxElements(void *fifo_ptr) {
     return fifo->max_elements - 1;  /* -1 because we store max+1 */
 }
 
+/*
+ * SpscFifo - lock-free single-producer/single-consumer ring.
+ *
+ * head is only written by the consumer, tail only by the producer; both are
+ * free-running and masked on access, so the ring needs no count field.
+ * data_seq/space_seq are futex words bumped after every push/pop (and on
+ * abort). A blocked side samples its seq word, re-checks the ring and only
+ * then sleeps on that value, so a wakeup between check and sleep is never
+ * lost. The wake syscall is skipped unless the other side flagged itself
+ * as waiting.
+ */
+typedef struct {
+    uint32_t head;              /* consumer index */
+    uint32_t tail;              /* producer index */
+    uint32_t mask;              /* capacity - 1 (capacity is a power of two) */
+    int max_elements;           /* usable slots, <= capacity */
+    void **buffer;
+    int data_seq;               /* futex: bumped on push/abort */
+    int space_seq;              /* futex: bumped on pop/abort */
+    int cons_waiting;
+    int prod_waiting;
+    int abort_flag;
+} SpscFifo;
+
+int SpscFifo_SizeOf(void) { return (int)sizeof(SpscFifo); }
+
+static int spsc_futex_wait(int *addr, int val, const struct timespec *rel)
+{
+    return (int)syscall(SYS_futex, addr, FUTEX_WAIT_PRIVATE, val, rel, NULL, 0);
+}
+
+static void spsc_futex_wake(int *addr)
+{
+    syscall(SYS_futex, addr, FUTEX_WAKE_PRIVATE, INT_MAX, NULL, NULL, 0);
+}
+
+static void spsc_deadline(struct timespec *deadline, int timeout_ms)
+{
+    clock_gettime(CLOCK_MONOTONIC, deadline);
+    deadline->tv_sec += timeout_ms / 1000;
+    deadline->tv_nsec += (timeout_ms % 1000) * 1000000;
+    if (deadline->tv_nsec >= 1000000000) {
+        deadline->tv_sec++;
+        deadline->tv_nsec -= 1000000000;
+    }
+}
+
+/* Sleep on *seq while it still equals seen. Returns 0 to re-check the
+ * ring, -1 once the deadline has passed. */
+static int spsc_wait(int *seq, int seen, int timeout_ms, const struct timespec *deadline)
+{
+    struct timespec now, rel;
+
+    if (timeout_ms < 0) {
+        spsc_futex_wait(seq, seen, NULL);
+        return 0;
+    }
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    rel.tv_sec = deadline->tv_sec - now.tv_sec;
+    rel.tv_nsec = deadline->tv_nsec - now.tv_nsec;
+    if (rel.tv_nsec < 0) {
+        rel.tv_sec--;
+        rel.tv_nsec += 1000000000;
+    }
+    if (rel.tv_sec < 0)
+        return -1;
+
+    if (spsc_futex_wait(seq, seen, &rel) != 0 && errno == ETIMEDOUT)
+        return -1;
+    return 0;
+}
+
+void SpscFifo_Init(void *fifo_ptr, int size) {
+    if (fifo_ptr == NULL || size <= 0) {
+        LOG_FIFO("SpscInit failed: invalid parameters");
+        return;
+    }
+
+    SpscFifo *fifo = (SpscFifo*)fifo_ptr;
+    uint32_t cap = 1;
+    while (cap < (uint32_t)size)
+        cap <<= 1;
+
+    memset(fifo, 0, sizeof(*fifo));
+    fifo->buffer = (void**)calloc(cap, sizeof(void*));
+    if (fifo->buffer == NULL) {
+        LOG_FIFO("SpscInit failed: malloc failed");
+        return;
+    }
+    fifo->mask = cap - 1;
+    fifo->max_elements = size;
+
+    LOG_FIFO("SpscInit: size=%d, capacity=%u", size, cap);
+}
+
+void SpscFifo_Abort(void *fifo_ptr) {
+    if (fifo_ptr == NULL) {
+        return;
+    }
+
+    SpscFifo *fifo = (SpscFifo*)fifo_ptr;
+    __atomic_store_n(&fifo->abort_flag, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&fifo->data_seq, 1, __ATOMIC_SEQ_CST);
+    __atomic_add_fetch(&fifo->space_seq, 1, __ATOMIC_SEQ_CST);
+    spsc_futex_wake(&fifo->data_seq);
+    spsc_futex_wake(&fifo->space_seq);
+}
+
+void SpscFifo_Deinit(void *fifo_ptr) {
+    if (fifo_ptr == NULL) {
+        return;
+    }
+
+    SpscFifo *fifo = (SpscFifo*)fifo_ptr;
+    SpscFifo_Abort(fifo);
+
+    if (fifo->buffer != NULL) {
+        free(fifo->buffer);
+        fifo->buffer = NULL;
+    }
+
+    LOG_FIFO("SpscDeinit: completed");
+}
+
+int SpscFifo_Queue(void *fifo_ptr, void *item, int timeout_ms) {
+    if (fifo_ptr == NULL) {
+        return 0;
+    }
+
+    SpscFifo *fifo = (SpscFifo*)fifo_ptr;
+    struct timespec deadline;
+    uint32_t tail = fifo->tail;
+
+    if (fifo->buffer == NULL) {
+        return 0;
+    }
+    if (timeout_ms > 0) {
+        spsc_deadline(&deadline, timeout_ms);
+    }
+
+    while (tail - __atomic_load_n(&fifo->head, __ATOMIC_ACQUIRE) >= (uint32_t)fifo->max_elements) {
+        if (timeout_ms == 0 || __atomic_load_n(&fifo->abort_flag, __ATOMIC_ACQUIRE)) {
+            return 0;
+        }
+
+        __atomic_store_n(&fifo->prod_waiting, 1, __ATOMIC_SEQ_CST);
+        int seen = __atomic_load_n(&fifo->space_seq, __ATOMIC_SEQ_CST);
+        if (tail - __atomic_load_n(&fifo->head, __ATOMIC_SEQ_CST) < (uint32_t)fifo->max_elements) {
+            break;
+        }
+        if (__atomic_load_n(&fifo->abort_flag, __ATOMIC_SEQ_CST) ||
+            spsc_wait(&fifo->space_seq, seen, timeout_ms, &deadline) < 0) {
+            __atomic_store_n(&fifo->prod_waiting, 0, __ATOMIC_RELAXED);
+            return 0;
+        }
+    }
+    __atomic_store_n(&fifo->prod_waiting, 0, __ATOMIC_RELAXED);
+
+    fifo->buffer[tail & fifo->mask] = item;
+    __atomic_store_n(&fifo->tail, tail + 1, __ATOMIC_RELEASE);
+
+    __atomic_add_fetch(&fifo->data_seq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&fifo->cons_waiting, __ATOMIC_SEQ_CST)) {
+        spsc_futex_wake(&fifo->data_seq);
+    }
+    return 1;
+}
+
+void *SpscFifo_Dequeue(void *fifo_ptr, int timeout_ms) {
+    if (fifo_ptr == NULL) {
+        return NULL;
+    }
+
+    SpscFifo *fifo = (SpscFifo*)fifo_ptr;
+    struct timespec deadline;
+    uint32_t head = fifo->head;
+
+    if (fifo->buffer == NULL) {
+        return NULL;
+    }
+    if (timeout_ms > 0) {
+        spsc_deadline(&deadline, timeout_ms);
+    }
+
+    while (__atomic_load_n(&fifo->tail, __ATOMIC_ACQUIRE) == head) {
+        if (timeout_ms == 0 || __atomic_load_n(&fifo->abort_flag, __ATOMIC_ACQUIRE)) {
+            return NULL;
+        }
+
+        __atomic_store_n(&fifo->cons_waiting, 1, __ATOMIC_SEQ_CST);
+        int seen = __atomic_load_n(&fifo->data_seq, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&fifo->tail, __ATOMIC_SEQ_CST) != head) {
+            break;
+        }
+        if (__atomic_load_n(&fifo->abort_flag, __ATOMIC_SEQ_CST) ||
+            spsc_wait(&fifo->data_seq, seen, timeout_ms, &deadline) < 0) {
+            __atomic_store_n(&fifo->cons_waiting, 0, __ATOMIC_RELAXED);
+            return NULL;
+        }
+    }
+    __atomic_store_n(&fifo->cons_waiting, 0, __ATOMIC_RELAXED);
+
+    void *item = fifo->buffer[head & fifo->mask];
+    __atomic_store_n(&fifo->head, head + 1, __ATOMIC_RELEASE);
+
+    __atomic_add_fetch(&fifo->space_seq, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&fifo->prod_waiting, __ATOMIC_SEQ_CST)) {
+        spsc_futex_wake(&fifo->space_seq);
+    }
+    return item;
+}
+
+int SpscFifo_GetMaxElements(void *fifo_ptr) {
+    if (fifo_ptr == NULL) {
+        return 0;
+    }
+
+    return ((SpscFifo*)fifo_ptr)->max_elements;
+}
+
+int SpscFifo_Count(void *fifo_ptr) {
+    if (fifo_ptr == NULL) {
+        return 0;
+    }
+
+    SpscFifo *fifo = (SpscFifo*)fifo_ptr;
+    return (int)(__atomic_load_n(&fifo->tail, __ATOMIC_ACQUIRE) -
+                 __atomic_load_n(&fifo->head, __ATOMIC_ACQUIRE));
+}
+
+/*
+ * ObjPool - fixed-capacity pool of equally sized objects.
+ *
+ * All objects come from one allocation made at init. free_map has one bit
+ * per object (1 = free); Get claims a bit with a CAS and Put returns it
+ * with an atomic OR, so neither side takes a lock or enters the heap.
+ * Objects that did not come from the pool are rejected by Put, which lets
+ * callers fall back to malloc when the pool runs dry and free those with
+ * the usual allocator.
+ */
+typedef struct {
+    uint8_t *base;
+    uint32_t *free_map;
+    int words;
+    int capacity;
+    int elem_size;
+    int in_use;
+    int peak;
+    unsigned int gets;
+    unsigned int exhausted;
+} ObjPool;
+
+int ObjPool_SizeOf(void) { return (int)sizeof(ObjPool); }
+
+int ObjPool_Init(void *pool_ptr, int count, int elem_size) {
+    if (pool_ptr == NULL || count <= 0 || elem_size <= 0) {
+        LOG_FIFO("PoolInit failed: invalid parameters");
+        return -1;
+    }
+
+    ObjPool *pool = (ObjPool*)pool_ptr;
+    memset(pool, 0, sizeof(*pool));
+
+    /* Keep every object 8-byte aligned for 64-bit timestamp fields */
+    elem_size = (elem_size + 7) & ~7;
+    pool->words = (count + 31) / 32;
+    pool->base = (uint8_t*)calloc((size_t)count, (size_t)elem_size);
+    pool->free_map = (uint32_t*)calloc((size_t)pool->words, sizeof(uint32_t));
+    if (pool->base == NULL || pool->free_map == NULL) {
+        LOG_FIFO("PoolInit failed: malloc failed");
+        free(pool->base);
+        free(pool->free_map);
+        memset(pool, 0, sizeof(*pool));
+        return -1;
+    }
+
+    for (int i = 0; i < count; i++) {
+        pool->free_map[i / 32] |= 1u << (i % 32);
+    }
+    pool->capacity = count;
+    pool->elem_size = elem_size;
+
+    LOG_FIFO("PoolInit: count=%d, elem_size=%d", count, elem_size);
+    return 0;
+}
+
+void ObjPool_Deinit(void *pool_ptr) {
+    if (pool_ptr == NULL) {
+        return;
+    }
+
+    ObjPool *pool = (ObjPool*)pool_ptr;
+    if (pool->in_use != 0) {
+        LOG_FIFO("PoolDeinit: %d objects still in use", pool->in_use);
+    }
+    free(pool->base);
+    free(pool->free_map);
+    memset(pool, 0, sizeof(*pool));
+}
+
+void *ObjPool_Get(void *pool_ptr) {
+    if (pool_ptr == NULL) {
+        return NULL;
+    }
+
+    ObjPool *pool = (ObjPool*)pool_ptr;
+    __atomic_add_fetch(&pool->gets, 1, __ATOMIC_RELAXED);
+
+    for (int w = 0; w < pool->words; w++) {
+        uint32_t bits = __atomic_load_n(&pool->free_map[w], __ATOMIC_RELAXED);
+        while (bits != 0) {
+            int bit = __builtin_ctz(bits);
+            if (!__atomic_compare_exchange_n(&pool->free_map[w], &bits, bits & ~(1u << bit),
+                                             0, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED)) {
+                continue;   /* bits reloaded by the failed CAS */
+            }
+
+            int used = __atomic_add_fetch(&pool->in_use, 1, __ATOMIC_RELAXED);
+            int peak = __atomic_load_n(&pool->peak, __ATOMIC_RELAXED);
+            while (used > peak &&
+                   !__atomic_compare_exchange_n(&pool->peak, &peak, used, 0,
+                                                __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+            }
+
+            void *obj = pool->base + (size_t)(w * 32 + bit) * (size_t)pool->elem_size;
+            memset(obj, 0, (size_t)pool->elem_size);
+            return obj;
+        }
+    }
+
+    __atomic_add_fetch(&pool->exhausted, 1, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+int ObjPool_Owns(void *pool_ptr, const void *obj) {
+    if (pool_ptr == NULL || obj == NULL) {
+        return 0;
+    }
+
+    ObjPool *pool = (ObjPool*)pool_ptr;
+    const uint8_t *p = (const uint8_t*)obj;
+    return pool->base != NULL && p >= pool->base &&
+           p < pool->base + (size_t)pool->capacity * (size_t)pool->elem_size;
+}
+
+int ObjPool_Put(void *pool_ptr, void *obj) {
+    if (!ObjPool_Owns(pool_ptr, obj)) {
+        return 0;
+    }
+
+    ObjPool *pool = (ObjPool*)pool_ptr;
+    int idx = (int)(((uint8_t*)obj - pool->base) / pool->elem_size);
+    uint32_t mask = 1u << (idx % 32);
+
+    /* Drop in_use before the bit is visible so it never exceeds capacity */
+    __atomic_sub_fetch(&pool->in_use, 1, __ATOMIC_RELAXED);
+    if (__atomic_fetch_or(&pool->free_map[idx / 32], mask, __ATOMIC_RELEASE) & mask) {
+        LOG_FIFO("PoolPut: double release of %p", obj);
+        __atomic_add_fetch(&pool->in_use, 1, __ATOMIC_RELAXED);
+    }
+    return 1;
+}
+
+void ObjPool_GetStats(void *pool_ptr, ObjPoolStats *stats) {
+    if (stats == NULL) {
+        return;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    if (pool_ptr == NULL) {
+        return;
+    }
+
+    ObjPool *pool = (ObjPool*)pool_ptr;
+    stats->capacity = pool->capacity;
+    stats->in_use = __atomic_load_n(&pool->in_use, __ATOMIC_RELAXED);
+    stats->peak = __atomic_load_n(&pool->peak, __ATOMIC_RELAXED);
+    stats->gets = __atomic_load_n(&pool->gets, __ATOMIC_RELAXED);
+    stats->exhausted = __atomic_load_n(&pool->exhausted, __ATOMIC_RELAXED);
+}
+
 typedef struct ImpFifoNode {
     struct ImpFifoNode *next;
     void *data;
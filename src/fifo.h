@@ -50,6 +50,86 @@ void *Fifo_Dequeue(void *fifo_ptr, int timeout_ms);
  */
 int Fifo_GetMaxElements(void *fifo_ptr);
 
+/*
+ * Single-producer/single-consumer variant of Fifo.
+ *
+ * Same calling convention and timeout/abort semantics as Fifo_*, but the
+ * fast path is wait-free: one atomic load and one release store per
+ * operation. Threads only enter the kernel (futex) when the ring is empty
+ * (consumer) or full (producer). Exactly one thread may call
+ * SpscFifo_Queue and exactly one may call SpscFifo_Dequeue at a time;
+ * callers with more than one producer must serialize them externally.
+ */
+int SpscFifo_SizeOf(void);
+void SpscFifo_Init(void *fifo_ptr, int size);
+void SpscFifo_Deinit(void *fifo_ptr);
+
+/**
+ * Add an item to the ring
+ * @param timeout_ms Timeout in milliseconds (-1 = infinite, 0 = no wait)
+ * @return 1 on success, 0 on full/timeout/abort
+ */
+int SpscFifo_Queue(void *fifo_ptr, void *item, int timeout_ms);
+
+/**
+ * Remove and return the oldest item
+ * @param timeout_ms Timeout in milliseconds (-1 = infinite, 0 = no wait)
+ * @return Item pointer on success, NULL on empty/timeout/abort
+ */
+void *SpscFifo_Dequeue(void *fifo_ptr, int timeout_ms);
+
+/* Wake both sides; subsequent waits fail until SpscFifo_Init is called again */
+void SpscFifo_Abort(void *fifo_ptr);
+int SpscFifo_GetMaxElements(void *fifo_ptr);
+int SpscFifo_Count(void *fifo_ptr);
+
+/*
+ * Fixed-capacity object pool.
+ *
+ * Hands out zeroed, 8-byte aligned objects from storage allocated once at
+ * ObjPool_Init. Get and Put are lock-free and safe from any thread. When
+ * every object is taken, Get returns NULL and counts the miss in
+ * 'exhausted'; callers are expected to fall back to the heap.
+ */
+typedef struct {
+    int capacity;               /* objects in the pool */
+    int in_use;                 /* objects currently handed out */
+    int peak;                   /* high-water mark of in_use */
+    unsigned int gets;          /* ObjPool_Get calls */
+    unsigned int exhausted;     /* ObjPool_Get calls that found the pool empty */
+} ObjPoolStats;
+
+int ObjPool_SizeOf(void);
+
+/**
+ * Initialize a pool
+ * @param pool_ptr Pointer to pool control structure memory (must be >= ObjPool_SizeOf())
+ * @param count Number of objects
+ * @param elem_size Size of each object in bytes
+ * @return 0 on success, -1 on failure
+ */
+int ObjPool_Init(void *pool_ptr, int count, int elem_size);
+
+/* Free the pool storage; objects still handed out become invalid */
+void ObjPool_Deinit(void *pool_ptr);
+
+/**
+ * Take a zeroed object from the pool
+ * @return Object pointer, or NULL when the pool is exhausted
+ */
+void *ObjPool_Get(void *pool_ptr);
+
+/**
+ * Return an object to the pool
+ * @return 1 if obj belongs to the pool, 0 otherwise (caller must free it)
+ */
+int ObjPool_Put(void *pool_ptr, void *obj);
+
+/* Return 1 if obj was handed out by this pool */
+int ObjPool_Owns(void *pool_ptr, const void *obj);
+
+void ObjPool_GetStats(void *pool_ptr, ObjPoolStats *stats);
+
 void *fifo_alloc(int count, int element_size);
 int fifo_free(void *fifo);
 int fifo_put(void *fifo, const void *data);
@@ -58,6 +58,7 @@ void imp_log_fun(int level, int option, int type, ...); /* T69 */
 extern void *alloc_device(const char *name, size_t size); /* T72/device.c */
 extern void free_device(void *dev);                        /* T72/device.c */
 extern int32_t is_has_simd128(void);                       /* T73/sys_core.c */
+extern int32_t nv12_resize_accelerated(void);              /* codec_c/nv12_resize.c */
 extern int32_t get_cpu_id(void);                           /* T73/sys_core.c */
 
 /* VBM API declared in kernel_interface.h; these are the additions
@@ -673,7 +674,7 @@ int32_t FrameSourceInit(void)
     *(int32_t *)((char *)v0_1 + 0x54) = 1;
     gFrameSource = (FrameSourceState *)((char *)v0_1 + 0x40);
 
-    if (is_has_simd128() == 0) {
+    if (is_has_simd128() == 0 && nv12_resize_accelerated() == 0) {
         sw_resize_use_simd = 0;
         sw_resize = c_resize_c;
     } else {
@@ -11,6 +11,7 @@
 #include <errno.h>
 #include <sys/select.h>
 #include <sys/eventfd.h>
+#include <sys/epoll.h>
 #include <pthread.h>
 #include <semaphore.h>
 #include <stdarg.h>
@@ -20,6 +21,7 @@
 #include "core/module.h"
 #include "fifo.h"
 #include "codec.h"
+#include "annexb.h"
 #include "kernel_interface.h"
 
 /* Legacy build uses the system module allocator exported from imp_system.c. */
@@ -55,6 +57,10 @@ static void enc_kmsg(const char *fmt, ...)
 #define MAX_ENC_GROUPS 3
 #define MAX_CHANNELS_PER_GROUP MAX_ENC_CHANNELS
 
+/* Packs stored inline with each pooled StreamBuffer; frames with more NAL
+ * units than this get a heap pack array instead. */
+#define ENC_STREAM_POOL_PACKS 16
+
 /* Internal stream buffer structure */
 typedef struct {
     /* Legacy single-pack (kept for internal debug compatibility) */
@@ -67,10 +73,13 @@ typedef struct {
     void *codec_stream;         /* Pointer to codec stream data */
     void *codec_user_data;      /* Returned metadata associated with codec_stream */
     void *injected_buf;         /* If non-NULL, malloc'd buffer we must free */
+    IMPEncoderPack *pack_slab;  /* Pack storage embedded in a pool entry (NULL if heap-allocated) */
     /* Base addresses for the full frame buffer (for IMPEncoderStream top-level) */
     uint32_t base_phy;          /* Physical base address */
     uint32_t base_vir;          /* Virtual base address */
     uint32_t base_size;         /* Total available bytes at base_vir */
+    uint64_t ready_us;          /* Entered the output queue */
+    uint64_t get_us;            /* Handed out by GetStream */
 } StreamBuffer;
 
 typedef struct {
@@ -115,7 +124,16 @@ typedef struct {
     /* Total: 0x308 bytes (776 bytes) */
 
     /* Extended fields (not part of binary structure) */
-    StreamBuffer *current_stream;  /* Current stream buffer */
+    /* Output stream queue, guarded by mutex_450, oldest first:
+     * [0, stream_held) were handed out by GetStream, [stream_held,
+     * stream_count) wait to be fetched. A release removes its entry
+     * wherever it sits, so streams can come back in any order. */
+    StreamBuffer *stream_queue[IMP_ENC_STREAM_MAX_DEPTH];
+    int stream_count;
+    int stream_held;
+    IMPEncoderStreamStat stream_stat;
+    uint64_t stream_lag_sum_us;
+    uint64_t stream_hold_sum_us;
     uint32_t stream_seq;           /* Stream sequence counter */
     int gop_length;                /* GOP length (offset 0x3d0) */
     int entropy_mode;              /* Entropy mode (offset 0x3fc) */
@@ -127,12 +145,25 @@ typedef struct {
     int bufshare_chn;              /* OEM SetbufshareChn(encChn, shareChn) cache */
     /* OpenIMP tracking to ensure early IDR without GetStream-time injection */
     int idr_requested_once;        /* 0=no request yet, 1=requested due to missing SPS/PPS */
-    int param_sets_seen;           /* 1 once SPS and PPS observed in packs */
+    int param_sets_seen;           /* 1 once SPS and PPS (and VPS for HEVC) observed in packs */
     int fisheye_enable;            /* Fisheye enable status (OEM offset 0x4c8) */
     void *frame_release_cb;        /* Frame release callback (OEM offset 0xFC) */
     void *frame_release_arg;       /* Frame release callback argument (OEM offset 0x100) */
     uint8_t enc_type;              /* Encoding type: 0=H264, 1=H265, 2=JPEG (OEM offset 0x2B) */
-    void *pending_frame;           /* Async frame handed from encoder_update -> encoder_thread */
+    /* Input frame queue encoder_update -> encoder_thread, guarded by mutex_1d8 */
+    void *frame_queue[IMP_ENC_QUEUE_MAX_DEPTH];
+    uint64_t frame_queue_ts[IMP_ENC_QUEUE_MAX_DEPTH]; /* Enqueue time (us) for latency */
+    int frame_queue_head;
+    int frame_queue_count;
+    IMPEncoderQueueAttr queue_attr;    /* Depth/policy; depth 0 = default (1, drop-oldest) */
+    int queue_pushers;             /* encoder_update calls inside encoder_queue_push */
+    int queue_abort;               /* Set by StopRecvPic/DestroyChn: pushes drop their frame */
+    IMPEncoderQueueStat queue_stat;
+    uint64_t queue_latency_sum_us;
+    void *stream_pool;             /* ObjPool of StreamBuffer + pack slab, sized from max_stream_cnt */
+    unsigned int stream_pack_overflows; /* Frames whose packs did not fit the pool slab */
+    int dispatch_attached;         /* Codec stream fd is in the stream dispatcher's epoll set */
+    VBMFrameHandle *frame_handles; /* Source frame held by each frame slot (tail of frame_buffers) */
 } EncChannel;
 
 /* Encoder group structure */
@@ -155,6 +186,43 @@ static EncChannel g_EncChannel[MAX_ENC_CHANNELS];
 static pthread_mutex_t encoder_mutex = PTHREAD_MUTEX_INITIALIZER;
 static int encoder_initialized = 0;
 
+/* Stream dispatcher.
+ *
+ * One thread serves every encoder channel. Each codec's stream-ready eventfd
+ * sits in an epoll set, so a finished frame wakes the dispatcher directly
+ * from the AVPU IRQ (or SW encode) path instead of being found by a periodic
+ * GetStream. The dispatcher moves streams into the channel's output queue
+ * until it holds max_stream_cnt of them (fetched-but-unreleased included);
+ * a full queue is counted in queueFull and left to ReleaseStream, which
+ * marks the channel in 'rescan' and pokes wake_fd so codec streams move on
+ * as soon as an entry frees up.
+ *
+ * A second epoll set holds the per-channel eventfds handed out by
+ * IMP_Encoder_GetFd; IMP_Encoder_PollingModuleStream waits on it so an
+ * application can wait for any channel in one syscall.
+ */
+#define ENC_DISPATCH_STALL_MS 100   /* Missed-IRQ recovery interval while channels are live */
+
+typedef struct {
+    pthread_mutex_t lock;       /* Serializes channel service against add/remove */
+    pthread_t thread;
+    int running;
+    int epfd;                   /* Codec stream fds + wake_fd (dispatcher thread) */
+    int ready_epfd;             /* Channel GetFd eventfds (PollingModuleStream) */
+    int wake_fd;
+    int users;                  /* Channels currently attached */
+    uint32_t rescan;            /* Channels whose output queue gained room */
+} EncStreamDispatcher;
+
+static EncStreamDispatcher g_stream_dispatch = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .epfd = -1,
+    .ready_epfd = -1,
+    .wake_fd = -1,
+};
+
+#define ENC_DISPATCH_WAKE_TAG 0xffffffffu
+
 static void enc_group_clear_slots(EncGroup *grp)
 {
     if (grp == NULL) return;
@@ -357,7 +425,9 @@ static int channel_encoder_init(EncChannel *chn);
 static int channel_encoder_exit(EncChannel *chn);
 static int channel_encoder_set_rc_param(void *dst, IMPEncoderRcAttr *src);
 static void *encoder_thread(void *arg);
-static void *stream_thread(void *arg);
+static int encoder_dispatch_attach(EncChannel *chn);
+static void encoder_dispatch_detach(EncChannel *chn);
+static void encoder_dispatch_kick(EncChannel *chn);
 static int encoder_update(void *module, void *frame);
 
 #define OEM_FRAME_CLONE_BYTES 0x30
@@ -375,19 +445,134 @@ static void encoder_release_frame_slot(EncChannel *chn, void *slot)
     Fifo_Queue(chn->fifo, slot, -1);
 }
 
-static void encoder_unlock_and_release_frame(EncChannel *chn, void *slot)
+static VBMFrameHandle *encoder_slot_handle(EncChannel *chn, void *slot)
+{
+    size_t idx = (size_t)((uint8_t *)slot - (uint8_t *)chn->frame_buffers) / OEM_FRAME_SLOT_BYTES;
+    return &chn->frame_handles[idx];
+}
+
+/* Drop the source frame reference a slot holds; the VBM frame goes back to
+ * the kernel once every observer has done the same. */
+static void encoder_unref_slot_frame(EncChannel *chn, void *slot)
 {
-    uint32_t vaddr = 0;
+    VBMFrameHandle *handle = encoder_slot_handle(chn, slot);
 
+    if (VBMFrameHandle_Unref(*handle) < 0)
+        LOG_ENC("encoder: stale source frame handle chn=%d pool=%u idx=%u gen=%u",
+                chn->chn_id, handle->chn, handle->index, handle->gen);
+}
+
+static void encoder_unlock_and_release_frame(EncChannel *chn, void *slot)
+{
     if (chn == NULL || slot == NULL)
         return;
 
-    memcpy(&vaddr, (uint8_t *)slot + 0x1c, sizeof(vaddr));
-    if (vaddr != 0)
-        VBMUnlockFrameByVaddr(vaddr);
+    encoder_unref_slot_frame(chn, slot);
     encoder_release_frame_slot(chn, slot);
 }
 
+/* StreamBuffers are taken from a per-channel pool so the stream thread does
+ * not hit the allocator on every frame. One entry per stream the application
+ * may hold (max_stream_cnt) plus the one the dispatcher is filling in. */
+static int encoder_stream_pool_init(EncChannel *chn)
+{
+    int count = chn->max_stream_cnt + 1;
+    int elem_size = (int)(sizeof(StreamBuffer) + ENC_STREAM_POOL_PACKS * sizeof(IMPEncoderPack));
+
+    chn->stream_pool = malloc(ObjPool_SizeOf());
+    if (chn->stream_pool == NULL)
+        return -1;
+    if (ObjPool_Init(chn->stream_pool, count, elem_size) < 0) {
+        free(chn->stream_pool);
+        chn->stream_pool = NULL;
+        return -1;
+    }
+    return 0;
+}
+
+static void encoder_stream_pool_exit(EncChannel *chn)
+{
+    ObjPoolStats st;
+
+    if (chn->stream_pool == NULL)
+        return;
+
+    ObjPool_GetStats(chn->stream_pool, &st);
+    LOG_ENC("stream pool chn=%d cap=%d peak=%d gets=%u exhausted=%u pack_overflows=%u",
+            chn->chn_id, st.capacity, st.peak, st.gets, st.exhausted,
+            chn->stream_pack_overflows);
+    ObjPool_Deinit(chn->stream_pool);
+    free(chn->stream_pool);
+    chn->stream_pool = NULL;
+}
+
+static StreamBuffer *encoder_stream_buf_get(EncChannel *chn)
+{
+    StreamBuffer *stream_buf = (StreamBuffer*)ObjPool_Get(chn->stream_pool);
+
+    if (stream_buf != NULL) {
+        stream_buf->pack_slab = (IMPEncoderPack*)(stream_buf + 1);
+        return stream_buf;
+    }
+
+    { static unsigned int miss_log = 0; unsigned int c = __sync_add_and_fetch(&miss_log, 1);
+      if (c <= 3 || (c % 50) == 0)
+        LOG_ENC("stream_dispatch: stream pool exhausted on chn=%d, using heap [#%u]", chn->chn_id, c);
+    }
+    return (StreamBuffer*)calloc(1, sizeof(StreamBuffer));
+}
+
+static IMPEncoderPack *encoder_stream_packs_get(EncChannel *chn, StreamBuffer *stream_buf, int count)
+{
+    if (stream_buf->pack_slab != NULL && count <= ENC_STREAM_POOL_PACKS)
+        return stream_buf->pack_slab;
+
+    if (stream_buf->pack_slab != NULL)
+        chn->stream_pack_overflows++;
+    return (IMPEncoderPack*)calloc((size_t)count, sizeof(IMPEncoderPack));
+}
+
+static void encoder_stream_buf_put(EncChannel *chn, StreamBuffer *stream_buf)
+{
+    if (stream_buf == NULL)
+        return;
+
+    /* Free injected buffer if we allocated one */
+    if (stream_buf->injected_buf) {
+        free(stream_buf->injected_buf);
+        stream_buf->injected_buf = NULL;
+    }
+    /* Free packs array unless it lives in the pool entry */
+    if (stream_buf->packs && stream_buf->packs != stream_buf->pack_slab)
+        free(stream_buf->packs);
+    stream_buf->packs = NULL;
+    stream_buf->packCount = 0;
+
+    if (!ObjPool_Put(chn->stream_pool, stream_buf))
+        free(stream_buf);
+}
+
+/* Give a stream's codec descriptor (and AVPU stream buffer) back to the
+ * codec, release the frame slot it encoded and recycle the StreamBuffer */
+static void encoder_stream_return(EncChannel *chn, StreamBuffer *stream_buf)
+{
+    if (stream_buf->codec_user_data != NULL) {
+        encoder_unref_slot_frame(chn, stream_buf->codec_user_data);
+    }
+
+    if (chn->codec != NULL && stream_buf->codec_stream != NULL) {
+        AL_Codec_Encode_ReleaseStream(chn->codec, stream_buf->codec_stream,
+                                      stream_buf->codec_user_data);
+    }
+
+    if (stream_buf->codec_user_data != NULL) {
+        encoder_release_frame_slot(chn, stream_buf->codec_user_data);
+        stream_buf->codec_user_data = NULL;
+    }
+
+    encoder_stream_buf_put(chn, stream_buf);
+}
+
 static int encoder_clone_source_frame(EncChannel *chn, void *src_frame, void **slot_out)
 {
     if (slot_out == NULL) return -1;
@@ -400,198 +585,170 @@ static int encoder_clone_source_frame(EncChannel *chn, void *src_frame, void **s
         return -1;
     }
 
-    memset(slot, 0, OEM_FRAME_SLOT_BYTES);
-    memcpy(slot, src_frame, OEM_FRAME_CLONE_BYTES);
-
-    uint32_t vaddr = 0;
-    memcpy(&vaddr, (uint8_t*)slot + 0x1c, sizeof(vaddr));
-    if (VBMLockFrameByVaddr(vaddr) < 0) {
-        LOG_ENC("encoder_update: failed to lock source frame vaddr=0x%x", vaddr);
+    /* Pin the source by index/generation rather than by vaddr lookup */
+    VBMFrameHandle *handle = encoder_slot_handle(chn, slot);
+    if (VBMFrame_GetHandle(src_frame, handle) < 0 || VBMFrameHandle_Ref(*handle) < 0) {
+        LOG_ENC("encoder_update: failed to reference source frame %p", src_frame);
         encoder_release_frame_slot(chn, slot);
         return -1;
     }
 
+    memset(slot, 0, OEM_FRAME_SLOT_BYTES);
+    memcpy(slot, src_frame, OEM_FRAME_CLONE_BYTES);
+
     *slot_out = slot;
     return 0;
 }
-/* H.264 SPS/PPS caching and minimal Annex B parsing for prefix injection */
-#define MAX_PARAM_SET_SIZE 256
-static uint8_t g_last_sps[MAX_ENC_CHANNELS][MAX_PARAM_SET_SIZE];
-static int g_last_sps_len[MAX_ENC_CHANNELS];
-static uint8_t g_last_pps[MAX_ENC_CHANNELS][MAX_PARAM_SET_SIZE];
-static int g_last_pps_len[MAX_ENC_CHANNELS];
-/* Warmup: force AUD+SPS+PPS injection for first few AUs per channel */
-static int g_inject_warmup[MAX_ENC_CHANNELS] = {0};
 
+/* ---- Input frame queue ----
+ * encoder_update (FS capture thread) pushes cloned frames, encoder_thread
+ * pops them. When the queue is full the channel's IMPEncoderQueuePolicy
+ * decides which frame is lost, and every loss is counted. */
 
-/* Find next start code position (returns index or len if none). Sets *sc to 3 or 4 */
-static size_t find_start_code(const uint8_t *b, size_t off, size_t len, int *sc)
+static uint64_t enc_mono_us(void)
 {
-    for (size_t i = off; i + 3 < len; ++i) {
-        if (b[i] == 0x00 && b[i+1] == 0x00) {
-            if (b[i+2] == 0x01) { if (sc) *sc = 3; return i; }
-            if (i + 4 < len && b[i+2] == 0x00 && b[i+3] == 0x01) { if (sc) *sc = 4; return i; }
-        }
-    }
-    if (sc) *sc = 0; return len;
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ull + (uint64_t)ts.tv_nsec / 1000u;
 }
 
-static void cache_sps_pps_from_annexb(int ch, const uint8_t *buf, size_t len)
+static int encoder_queue_depth(const EncChannel *chn)
 {
-    if (ch < 0 || ch >= MAX_ENC_CHANNELS || !buf || len < 4) return;
-    size_t i = 0; int sc = 0;
-    i = find_start_code(buf, 0, len, &sc);
-    while (i < len) {
-        size_t nal_start = i + (sc ? sc : 0);
-        int sc2 = 0; size_t next = find_start_code(buf, nal_start, len, &sc2);
-        if (nal_start < next) {
-            uint8_t nalh = buf[nal_start];
-            uint8_t nalt = nalh & 0x1F;
-            if (nalt == 7) { /* SPS */
-                size_t sz = next - nal_start;
-                if ((int)sz > MAX_PARAM_SET_SIZE) sz = MAX_PARAM_SET_SIZE;
-                memcpy(g_last_sps[ch], buf + nal_start, sz);
-                g_last_sps_len[ch] = (int)sz;
-            } else if (nalt == 8) { /* PPS */
-                size_t sz = next - nal_start;
-                if ((int)sz > MAX_PARAM_SET_SIZE) sz = MAX_PARAM_SET_SIZE;
-                memcpy(g_last_pps[ch], buf + nal_start, sz);
-                g_last_pps_len[ch] = (int)sz;
-            }
-        }
-        if (next >= len) break;
-        i = next; sc = sc2;
-    }
-}
-/* Minimal bit writer helpers for synthesized SPS/PPS */
-static void wb_bit(uint8_t *b, int *bp, int v){ int byte=*bp/8, off=7-(*bp%8); if(v) b[byte]|=(1<<off); else b[byte]&=~(1<<off); (*bp)++; }
-static void wb_bits(uint8_t *b, int *bp, uint32_t val, int n){ for(int i=n-1;i>=0;i--) wb_bit(b,bp,(val>>i)&1); }
-static void wb_ue(uint8_t *b, int *bp, uint32_t v){ uint32_t code=v+1; int k=0; for(uint32_t t=code; t; t>>=1) k++; int leading_zero_bits = k-1; for(int i=0;i<leading_zero_bits;i++) wb_bit(b,bp,0); wb_bits(b,bp,code, k); }
-
-/* Build very minimal Baseline SPS (Annex B, startcode included). Matches 42e01f */
-static int synth_h264_sps(uint8_t *out, int width, int height){
-    int pos=0; out[pos++]=0; out[pos++]=0; out[pos++]=0; out[pos++]=1; out[pos++]=0x67; /* SPS */
-    memset(out+pos,0,128); int bp=pos*8;
-    wb_bits(out,&bp,66,8);       /* profile_idc = 66 (Baseline) */
-    wb_bits(out,&bp,0xE0,8);     /* constraint flags */
-    wb_bits(out,&bp,0x1F,8);     /* level_idc = 31 */
-    wb_ue(out,&bp,0);            /* seq_parameter_set_id */
-    wb_ue(out,&bp,0);            /* log2_max_frame_num_minus4 */
-    wb_ue(out,&bp,0);            /* pic_order_cnt_type */
-    wb_ue(out,&bp,0);            /* log2_max_pic_order_cnt_lsb_minus4 */
-    wb_ue(out,&bp,1);            /* max_num_ref_frames (1) */
-    wb_bit(out,&bp,0);           /* gaps_in_frame_num_value_allowed_flag */
-    uint32_t w_mbs = (width + 15) / 16; uint32_t h_mbs = (height + 15) / 16;
-    wb_ue(out,&bp, w_mbs - 1);   /* pic_width_in_mbs_minus1 */
-    wb_ue(out,&bp, h_mbs - 1);   /* pic_height_in_map_units_minus1 (frame-only) */
-    wb_bit(out,&bp,1);           /* frame_mbs_only_flag */
-    wb_bit(out,&bp,1);           /* direct_8x8_inference_flag */
-    wb_bit(out,&bp,0);           /* frame_cropping_flag */
-    wb_bit(out,&bp,0);           /* vui_parameters_present_flag (omit) */
-    wb_bit(out,&bp,1);           /* rbsp_stop_one_bit */
-    while (bp % 8) wb_bit(out,&bp,0);
-    return bp/8;
-}
-
-/* Build minimal PPS (Annex B, startcode included) */
-static int synth_h264_pps(uint8_t *out){
-    int pos=0; out[pos++]=0; out[pos++]=0; out[pos++]=0; out[pos++]=1; out[pos++]=0x68; /* PPS */
-    memset(out+pos,0,64); int bp=pos*8;
-    wb_ue(out,&bp,0);            /* pic_parameter_set_id */
-    wb_ue(out,&bp,0);            /* seq_parameter_set_id */
-    wb_bit(out,&bp,0);           /* entropy_coding_mode_flag = CAVLC */
-    wb_bit(out,&bp,0);           /* bottom_field_pic_order_in_frame_present_flag */
-    wb_ue(out,&bp,0);            /* num_slice_groups_minus1 */
-    wb_ue(out,&bp,0);            /* num_ref_idx_l0_default_active_minus1 */
-    wb_ue(out,&bp,0);            /* num_ref_idx_l1_default_active_minus1 */
-    wb_bit(out,&bp,0);           /* weighted_pred_flag */
-    wb_bits(out,&bp,0,2);        /* weighted_bipred_idc */
-    wb_ue(out,&bp,0);            /* pic_init_qp_minus26 */
-    wb_ue(out,&bp,0);            /* pic_init_qs_minus26 */
-    wb_ue(out,&bp,0);            /* chroma_qp_index_offset */
-    wb_bit(out,&bp,0);           /* deblocking_filter_control_present_flag */
-    wb_bit(out,&bp,0);           /* constrained_intra_pred_flag */
-    wb_bit(out,&bp,0);           /* redundant_pic_cnt_present_flag */
-    wb_bit(out,&bp,1);           /* rbsp_stop_one_bit */
-    while (bp % 8) wb_bit(out,&bp,0);
-    return bp/8;
-}
-
-static int first_vcl_type(const uint8_t *buf, size_t len){ size_t i=0; int sc=0; i=find_start_code(buf,0,len,&sc); while(i<len){ size_t ns=i+(sc?sc:0); int sc2=0; size_t nx=find_start_code(buf,ns,len,&sc2); if(ns<nx){ uint8_t t=buf[ns]&0x1F; if(t==1||t==5) return t; } if(nx>=len) break; i=nx; sc=sc2; } return 0; }
-
-static int build_aud_simple(uint8_t *out, int is_idr){ int pos=0; out[pos++]=0; out[pos++]=0; out[pos++]=0; out[pos++]=1; out[pos++]=0x09; /* AUD */ uint8_t rbsp= (is_idr?0:1)<<5; out[pos++]=rbsp; out[pos++]=0x80; return pos; }
-
-
-static int has_sps_pps_before_vcl(const uint8_t *buf, size_t len)
+    return chn->queue_attr.depth ? (int)chn->queue_attr.depth : 1;
+}
+
+/* Called with mutex_1d8 held */
+static void *encoder_queue_pop_locked(EncChannel *chn, uint64_t *ts_out)
 {
-    size_t i = 0; int sc = 0; int seen_sps = 0, seen_pps = 0;
-    i = find_start_code(buf, 0, len, &sc);
-    while (i < len) {
-        size_t nal_start = i + (sc ? sc : 0);
-        int sc2 = 0; size_t next = find_start_code(buf, nal_start, len, &sc2);
-        if (nal_start < next) {
-            uint8_t nalt = buf[nal_start] & 0x1F;
-            if (nalt == 7) seen_sps = 1;
-            else if (nalt == 8) seen_pps = 1;
-            else if (nalt == 1 || nalt == 5) return (seen_sps && seen_pps);
-        }
-        if (next >= len) break;
-        i = next; sc = sc2;
+    if (chn->frame_queue_count == 0)
+        return NULL;
+
+    int idx = chn->frame_queue_head;
+    void *frame = chn->frame_queue[idx];
+    if (ts_out)
+        *ts_out = chn->frame_queue_ts[idx];
+    chn->frame_queue[idx] = NULL;
+    chn->frame_queue_head = (idx + 1) % IMP_ENC_QUEUE_MAX_DEPTH;
+    chn->frame_queue_count--;
+    chn->queue_stat.curDepth = (uint32_t)chn->frame_queue_count;
+    return frame;
+}
+
+/* Drop queued frames beyond the configured depth, oldest first. Called with
+ * mutex_1d8 held. */
+static void encoder_queue_trim_locked(EncChannel *chn, int depth)
+{
+    while (chn->frame_queue_count > depth) {
+        void *old = encoder_queue_pop_locked(chn, NULL);
+        encoder_unlock_and_release_frame(chn, old);
+        chn->queue_stat.dropped++;
+        chn->queue_stat.droppedFull++;
     }
-    return (seen_sps && seen_pps);
 }
 
-static uint8_t *inject_prefix_if_needed(int ch, int is_h264, const uint8_t *buf, size_t len, size_t *out_len)
+static void encoder_queue_note_drop(EncChannel *chn, uint32_t *reason)
 {
-    if (!is_h264 || !buf || len == 0 || ch < 0 || ch >= MAX_ENC_CHANNELS) return NULL;
-    /* Update caches from current buffer */
-    cache_sps_pps_from_annexb(ch, buf, len);
-    /* If SPS/PPS already present before first VCL, do nothing (OEM-compatible). Otherwise inject unconditionally. */
-    if (has_sps_pps_before_vcl(buf, len)) return NULL;
-
-    /* Determine if first VCL is IDR to choose AUD primary_pic_type */
-    int vcl_t = first_vcl_type(buf, len);
-    int is_idr = (vcl_t == 5);
-
-    /* Gather SPS/PPS: prefer cached, otherwise synthesize minimal from channel attrs */
-    uint8_t sps_local[256], pps_local[128];
-    const uint8_t *sps = NULL, *pps = NULL; int sps_len = 0, pps_len = 0;
-    if (g_last_sps_len[ch] > 0 && g_last_pps_len[ch] > 0) {
-        sps = g_last_sps[ch]; sps_len = g_last_sps_len[ch];
-        pps = g_last_pps[ch]; pps_len = g_last_pps_len[ch];
-    } else {
-        /* Synthesize minimal SPS/PPS (Annex B) */
-        int width = 0, height = 0;
-        if (g_EncChannel[ch].chn_id >= 0) {
-            width = (int)g_EncChannel[ch].attr.encAttr.maxPicWidth;
-            height = (int)g_EncChannel[ch].attr.encAttr.maxPicHeight;
+    pthread_mutex_lock(&chn->mutex_1d8);
+    chn->queue_stat.dropped++;
+    (*reason)++;
+    uint32_t dropped = chn->queue_stat.dropped;
+    pthread_mutex_unlock(&chn->mutex_1d8);
+
+    if (dropped <= 5 || (dropped % 50) == 0)
+        LOG_ENC("encoder_update: chn=%d dropped frame (total=%u)", chn->chn_id, dropped);
+}
+
+/* Queue a cloned frame, applying the overflow policy. Takes ownership of
+ * frame: on any drop it is unlocked and its slot returned. Depth and policy
+ * are re-read on every pass, so SetChnQueueAttr takes effect on a producer
+ * blocked here; encoder_queue_abort() fails the push. Called without
+ * encoder_mutex, as one of the channel's queue_pushers. */
+static void encoder_queue_push(EncChannel *chn, void *frame)
+{
+    struct timespec deadline;
+    int have_deadline = 0;
+
+    pthread_mutex_lock(&chn->mutex_1d8);
+
+    while (!chn->queue_abort && chn->frame_queue_count >= encoder_queue_depth(chn)) {
+        if (chn->queue_attr.policy == IMP_ENC_QUEUE_DROP_NEWEST) {
+            pthread_mutex_unlock(&chn->mutex_1d8);
+            encoder_unlock_and_release_frame(chn, frame);
+            encoder_queue_note_drop(chn, &chn->queue_stat.droppedFull);
+            return;
+        }
+        if (chn->queue_attr.policy != IMP_ENC_QUEUE_BLOCK) {
+            encoder_queue_trim_locked(chn, encoder_queue_depth(chn) - 1);
+            break;
+        }
+
+        if (!have_deadline) {
+            uint32_t ms = chn->queue_attr.blockTimeoutMs;
+            clock_gettime(CLOCK_REALTIME, &deadline);
+            deadline.tv_sec += ms / 1000;
+            deadline.tv_nsec += (long)(ms % 1000) * 1000000L;
+            if (deadline.tv_nsec >= 1000000000L) {
+                deadline.tv_sec++;
+                deadline.tv_nsec -= 1000000000L;
+            }
+            have_deadline = 1;
         }
-        if (width <= 0 || height <= 0) {
-            /* Fallback to common defaults to avoid crash */
-            width = 640; height = 360;
+        if (pthread_cond_timedwait(&chn->cond_1f0, &chn->mutex_1d8, &deadline) == ETIMEDOUT &&
+            !chn->queue_abort && chn->frame_queue_count >= encoder_queue_depth(chn)) {
+            chn->queue_stat.blockTimeouts++;
+            pthread_mutex_unlock(&chn->mutex_1d8);
+            encoder_unlock_and_release_frame(chn, frame);
+            encoder_queue_note_drop(chn, &chn->queue_stat.droppedFull);
+            return;
         }
-        sps_len = synth_h264_sps(sps_local, width, height);
-        pps_len = synth_h264_pps(pps_local);
-        sps = sps_local; pps = pps_local;
     }
 
-    /* Optionally prepend AUD for better compatibility */
-    uint8_t aud[8]; int aud_len = build_aud_simple(aud, is_idr);
+    if (chn->queue_abort) {
+        pthread_mutex_unlock(&chn->mutex_1d8);
+        encoder_unlock_and_release_frame(chn, frame);
+        return;
+    }
 
-    size_t add = (size_t)aud_len + (size_t)sps_len + (size_t)pps_len;
-    uint8_t *out = (uint8_t*)malloc(add + len);
-    if (!out) return NULL;
-    size_t o = 0;
-    memcpy(out + o, aud, aud_len); o += aud_len;
-    memcpy(out + o, sps, sps_len); o += sps_len;
-    memcpy(out + o, pps, pps_len); o += pps_len;
-    if (g_inject_warmup[ch] > 0) { g_inject_warmup[ch]--; }
+    int tail = (chn->frame_queue_head + chn->frame_queue_count) % IMP_ENC_QUEUE_MAX_DEPTH;
+    chn->frame_queue[tail] = frame;
+    chn->frame_queue_ts[tail] = enc_mono_us();
+    chn->frame_queue_count++;
+    chn->queue_stat.queued++;
+    chn->queue_stat.curDepth = (uint32_t)chn->frame_queue_count;
+    if (chn->queue_stat.curDepth > chn->queue_stat.maxDepth)
+        chn->queue_stat.maxDepth = chn->queue_stat.curDepth;
+    pthread_cond_broadcast(&chn->cond_1f0);
 
-    memcpy(out + o, buf, len); o += len;
-    *out_len = o;
-    return out;
+    pthread_mutex_unlock(&chn->mutex_1d8);
 }
 
+/* Fail pending and later pushes, then wait until no producer is left in
+ * encoder_queue_push(). Called with encoder_mutex held, so no new producer
+ * can register meanwhile. */
+static void encoder_queue_abort(EncChannel *chn)
+{
+    pthread_mutex_lock(&chn->mutex_1d8);
+    chn->queue_abort = 1;
+    pthread_cond_broadcast(&chn->cond_1f0);
+    while (chn->queue_pushers > 0)
+        pthread_cond_wait(&chn->cond_1f0, &chn->mutex_1d8);
+    pthread_mutex_unlock(&chn->mutex_1d8);
+}
+
+static void encoder_mutex_cleanup(void *mutex)
+{
+    pthread_mutex_unlock((pthread_mutex_t *)mutex);
+}
+
+/* Release every frame still waiting for the encoder */
+static void encoder_queue_flush(EncChannel *chn)
+{
+    pthread_mutex_lock(&chn->mutex_1d8);
+    while (chn->frame_queue_count > 0) {
+        encoder_unlock_and_release_frame(chn, encoder_queue_pop_locked(chn, NULL));
+    }
+    pthread_mutex_unlock(&chn->mutex_1d8);
+}
 
 /* Initialize encoder module */
 static void encoder_init(void) {
@@ -796,6 +953,7 @@ int IMP_Encoder_CreateChn(int encChn, IMPEncoderCHNAttr *attr) {
     int saved_qp_ip_delta = chn->qp_ip_delta;
     int saved_last_qp = chn->last_qp;
     int saved_bufshare_chn = chn->bufshare_chn;
+    IMPEncoderQueueAttr saved_queue_attr = chn->queue_attr;
 
     if (codec_type == IMP_ENC_TYPE_JPEG) {
         if (saved_bufshare_chn < 0) {
@@ -820,6 +978,7 @@ int IMP_Encoder_CreateChn(int encChn, IMPEncoderCHNAttr *attr) {
     chn->qp_ip_delta = saved_qp_ip_delta;
     chn->last_qp = saved_last_qp;
     chn->bufshare_chn = saved_bufshare_chn;
+    chn->queue_attr = saved_queue_attr;
 
     /* Copy attributes */
     memcpy(&chn->attr, attr, sizeof(IMPEncoderCHNAttr));
@@ -843,6 +1002,8 @@ int IMP_Encoder_CreateChn(int encChn, IMPEncoderCHNAttr *attr) {
     if (chn->max_stream_cnt <= 0) {
         chn->max_stream_cnt = 2;
         enc_kmsg("CreateChn default max_stream_cnt chn=%d max=2", encChn);
+    } else if (chn->max_stream_cnt > IMP_ENC_STREAM_MAX_DEPTH) {
+        chn->max_stream_cnt = IMP_ENC_STREAM_MAX_DEPTH;
     }
 
     /* Initialize semaphores (from decompilation at 0x83d18) */
@@ -894,6 +1055,14 @@ int IMP_Encoder_CreateChn(int encChn, IMPEncoderCHNAttr *attr) {
         return -1;
     }
 
+    /* The stream thread started by channel_encoder_init draws from this */
+    if (encoder_stream_pool_init(chn) < 0) {
+        LOG_ENC("CreateChn: failed to allocate stream pool");
+        chn->chn_id = -1;
+        pthread_mutex_unlock(&encoder_mutex);
+        return -1;
+    }
+
     /* Initialize encoder (from decompilation: channel_encoder_init) */
     if (channel_encoder_init(chn) < 0) {
         LOG_ENC("CreateChn: channel_encoder_init failed");
@@ -902,7 +1071,9 @@ int IMP_Encoder_CreateChn(int encChn, IMPEncoderCHNAttr *attr) {
         if (chn->frame_buffers != NULL) {
             free(chn->frame_buffers);
             chn->frame_buffers = NULL;
+            chn->frame_handles = NULL;
         }
+        encoder_stream_pool_exit(chn);
 
         chn->chn_id = -1;
         pthread_mutex_unlock(&encoder_mutex);
@@ -923,6 +1094,7 @@ int IMP_Encoder_CreateChn(int encChn, IMPEncoderCHNAttr *attr) {
     if (*buf_ptr == NULL) {
         LOG_ENC("CreateChn: failed to allocate stream buffers");
         channel_encoder_exit(chn);
+        encoder_stream_pool_exit(chn);
         chn->chn_id = -1;
         pthread_mutex_unlock(&encoder_mutex);
         return -1;
@@ -937,6 +1109,7 @@ int IMP_Encoder_CreateChn(int encChn, IMPEncoderCHNAttr *attr) {
     if (chn->eventfd < 0) {
         LOG_ENC("CreateChn: failed to create eventfd");
         channel_encoder_exit(chn);
+        encoder_stream_pool_exit(chn);
         if (chn->frame_buffers != NULL) {
             free(chn->frame_buffers);
         }
@@ -945,6 +1118,17 @@ int IMP_Encoder_CreateChn(int encChn, IMPEncoderCHNAttr *attr) {
         return -1;
     }
 
+    if (encoder_dispatch_attach(chn) < 0) {
+        LOG_ENC("CreateChn: failed to attach stream dispatcher");
+        channel_encoder_exit(chn);
+        encoder_stream_pool_exit(chn);
+        close(chn->eventfd);
+        chn->eventfd = -1;
+        chn->chn_id = -1;
+        pthread_mutex_unlock(&encoder_mutex);
+        return -1;
+    }
+
     pthread_mutex_unlock(&encoder_mutex);
 
     LOG_ENC("CreateChn: chn=%d, profile=0x%x, share=%d created successfully (frame_stream_meta=%d x %d)",
@@ -986,6 +1170,19 @@ int IMP_Encoder_DestroyChn(int encChn) {
 
     EncChannel *chn = &g_EncChannel[encChn];
 
+    /* No producer may still be queueing into the channel */
+    encoder_queue_abort(chn);
+
+    /* Stop stream delivery before the codec and eventfd go away */
+    encoder_dispatch_detach(chn);
+
+    /* Hand queued and unreleased streams back while the codec that owns
+     * their descriptors still exists */
+    for (int i = 0; i < chn->stream_count; i++)
+        encoder_stream_return(chn, chn->stream_queue[i]);
+    chn->stream_count = 0;
+    chn->stream_held = 0;
+
     /* Destroy codec if it exists */
     if (chn->codec != NULL) {
         AL_Codec_Encode_Destroy(chn->codec);
@@ -1007,22 +1204,12 @@ int IMP_Encoder_DestroyChn(int encChn) {
         chn->eventfd = -1;
     }
 
-    if (chn->pending_frame != NULL) {
-        encoder_unlock_and_release_frame(chn, chn->pending_frame);
-        chn->pending_frame = NULL;
-    }
+    encoder_queue_flush(chn);
 
     pthread_cond_destroy(&chn->cond_1f0);
     pthread_mutex_destroy(&chn->mutex_1d8);
 
-    /* Free current stream buffer if any */
-    if (chn->current_stream != NULL) {
-        if (chn->current_stream->codec_stream != NULL) {
-            free(chn->current_stream->codec_stream);
-        }
-        free(chn->current_stream);
-        chn->current_stream = NULL;
-    }
+    encoder_stream_pool_exit(chn);
 
     /* Clear the channel */
     memset(&g_EncChannel[encChn], 0, sizeof(g_EncChannel[encChn]));
@@ -1168,6 +1355,10 @@ int IMP_Encoder_StartRecvPic(int encChn) {
     g_EncChannel[encChn].recv_pic_started = 1;
     g_EncChannel[encChn].recv_pic_enabled = 1;
 
+    pthread_mutex_lock(&g_EncChannel[encChn].mutex_1d8);
+    g_EncChannel[encChn].queue_abort = 0;
+    pthread_mutex_unlock(&g_EncChannel[encChn].mutex_1d8);
+
     pthread_mutex_unlock(&encoder_mutex);
 
     LOG_ENC("StartRecvPic: chn=%d", encChn);
@@ -1194,6 +1385,9 @@ int IMP_Encoder_StopRecvPic(int encChn) {
     /* Clear flag at offset 0x400 */
     g_EncChannel[encChn].recv_pic_enabled = 0;
 
+    /* A producer blocked on a full queue gives up its frame */
+    encoder_queue_abort(&g_EncChannel[encChn]);
+
     /* Drain the pipeline - wait for pending frames to complete */
     /* Give threads time to finish processing current frames */
     pthread_mutex_unlock(&encoder_mutex);
@@ -1212,8 +1406,6 @@ int IMP_Encoder_StopRecvPic(int encChn) {
         }
     }
 
-    pthread_mutex_lock(&encoder_mutex);
-
     LOG_ENC("StopRecvPic: chn=%d", encChn);
     return 0;
 }
@@ -1253,15 +1445,31 @@ int IMP_Encoder_GetStream(int encChn, IMPEncoderStream *stream, int block) {
         }
     }
 
-    /* Lock mutex to access current_stream */
+    /* Hand out the oldest stream not fetched yet */
     pthread_mutex_lock(&chn->mutex_450);
 
-    if (chn->current_stream == NULL) {
+    if (chn->stream_held >= chn->stream_count) {
         pthread_mutex_unlock(&chn->mutex_450);
         return -1;
     }
 
-    StreamBuffer *stream_buf = chn->current_stream;
+    StreamBuffer *stream_buf = chn->stream_queue[chn->stream_held++];
+    uint64_t lag_us;
+
+    stream_buf->get_us = enc_mono_us();
+    lag_us = stream_buf->get_us - stream_buf->ready_us;
+    chn->stream_stat.delivered++;
+    chn->stream_lag_sum_us += lag_us;
+    chn->stream_stat.lagAvgUs = (uint32_t)(chn->stream_lag_sum_us / chn->stream_stat.delivered);
+    if (lag_us > chn->stream_stat.lagMaxUs)
+        chn->stream_stat.lagMaxUs = (uint32_t)lag_us;
+
+    /* GetFd stays readable while streams wait to be fetched */
+    if (chn->stream_held == chn->stream_count && chn->eventfd >= 0) {
+        uint64_t val;
+        ssize_t n = read(chn->eventfd, &val, sizeof(val));
+        (void)n;
+    }
 
     /* Populate IMPEncoderStream structure (T31 layout) */
     stream->phyAddr = stream_buf->base_phy;
@@ -1284,8 +1492,7 @@ int IMP_Encoder_GetStream(int encChn, IMPEncoderStream *stream, int block) {
              stream_buf->packs ? stream_buf->packs[0].offset : stream_buf->pack.offset,
              stream_buf->packs ? stream_buf->packs[0].length : stream_buf->pack.length);
 
-    /* Keep stream_buf in current_stream until ReleaseStream is called */
-    /* Don't set current_stream to NULL here */
+    /* The stream stays queued, held, until ReleaseStream */
 
     pthread_mutex_unlock(&chn->mutex_450);
 
@@ -1307,51 +1514,42 @@ int IMP_Encoder_ReleaseStream(int encChn, IMPEncoderStream *stream) {
     if (stream->seq % 50 == 0)
     LOG_ENC("ReleaseStream: chn=%d, seq=%u", encChn, stream->seq);
 
-    /* Lock mutex to access current_stream */
+    /* Streams come back in any order; find this one by its seq */
     pthread_mutex_lock(&chn->mutex_450);
 
-    if (chn->current_stream != NULL) {
-        StreamBuffer *stream_buf = chn->current_stream;
+    int idx;
+    for (idx = 0; idx < chn->stream_held; idx++) {
+        if (chn->stream_queue[idx]->seq == stream->seq)
+            break;
+    }
+    if (idx == chn->stream_held) {
+        pthread_mutex_unlock(&chn->mutex_450);
+        LOG_ENC("ReleaseStream: chn=%d seq=%u is not held", encChn, stream->seq);
+        return -1;
+    }
 
-        if (stream_buf->codec_user_data != NULL) {
-            uint32_t vaddr = 0;
-            memcpy(&vaddr, (uint8_t*)stream_buf->codec_user_data + 0x1c, sizeof(vaddr));
-            if (VBMUnlockFrameByVaddr(vaddr) < 0) {
-                LOG_ENC("ReleaseStream: WARNING - failed to unlock source frame vaddr=0x%x", vaddr);
-            }
-        }
+    StreamBuffer *stream_buf = chn->stream_queue[idx];
+    uint64_t hold_us = enc_mono_us() - stream_buf->get_us;
 
-        /* Release codec stream back to codec */
-        if (chn->codec != NULL && stream_buf->codec_stream != NULL) {
-            AL_Codec_Encode_ReleaseStream(chn->codec, stream_buf->codec_stream,
-                                          stream_buf->codec_user_data);
-        }
+    memmove(&chn->stream_queue[idx], &chn->stream_queue[idx + 1],
+            (size_t)(chn->stream_count - idx - 1) * sizeof(chn->stream_queue[0]));
+    chn->stream_count--;
+    chn->stream_held--;
 
-        if (stream_buf->codec_user_data != NULL) {
-            encoder_release_frame_slot(chn, stream_buf->codec_user_data);
-            stream_buf->codec_user_data = NULL;
-        }
+    chn->stream_stat.released++;
+    if (idx != 0)
+        chn->stream_stat.releasedOutOfOrder++;
+    chn->stream_hold_sum_us += hold_us;
+    chn->stream_stat.holdAvgUs = (uint32_t)(chn->stream_hold_sum_us / chn->stream_stat.released);
+    if (hold_us > chn->stream_stat.holdMaxUs)
+        chn->stream_stat.holdMaxUs = (uint32_t)hold_us;
 
-        /* Free injected buffer if we allocated one */
-        if (stream_buf->injected_buf) {
-            free(stream_buf->injected_buf);
-            stream_buf->injected_buf = NULL;
-        }
-        /* Free packs array if allocated */
-        if (stream_buf->packs) {
-            free(stream_buf->packs);
-            stream_buf->packs = NULL;
-            stream_buf->packCount = 0;
-        }
-        /* Free stream buffer */
-        free(stream_buf);
-        chn->current_stream = NULL;
-        /* Signal producer (stream_thread) that a slot is now available.
-         * stream_thread waits on sem_408 when the slot is occupied. */
-        sem_post(&chn->sem_408);
+    /* Return stream buffer (and its packs) to the channel pool */
+    encoder_stream_return(chn, stream_buf);
 
-        /* Throttled: per-frame freed log suppressed */
-    }
+    /* A queue entry is free again: let the dispatcher move the next codec
+     * stream in */
+    encoder_dispatch_kick(chn);
 
     pthread_mutex_unlock(&chn->mutex_450);
 
@@ -1400,6 +1598,137 @@ int IMP_Encoder_Query(int encChn, IMPEncoderCHNStat *stat) {
     if (stat == NULL) return -1;
     LOG_ENC("Query: chn=%d", encChn);
     memset(stat, 0, sizeof(*stat));
+
+    if (encChn < 0 || encChn >= MAX_ENC_CHANNELS) {
+        return -1;
+    }
+    EncChannel *chn = &g_EncChannel[encChn];
+    if (chn->chn_id < 0) {
+        LOG_ENC("Query: Encoder Channel%d hasn't been created", encChn);
+        return -1;
+    }
+
+    /* leftPics: frames waiting for the encoder; leftFrames/leftBytes/
+     * curPacks: the streams waiting to be fetched (curPacks of the next
+     * one). The full counters are in IMP_Encoder_GetChnQueueStat and
+     * IMP_Encoder_GetChnStreamStat. */
+    pthread_mutex_lock(&chn->mutex_1d8);
+    stat->leftPics = (uint32_t)chn->frame_queue_count;
+    pthread_mutex_unlock(&chn->mutex_1d8);
+
+    pthread_mutex_lock(&chn->mutex_450);
+    stat->leftFrames = (uint32_t)(chn->stream_count - chn->stream_held);
+    for (int i = chn->stream_held; i < chn->stream_count; i++)
+        stat->leftBytes += chn->stream_queue[i]->base_size;
+    if (stat->leftFrames > 0) {
+        StreamBuffer *next = chn->stream_queue[chn->stream_held];
+        stat->curPacks = next->packs ? next->packCount : 1;
+    }
+    pthread_mutex_unlock(&chn->mutex_450);
+
+    stat->work_done = (stat->leftPics == 0 && stat->leftFrames == 0);
+    return 0;
+}
+
+int IMP_Encoder_SetChnQueueAttr(int encChn, const IMPEncoderQueueAttr *attr) {
+    if (encChn < 0 || encChn >= MAX_ENC_CHANNELS || attr == NULL) {
+        return -1;
+    }
+    if (attr->depth < 1 || attr->depth > IMP_ENC_QUEUE_MAX_DEPTH ||
+        attr->policy < IMP_ENC_QUEUE_DROP_OLDEST || attr->policy > IMP_ENC_QUEUE_BLOCK) {
+        LOG_ENC("SetChnQueueAttr failed: chn=%d depth=%u policy=%d", encChn, attr->depth, attr->policy);
+        return -1;
+    }
+
+    EncChannel *chn = &g_EncChannel[encChn];
+
+    pthread_mutex_lock(&encoder_mutex);
+    if (chn->chn_id >= 0) {
+        pthread_mutex_lock(&chn->mutex_1d8);
+        chn->queue_attr = *attr;
+        encoder_queue_trim_locked(chn, (int)attr->depth);
+        /* A producer blocked on the queue re-reads depth and policy */
+        pthread_cond_broadcast(&chn->cond_1f0);
+        pthread_mutex_unlock(&chn->mutex_1d8);
+    } else {
+        chn->queue_attr = *attr;
+    }
+    pthread_mutex_unlock(&encoder_mutex);
+
+    LOG_ENC("SetChnQueueAttr: chn=%d depth=%u policy=%d timeout=%ums",
+            encChn, attr->depth, attr->policy, attr->blockTimeoutMs);
+    return 0;
+}
+
+int IMP_Encoder_GetChnQueueAttr(int encChn, IMPEncoderQueueAttr *attr) {
+    if (encChn < 0 || encChn >= MAX_ENC_CHANNELS || attr == NULL) {
+        return -1;
+    }
+
+    *attr = g_EncChannel[encChn].queue_attr;
+    if (attr->depth == 0) {
+        attr->depth = 1;
+        attr->policy = IMP_ENC_QUEUE_DROP_OLDEST;
+    }
+    return 0;
+}
+
+int IMP_Encoder_GetChnQueueStat(int encChn, IMPEncoderQueueStat *stat) {
+    if (encChn < 0 || encChn >= MAX_ENC_CHANNELS || stat == NULL) {
+        return -1;
+    }
+
+    EncChannel *chn = &g_EncChannel[encChn];
+    if (chn->chn_id < 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&chn->mutex_1d8);
+    *stat = chn->queue_stat;
+    pthread_mutex_unlock(&chn->mutex_1d8);
+    return 0;
+}
+
+int IMP_Encoder_GetChnStreamStat(int encChn, IMPEncoderStreamStat *stat) {
+    if (encChn < 0 || encChn >= MAX_ENC_CHANNELS || stat == NULL) {
+        return -1;
+    }
+
+    EncChannel *chn = &g_EncChannel[encChn];
+    if (chn->chn_id < 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&chn->mutex_450);
+    *stat = chn->stream_stat;
+    stat->ready = (uint32_t)(chn->stream_count - chn->stream_held);
+    stat->held = (uint32_t)chn->stream_held;
+    pthread_mutex_unlock(&chn->mutex_450);
+    return 0;
+}
+
+int IMP_Encoder_GetChnAvpuStat(int encChn, IMPEncoderAvpuStat *stat) {
+    AvpuSchedStat st;
+
+    if (encChn < 0 || encChn >= MAX_ENC_CHANNELS || stat == NULL) {
+        return -1;
+    }
+
+    EncChannel *chn = &g_EncChannel[encChn];
+    if (chn->chn_id < 0 || chn->codec == NULL) {
+        return -1;
+    }
+    if (AL_Codec_Encode_GetSchedStat(chn->codec, &st) < 0) {
+        return -1;
+    }
+
+    stat->jobs = st.jobs;
+    stat->deadlineMiss = st.deadline_miss;
+    stat->timeouts = st.timeouts;
+    stat->waitAvgUs = st.wait_avg_us;
+    stat->waitMaxUs = st.wait_max_us;
+    stat->runAvgUs = st.run_avg_us;
+    stat->runMaxUs = st.run_max_us;
     return 0;
 }
 
@@ -1592,7 +1921,7 @@ static int encoder_channel_has_pending_stream(int encChn) {
     }
 
     pthread_mutex_lock(&chn->mutex_450);
-    int pending = (chn->current_stream != NULL);
+    int pending = (chn->stream_held < chn->stream_count);
     pthread_mutex_unlock(&chn->mutex_450);
     return pending;
 }
@@ -1685,6 +2014,11 @@ int IMP_Encoder_SetMaxStreamCnt(int encChn, int cnt) {
         return -1;
     }
 
+    if (cnt < 1 || cnt > IMP_ENC_STREAM_MAX_DEPTH) {
+        LOG_ENC("SetMaxStreamCnt failed: cnt=%d not in 1..%d", cnt, IMP_ENC_STREAM_MAX_DEPTH);
+        return -1;
+    }
+
     /* Store max stream count at offset 0x4c0 from channel base */
     chn->max_stream_cnt = cnt;
 
@@ -1711,13 +2045,18 @@ int IMP_Encoder_SetStreamBufSize(int encChn, int size) {
     return 0;
 }
 
+/* Waits on the stream dispatcher's ready set: every attached channel's
+ * GetFd eventfd, which stays readable while streams wait to be fetched. */
 int IMP_Encoder_PollingModuleStream(uint32_t *encChnBitmap, uint32_t timeoutMsec) {
     if (encChnBitmap == NULL) return -1;
 
-    const uint32_t sleep_step_us = 1000;
-    uint32_t waited_us = 0;
+    struct epoll_event evs[MAX_ENC_CHANNELS];
+    struct timespec start, now;
+    int epfd = g_stream_dispatch.ready_epfd;
+
+    clock_gettime(CLOCK_MONOTONIC, &start);
 
-    do {
+    for (;;) {
         uint32_t bitmap = 0;
         for (int encChn = 0; encChn < MAX_ENC_CHANNELS && encChn < 32; encChn++) {
             if (encoder_channel_has_pending_stream(encChn)) {
@@ -1730,12 +2069,42 @@ int IMP_Encoder_PollingModuleStream(uint32_t *encChnBitmap, uint32_t timeoutMsec
             return 0;
         }
 
-        usleep(sleep_step_us);
-        waited_us += sleep_step_us;
-    } while (waited_us < (timeoutMsec * 1000u));
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        int64_t elapsed_ms = (int64_t)(now.tv_sec - start.tv_sec) * 1000 +
+                             (now.tv_nsec - start.tv_nsec) / 1000000;
+        if (elapsed_ms >= (int64_t)timeoutMsec) {
+            return 0;
+        }
+        int wait_ms = (int)((int64_t)timeoutMsec - elapsed_ms);
 
-    *encChnBitmap = 0;
-    return 0;
+        if (epfd < 0) {
+            /* No channel has been attached yet */
+            usleep((useconds_t)wait_ms * 1000u);
+            continue;
+        }
+
+        int n = epoll_wait(epfd, evs, MAX_ENC_CHANNELS, wait_ms);
+        if (n < 0 && errno != EINTR) {
+            return -1;
+        }
+        if (n > 0) {
+            /* A ready fd for a channel that is not receiving pictures would
+             * keep firing; back off instead of spinning. */
+            uint32_t fired = 0;
+            for (int i = 0; i < n; i++) {
+                fired |= 1u << evs[i].data.u32;
+            }
+            int any = 0;
+            for (int encChn = 0; encChn < MAX_ENC_CHANNELS; encChn++) {
+                if ((fired & (1u << encChn)) && encoder_channel_has_pending_stream(encChn)) {
+                    any = 1;
+                }
+            }
+            if (!any) {
+                usleep(1000);
+            }
+        }
+    }
 }
 
 int IMP_Encoder_SetChnResizeMode(int encChn, int en) {
@@ -2141,6 +2510,9 @@ static int channel_encoder_init(EncChannel *chn) {
     }
     enc_kmsg("channel_encoder_init entropy-ok chn=%d mode=%d", chn->chn_id, chn->entropy_mode);
 
+    /* Codec stream descriptors are held alongside our StreamBuffers */
+    AL_Codec_Encode_SetStreamPoolDepth(chn->codec, chn->max_stream_cnt + 1);
+
     /* Get source frame count and size */
     if (AL_Codec_Encode_GetSrcFrameCntAndSize(chn->codec, &chn->src_frame_cnt, &chn->src_frame_size) < 0) {
         LOG_ENC("channel_encoder_init: GetSrcFrameCntAndSize failed");
@@ -2154,8 +2526,8 @@ static int channel_encoder_init(EncChannel *chn) {
     enc_kmsg("channel_encoder_init buffers chn=%d frame_cnt=%d frame_size=%d",
              chn->chn_id, chn->src_frame_cnt, chn->src_frame_size);
 
-    /* Allocate frame buffers */
-    size_t buf_size = chn->src_frame_cnt * 0x458; /* 0x458 bytes per frame buffer */
+    /* Allocate frame buffers, with the per-slot source frame handles after them */
+    size_t buf_size = chn->src_frame_cnt * (0x458 + sizeof(VBMFrameHandle)); /* 0x458 bytes per frame buffer */
     chn->frame_buffers = calloc(buf_size, 1);
     if (chn->frame_buffers == NULL) {
         LOG_ENC("channel_encoder_init: failed to allocate frame buffers");
@@ -2163,6 +2535,7 @@ static int channel_encoder_init(EncChannel *chn) {
         AL_Codec_Encode_Destroy(chn->codec);
         return -1;
     }
+    chn->frame_handles = (VBMFrameHandle*)((uint8_t*)chn->frame_buffers + chn->src_frame_cnt * 0x458);
     enc_kmsg("channel_encoder_init framebuf-ok chn=%d ptr=%p size=%zu", chn->chn_id, chn->frame_buffers, buf_size);
 
     /* Initialize fifo */
@@ -2189,21 +2562,9 @@ static int channel_encoder_init(EncChannel *chn) {
     enc_kmsg("channel_encoder_init encoder-thread-ok chn=%d tid=%p",
              chn->chn_id, (void *)chn->thread_encoder);
 
-    /* Create stream thread (from decompilation at 0x80b60) */
-    ret = pthread_create(&chn->thread_stream, NULL, stream_thread, chn);
-    if (ret != 0) {
-        LOG_ENC("channel_encoder_init: failed to create stream thread: %s (%d)",
-                strerror(ret), ret);
-        enc_kmsg("channel_encoder_init stream-thread-failed chn=%d ret=%d", chn->chn_id, ret);
-        pthread_cancel(chn->thread_encoder);
-        pthread_join(chn->thread_encoder, NULL);
-        Fifo_Deinit(chn->fifo);
-        free(chn->frame_buffers);
-        AL_Codec_Encode_Destroy(chn->codec);
-        return -1;
-    }
-    enc_kmsg("channel_encoder_init stream-thread-ok chn=%d tid=%p",
-             chn->chn_id, (void *)chn->thread_stream);
+    /* OEM starts a per-channel stream thread here (0x80b60). Streams are
+     * instead collected by the shared dispatcher, which CreateChn attaches
+     * once the channel eventfd exists (encoder_dispatch_attach). */
 
     return 0;
 }
@@ -2221,15 +2582,9 @@ static int channel_encoder_exit(EncChannel *chn) {
         pthread_join(chn->thread_encoder, NULL);
     }
 
-    if (chn->thread_stream) {
-        pthread_cancel(chn->thread_stream);
-        pthread_join(chn->thread_stream, NULL);
-    }
+    encoder_dispatch_detach(chn);
 
-    if (chn->pending_frame != NULL) {
-        encoder_unlock_and_release_frame(chn, chn->pending_frame);
-        chn->pending_frame = NULL;
-    }
+    encoder_queue_flush(chn);
 
     /* Cleanup fifo */
     Fifo_Deinit(chn->fifo);
@@ -2238,6 +2593,7 @@ static int channel_encoder_exit(EncChannel *chn) {
     if (chn->frame_buffers) {
         free(chn->frame_buffers);
         chn->frame_buffers = NULL;
+        chn->frame_handles = NULL;
     }
 
     /* Destroy codec */
@@ -2332,17 +2688,22 @@ static void *encoder_thread(void *arg) {
 
     while (1) {
         void *queued_frame = NULL;
+        uint64_t queued_us = 0;
 
         pthread_testcancel();
         pthread_mutex_lock(&chn->mutex_1d8);
-        while (chn->pending_frame == NULL) {
+        /* pthread_cond_wait is a cancellation point that returns with the
+         * mutex held; make sure channel_encoder_exit can still take it. */
+        pthread_cleanup_push(encoder_mutex_cleanup, &chn->mutex_1d8);
+        while (chn->frame_queue_count == 0) {
             LOG_ENC("encoder_thread: waiting chn=%d codec=%p recv=%u started=%u", chn->chn_id, chn->codec,
                     chn->recv_pic_started, chn->started);
             pthread_cond_wait(&chn->cond_1f0, &chn->mutex_1d8);
         }
-        queued_frame = chn->pending_frame;
-        chn->pending_frame = NULL;
-        pthread_mutex_unlock(&chn->mutex_1d8);
+        queued_frame = encoder_queue_pop_locked(chn, &queued_us);
+        /* Wake an encoder_update blocked on a full queue */
+        pthread_cond_broadcast(&chn->cond_1f0);
+        pthread_cleanup_pop(1);
 
         if (queued_frame == NULL)
             continue;
@@ -2357,280 +2718,396 @@ static void *encoder_thread(void *arg) {
         } else {
             LOG_ENC("encoder_thread: AL_Codec_Encode_Process ok chn=%d frame=%p", chn->chn_id, queued_frame);
             enc_kmsg("encoder_thread process ok chn=%d frame=%p", chn->chn_id, queued_frame);
+
+            uint64_t latency_us = enc_mono_us() - queued_us;
+            pthread_mutex_lock(&chn->mutex_1d8);
+            chn->queue_stat.encoded++;
+            chn->queue_latency_sum_us += latency_us;
+            chn->queue_stat.latencyAvgUs = (uint32_t)(chn->queue_latency_sum_us / chn->queue_stat.encoded);
+            if (latency_us > chn->queue_stat.latencyMaxUs)
+                chn->queue_stat.latencyMaxUs = (uint32_t)latency_us;
+            pthread_mutex_unlock(&chn->mutex_1d8);
         }
     }
 
     return NULL;
 }
 
-/* Stream thread - handles stream output */
-static void *stream_thread(void *arg) {
-    EncChannel *chn = (EncChannel*)arg;
+/* ========== Stream Dispatcher ========== */
 
-    if (chn == NULL) {
-        LOG_ENC("stream_thread: NULL channel pointer!");
+/* Build a StreamBuffer for one codec stream: split the Annex B payload into
+ * packs and latch SPS/PPS tracking. */
+static StreamBuffer *encoder_build_stream(EncChannel *chn, void *codec_stream, void *codec_user_data)
+{
+    /* Take a StreamBuffer from the channel pool */
+    StreamBuffer *stream_buf = encoder_stream_buf_get(chn);
+    if (stream_buf == NULL) {
         return NULL;
     }
 
-    LOG_ENC("stream_thread: started for channel %d", chn->chn_id);
+    /* codec_stream is actually a HWStreamBuffer pointer */
+    /* Extract metadata from HWStreamBuffer structure:
+     * 0x00: phys_addr
+     * 0x04: virt_addr
+     * 0x08: length
+     * 0x0c: timestamp (64-bit)
+     * 0x14: frame_type
+     * 0x18: slice_type
+     */
+    uint8_t *hw_stream = (uint8_t*)codec_stream;
+    uint32_t phys_addr, virt_addr, length, frame_type, slice_type;
+    uint64_t timestamp;
+
+    memcpy(&phys_addr, hw_stream + 0x00, sizeof(uint32_t));
+    memcpy(&virt_addr, hw_stream + 0x04, sizeof(uint32_t));
+    memcpy(&length, hw_stream + 0x08, sizeof(uint32_t));
+    memcpy(&timestamp, hw_stream + 0x0c, sizeof(uint64_t));
+    memcpy(&frame_type, hw_stream + 0x14, sizeof(uint32_t));
+    memcpy(&slice_type, hw_stream + 0x18, sizeof(uint32_t));
+
+    /* Prepare for optional H.264 SPS/PPS prefix injection */
+    uint32_t out_phy = phys_addr;
+    uint32_t out_vir = virt_addr;
+    uint32_t out_len = length;
+    stream_buf->injected_buf = NULL;
+    /* Determine codec type from profile's top byte (OEM format): 0=AVC,1=HEVC,4=JPEG */
+    uint32_t profile_enum = chn->attr.encAttr.profile;
+    uint32_t codec_type = (profile_enum >> 24) & 0xFF;
+
+    /* Initialize stream buffer */
+    stream_buf->codec_stream = codec_stream;
+    stream_buf->codec_user_data = codec_user_data;
+    stream_buf->seq = chn->stream_seq++;
+    stream_buf->streamEnd = 0;
+
+    /* Populate base addresses and T31-style pack */
+    stream_buf->base_phy = out_phy;
+    stream_buf->base_vir = out_vir;
+    stream_buf->base_size = out_len;
+
+    /* Split the Annex B buffer into one pack per NAL unit to mirror OEM
+     * libimp. A single indexing pass fills a table the size of the pooled
+     * pack slab; only an access unit with more NAL units is indexed again. */
+    uint8_t *p_all = (uint8_t*)(uintptr_t)out_vir;
+    AnnexbCodec nal_codec = (codec_type == IMP_ENC_TYPE_HEVC) ? ANNEXB_HEVC : ANNEXB_H264;
+    AnnexbNal nal_local[ENC_STREAM_POOL_PACKS];
+    AnnexbNal *nals = nal_local;
+    int count = 0;
+
+    /* JPEG has no start codes; slice data may still hold 00 00 01 */
+    if (codec_type != IMP_ENC_TYPE_JPEG)
+        count = annexb_index(p_all, (size_t)out_len, nal_codec, nal_local, ENC_STREAM_POOL_PACKS);
+    if (count > ENC_STREAM_POOL_PACKS) {
+        nals = (AnnexbNal*)malloc((size_t)count * sizeof(*nals));
+        if (nals != NULL)
+            annexb_index(p_all, (size_t)out_len, nal_codec, nals, count);
+        else
+            count = 0;
+    }
+
+    stream_buf->packs = NULL;
+    stream_buf->packCount = 0;
+    if (count > 0)
+        stream_buf->packs = encoder_stream_packs_get(chn, stream_buf, count);
+
+    if (stream_buf->packs == NULL) {
+        /* Fallback: single pack covering whole buffer */
+        stream_buf->pack.offset = 0;
+        stream_buf->pack.length = out_len;
+        stream_buf->pack.timestamp = (int64_t)timestamp;
+        stream_buf->pack.frameEnd = 1;
+        memset(&stream_buf->pack.nalType, 0, sizeof(stream_buf->pack.nalType));
+        /* Heuristic based on frame_type */
+        if (codec_type == IMP_ENC_TYPE_AVC) {
+            stream_buf->pack.nalType.h264NalType = (frame_type == 0) ? IMP_H264_NAL_SLICE_IDR : IMP_H264_NAL_SLICE;
+        } else if (codec_type == IMP_ENC_TYPE_HEVC) {
+            stream_buf->pack.nalType.h265NalType = (frame_type == 0) ? IMP_H265_NAL_SLICE_IDR_W_RADL : IMP_H265_NAL_SLICE_TRAIL_R;
+        }
+        stream_buf->pack.sliceType = (IMPEncoderSliceType)slice_type;
+    } else {
+        stream_buf->packCount = (uint32_t)count;
+        for (int idx = 0; idx < count; idx++) {
+            IMPEncoderPack *pk = &stream_buf->packs[idx];
+
+            pk->offset = nals[idx].offset;
+            pk->length = nals[idx].length;
+            pk->timestamp = (int64_t)timestamp;
+            pk->frameEnd = (idx == (count - 1)) ? 1 : 0;
+            memset(&pk->nalType, 0, sizeof(pk->nalType));
+            if (nal_codec == ANNEXB_HEVC)
+                pk->nalType.h265NalType = (IMPEncoderH265NaluType)nals[idx].type;
+            else
+                pk->nalType.h264NalType = (IMPEncoderH264NaluType)nals[idx].type;
+            pk->sliceType = (IMPEncoderSliceType)slice_type;
+        }
 
-    /* Main stream handling loop */
-    while (1) {
-        /* Check for thread cancellation */
-        pthread_testcancel();
+        /* Populate legacy single-pack with first pack for debug compatibility */
+        stream_buf->pack = stream_buf->packs[0];
+    }
+    if (nals != nal_local)
+        free(nals);
+
+    /* If no parameter sets observed yet on this channel, request an IDR once */
+    if ((codec_type == IMP_ENC_TYPE_AVC || codec_type == IMP_ENC_TYPE_HEVC) && !chn->param_sets_seen) {
+        const IMPEncoderPack *pk = stream_buf->packs ? stream_buf->packs : &stream_buf->pack;
+        uint32_t n = stream_buf->packs ? stream_buf->packCount : 1;
+        int saw_vps = (codec_type == IMP_ENC_TYPE_AVC), saw_sps = 0, saw_pps = 0;
+        for (uint32_t ii = 0; ii < n; ++ii) {
+            if (codec_type == IMP_ENC_TYPE_HEVC) {
+                IMPEncoderH265NaluType t = pk[ii].nalType.h265NalType;
+                if (t == IMP_H265_NAL_VPS) saw_vps = 1;
+                else if (t == IMP_H265_NAL_SPS) saw_sps = 1;
+                else if (t == IMP_H265_NAL_PPS) saw_pps = 1;
+            } else {
+                IMPEncoderH264NaluType t = pk[ii].nalType.h264NalType;
+                if (t == IMP_H264_NAL_SPS) saw_sps = 1;
+                else if (t == IMP_H264_NAL_PPS) saw_pps = 1;
+            }
+        }
+        if (saw_vps && saw_sps && saw_pps) {
+            chn->param_sets_seen = 1;
+        } else if (!chn->idr_requested_once) {
+            chn->idr_requested_once = 1;
+            LOG_ENC("No parameter sets yet on chn=%d; requesting IDR", chn->chn_id);
+            IMP_Encoder_RequestIDR(chn->chn_id);
+        }
+    }
 
-        /* Wait for eventfd signal from encoder thread */
+    if (stream_buf->seq % 50 == 0)
+    LOG_ENC("stream_dispatch: stream seq=%u, packs=%u, total_len=%u, type=%s",
+            stream_buf->seq, stream_buf->packs ? stream_buf->packCount : 1, stream_buf->base_size,
+            frame_type == 0 ? "I" : (frame_type == 1 ? "P" : "B"));
+    enc_kmsg("stream_dispatch stream seq=%u packs=%u total_len=%u base=0x%x first_off=%u first_len=%u type=%s",
+             stream_buf->seq,
+             stream_buf->packs ? stream_buf->packCount : 1,
+             stream_buf->base_size,
+             stream_buf->base_vir,
+             stream_buf->packs ? stream_buf->packs[0].offset : stream_buf->pack.offset,
+             stream_buf->packs ? stream_buf->packs[0].length : stream_buf->pack.length,
+             frame_type == 0 ? "I" : (frame_type == 1 ? "P" : "B"));
+
+    return stream_buf;
+}
+
+/* Move codec streams into the channel's output queue while it has room.
+ * Called with g_stream_dispatch.lock held. */
+static void encoder_dispatch_channel(EncChannel *chn)
+{
+    while (chn->codec != NULL) {
+        void *codec_stream = NULL;
+        void *codec_user_data = NULL;
+
+        pthread_mutex_lock(&chn->mutex_450);
+        int full = (chn->stream_count >= chn->max_stream_cnt);
+        if (full)
+            chn->stream_stat.queueFull++;
+        pthread_mutex_unlock(&chn->mutex_450);
+        if (full) {
+            return;     /* ReleaseStream re-queues us via rescan */
+        }
+
+        if (AL_Codec_Encode_TryGetStream(chn->codec, &codec_stream, &codec_user_data) != 0 ||
+            codec_stream == NULL) {
+            return;
+        }
+
+        if (chn->stream_seq % 50 == 0)
+        LOG_ENC("stream_dispatch: chn=%d got stream %p (seq=%u)", chn->chn_id, codec_stream, chn->stream_seq);
+
+        StreamBuffer *stream_buf = encoder_build_stream(chn, codec_stream, codec_user_data);
+        if (stream_buf == NULL) {
+            LOG_ENC("stream_dispatch: chn=%d out of stream buffers, dropping stream", chn->chn_id);
+            AL_Codec_Encode_ReleaseStream(chn->codec, codec_stream, codec_user_data);
+            if (codec_user_data != NULL)
+                encoder_unlock_and_release_frame(chn, codec_user_data);
+            continue;
+        }
+
+        /* Queue for GetStream */
+        pthread_mutex_lock(&chn->mutex_450);
+        stream_buf->ready_us = enc_mono_us();
+        chn->stream_queue[chn->stream_count++] = stream_buf;
+        if ((uint32_t)chn->stream_count > chn->stream_stat.maxOccupancy)
+            chn->stream_stat.maxOccupancy = (uint32_t)chn->stream_count;
+        /* Signal sem_428 (PollingStream waits on this) */
+        sem_post(&chn->sem_428);
+        /* Signal sem_418 (GetStream waits on this) */
+        sem_post(&chn->sem_418);
+        /* Also notify via eventfd for apps using GetFd/poll; GetStream
+         * drains it once nothing is left to fetch */
         if (chn->eventfd >= 0) {
-            uint64_t val;
-            fd_set readfds;
-            struct timeval tv;
-
-            FD_ZERO(&readfds);
-            FD_SET(chn->eventfd, &readfds);
-            tv.tv_sec = 0;
-            tv.tv_usec = 100000; /* 100ms timeout */
-
-            int ret = select(chn->eventfd + 1, &readfds, NULL, NULL, &tv);
-            if (ret > 0 && FD_ISSET(chn->eventfd, &readfds)) {
-                ssize_t n = read(chn->eventfd, &val, sizeof(val));
-                (void)n; /* Suppress unused warning */
-            }
+            uint64_t val = 1;
+            ssize_t n = write(chn->eventfd, &val, sizeof(val));
+            (void)n;
         }
+        pthread_mutex_unlock(&chn->mutex_450);
+    }
+}
 
-        /* Get encoded stream from codec */
-        if (chn->codec != NULL) {
-            void *codec_stream = NULL;
-            void *codec_user_data = NULL;
-            if (AL_Codec_Encode_GetStream(chn->codec, &codec_stream, &codec_user_data) == 0 && codec_stream != NULL) {
-                /* Validate stream pointer - must be a reasonable heap address */
-                uintptr_t stream_addr = (uintptr_t)codec_stream;
-                if (stream_addr < 0x10000) {
-                    LOG_ENC("stream_thread: invalid stream pointer %p (too small)", codec_stream);
-                    continue;
-                }
+/* Ask the dispatcher to look at chn again (its output slot was released) */
+static void encoder_dispatch_kick(EncChannel *chn)
+{
+    EncStreamDispatcher *d = &g_stream_dispatch;
+    int idx = (int)(chn - g_EncChannel);
 
-                if (chn->stream_seq % 50 == 0)
-                LOG_ENC("stream_thread: got stream %p (seq=%u)", codec_stream, chn->stream_seq);
-
-                /* Create StreamBuffer structure */
-                StreamBuffer *stream_buf = (StreamBuffer*)calloc(1, sizeof(StreamBuffer));
-                if (stream_buf != NULL) {
-                    /* codec_stream is actually a HWStreamBuffer pointer */
-                    /* Extract metadata from HWStreamBuffer structure:
-                     * 0x00: phys_addr
-                     * 0x04: virt_addr
-                     * 0x08: length
-                     * 0x0c: timestamp (64-bit)
-                     * 0x14: frame_type
-                     * 0x18: slice_type
-                     */
-                    uint8_t *hw_stream = (uint8_t*)codec_stream;
-                    uint32_t phys_addr, virt_addr, length, frame_type, slice_type;
-                    uint64_t timestamp;
-
-                    memcpy(&phys_addr, hw_stream + 0x00, sizeof(uint32_t));
-                    memcpy(&virt_addr, hw_stream + 0x04, sizeof(uint32_t));
-                    memcpy(&length, hw_stream + 0x08, sizeof(uint32_t));
-                    memcpy(&timestamp, hw_stream + 0x0c, sizeof(uint64_t));
-                    memcpy(&frame_type, hw_stream + 0x14, sizeof(uint32_t));
-                    memcpy(&slice_type, hw_stream + 0x18, sizeof(uint32_t));
-
-
-                        /* Prepare for optional H.264 SPS/PPS prefix injection */
-                        uint32_t out_phy = phys_addr;
-                        uint32_t out_vir = virt_addr;
-                        uint32_t out_len = length;
-                        stream_buf->injected_buf = NULL;
-                        /* Determine codec type from profile's top byte (OEM format): 0=AVC,1=HEVC,4=JPEG */
-                        uint32_t profile_enum = chn->attr.encAttr.profile;
-                        uint32_t codec_type = (profile_enum >> 24) & 0xFF;
-                        int is_h264 = (codec_type == IMP_ENC_TYPE_AVC);
-                        /* Injection path removed: streaming uses encoder-provided AU only */
-                        (void)is_h264; /* keep variable for potential future use */
-
-                    /* Initialize stream buffer */
-                    stream_buf->codec_stream = codec_stream;
-                    stream_buf->codec_user_data = codec_user_data;
-                    stream_buf->seq = chn->stream_seq++;
-                    stream_buf->streamEnd = 0;
-
-                    /* Populate base addresses and T31-style pack (possibly using injected buffer) */
-                    stream_buf->base_phy = out_phy;
-                    stream_buf->base_vir = out_vir;
-                    stream_buf->base_size = out_len;
-
-                    /* Split Annex B buffer into packs per NAL start code to mirror OEM libimp */
-                    uint8_t *p_all = (uint8_t*)(uintptr_t)out_vir;
-                    size_t L_all = (size_t)out_len;
-                    size_t i = 0; int sc = 0; int count = 0;
-                    i = find_start_code(p_all, 0, L_all, &sc);
-                    while (i < L_all) {
-                        size_t ns = i + (sc ? sc : 0);
-                        int sc2 = 0; size_t nx = find_start_code(p_all, ns, L_all, &sc2);
-                        count++;
-                        if (nx >= L_all) break;
-                        i = nx; sc = sc2;
-                    }
-
-                    if (count <= 0) {
-                        /* Fallback: single pack covering whole buffer */
-                        stream_buf->packs = NULL;
-                        stream_buf->packCount = 0;
-                        stream_buf->pack.offset = 0;
-                        stream_buf->pack.length = out_len;
-                        stream_buf->pack.timestamp = (int64_t)timestamp;
-                        stream_buf->pack.frameEnd = 1;
-                        memset(&stream_buf->pack.nalType, 0, sizeof(stream_buf->pack.nalType));
-                        if (codec_type == IMP_ENC_TYPE_AVC) {
-                            /* Heuristic based on frame_type */
-                            stream_buf->pack.nalType.h264NalType = (frame_type == 0) ? 5 : 1;
-                        }
-                        stream_buf->pack.sliceType = (IMPEncoderSliceType)slice_type;
-                    } else {
-                        stream_buf->packs = (IMPEncoderPack*)calloc((size_t)count, sizeof(IMPEncoderPack));
-                        stream_buf->packCount = (uint32_t)count;
-
-                        /* Second pass: fill packs */
-                        i = find_start_code(p_all, 0, L_all, &sc);
-                        int idx = 0;
-                        while (idx < count && i < L_all) {
-                            size_t ns = i + (sc ? sc : 0);
-                            int sc2 = 0; size_t nx = find_start_code(p_all, ns, L_all, &sc2);
-                            size_t seg_len = (nx < L_all) ? (nx - i) : (L_all - i);
-
-                            stream_buf->packs[idx].offset = (uint32_t)i;
-                            stream_buf->packs[idx].length = (uint32_t)seg_len;
-                            stream_buf->packs[idx].timestamp = (int64_t)timestamp;
-                            stream_buf->packs[idx].frameEnd = (idx == (count - 1)) ? 1 : 0;
-                            memset(&stream_buf->packs[idx].nalType, 0, sizeof(stream_buf->packs[idx].nalType));
-                            if (ns < L_all) {
-                                uint8_t t = p_all[ns] & 0x1F; /* H.264 */
-                                stream_buf->packs[idx].nalType.h264NalType = t;
-                            }
-                            stream_buf->packs[idx].sliceType = (IMPEncoderSliceType)slice_type;
-
-                            if (nx >= L_all) break;
-                            i = nx; sc = sc2; idx++;
-                        }
-
-                        /* Populate legacy single-pack with first pack for debug compatibility */
-                        stream_buf->pack = stream_buf->packs[0];
-                    }
-
-                    /* If no SPS/PPS observed yet on this channel, request an IDR once */
-                    if (codec_type == IMP_ENC_TYPE_AVC && !chn->param_sets_seen) {
-                        int saw_sps = 0, saw_pps = 0;
-                        if (stream_buf->packs && stream_buf->packCount > 0) {
-                            for (uint32_t ii = 0; ii < stream_buf->packCount; ++ii) {
-                                uint8_t t = stream_buf->packs[ii].nalType.h264NalType;
-                                if (t == 7) saw_sps = 1; else if (t == 8) saw_pps = 1;
-                            }
-                        } else {
-                            uint8_t t = stream_buf->pack.nalType.h264NalType;
-                            if (t == 7) saw_sps = 1; else if (t == 8) saw_pps = 1;
-                        }
-                        if (saw_sps && saw_pps) {
-                            chn->param_sets_seen = 1;
-                        } else if (!chn->idr_requested_once) {
-                            chn->idr_requested_once = 1;
-                            LOG_ENC("No SPS/PPS yet on chn=%d; requesting IDR", chn->chn_id);
-                            IMP_Encoder_RequestIDR(chn->chn_id);
-                        }
-                    }
-
-                    /* Store in channel for GetStream (only if slot is empty) */
-                    int posted = 0;
-                    pthread_mutex_lock(&chn->mutex_450);
-                    if (chn->current_stream == NULL) {
-                        chn->current_stream = stream_buf;
-                        /* Signal sem_428 (PollingStream waits on this) */
-                        sem_post(&chn->sem_428);
-                        /* Signal sem_418 (GetStream waits on this) */
-                        sem_post(&chn->sem_418);
-                        /* Also notify via eventfd for apps using GetFd/poll */
-                        if (chn->eventfd >= 0) {
-                            uint64_t val = 1;
-                            ssize_t n = write(chn->eventfd, &val, sizeof(val));
-                            (void)n;
-                        }
-                        posted = 1;
-                    }
-                    pthread_mutex_unlock(&chn->mutex_450);
-
-                    /* If consumer hasn't released previous stream yet, wait until it is released, then post */
-                    if (!posted) {
-                        { static unsigned int wait_count = 0; unsigned int c = __sync_add_and_fetch(&wait_count, 1);
-                          if (c <= 5 || (c % 50) == 0)
-                            LOG_ENC("stream_thread: waiting (not dropping) because previous stream not yet released [#%u]", c);
-                        }
-                        while (!posted) {
-                            /* Wait for ReleaseStream to signal slot available */
-                            sem_wait(&chn->sem_408);
-                            /* Try again to post */
-                            pthread_mutex_lock(&chn->mutex_450);
-                            if (chn->current_stream == NULL) {
-                                chn->current_stream = stream_buf;
-                                sem_post(&chn->sem_428);
-                                sem_post(&chn->sem_418);
-                                if (chn->eventfd >= 0) {
-                                    uint64_t val = 1;
-                                    ssize_t n = write(chn->eventfd, &val, sizeof(val));
-                                    (void)n;
-                                }
-                                posted = 1;
-                            }
-                            pthread_mutex_unlock(&chn->mutex_450);
-                        }
-                    }
-
-                    /* Log final posted stream */
-                    if (stream_buf->seq % 50 == 0)
-                    LOG_ENC("stream_thread: stream seq=%u, packs=%u, total_len=%u, type=%s",
-                            stream_buf->seq, stream_buf->packs ? stream_buf->packCount : 1, stream_buf->base_size,
-                            frame_type == 0 ? "I" : (frame_type == 1 ? "P" : "B"));
-                    enc_kmsg("stream_thread stream seq=%u packs=%u total_len=%u base=0x%x first_off=%u first_len=%u type=%s",
-                             stream_buf->seq,
-                             stream_buf->packs ? stream_buf->packCount : 1,
-                             stream_buf->base_size,
-                             stream_buf->base_vir,
-                             stream_buf->packs ? stream_buf->packs[0].offset : stream_buf->pack.offset,
-                             stream_buf->packs ? stream_buf->packs[0].length : stream_buf->pack.length,
-                             frame_type == 0 ? "I" : (frame_type == 1 ? "P" : "B"));
-
-                    /* Debug: print first few NAL types from outgoing buffer */
-                    if (stream_buf->base_size >= 6) {
-                        const uint8_t *p = (const uint8_t*)(uintptr_t)stream_buf->base_vir;
-                        size_t L = stream_buf->base_size;
-                        size_t i = 0; int sc = 0; int cnt = 0;
-                        i = find_start_code(p, 0, L, &sc);
-                        char nal_str[64]; int off = 0;
-                        off += snprintf(nal_str+off, sizeof(nal_str)-off, "NALs:");
-                        while (i < L && cnt < 4) {
-                            size_t ns = i + (sc ? sc : 0);
-                            int sc2 = 0; size_t nx = find_start_code(p, ns, L, &sc2);
-                            if (ns < nx) {
-                                uint8_t t = p[ns] & 0x1F; cnt++;
-                                off += snprintf(nal_str+off, sizeof(nal_str)-off, " %u", t);
-                            }
-                            if (nx >= L) break;
-                            i = nx;
-                            sc = sc2;
-                        }
-                        if (stream_buf->seq % 50 == 0)
-                        LOG_ENC("stream_thread: %s", nal_str);
-                    }
+    __atomic_or_fetch(&d->rescan, 1u << idx, __ATOMIC_RELEASE);
+    if (d->wake_fd >= 0) {
+        uint64_t one = 1;
+        ssize_t n = write(d->wake_fd, &one, sizeof(one));
+        (void)n;
+    }
+}
 
-                }
+static void *stream_dispatch_thread(void *arg)
+{
+    EncStreamDispatcher *d = (EncStreamDispatcher*)arg;
+    struct epoll_event evs[MAX_ENC_CHANNELS + 1];
+
+    LOG_ENC("stream_dispatch: started");
+
+    while (__atomic_load_n(&d->running, __ATOMIC_ACQUIRE)) {
+        uint32_t todo = 0;
+        int n = epoll_wait(d->epfd, evs, MAX_ENC_CHANNELS + 1, ENC_DISPATCH_STALL_MS);
+
+        if (n < 0 && errno != EINTR) {
+            LOG_ENC("stream_dispatch: epoll_wait failed: %s", strerror(errno));
+            usleep(10000);
+            continue;
+        }
+
+        pthread_mutex_lock(&d->lock);
+        for (int i = 0; i < n; i++) {
+            uint64_t val;
+            ssize_t r = 0;
+            if (evs[i].data.u32 == ENC_DISPATCH_WAKE_TAG) {
+                r = read(d->wake_fd, &val, sizeof(val));
+            } else if (g_EncChannel[evs[i].data.u32].dispatch_attached) {
+                /* Re-arm the codec fd before draining so no push is missed */
+                EncChannel *chn = &g_EncChannel[evs[i].data.u32];
+                r = read(AL_Codec_Encode_GetStreamFd(chn->codec), &val, sizeof(val));
+                todo |= 1u << evs[i].data.u32;
             }
-        } else {
-            /* No codec yet, just wait */
-            usleep(10000); /* 10ms */
+            (void)r;
+        }
+        todo |= __atomic_exchange_n(&d->rescan, 0, __ATOMIC_ACQUIRE);
+
+        for (int idx = 0; idx < MAX_ENC_CHANNELS; idx++) {
+            EncChannel *chn = &g_EncChannel[idx];
+            if (!chn->dispatch_attached)
+                continue;
+            /* Nothing woke us for a while: look for a completion whose
+             * interrupt was lost. A recovered stream signals the codec fd. */
+            if (n == 0 && AL_Codec_Encode_RecoverStream(chn->codec))
+                todo |= 1u << idx;
+            if (todo & (1u << idx))
+                encoder_dispatch_channel(chn);
         }
+        pthread_mutex_unlock(&d->lock);
     }
 
+    LOG_ENC("stream_dispatch: stopped");
     return NULL;
 }
 
+/* Attach a channel's codec stream fd and GetFd eventfd. The dispatcher
+ * thread is started with the first channel. Called with encoder_mutex held. */
+static int encoder_dispatch_attach(EncChannel *chn)
+{
+    EncStreamDispatcher *d = &g_stream_dispatch;
+    int idx = (int)(chn - g_EncChannel);
+    int codec_fd = AL_Codec_Encode_GetStreamFd(chn->codec);
+    struct epoll_event ev;
+
+    if (chn->dispatch_attached)
+        return 0;
+    if (codec_fd < 0) {
+        LOG_ENC("stream_dispatch: chn=%d codec has no stream fd", chn->chn_id);
+        return -1;
+    }
+
+    pthread_mutex_lock(&d->lock);
+    if (d->epfd < 0) {
+        d->epfd = epoll_create1(EPOLL_CLOEXEC);
+        d->ready_epfd = epoll_create1(EPOLL_CLOEXEC);
+        d->wake_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (d->epfd < 0 || d->ready_epfd < 0 || d->wake_fd < 0) {
+            LOG_ENC("stream_dispatch: setup failed: %s", strerror(errno));
+            if (d->epfd >= 0) close(d->epfd);
+            if (d->ready_epfd >= 0) close(d->ready_epfd);
+            if (d->wake_fd >= 0) close(d->wake_fd);
+            d->epfd = d->ready_epfd = d->wake_fd = -1;
+            pthread_mutex_unlock(&d->lock);
+            return -1;
+        }
+        memset(&ev, 0, sizeof(ev));
+        ev.events = EPOLLIN;
+        ev.data.u32 = ENC_DISPATCH_WAKE_TAG;
+        epoll_ctl(d->epfd, EPOLL_CTL_ADD, d->wake_fd, &ev);
+    }
+
+    memset(&ev, 0, sizeof(ev));
+    ev.events = EPOLLIN;
+    ev.data.u32 = (uint32_t)idx;
+    if (epoll_ctl(d->epfd, EPOLL_CTL_ADD, codec_fd, &ev) < 0) {
+        LOG_ENC("stream_dispatch: chn=%d epoll add failed: %s", chn->chn_id, strerror(errno));
+        pthread_mutex_unlock(&d->lock);
+        return -1;
+    }
+    if (chn->eventfd >= 0)
+        epoll_ctl(d->ready_epfd, EPOLL_CTL_ADD, chn->eventfd, &ev);
+    chn->dispatch_attached = 1;
+
+    if (d->users++ == 0) {
+        __atomic_store_n(&d->running, 1, __ATOMIC_RELEASE);
+        int ret = pthread_create(&d->thread, NULL, stream_dispatch_thread, d);
+        if (ret != 0) {
+            LOG_ENC("stream_dispatch: failed to create thread: %s (%d)", strerror(ret), ret);
+            __atomic_store_n(&d->running, 0, __ATOMIC_RELEASE);
+            epoll_ctl(d->epfd, EPOLL_CTL_DEL, codec_fd, NULL);
+            if (chn->eventfd >= 0)
+                epoll_ctl(d->ready_epfd, EPOLL_CTL_DEL, chn->eventfd, NULL);
+            chn->dispatch_attached = 0;
+            d->users--;
+            pthread_mutex_unlock(&d->lock);
+            return -1;
+        }
+    }
+    pthread_mutex_unlock(&d->lock);
+
+    /* Pick up anything the codec queued before we were listening */
+    encoder_dispatch_kick(chn);
+    return 0;
+}
+
+/* Detach a channel; the last one stops the dispatcher thread. Called with
+ * encoder_mutex held, before the channel's codec or eventfd go away. */
+static void encoder_dispatch_detach(EncChannel *chn)
+{
+    EncStreamDispatcher *d = &g_stream_dispatch;
+    int stop;
+
+    pthread_mutex_lock(&d->lock);
+    if (!chn->dispatch_attached) {
+        pthread_mutex_unlock(&d->lock);
+        return;
+    }
+    epoll_ctl(d->epfd, EPOLL_CTL_DEL, AL_Codec_Encode_GetStreamFd(chn->codec), NULL);
+    if (chn->eventfd >= 0)
+        epoll_ctl(d->ready_epfd, EPOLL_CTL_DEL, chn->eventfd, NULL);
+    chn->dispatch_attached = 0;
+    stop = (--d->users == 0);
+    if (stop)
+        __atomic_store_n(&d->running, 0, __ATOMIC_RELEASE);
+    pthread_mutex_unlock(&d->lock);
+
+    if (stop) {
+        uint64_t one = 1;
+        ssize_t n = write(d->wake_fd, &one, sizeof(one));
+        (void)n;
+        pthread_join(d->thread, NULL);
+    }
+}
+
 /* ========== Module Binding Functions ========== */
 /**
  * encoder_update - Called by observer pattern when a frame is available
@@ -2673,8 +3150,8 @@ static int encoder_update(void *module, void *frame) {
      * one matching enc_group, i.e. module->group_id). The old code used
      * dst_chn = group_id as a direct channel index, not as a group with
      * multiple sub-channels. Iterating ALL channels in the group causes
-     * multiple VBMLockFrameByVaddr calls (ref_count > 1), and if any
-     * channel's ReleaseStream path fails to call VBMUnlockFrameByVaddr,
+     * multiple source frame references (ref_count > 1), and if any
+     * channel's ReleaseStream path fails to drop its reference,
      * the frame is never returned to the kernel → DQBUF blocks forever.
      *
      * Also: on Process failure, must VBMUnlock the frame (93de1a9 did this). */
@@ -2691,18 +3168,26 @@ static int encoder_update(void *module, void *frame) {
             LOG_ENC("encoder_update: clone ret=%d queued_frame=%p chn=%d", clone_ret, queued_frame, chn->chn_id);
             enc_kmsg("encoder_update clone ret=%d queued_frame=%p chn=%d", clone_ret, queued_frame, chn->chn_id);
             if (clone_ret == 0) {
+                /* IMP_ENC_QUEUE_BLOCK may wait in the push: do it without
+                 * encoder_mutex, so control calls and the other channels go
+                 * on. queue_pushers keeps DestroyChn from tearing the
+                 * channel down under it. */
                 pthread_mutex_lock(&chn->mutex_1d8);
-                if (chn->pending_frame != NULL) {
-                    LOG_ENC("encoder_update: replacing pending frame on chn=%d", chn->chn_id);
-                    enc_kmsg("encoder_update replacing pending chn=%d old=%p new=%p",
-                             chn->chn_id, chn->pending_frame, queued_frame);
-                    encoder_unlock_and_release_frame(chn, chn->pending_frame);
-                }
-                chn->pending_frame = queued_frame;
-                pthread_cond_signal(&chn->cond_1f0);
-                LOG_ENC("encoder_update: queued frame chn=%d frame=%p", chn->chn_id, queued_frame);
-                enc_kmsg("encoder_update queued chn=%d frame=%p", chn->chn_id, queued_frame);
+                chn->queue_pushers++;
+                pthread_mutex_unlock(&chn->mutex_1d8);
+                pthread_mutex_unlock(&encoder_mutex);
+
+                encoder_queue_push(chn, queued_frame);
+                LOG_ENC("encoder_update: queued frame chn=%d frame=%p", enc_group, queued_frame);
+                enc_kmsg("encoder_update queued chn=%d frame=%p", enc_group, queued_frame);
+
+                pthread_mutex_lock(&chn->mutex_1d8);
+                if (--chn->queue_pushers == 0)
+                    pthread_cond_broadcast(&chn->cond_1f0);
                 pthread_mutex_unlock(&chn->mutex_1d8);
+                return 0;
+            } else {
+                encoder_queue_note_drop(chn, &chn->queue_stat.droppedNoSlot);
             }
         } else {
             LOG_ENC("encoder_update: skip group=%d chn_id=%d recv=%u codec=%p", enc_group, chn->chn_id,
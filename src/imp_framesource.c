@@ -534,6 +534,11 @@ int IMP_FrameSource_DisableChn(int chnNum) {
     /* Set state to stopping */
     chn->state = 0;
 
+    /* Wake a capture thread blocked in POLL_FRAME so it sees the state */
+    if (chn->fd >= 0) {
+        fs_poll_cancel(chn->fd);
+    }
+
     /* Cancel and wait for capture thread */
     if (chn->thread != 0) {
         pthread_cancel(chn->thread);
@@ -552,6 +557,16 @@ int IMP_FrameSource_DisableChn(int chnNum) {
 
     /* Close device */
     if (chn->fd >= 0) {
+        fs_poll_stats_t ps;
+
+        if (fs_poll_get_stats(chn->fd, &ps) == 0 && ps.ioctls > 0) {
+            LOG_FS("DisableChn: chn=%d POLL_FRAME calls=%llu ioctls=%llu joined=%llu timeouts=%llu cancels=%llu wait avg=%lluus max=%lluus",
+                   chnNum, (unsigned long long)ps.calls, (unsigned long long)ps.ioctls,
+                   (unsigned long long)ps.joined, (unsigned long long)ps.timeouts,
+                   (unsigned long long)ps.cancels,
+                   (unsigned long long)(ps.wait_total_us / ps.ioctls),
+                   (unsigned long long)ps.wait_max_us);
+        }
         fs_close_device(chn->fd);
         chn->fd = -1;
     }
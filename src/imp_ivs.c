@@ -9,7 +9,9 @@
 #include <stdint.h>
 #include <pthread.h>
 #include <semaphore.h>
+#include <sys/eventfd.h>
 #include <time.h>
+#include <unistd.h>
 
 #include <imp/imp_common.h>
 #include <imp/imp_system.h>
@@ -49,7 +51,13 @@ typedef struct {
     sem_t sem_frame;             /* unused placeholder (matches vendor having sems) */
     sem_t sem_lock;              /* used as a basic lock semaphore (value 1) */
     sem_t sem_result;            /* posted when a result is available */
+    int result_fd;               /* eventfd counting along with sem_result */
     IMPIVSInterface *iface;      /* handler */
+    IMPIVSSchedAttr sched;       /* target analysis rate and latency budget */
+    IMPIVSChnStat stat;
+    uint64_t next_due_us;        /* earliest frame time the rate takes next */
+    uint64_t win_start_us;       /* achieved-rate window */
+    uint32_t win_count;
 } IVSChn;
 
 static void *g_ivs_groups[MAX_IVS_GROUPS];    /* Module* per group */
@@ -67,6 +75,46 @@ static void *ivs_worker(void *arg) {
     return NULL;
 }
 
+static uint64_t ivs_now_us(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+/* Frames are analysed inline on the frame source thread here, so a slow
+ * channel is throttled to its target rate, and to the rate it sustains
+ * once its latency passes the budget, instead of stalling the source */
+static int ivs_admit(IVSChn *c, uint64_t now) {
+    uint64_t interval = c->sched.targetFps ? 1000000ULL / c->sched.targetFps : 0;
+    uint64_t budget = (uint64_t)(c->sched.budgetMs ? c->sched.budgetMs : 200) * 1000ULL;
+    int backoff = 0;
+    if (c->stat.latencyUs > budget && c->stat.latencyUs > interval) {
+        interval = c->stat.latencyUs;
+        backoff = 1;
+    }
+    if (interval && c->next_due_us && now < c->next_due_us) {
+        if (backoff) c->stat.skippedLoad++;
+        else c->stat.skippedRate++;
+        return 0;
+    }
+    c->next_due_us = (!c->next_due_us || now - c->next_due_us >= interval)
+                     ? now + interval : c->next_due_us + interval;
+    return 1;
+}
+
+static void ivs_account(IVSChn *c, uint64_t start, uint64_t now) {
+    uint32_t sample = (uint32_t)(now - start);
+    c->stat.latencyUs = c->stat.latencyUs ? c->stat.latencyUs - c->stat.latencyUs / 8 + sample / 8 : sample;
+    c->stat.analysedFrames++;
+    c->win_count++;
+    if (!c->win_start_us) c->win_start_us = start;
+    if (now - c->win_start_us >= 1000000ULL) {
+        c->stat.fpsX100 = (uint32_t)((uint64_t)c->win_count * 100000000ULL / (now - c->win_start_us));
+        c->win_start_us = now;
+        c->win_count = 0;
+    }
+}
+
 /* Update callback invoked by System when FS notifies observers */
 static int ivs_update(void *module, void *frame) {
     if (!module || !frame) return 0;
@@ -76,10 +124,15 @@ static int ivs_update(void *module, void *frame) {
     for (int i = 0; i < MAX_IVS_CHANNELS; i++) {
         IVSChn *c = &g_ivs_chn[i];
         if (c->running && c->grp_id == grp && c->iface) {
+            uint64_t start = ivs_now_us();
+            if (!ivs_admit(c, start)) continue;
             if (c->iface->process) {
                 c->iface->process(c->iface, frame);
             }
-            /* Signal a result is available */
+            ivs_account(c, start, ivs_now_us());
+            /* Signal a result is available; fd first so a PollingResult
+             * that takes the sem always finds the count to consume */
+            eventfd_write(c->result_fd, 1);
             sem_post(&c->sem_result);
         }
     }
@@ -156,10 +209,20 @@ int IMP_IVS_CreateChn(int chnNum, IMPIVSInterface *handler) {
     sem_init(&c->sem_frame, 0, 0);
     sem_init(&c->sem_lock, 0, 1);
     sem_init(&c->sem_result, 0, 0);
+    c->result_fd = eventfd(0, EFD_NONBLOCK | EFD_SEMAPHORE | EFD_CLOEXEC);
+    if (c->result_fd < 0) {
+        LOG_IVS("CreateChn: eventfd failed");
+        sem_destroy(&c->sem_result);
+        sem_destroy(&c->sem_lock);
+        sem_destroy(&c->sem_frame);
+        c->iface = NULL;
+        return -1;
+    }
 
     /* Optional init callback */
     if (c->iface->init && c->iface->init(c->iface) < 0) {
         LOG_IVS("CreateChn: init callback failed");
+        close(c->result_fd);
         sem_destroy(&c->sem_result);
         sem_destroy(&c->sem_lock);
         sem_destroy(&c->sem_frame);
@@ -170,6 +233,7 @@ int IMP_IVS_CreateChn(int chnNum, IMPIVSInterface *handler) {
     if (pthread_create(&c->thread, NULL, ivs_worker, c) != 0) {
         LOG_IVS("CreateChn: thread create failed");
         if (c->iface->exit) c->iface->exit(c->iface);
+        close(c->result_fd);
         sem_destroy(&c->sem_result);
         sem_destroy(&c->sem_lock);
         sem_destroy(&c->sem_frame);
@@ -194,6 +258,8 @@ int IMP_IVS_DestroyChn(int chnNum) {
         c->thread = 0;
     }
     if (c->iface->exit) c->iface->exit(c->iface);
+    close(c->result_fd);
+    c->result_fd = -1;
     sem_destroy(&c->sem_result);
     sem_destroy(&c->sem_lock);
     sem_destroy(&c->sem_frame);
@@ -279,24 +345,66 @@ int IMP_IVS_StopRecvPic(int chnNum) {
     return 0;
 }
 
+/* Taking a result off sem_result also takes it off the eventfd, so the fd
+ * only polls readable while PollingResult would succeed */
+static int ivs_result_taken(IVSChn *c, int ret) {
+    if (ret == 0) {
+        eventfd_t count;
+        eventfd_read(c->result_fd, &count);
+    }
+    return ret;
+}
+
 int IMP_IVS_PollingResult(int chnNum, int timeoutMs) {
     if (chnNum < 0 || chnNum >= MAX_IVS_CHANNELS) return -1;
     IVSChn *c = &g_ivs_chn[chnNum];
     if (!c->iface) return -1;
     if (timeoutMs == 0) {
-        return sem_trywait(&c->sem_result);
+        return ivs_result_taken(c, sem_trywait(&c->sem_result));
     }
     struct timespec ts;
     clock_gettime(CLOCK_REALTIME, &ts);
     if (timeoutMs < 0) {
         /* Infinite wait */
         while (sem_wait(&c->sem_result) != 0) {}
-        return 0;
+        return ivs_result_taken(c, 0);
     }
     ts.tv_sec += timeoutMs / 1000;
     ts.tv_nsec += (timeoutMs % 1000) * 1000000;
     if (ts.tv_nsec >= 1000000000) { ts.tv_sec++; ts.tv_nsec -= 1000000000; }
-    return sem_timedwait(&c->sem_result, &ts);
+    return ivs_result_taken(c, sem_timedwait(&c->sem_result, &ts));
+}
+
+int IMP_IVS_GetFd(int chnNum) {
+    if (chnNum < 0 || chnNum >= MAX_IVS_CHANNELS) return -1;
+    IVSChn *c = &g_ivs_chn[chnNum];
+    if (!c->iface) return -1;
+    return c->result_fd;
+}
+
+int IMP_IVS_SetSchedAttr(int chnNum, const IMPIVSSchedAttr *attr) {
+    if (chnNum < 0 || chnNum >= MAX_IVS_CHANNELS || !attr) return -1;
+    IVSChn *c = &g_ivs_chn[chnNum];
+    if (!c->iface) return -1;
+    c->sched = *attr;
+    c->next_due_us = 0;
+    return 0;
+}
+
+int IMP_IVS_GetSchedAttr(int chnNum, IMPIVSSchedAttr *attr) {
+    if (chnNum < 0 || chnNum >= MAX_IVS_CHANNELS || !attr) return -1;
+    IVSChn *c = &g_ivs_chn[chnNum];
+    if (!c->iface) return -1;
+    *attr = c->sched;
+    return 0;
+}
+
+int IMP_IVS_GetChnStat(int chnNum, IMPIVSChnStat *stat) {
+    if (chnNum < 0 || chnNum >= MAX_IVS_CHANNELS || !stat) return -1;
+    IVSChn *c = &g_ivs_chn[chnNum];
+    if (!c->iface) return -1;
+    *stat = c->stat;
+    return 0;
 }
 
 int IMP_IVS_GetResult(int chnNum, void **result) {
@@ -441,6 +441,7 @@ IMPRgnHandle IMP_OSD_CreateRgn(IMPOSDRgnAttr *prAttr) {
         case OSD_REG_LINE:
         case OSD_REG_RECT:
         case OSD_REG_COVER:
+        case OSD_REG_TEXT:
             /* These types don't need separate data buffers */
             data_size = 0;
             break;
@@ -829,6 +830,24 @@ int IMP_OSD_UpdateRgnAttrData(IMPRgnHandle handle, IMPOSDRgnAttrData *prAttrData
     return 0;
 }
 
+int IMP_OSD_SetRgnFont(IMPRgnHandle handle, const IMPOSDFont *font) {
+    if (handle < 0 || handle >= MAX_OSD_REGIONS) return -1;
+    if (font != NULL && (font->chars == NULL || font->pData == NULL ||
+                         font->glyphWidth <= 0 || (font->glyphWidth & 1))) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&osd_mutex);
+    if (gosd == NULL || !gosd->regions[handle].allocated) {
+        pthread_mutex_unlock(&osd_mutex);
+        return -1;
+    }
+
+    /* No software renderer in this build; accepted like the region data */
+    pthread_mutex_unlock(&osd_mutex);
+    return 0;
+}
+
 int IMP_OSD_ShowRgn(IMPRgnHandle handle, int grpNum, int showFlag) {
     if (handle < 0 || handle >= MAX_OSD_REGIONS) return -1;
     if (grpNum < 0 || grpNum >= MAX_OSD_GROUPS) return -1;
@@ -16,6 +16,8 @@
 #include <semaphore.h>
 #include <imp/imp_system.h>
 #include "dma_alloc.h"
+#include "kernel_interface.h"
+#include "fifo.h"
 #include "imp_log_int.h"
 
 #define IMP_VERSION "1.1.6"
@@ -165,6 +167,8 @@ static Module* get_module(int deviceID, int groupID);
 Module* IMP_System_GetModule(int deviceID, int groupID);
 int remove_observer_from_module(void *src_module, void *dst_module);
 static int add_observer(Module *module, Observer *observer);
+static void obs_mailbox_create(Module *src, Module *dst);
+static void obs_mailbox_destroy(Module *src, Module *dst);
 int system_get_bind_src(IMPCell *dstCell, IMPCell *srcCell);
 
 /* get_module - returns module pointer from g_modules array
@@ -322,7 +326,8 @@ static int system_bind(IMPCell *srcCell, IMPCell *dstCell) {
                src_module->output_count, output_ptr);
 
     /* OEM calls BindObserverToSubject and always returns 0 */
-    BindObserverToSubject(src_module, dst_module, output_ptr);
+    if (BindObserverToSubject(src_module, dst_module, output_ptr) == 0)
+        obs_mailbox_create(src_module, dst_module);
     return 0;
 }
 
@@ -350,6 +355,9 @@ static int system_unbind(IMPCell *srcCell, IMPCell *dstCell) {
             src_module->name,
             srcCell->deviceID, srcCell->groupID, srcCell->outputID);
 
+    /* Stop the async worker first so no update runs after unbind returns */
+    obs_mailbox_destroy(src_module, dst_module);
+
     /* OEM calls UnBindObserverFromSubject with just src and dst, returns 0 */
     UnBindObserverFromSubject(src_module, dst_module);
     return 0;
@@ -563,6 +571,213 @@ int IMP_System_GetBindbyDest(IMPCell *dstCell, IMPCell *srcCell) {
 
 /* ========== Observer Pattern Implementation ========== */
 
+/* Async observer dispatch: each binding made while the mode is ASYNC gets a
+ * mailbox (SPSC ring; the source's notify thread is the only producer) and
+ * a worker that calls the bound module's update. Mailbox items are frame
+ * pointers tagged in bit 0 when a VBM reference was taken for them. */
+#define OBS_MAILBOX_DEFAULT_DEPTH 4
+#define OBS_MAILBOX_MAX           (MAX_DEVICES * MAX_GROUPS)
+#define OBS_FRAME_HELD            ((uintptr_t)1)
+
+typedef struct {
+    Module *src;
+    Module *dst;
+    void *fifo;
+    pthread_t thread;
+    int stopping;
+    uint32_t delivered;
+    uint32_t dropped;
+    uint32_t max_queued;
+} ObserverMailbox;
+
+static IMPObserverDispatchMode g_obs_dispatch_mode = IMP_OBSERVER_DISPATCH_INLINE;
+static int g_obs_dispatch_depth = OBS_MAILBOX_DEFAULT_DEPTH;
+static ObserverMailbox *g_obs_mailboxes[OBS_MAILBOX_MAX];
+/* Readers: notify fan-out. Writer: mailbox create/destroy. */
+static pthread_rwlock_t g_obs_mailbox_lock = PTHREAD_RWLOCK_INITIALIZER;
+/* Live mailboxes; with none, notify skips the lock and the table scan */
+static int g_obs_mailbox_count;
+
+static ObserverMailbox *obs_mailbox_find(Module *src, Module *dst)
+{
+    for (int i = 0; i < OBS_MAILBOX_MAX; i++) {
+        ObserverMailbox *mb = g_obs_mailboxes[i];
+        if (mb != NULL && mb->dst == dst && mb->src == src)
+            return mb;
+    }
+    return NULL;
+}
+
+static void *obs_mailbox_thread(void *arg)
+{
+    ObserverMailbox *mb = (ObserverMailbox*)arg;
+    int (*update_fn)(Module*, void*) = (int (*)(Module*, void*))mb->dst->func_4c;
+    void *item;
+
+    /* After SpscFifo_Abort, Dequeue still drains what is queued, then NULL */
+    while ((item = SpscFifo_Dequeue(mb->fifo, -1)) != NULL) {
+        void *frame = (void*)((uintptr_t)item & ~OBS_FRAME_HELD);
+
+        if (!__atomic_load_n(&mb->stopping, __ATOMIC_ACQUIRE) && update_fn != NULL) {
+            update_fn(mb->dst, frame);
+            __atomic_add_fetch(&mb->delivered, 1, __ATOMIC_RELAXED);
+        }
+        if ((uintptr_t)item & OBS_FRAME_HELD)
+            VBMUnLockFrame(frame);
+    }
+    return NULL;
+}
+
+static void obs_mailbox_create(Module *src, Module *dst)
+{
+    if (g_obs_dispatch_mode != IMP_OBSERVER_DISPATCH_ASYNC || dst->func_4c == NULL)
+        return;
+
+    ObserverMailbox *mb = (ObserverMailbox*)calloc(1, sizeof(*mb));
+    if (mb == NULL)
+        return;
+    mb->src = src;
+    mb->dst = dst;
+    mb->fifo = malloc(SpscFifo_SizeOf());
+    if (mb->fifo == NULL) {
+        free(mb);
+        return;
+    }
+    SpscFifo_Init(mb->fifo, g_obs_dispatch_depth);
+
+    if (pthread_create(&mb->thread, NULL, obs_mailbox_thread, mb) != 0) {
+        IMP_LOG_ERR("System", "%s: worker for %s failed, using inline dispatch\n",
+                    "obs_mailbox_create", dst->name);
+        SpscFifo_Deinit(mb->fifo);
+        free(mb->fifo);
+        free(mb);
+        return;
+    }
+
+    pthread_rwlock_wrlock(&g_obs_mailbox_lock);
+    int slot = -1;
+    for (int i = 0; i < OBS_MAILBOX_MAX; i++) {
+        if (g_obs_mailboxes[i] == NULL) {
+            slot = i;
+            break;
+        }
+    }
+    if (slot >= 0) {
+        g_obs_mailboxes[slot] = mb;
+        __atomic_add_fetch(&g_obs_mailbox_count, 1, __ATOMIC_RELEASE);
+    }
+    pthread_rwlock_unlock(&g_obs_mailbox_lock);
+
+    if (slot < 0) {
+        SpscFifo_Abort(mb->fifo);
+        pthread_join(mb->thread, NULL);
+        SpscFifo_Deinit(mb->fifo);
+        free(mb->fifo);
+        free(mb);
+        return;
+    }
+
+    IMP_LOG_DBG("System", "async dispatch %s -> %s depth=%d\n", src->name, dst->name,
+                SpscFifo_GetMaxElements(mb->fifo));
+}
+
+static void obs_mailbox_destroy(Module *src, Module *dst)
+{
+    ObserverMailbox *mb = NULL;
+
+    pthread_rwlock_wrlock(&g_obs_mailbox_lock);
+    for (int i = 0; i < OBS_MAILBOX_MAX; i++) {
+        if (g_obs_mailboxes[i] != NULL && g_obs_mailboxes[i]->src == src &&
+            g_obs_mailboxes[i]->dst == dst) {
+            mb = g_obs_mailboxes[i];
+            g_obs_mailboxes[i] = NULL;
+            __atomic_sub_fetch(&g_obs_mailbox_count, 1, __ATOMIC_RELEASE);
+            break;
+        }
+    }
+    pthread_rwlock_unlock(&g_obs_mailbox_lock);
+
+    if (mb == NULL)
+        return;
+
+    /* Queued frames are released, not delivered, once unbinding started */
+    __atomic_store_n(&mb->stopping, 1, __ATOMIC_RELEASE);
+    SpscFifo_Abort(mb->fifo);
+    pthread_join(mb->thread, NULL);
+
+    IMP_LOG_DBG("System", "async dispatch %s -> %s: delivered=%u dropped=%u max_queued=%u\n",
+                src->name, dst->name, mb->delivered, mb->dropped, mb->max_queued);
+    SpscFifo_Deinit(mb->fifo);
+    free(mb->fifo);
+    free(mb);
+}
+
+/* Post a frame to a mailbox; called with g_obs_mailbox_lock held for read.
+ * Never blocks: a full mailbox drops the frame for this binding only. */
+static void obs_mailbox_post(ObserverMailbox *mb, void *frame)
+{
+    uintptr_t item = (uintptr_t)frame;
+
+    if (VBMLockFrame(frame) == 0)
+        item |= OBS_FRAME_HELD;
+
+    if (!SpscFifo_Queue(mb->fifo, (void*)item, 0)) {
+        if (item & OBS_FRAME_HELD)
+            VBMUnLockFrame(frame);
+        uint32_t n = __atomic_add_fetch(&mb->dropped, 1, __ATOMIC_RELAXED);
+        if (n <= 3 || (n % 100) == 0)
+            sys2_trace("libimp/BIND2: mailbox full %s -> %s dropped=%u\n",
+                       mb->src->name, mb->dst->name, n);
+        return;
+    }
+
+    uint32_t queued = (uint32_t)SpscFifo_Count(mb->fifo);
+    if (queued > mb->max_queued)
+        mb->max_queued = queued;
+}
+
+int IMP_System_SetObserverDispatch(IMPObserverDispatchMode mode, int depth) {
+    if (mode != IMP_OBSERVER_DISPATCH_INLINE && mode != IMP_OBSERVER_DISPATCH_ASYNC) {
+        return -1;
+    }
+    if (depth < 0 || depth > 64) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&system_mutex);
+    g_obs_dispatch_mode = mode;
+    g_obs_dispatch_depth = depth ? depth : OBS_MAILBOX_DEFAULT_DEPTH;
+    pthread_mutex_unlock(&system_mutex);
+    return 0;
+}
+
+int IMP_System_GetObserverDispatchStat(IMPCell *dstCell, IMPObserverDispatchStat *stat) {
+    if (dstCell == NULL || stat == NULL) {
+        return -1;
+    }
+
+    Module *dst = get_module(dstCell->deviceID, dstCell->groupID);
+    if (dst == NULL) {
+        return -1;
+    }
+
+    int ret = -1;
+    pthread_rwlock_rdlock(&g_obs_mailbox_lock);
+    for (int i = 0; i < OBS_MAILBOX_MAX; i++) {
+        ObserverMailbox *mb = g_obs_mailboxes[i];
+        if (mb != NULL && mb->dst == dst) {
+            stat->delivered = __atomic_load_n(&mb->delivered, __ATOMIC_RELAXED);
+            stat->dropped = __atomic_load_n(&mb->dropped, __ATOMIC_RELAXED);
+            stat->queued = (uint32_t)SpscFifo_Count(mb->fifo);
+            stat->maxQueued = mb->max_queued;
+            ret = 0;
+            break;
+        }
+    }
+    pthread_rwlock_unlock(&g_obs_mailbox_lock);
+    return ret;
+}
+
 /**
  * add_observer - Add observer to module's observer list
  * Based on decompilation at 0x1a920
@@ -659,12 +874,17 @@ int notify_observers(Module *module, void *frame) {
         return -1;
     }
 
-    extern int VBMUnLockFrame(void *frame);
-
     Observer *obs = (Observer*)module->observer_list;
     sys2_trace("libimp/BIND2: notify src=%p(%s) frame=%p first=%p\n",
                module, module->name, frame, obs);
 
+    /* Hold a publisher reference across the fan-out. Observers that keep
+     * the frame past their update call take their own (VBMLockFrame or a
+     * VBMFrameHandle), and the frame goes back to the pool/kernel when the
+     * last reference drops -- including when no observer wanted it. */
+    VBMFrameHandle handle;
+    int held = (VBMFrame_GetHandle(frame, &handle) == 0 && VBMFrameHandle_Ref(handle) == 0);
+
     while (obs != NULL) {
         if (obs->module != NULL) {
             Module *dst_module = (Module*)obs->module;
@@ -675,8 +895,21 @@ int notify_observers(Module *module, void *frame) {
                        obs, dst_module, dst_module->name, dst_module->func_4c,
                        frame, obs->output_index);
 
-            /* Call the update function at offset 0x4c */
-            if (dst_module->func_4c != NULL) {
+            /* Not held across inline updates: they may notify further
+             * observers (OSD) or block (encoder queue policy). */
+            ObserverMailbox *mb = NULL;
+            if (__atomic_load_n(&g_obs_mailbox_count, __ATOMIC_ACQUIRE) != 0) {
+                pthread_rwlock_rdlock(&g_obs_mailbox_lock);
+                mb = obs_mailbox_find(module, dst_module);
+                if (mb != NULL)
+                    obs_mailbox_post(mb, frame);
+                pthread_rwlock_unlock(&g_obs_mailbox_lock);
+            }
+
+            if (mb != NULL) {
+                /* Delivered by the binding's worker */
+            } else if (dst_module->func_4c != NULL) {
+                /* Call the update function at offset 0x4c */
                 /* Update function signature: int update(Module *module, void *frame) */
                 int (*update_fn)(Module*, void*) = (int (*)(Module*, void*))dst_module->func_4c;
 
@@ -693,6 +926,9 @@ int notify_observers(Module *module, void *frame) {
         obs = obs->next;
     }
 
+    if (held)
+        VBMFrameHandle_Unref(handle);
+
     return 0;
 }
 
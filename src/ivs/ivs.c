@@ -6,12 +6,14 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <sys/prctl.h>
+#include <sys/eventfd.h>
 #include <time.h>
 #include <unistd.h>
 
 #include "core/globals.h"
 #include "imp/imp_ivs.h"
+#include "ivs_luma.h"
+#include "ivs_sched.h"
 
 int32_t IMP_Log_Get_Option(void); /* forward decl, ported by T<N> later */
 int32_t imp_log_fun(int32_t level, int32_t option, int32_t type, ...); /* forward decl, ported by T<N> later */
@@ -32,13 +34,16 @@ typedef struct IMPIVSInterfaceLayout {
     void (*exit)(struct IMPIVSInterfaceLayout *handler);
     int32_t (*preProcessSync)(struct IMPIVSInterfaceLayout *handler, void *frame);
     int32_t (*processAsync)(struct IMPIVSInterfaceLayout *handler, void *frame);
-    int32_t (*getResult)(struct IMPIVSInterfaceLayout *handler);
-    int32_t (*releaseResult)(struct IMPIVSInterfaceLayout *handler);
+    int32_t (*getResult)(struct IMPIVSInterfaceLayout *handler, void **result);
+    int32_t (*releaseResult)(struct IMPIVSInterfaceLayout *handler, void *result);
     int32_t (*getParam)(struct IMPIVSInterfaceLayout *handler);
     void (*updateParam)(struct IMPIVSInterfaceLayout *handler, void *param);
     void (*stop)(struct IMPIVSInterfaceLayout *handler);
 } IMPIVSInterfaceLayout;
 
+/* Result-ready eventfd per channel, counting along with the result sem */
+static int32_t ivs_result_fd[0x41];
+
 static char *ivs_channel_ptr(int32_t chn_num)
 {
     return (char *)gIVS + chn_num * 0x48;
@@ -59,181 +64,52 @@ static int VBMUnlockFrameByVaddr(uint32_t vaddr)
     return VBMUnlockFrameByVaddr_export(vaddr);
 }
 
-static void ivs_processing_cleanup_push_handle(void *arg1)
-{
-    int32_t result = *(int32_t *)((char *)arg1 + 0x40);
-
-    if (result == 0) {
-        return;
-    }
-
-    imp_log_fun(3, IMP_Log_Get_Option(), 2, "IVS",
-        "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x68,
-        "ivs_processing_cleanup_push_handle",
-        "%s(%d)\n", "ivs_processing_cleanup_push_handle", 0x68);
-    VBMUnlockFrameByVaddr(*(uint32_t *)(*(char **)((char *)arg1 + 0x40) + 0x1c));
-}
-
-static void *ivs_processing(void *arg1)
+/* Pool worker: one posted frame of channel chn_num. sem_process_end has
+ * been held since ivs_update took the frame and is given back here. */
+static void ivs_run_job(int32_t chn_num, int32_t late)
 {
-    int32_t chn_num = (int32_t)(intptr_t)arg1;
-    int32_t var_40 = -1;
-    int32_t i_1 = 0;
-    char var_98[0x89];
     char *chn = ivs_channel_ptr(chn_num);
-
-    sprintf(var_98, "IVS(%d)-%s", chn_num, "ivs_processing");
-    prctl(PR_SET_NAME, (unsigned long)var_98, 0UL, 0UL, 0UL);
-
-    if (gIVS == 0) {
-        imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
-            "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x7e,
-            "ivs_processing", "ivs_create_group error !\n");
-        return NULL;
-    }
-
-    while (1) {
-        int32_t i;
-
-        pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-
-        if (*(int32_t *)(chn + 0x44) == 0) {
-            pthread_cleanup_push(ivs_processing_cleanup_push_handle, chn + 0x4);
-            pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-            sem_wait((sem_t *)(chn + 0x4));
-            pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-            pthread_cleanup_pop(0);
+    char *frame = *(char **)(chn + 0x44);
+    IMPIVSInterfaceLayout *handler = *(IMPIVSInterfaceLayout **)(chn + 0x38);
+    int32_t ret;
+
+    if (late || *(int32_t *)(chn + 0x34) != 1) {
+        /* Stale or stopped: hand the frame back to the pool right away */
+        if (late) {
+            imp_log_fun(4, IMP_Log_Get_Option(), 2, "IVS",
+                "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x9d,
+                "ivs_processing",
+                "%s(%d):chnNum=%d drop late frame(pool_idx=%d,idx=%d)\n",
+                "ivs_processing", 0x9d, chn_num, ((int32_t *)frame)[1], *(int32_t *)frame);
         }
+        VBMUnlockFrameByVaddr(*(uint32_t *)(frame + 0x1c));
+        *(void **)(chn + 0x44) = NULL;
+        sem_post((sem_t *)(chn + 0x14));
+        return;
+    }
 
-        while (1) {
-            int32_t i_3;
-            int32_t enable_before = *(int32_t *)(chn + 0x34);
-
-            i_1 = 0;
-            i = i_1;
-
-            if (enable_before == 1) {
-                do {
-                    struct timespec var_58;
-                    uint64_t deadline_ns;
-
-                    clock_gettime(CLOCK_REALTIME, &var_58);
-                    deadline_ns = (uint64_t)var_58.tv_nsec + 0x77359400ULL;
-                    var_58.tv_sec += (time_t)(deadline_ns / 1000000000ULL);
-                    var_58.tv_nsec = (long)(deadline_ns % 1000000000ULL);
-                    i_3 = sem_timedwait((sem_t *)(chn + 0x4), &var_58);
-                    i_1 = i_3;
-
-                    if (i_3 < 0) {
-                        int32_t err = errno;
-
-                        var_40 = err;
-                        imp_log_fun(5, IMP_Log_Get_Option(), 2, "IVS",
-                            "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x94,
-                            "ivs_processing",
-                            ":warn: sem_timedwait %d ret = %d, errnum = %d, enable = %d\n",
-                            0x94, i_1, err, *(int32_t *)(chn + 0x34));
-                        if (i_3 >= 0 || err == 0x91) {
-                            i = i_1;
-                        } else {
-                            i = i_1;
-                            if (err != 4 || *(int32_t *)(chn + 0x34) != enable_before) {
-                                break;
-                            }
-                        }
-                    } else {
-                        i = i_1;
-                    }
-
-                    if (i_1 < 0) {
-                        break;
-                    }
-
-                    if (*(uint32_t *)(*(char **)(chn + 0x44) + 0x1c) != 0) {
-                        imp_log_fun(4, IMP_Log_Get_Option(), 2, "IVS",
-                            "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x9d,
-                            "ivs_processing",
-                            "%s(%d):unlock has post frame(pool_idx=%d,idx=%d),ret=%d\n",
-                            "ivs_processing", 0x9d,
-                            ((int32_t *)(*(void **)(chn + 0x44)))[1],
-                            *(int32_t *)(*(void **)(chn + 0x44)),
-                            i_1);
-                        VBMUnlockFrameByVaddr(*(uint32_t *)(*(char **)(chn + 0x44) + 0x1c));
-                    }
-                } while (i != 0);
-            }
-
-            pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-
-            if (*(int32_t *)(chn + 0x34) != 1) {
-                imp_log_fun(5, IMP_Log_Get_Option(), 2, "IVS",
-                    "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0xa4,
-                    "ivs_processing",
-                    "warn: %d ivs->chn[%d].enable = %d\n",
-                    0xa4, chn_num, *(int32_t *)(chn + 0x34));
-                *(void **)(chn + 0x44) = NULL;
-                pthread_setcancelstate(PTHREAD_CANCEL_DISABLE, NULL);
-                break;
-            }
-
-            {
-                IMPIVSInterfaceLayout *handler = *(IMPIVSInterfaceLayout **)(chn + 0x38);
-
-                if (handler->processAsync == NULL) {
-                    VBMUnlockFrameByVaddr(*(uint32_t *)(*(char **)(chn + 0x44) + 0x1c));
-                    i_1 = i_3;
-                    break;
-                }
-
-                i_3 = handler->processAsync(handler, *(void **)(chn + 0x44));
-                i_1 = i_3;
-
-                if (i_3 < 0) {
-                    break;
-                }
-
-                *(void **)(chn + 0x44) = NULL;
-                pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-
-                if (i_1 == 0) {
-                    sem_post((sem_t *)(chn + 0x24));
-                }
-
-                sem_post((sem_t *)(chn + 0x14));
-                pthread_setcancelstate(PTHREAD_CANCEL_ENABLE, NULL);
-            }
-        }
-
-        if (*(int32_t *)(chn + 0x34) == 1) {
-            if (i_1 < 0 && var_40 != 0x91) {
-                if (var_40 != 4) {
-                    imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
-                        "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0xc2,
-                        "ivs_processing",
-                        "%s(%d): chnNum=%d ivs process failed\n",
-                        "ivs_processing", 0xc2, chn_num);
-                    return NULL;
-                }
-            } else {
-                continue;
-            }
-        }
+    ret = handler->processAsync(handler, frame);
+    *(void **)(chn + 0x44) = NULL;
 
+    if (ret == 0) {
+        /* fd first: whoever takes the sem finds the count there */
+        eventfd_write(ivs_result_fd[chn_num], 1);
+        sem_post((sem_t *)(chn + 0x24));
+    } else if (ret < 0) {
         imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
-            "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0xa8,
+            "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0xc2,
             "ivs_processing",
-            "%s(%d):ivs chn[%d].enable=%d is stoped, ret=%d, errnum=%d\n",
-            "ivs_processing", 0xa8, chn_num,
-            *(int32_t *)(chn + 0x34), i_1, var_40);
-        return NULL;
+            "%s(%d): chnNum=%d ivs process failed\n",
+            "ivs_processing", 0xc2, chn_num);
     }
+
+    sem_post((sem_t *)(chn + 0x14));
 }
 
 static int32_t ivs_update(void *arg1, void *arg2)
 {
-    int32_t s0_1 = -1;
-    int32_t s5_1 = 0;
-    char *s4_1;
+    int32_t grp_num;
+    int32_t chn_num;
 
     if (gIVS == 0) {
         imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
@@ -242,115 +118,59 @@ static int32_t ivs_update(void *arg1, void *arg2)
         return -1;
     }
 
-    s4_1 = (char *)gIVS + 0x14;
-
-    while (1) {
-        int32_t var_48 = 0;
-
-        if (*(int32_t *)(s4_1 + 0x2c) == *(int32_t *)((char *)arg1 + 0x8) &&
-            *(int32_t *)(s4_1 + 0x20) == 1) {
-            int32_t var_64;
-            int32_t var_60;
+    grp_num = *(int32_t *)((char *)arg1 + 0x8);
 
-            if (sem_getvalue((sem_t *)s4_1, &var_48) < 0) {
-                imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
-                    "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0xfb,
-                    "ivs_update",
-                    "sem_getvalue(&ivs->chn[%d].sem_process_end) failed\n",
-                    s5_1, var_64, var_60);
-                return -1;
-            }
-
-            if (var_48 > 0) {
-                int32_t s7_1 = *(int32_t *)(s4_1 + 0x20);
-
-                while (1) {
-                    const char *var_3c_1;
-                    const char *s2_3;
-
-                    if (s7_1 != 1) {
-                        var_3c_1 = "AI_DisableAec";
-                        s2_3 = "ivs_update";
-                        goto label_log_warn;
-                    }
+    /* One luma pyramid per group and frame, shared by the interfaces'
+     * preProcessSync below */
+    ivs_luma_begin(grp_num, arg2);
 
-                    {
-                        struct timespec var_50;
-                        uint64_t deadline_ns;
-                        int32_t v0_9;
-
-                        clock_gettime(CLOCK_REALTIME, &var_50);
-                        deadline_ns = (uint64_t)var_50.tv_nsec + 0x77359400ULL;
-                        var_50.tv_sec += (time_t)(deadline_ns / 1000000000ULL);
-                        var_50.tv_nsec = (long)(deadline_ns % 1000000000ULL);
-                        v0_9 = sem_timedwait((sem_t *)s4_1, &var_50);
-                        if (v0_9 < 0) {
-                            s2_3 = "ivs_update";
-                            var_3c_1 = "AI_DisableAec";
-                            s0_1 = errno;
-                            var_60 = s0_1;
-                            var_64 = v0_9;
-                            imp_log_fun(5, IMP_Log_Get_Option(), 2, "IVS",
-                                "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x10a,
-                                "ivs_update",
-                                "warn: sem_timedwait %d ret = %d errnum = %d\n",
-                                0x10a, var_64, var_60);
-                            if (s0_1 != 0x91 && s0_1 != 4) {
-                                goto label_log_warn;
-                            }
-                        } else if (v0_9 == 0) {
-                            break;
-                        }
-
-                        if (*(int32_t *)(s4_1 + 0x20) == s7_1) {
-                            s2_3 = "ivs_update";
-                            var_3c_1 = "AI_DisableAec";
-                            goto label_log_warn;
-                        }
-                    }
-                }
-
-                if (*(uint32_t *)(s4_1 + 0x28) != 0) {
-                    IMPIVSInterfaceLayout *handler = *(IMPIVSInterfaceLayout **)(s4_1 + 0x24);
+    for (chn_num = 0; chn_num < 0x40; chn_num++) {
+        char *chn = ivs_channel_ptr(chn_num);
+        IMPIVSInterfaceLayout *handler;
+        int32_t busy;
 
-                    *(int32_t *)(s4_1 + 0x28) = 0;
-                    if (handler->updateParam != NULL) {
-                        handler->updateParam(handler, handler->param);
-                        handler = *(IMPIVSInterfaceLayout **)(s4_1 + 0x24);
-                    }
+        if (*(int32_t *)(chn + 0x40) != grp_num || *(int32_t *)(chn + 0x34) != 1) {
+            continue;
+        }
 
-                    if (handler->preProcessSync != NULL &&
-                        handler->preProcessSync(handler, arg2) < 0) {
-                        imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
-                            "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x121,
-                            "ivs_update", "ivs chn[%d] PreprocessSync failed\n",
-                            s5_1, var_64, var_60);
-                    } else {
-                        VBMLockFrameByVaddr(*(uint32_t *)((char *)arg2 + 0x1c));
-                        *(void **)(s4_1 + 0x30) = arg2;
-                        sem_post((sem_t *)(s4_1 - 0x10));
-                    }
-                } else {
-                    const char *var_3c_1 = "AI_DisableAec";
-                    const char *s2_3 = "ivs_update";
+        /* sem_process_end stays taken until the job has run or is dropped;
+         * a channel still on its last frame, or over its rate, skips this
+         * one without touching its lock */
+        busy = sem_trywait((sem_t *)(chn + 0x14)) != 0;
+        if (!ivs_sched_admit(chn_num, busy)) {
+            if (!busy) {
+                sem_post((sem_t *)(chn + 0x14));
+            }
+            continue;
+        }
 
-label_log_warn:
-                    var_64 = s0_1;
-                    imp_log_fun(5, IMP_Log_Get_Option(), 2, "IVS",
-                        "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x112,
-                        "ivs_update", "warn: %d ivs->chn[%d].enable = %d\n",
-                        s5_1, var_64, var_60);
-                    (void)var_3c_1;
-                    (void)s2_3;
-                }
+        handler = *(IMPIVSInterfaceLayout **)(chn + 0x38);
+        if (*(uint32_t *)(chn + 0x3c) != 0) {
+            *(uint32_t *)(chn + 0x3c) = 0;
+            if (handler->updateParam != NULL) {
+                handler->updateParam(handler, handler->param);
             }
         }
 
-        s5_1 += 1;
-        s4_1 += 0x48;
+        if (handler->preProcessSync != NULL && handler->preProcessSync(handler, arg2) < 0) {
+            imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
+                "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x121,
+                "ivs_update", "ivs chn[%d] PreprocessSync failed\n", chn_num);
+            sem_post((sem_t *)(chn + 0x14));
+            continue;
+        }
 
-        if (s5_1 == 0x40) {
-            break;
+        if (handler->processAsync == NULL) {
+            sem_post((sem_t *)(chn + 0x14));
+            continue;
+        }
+
+        VBMLockFrameByVaddr(*(uint32_t *)((char *)arg2 + 0x1c));
+        *(void **)(chn + 0x44) = arg2;
+        if (ivs_sched_submit(chn_num) < 0) {
+            VBMUnlockFrameByVaddr(*(uint32_t *)((char *)arg2 + 0x1c));
+            *(void **)(chn + 0x44) = NULL;
+            sem_post((sem_t *)(chn + 0x14));
         }
     }
 
@@ -401,12 +221,18 @@ int32_t IVSInit(void)
         } while ((char *)i != v0 + 0x1274);
     }
 
+    for (int32_t i = 0; i < 0x41; i++) {
+        ivs_result_fd[i] = -1;
+    }
+
     gIVS = (IVSState *)(v0 + 0x40);
     return 0;
 }
 
 int32_t IVSExit(void)
 {
+    ivs_sched_stop();
+
     if (gIVS != 0) {
         free_device(*(void **)gIVS);
         gIVS = 0;
@@ -648,6 +474,18 @@ int IMP_IVS_CreateChn(int chn_num, IMPIVSInterface *handler)
                 return -1;
             }
 
+            ivs_result_fd[chn_num] = eventfd(0, EFD_NONBLOCK | EFD_SEMAPHORE | EFD_CLOEXEC);
+            if (ivs_result_fd[chn_num] < 0) {
+                imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
+                    "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x20f,
+                    "IMP_IVS_CreateChn",
+                    "eventfd ivs->chn[%d].result_fd failed\n", chn_num);
+                sem_destroy((sem_t *)(fp_1 + 0x24));
+                sem_destroy((sem_t *)(fp_1 + 0x14));
+                sem_destroy((sem_t *)(fp_1 + 0x4));
+                return -1;
+            }
+
             *(int32_t *)(fp_1 + 0x34) = 0;
             *(void **)(fp_1 + 0x38) = arg2;
             *(int32_t *)(fp_1 + 0x3c) = 0;
@@ -660,14 +498,17 @@ int IMP_IVS_CreateChn(int chn_num, IMPIVSInterface *handler)
                 *(int32_t *)(fp_1 + 0x34) = 0;
                 *(void **)(fp_1 + 0x38) = NULL;
                 *(int32_t *)(fp_1 + 0x3c) = 0;
+                close(ivs_result_fd[chn_num]);
+                ivs_result_fd[chn_num] = -1;
                 sem_destroy((sem_t *)(fp_1 + 0x24));
                 sem_destroy((sem_t *)(fp_1 + 0x14));
                 sem_destroy((sem_t *)(fp_1 + 0x4));
                 return -1;
             }
 
-            if (pthread_create((pthread_t *)(fp_1 + 0x48), NULL, ivs_processing,
-                    (void *)(intptr_t)chn_num) >= 0) {
+            /* Channels share the analysis pool; the first one starts it */
+            ivs_sched_reset(chn_num);
+            if (ivs_sched_start(0, ivs_run_job) >= 0) {
                 return 0;
             }
 
@@ -680,6 +521,8 @@ int IMP_IVS_CreateChn(int chn_num, IMPIVSInterface *handler)
             *(int32_t *)(fp_1 + 0x34) = 0;
             *(void **)(fp_1 + 0x38) = NULL;
             *(int32_t *)(fp_1 + 0x3c) = 0;
+            close(ivs_result_fd[chn_num]);
+            ivs_result_fd[chn_num] = -1;
             sem_destroy((sem_t *)(fp_1 + 0x24));
             sem_destroy((sem_t *)(fp_1 + 0x14));
             sem_destroy((sem_t *)(fp_1 + 0x4));
@@ -725,8 +568,37 @@ int IMP_IVS_DestroyChn(int chn_num)
             return 0;
         }
 
-        pthread_cancel(*(pthread_t *)(s2_2 + 0x48));
-        pthread_join(*(pthread_t *)(s2_2 + 0x48), NULL);
+        /* Take back a frame still waiting for a worker, then wait out one
+         * being analysed: sem_process_end is free once neither is left */
+        *(int32_t *)(s2_2 + 0x34) = 0;
+        if (ivs_sched_cancel(chn_num)) {
+            VBMUnlockFrameByVaddr(*(uint32_t *)(*(char **)(s2_2 + 0x44) + 0x1c));
+            *(void **)(s2_2 + 0x44) = NULL;
+            sem_post((sem_t *)(s2_2 + 0x14));
+        }
+
+        /* A job on a worker always ends by posting sem_process_end (a
+         * late one just drops its frame), and until then it uses the
+         * interface, the result fd and the semaphores below: never tear
+         * down under it. Say so if it takes long, then keep waiting. */
+        {
+            struct timespec var_28;
+            int32_t ret;
+
+            clock_gettime(CLOCK_REALTIME, &var_28);
+            var_28.tv_sec += 2;
+            while ((ret = sem_timedwait((sem_t *)(s2_2 + 0x14), &var_28)) < 0 && errno == EINTR) {
+            }
+            if (ret < 0) {
+                imp_log_fun(5, IMP_Log_Get_Option(), 2, "IVS",
+                    "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x249,
+                    "IMP_IVS_DestroyChn",
+                    "IMP_IVS_DestroyChn(%d) hasn't sync the sem_process_end signal, waiting for the running job\n",
+                    chn_num);
+                while (sem_wait((sem_t *)(s2_2 + 0x14)) < 0 && errno == EINTR) {
+                }
+            }
+        }
 
         {
             IMPIVSInterfaceLayout *a0_2 = *(IMPIVSInterfaceLayout **)(s2_2 + 0x38);
@@ -736,10 +608,11 @@ int IMP_IVS_DestroyChn(int chn_num)
             }
         }
 
-        *(int32_t *)(s2_2 + 0x48) = -1;
         *(int32_t *)(s2_2 + 0x34) = 0;
         *(void **)(s2_2 + 0x38) = NULL;
         *(void **)(s2_2 + 0x44) = NULL;
+        close(ivs_result_fd[chn_num]);
+        ivs_result_fd[chn_num] = -1;
         sem_destroy((sem_t *)(s2_2 + 0x24));
         sem_destroy((sem_t *)(s2_2 + 0x14));
         sem_destroy((sem_t *)(s2_2 + 0x4));
@@ -961,6 +834,19 @@ int IMP_IVS_StopRecvPic(int chn_num)
     return -1;
 }
 
+/* A result taken off the sem also leaves the eventfd count, so the fd only
+ * polls readable while PollingResult would succeed */
+static int32_t ivs_result_taken(int32_t chn_num, int32_t ret)
+{
+    if (ret == 0) {
+        eventfd_t count;
+
+        eventfd_read(ivs_result_fd[chn_num], &count);
+    }
+
+    return ret;
+}
+
 int IMP_IVS_PollingResult(int chn_num, int timeout_ms)
 {
     const char *var_44_1;
@@ -1001,7 +887,7 @@ int IMP_IVS_PollingResult(int chn_num, int timeout_ms)
         }
 
         if (timeout_ms == 0) {
-            return sem_trywait((sem_t *)(chn + 0x24));
+            return ivs_result_taken(chn_num, sem_trywait((sem_t *)(chn + 0x24)));
         }
 
         if (timeout_ms < 0) {
@@ -1009,7 +895,7 @@ int IMP_IVS_PollingResult(int chn_num, int timeout_ms)
 
             var_28.tv_sec = time(NULL) + 0xa;
             var_28.tv_nsec = 0;
-            return sem_timedwait((sem_t *)(chn + 0x24), &var_28);
+            return ivs_result_taken(chn_num, sem_timedwait((sem_t *)(chn + 0x24), &var_28));
         }
 
         {
@@ -1021,7 +907,7 @@ int IMP_IVS_PollingResult(int chn_num, int timeout_ms)
             timeout_ns = (uint64_t)var_28.tv_nsec + (uint64_t)timeout_ms * 1000000ULL;
             var_28.tv_sec += (time_t)(timeout_ns / 1000000000ULL);
             var_28.tv_nsec = (long)(timeout_ns % 1000000000ULL);
-            result_1 = sem_timedwait((sem_t *)(chn + 0x24), &var_28);
+            result_1 = ivs_result_taken(chn_num, sem_timedwait((sem_t *)(chn + 0x24), &var_28));
             result = result_1;
             if (result_1 < 0) {
                 imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
@@ -1041,8 +927,6 @@ int IMP_IVS_GetResult(int chn_num, void **result)
     int32_t v0_5;
     int32_t v1_3;
 
-    (void)result;
-
     if ((uint32_t)chn_num >= 0x41) {
         v0_5 = IMP_Log_Get_Option();
         var_1c_2 = "ChnNum is error !\n";
@@ -1062,7 +946,7 @@ int IMP_IVS_GetResult(int chn_num, void **result)
             return -1;
         }
 
-        if (s0_1->getResult != NULL && s0_1->getResult(s0_1) >= 0) {
+        if (s0_1->getResult != NULL && s0_1->getResult(s0_1, result) >= 0) {
             return 0;
         }
 
@@ -1085,8 +969,6 @@ int IMP_IVS_ReleaseResult(int chn_num, void *result)
     int32_t v0_5;
     int32_t v1_3;
 
-    (void)result;
-
     if ((uint32_t)chn_num >= 0x41) {
         v0_5 = IMP_Log_Get_Option();
         var_1c_2 = "ChnNum is error !\n";
@@ -1106,7 +988,7 @@ int IMP_IVS_ReleaseResult(int chn_num, void *result)
             return -1;
         }
 
-        if (s0_1->releaseResult != NULL && s0_1->releaseResult(s0_1) >= 0) {
+        if (s0_1->releaseResult != NULL && s0_1->releaseResult(s0_1, result) >= 0) {
             return 0;
         }
 
@@ -1205,3 +1087,167 @@ int IMP_IVS_SetParam(int chn_num, void *param)
         "IMP_IVS_SetParam", var_1c_1);
     return -1;
 }
+
+int IMP_IVS_GetFd(int chn_num)
+{
+    const char *var_1c_2;
+    int32_t v0_5;
+    int32_t v1_3;
+
+    if ((uint32_t)chn_num >= 0x41) {
+        v0_5 = IMP_Log_Get_Option();
+        var_1c_2 = "ChnNum is error !\n";
+        v1_3 = 0x348;
+    } else if (gIVS == 0) {
+        v0_5 = IMP_Log_Get_Option();
+        var_1c_2 = "ivs_create_group error !\n";
+        v1_3 = 0x34e;
+    } else {
+        if (*(void **)(ivs_channel_ptr(chn_num) + 0x38) == NULL) {
+            imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
+                "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x353,
+                "IMP_IVS_GetFd", "%s:not init IMP_IVS_CreateChn!\n",
+                "IMP_IVS_GetFd");
+            return -1;
+        }
+
+        return ivs_result_fd[chn_num];
+    }
+
+    imp_log_fun(6, v0_5, 2, "IVS",
+        "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", v1_3,
+        "IMP_IVS_GetFd", var_1c_2);
+    return -1;
+}
+
+int IMP_IVS_SetSchedAttr(int chn_num, const IMPIVSSchedAttr *attr)
+{
+    const char *var_1c_2;
+    int32_t v0_5;
+    int32_t v1_3;
+
+    if ((uint32_t)chn_num >= 0x41) {
+        v0_5 = IMP_Log_Get_Option();
+        var_1c_2 = "ChnNum is error !\n";
+        v1_3 = 0x368;
+    } else if (attr == NULL) {
+        v0_5 = IMP_Log_Get_Option();
+        var_1c_2 = "param is NULL!\n";
+        v1_3 = 0x36d;
+    } else if (gIVS == 0) {
+        v0_5 = IMP_Log_Get_Option();
+        var_1c_2 = "ivs_create_group error !\n";
+        v1_3 = 0x372;
+    } else {
+        if (*(void **)(ivs_channel_ptr(chn_num) + 0x38) == NULL) {
+            imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
+                "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x377,
+                "IMP_IVS_SetSchedAttr", "%s:not init IMP_IVS_CreateChn!\n",
+                "IMP_IVS_SetSchedAttr");
+            return -1;
+        }
+
+        {
+            IvsSchedAttr a;
+
+            a.target_fps = (int32_t)attr->targetFps;
+            a.budget_ms = (int32_t)attr->budgetMs;
+            return ivs_sched_set_attr(chn_num, &a);
+        }
+    }
+
+    imp_log_fun(6, v0_5, 2, "IVS",
+        "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", v1_3,
+        "IMP_IVS_SetSchedAttr", var_1c_2);
+    return -1;
+}
+
+int IMP_IVS_GetSchedAttr(int chn_num, IMPIVSSchedAttr *attr)
+{
+    const char *var_1c_2;
+    int32_t v0_5;
+    int32_t v1_3;
+
+    if ((uint32_t)chn_num >= 0x41) {
+        v0_5 = IMP_Log_Get_Option();
+        var_1c_2 = "ChnNum is error !\n";
+        v1_3 = 0x388;
+    } else if (attr == NULL) {
+        v0_5 = IMP_Log_Get_Option();
+        var_1c_2 = "param is NULL!\n";
+        v1_3 = 0x38d;
+    } else if (gIVS == 0) {
+        v0_5 = IMP_Log_Get_Option();
+        var_1c_2 = "ivs_create_group error !\n";
+        v1_3 = 0x392;
+    } else {
+        if (*(void **)(ivs_channel_ptr(chn_num) + 0x38) == NULL) {
+            imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
+                "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x397,
+                "IMP_IVS_GetSchedAttr", "%s:not init IMP_IVS_CreateChn!\n",
+                "IMP_IVS_GetSchedAttr");
+            return -1;
+        }
+
+        {
+            IvsSchedAttr a;
+
+            ivs_sched_get_attr(chn_num, &a);
+            attr->targetFps = (uint32_t)a.target_fps;
+            attr->budgetMs = (uint32_t)a.budget_ms;
+            return 0;
+        }
+    }
+
+    imp_log_fun(6, v0_5, 2, "IVS",
+        "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", v1_3,
+        "IMP_IVS_GetSchedAttr", var_1c_2);
+    return -1;
+}
+
+int IMP_IVS_GetChnStat(int chn_num, IMPIVSChnStat *stat)
+{
+    const char *var_1c_2;
+    int32_t v0_5;
+    int32_t v1_3;
+
+    if ((uint32_t)chn_num >= 0x41) {
+        v0_5 = IMP_Log_Get_Option();
+        var_1c_2 = "ChnNum is error !\n";
+        v1_3 = 0x3a8;
+    } else if (stat == NULL) {
+        v0_5 = IMP_Log_Get_Option();
+        var_1c_2 = "param is NULL!\n";
+        v1_3 = 0x3ad;
+    } else if (gIVS == 0) {
+        v0_5 = IMP_Log_Get_Option();
+        var_1c_2 = "ivs_create_group error !\n";
+        v1_3 = 0x3b2;
+    } else {
+        if (*(void **)(ivs_channel_ptr(chn_num) + 0x38) == NULL) {
+            imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS",
+                "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", 0x3b7,
+                "IMP_IVS_GetChnStat", "%s:not init IMP_IVS_CreateChn!\n",
+                "IMP_IVS_GetChnStat");
+            return -1;
+        }
+
+        {
+            IvsSchedStat st;
+
+            ivs_sched_get_stat(chn_num, &st);
+            stat->analysedFrames = st.analysed;
+            stat->skippedRate = st.skip_rate;
+            stat->skippedLoad = st.skip_load;
+            stat->skippedLate = st.skip_late;
+            stat->fpsX100 = st.fps_x100;
+            stat->latencyUs = st.latency_us;
+            return 0;
+        }
+    }
+
+    imp_log_fun(6, v0_5, 2, "IVS",
+        "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs.c", v1_3,
+        "IMP_IVS_GetChnStat", var_1c_2);
+    return -1;
+}
@@ -6,6 +6,9 @@
 
 #include "imp/imp_ivs.h"
 #include "imp/imp_ivs_base_move.h"
+#include "ivs/ivs_kernels.h"
+#include "ivs/ivs_luma.h"
+#include "ivs/ivs_result.h"
 
 int32_t IMP_Log_Get_Option(void); /* forward decl, ported by T<N> later */
 int32_t imp_log_fun(int32_t level, int32_t option, int32_t type, ...); /* forward decl, ported by T<N> later */
@@ -44,16 +47,37 @@ typedef struct IMPIVSInterfaceLayout {
     uint32_t param_storage[16];
 } IMPIVSInterfaceLayout;
 
+/* IVSMove_init's context: the 0x94-byte stock layout, then our own fields */
+typedef struct {
+    int32_t stock[0x25];
+    const IvsLumaPlane *luma;       /* Shared luma of the pending frame, or NULL */
+} BaseMoveContext;
+
 uint32_t dump_base_move_ivs = 0;
 
-static int32_t sub_de4b0(void)
+int32_t BaseMoveReleaseResult(void *arg1, void *arg2)
 {
-    return 0;
-}
+    void *a0_3 = *(void **)((char *)arg1 + 0x30);
+    IvsResultRing *ring;
+    int32_t idx;
 
-int32_t BaseMoveReleaseResult(void)
-{
-    return sub_de4b0();
+    if (a0_3 == NULL) {
+        imp_log_fun(6, IMP_Log_Get_Option(), 2, "BASEIMPIVSMOVE",
+            "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0xe4,
+            "BaseMoveReleaseResult", "BaseMoveReleaseResult");
+        return -1;
+    }
+
+    ring = *(IvsResultRing **)((char *)a0_3 + 0x48);
+    idx = ivs_result_ring_index(ring, arg2);
+    if (idx < 0 || ivs_result_ring_release(ring, idx) != 0) {
+        imp_log_fun(6, IMP_Log_Get_Option(), 2, "BASEIMPIVSMOVE",
+            "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0xea,
+            "BaseMoveReleaseResult", "result %p is not held\n", arg2);
+        return -1;
+    }
+
+    return 0;
 }
 
 static int32_t sub_de500(void *arg1, int32_t **arg2)
@@ -61,22 +85,24 @@ static int32_t sub_de500(void *arg1, int32_t **arg2)
     void *s1_1 = *(void **)((char *)arg1 + 0x30);
 
     if (s1_1 == NULL) {
-        imp_log_fun(6, sub_de500(arg1, arg2), 2, "BASEIMPIVSMOVE",
+        imp_log_fun(6, IMP_Log_Get_Option(), 2, "BASEIMPIVSMOVE",
             "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0xc4,
             "BaseMoveGetResult", "BaseMoveGetResult");
         return -1;
     }
 
     {
-        int32_t *v0 = *(int32_t **)((char *)s1_1 + 0x48);
-        int32_t s0_1 = v0[0];
-        int32_t v0_2 = s0_1 * 0x18;
-        int32_t *a2_1;
+        int32_t s0_1;
+        int32_t *s5_3 = ivs_result_ring_get(*(IvsResultRing **)((char *)s1_1 + 0x48), &s0_1);
 
-        *arg2 = (int32_t *)((char *)((intptr_t)v0[2]) + v0_2);
+        /* Handed out by pointer and held until BaseMoveReleaseResult */
+        if (s5_3 == NULL) {
+            return -1;
+        }
+
+        *arg2 = s5_3;
 
         if ((dump_base_move_ivs & 1U) != 0) {
-            int32_t *s5_3 = (int32_t *)((char *)((intptr_t)(*(int32_t **)((char *)s1_1 + 0x48))[2]) + v0_2);
             int32_t s0_3;
             char *v0_5;
             char *a0_4;
@@ -104,12 +130,7 @@ static int32_t sub_de500(void *arg1, int32_t **arg2)
             imp_log_fun(6, IMP_Log_Get_Option(), 2, "BASEIMPIVSMOVE",
                 "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0xda,
                 "BaseMoveGetResult", "result: read cnt = %d\n", s0_3);
-            a2_1 = *(int32_t **)((char *)s1_1 + 0x48);
-        } else {
-            a2_1 = *(int32_t **)((char *)s1_1 + 0x48);
         }
-
-        a2_1[0] = (a2_1[0] + 1) % 6;
     }
 
     return 0;
@@ -131,21 +152,18 @@ static int32_t sub_de734(void *arg1, void *arg2)
             "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0x97,
             "BaseMoveProcessAsync", "BaseMoveProcessAsync");
     } else {
-        int32_t *v0 = *(int32_t **)((char *)s3_3 + 0x48);
-        int32_t s2_1 = v0[1];
-        int32_t s0_2 = s2_1 * 0x18;
+        IvsResultRing *v0 = *(IvsResultRing **)((char *)s3_3 + 0x48);
+        /* Written in place; with every slot still held by the application
+         * this is the spare slot and the result is dropped, not overwritten */
+        int32_t *s0_3 = ivs_result_ring_claim(v0);
 
-        result = imp_base_move_process(s3_3, arg2, (int32_t *)((char *)(intptr_t)v0[2] + s0_2), 0);
+        result = imp_base_move_process(s3_3, arg2, s0_3, 0);
 
         if ((dump_base_move_ivs & 1U) != 0) {
-            int32_t *s0_3 = (int32_t *)((char *)((intptr_t)(*(int32_t **)((char *)s3_3 + 0x48))[2]) + s0_2);
-
-            if (s2_1 == 0) {
-                imp_log_fun(6, IMP_Log_Get_Option(), 2, "BASEIMPIVSMOVE",
-                    "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0xa7,
-                    "BaseMoveProcessAsync", "result: write id = %d, ret = %d, datalen = %d ret = %d\n",
-                    0, s0_3[0], s0_3[2], result);
-            }
+            imp_log_fun(6, IMP_Log_Get_Option(), 2, "BASEIMPIVSMOVE",
+                "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0xa7,
+                "BaseMoveProcessAsync", "result: write id = %d, ret = %d, datalen = %d ret = %d\n",
+                ivs_result_ring_index(v0, s0_3), s0_3[0], s0_3[2], result);
 
             {
                 int32_t a1 = s0_3[2];
@@ -170,9 +188,7 @@ static int32_t sub_de734(void *arg1, void *arg2)
         }
 
         if (result == 0) {
-            int32_t *a1_2 = *(int32_t **)((char *)s3_3 + 0x48);
-            a1_2[1] = (a1_2[1] + 1) % 6;
-            return result;
+            return ivs_result_ring_commit(v0, s0_3) ? 0 : 1;
         }
 
         if (result < 0) {
@@ -195,55 +211,34 @@ static int32_t sub_dea30(void *arg1)
     void *s1_3 = *(void **)((char *)arg1 + 0x30);
 
     if (s1_3 == NULL) {
-        return imp_log_fun(6, sub_dea30(arg1), 2, "BASEIMPIVSMOVE",
+        return imp_log_fun(6, IMP_Log_Get_Option(), 2, "BASEIMPIVSMOVE",
             "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0x50,
             "BaseMoveExit", "BaseMoveExit");
     }
 
     {
-        void *v0 = *(void **)((char *)s1_3 + 0x48);
-        int32_t gp_4;
+        IvsResultRing *v0 = *(IvsResultRing **)((char *)s1_3 + 0x48);
+        int32_t v0_8;
 
         if (v0 == NULL) {
-            imp_log_fun(6, sub_dea30(arg1), 2, "BASEIMPIVSMOVE",
+            imp_log_fun(6, IMP_Log_Get_Option(), 2, "BASEIMPIVSMOVE",
                 "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0x57,
                 "BaseMoveExit", "calloc baseMoveInterface is NULL!\n");
-            gp_4 = 0;
         } else {
-            void *v0_1 = *(void **)((char *)v0 + 8);
-            int32_t s0_1 = 0;
+            /* Every slot owns a motion map, the spare one included */
+            for (int32_t s0_1 = 0; s0_1 <= IVS_RESULT_DEPTH; s0_1++) {
+                int32_t *slot = ivs_result_ring_slot(v0, s0_1);
 
-            if (v0_1 != NULL) {
-                void *v0_3;
-                do {
-                    free(*(void **)((char *)v0_1 + s0_1 + 4));
-                    s0_1 += 0x18;
-                    v0_3 = *(void **)((char *)s1_3 + 0x48);
-                    if (s0_1 == 0x90) {
-                        break;
-                    }
-                    v0_1 = *(void **)((char *)v0_3 + 8);
-                } while (1);
-
-                free(*(void **)((char *)v0_3 + 8));
-                free(*(void **)((char *)s1_3 + 0x48));
-                gp_4 = imp_free_base_move(s1_3);
-                *(void **)((char *)arg1 + 0x30) = NULL;
-                return gp_4;
+                free((void *)(intptr_t)slot[1]);
             }
 
-            imp_log_fun(6, sub_dea30(arg1), 2, "BASEIMPIVSMOVE",
-                "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0x5c,
-                "BaseMoveExit", "calloc baseMoveInterface is NULL!\n");
-            free(*(void **)((char *)s1_3 + 0x48));
-            gp_4 = 0;
+            ivs_result_ring_destroy(v0);
+            *(IvsResultRing **)((char *)s1_3 + 0x48) = NULL;
         }
 
-        {
-            int32_t v0_8 = imp_free_base_move(s1_3);
-            *(void **)((char *)arg1 + 0x30) = NULL;
-            return v0_8;
-        }
+        v0_8 = imp_free_base_move(s1_3);
+        *(void **)((char *)arg1 + 0x30) = NULL;
+        return v0_8;
     }
 }
 
@@ -276,49 +271,31 @@ static int32_t sub_dec78(uint32_t *arg1, void *arg2)
         }
 
         {
-            int32_t *v0_1 = calloc(1, 0xc);
-            int32_t gp_5;
+            IvsResultRing *v0_1 = ivs_result_ring_create(IVS_RESULT_DEPTH, 0x18);
 
-            *(int32_t **)(v0 + 0x48) = v0_1;
+            *(IvsResultRing **)(intptr_t)(v0 + 0x48) = v0_1;
 
-            if (v0_1 == NULL) {
-                imp_log_fun(6, IMP_Log_Get_Option(), 2, "BASEIMPIVSMOVE",
-                    "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0x28,
-                    "BaseMoveInit", "calloc baseMoveInterface is NULL!\n");
-                gp_5 = 0;
-            } else {
-                int32_t v0_2 = (int32_t)(intptr_t)calloc(6, 0x18);
-                int32_t gp_2 = 0;
-
-                v0_1[2] = v0_2;
+            if (v0_1 != NULL) {
+                int32_t v1_1 = *(int32_t *)(intptr_t)(v0 + 0x20) * *(int32_t *)(intptr_t)(v0 + 0x24);
+                int32_t s2_2 = v1_1 + 0x3f;
 
-                if (v0_2 != 0) {
-                    int32_t i = v0_2 + 4;
-                    int32_t v1_1 = *(int32_t *)(v0 + 0x20) * *(int32_t *)(v0 + 0x24);
-                    int32_t s2_2 = v1_1 + 0x3f;
+                if (v1_1 >= 0) {
+                    s2_2 = v1_1;
+                }
 
-                    if (v1_1 >= 0) {
-                        s2_2 = v1_1;
-                    }
+                for (int32_t i = 0; i <= IVS_RESULT_DEPTH; i++) {
+                    int32_t *slot = ivs_result_ring_slot(v0_1, i);
 
-                    do {
-                        i += 0x18;
-                        *(int32_t *)(i - 0x18) = (int32_t)(intptr_t)calloc((size_t)(s2_2 >> 6), 1);
-                    } while (i != v0_2 + 0x94);
-
-                    v0_1[1] = 0;
-                    v0_1[0] = 0;
-                    *(int32_t *)((char *)arg2 + 0x30) = v0;
-                    return 0;
+                    slot[1] = (int32_t)(intptr_t)calloc((size_t)(s2_2 >> 6), 1);
                 }
 
-                imp_log_fun(6, IMP_Log_Get_Option(), 2, "BASEIMPIVSMOVE",
-                    "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0x2e,
-                    "BaseMoveInit", "calloc baseMoveInterface is NULL!\n");
-                free(*(void **)(v0 + 0x48));
-                gp_5 = 0;
+                *(int32_t *)((char *)arg2 + 0x30) = v0;
+                return 0;
             }
 
+            imp_log_fun(6, IMP_Log_Get_Option(), 2, "BASEIMPIVSMOVE",
+                "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/base_move_ivs.c", 0x28,
+                "BaseMoveInit", "calloc baseMoveInterface is NULL!\n");
             imp_free_base_move((void *)(intptr_t)v0);
             *(void **)((char *)arg2 + 0x30) = NULL;
             return -1;
@@ -650,7 +627,7 @@ void *imp_alloc_base_move(uint32_t *arg1, int32_t arg2)
                 "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_base_move/src/ivs_base_move.c", 0x34,
                 "IVSMove_init", "skipFrameCnt or referenceNum out of range\n");
         } else {
-            int32_t *v0_3 = calloc(1, 0x94);
+            int32_t *v0_3 = calloc(1, sizeof(BaseMoveContext));
 
             if (v0_3 == NULL) {
                 imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS_MOVE",
@@ -738,6 +715,8 @@ int32_t imp_free_base_move(void *arg1)
         void *s2 = *(void **)((char *)arg1 + 4);
         void *a0 = *(void **)((char *)s2 + 0x3c);
 
+        ivs_luma_release(((BaseMoveContext *)s2)->luma);
+
         if (a0 != NULL) {
             free(a0);
             *(void **)((char *)s2 + 0x3c) = NULL;
@@ -775,8 +754,21 @@ int32_t imp_free_base_move(void *arg1)
     return 0;
 }
 
+/* The group's pyramid level 0 is the frame's own luma, which stays locked
+ * until processing is done: reference it instead of copying the plane */
 int32_t imp_base_move_preprocess(void *arg1, void *arg2)
 {
+    BaseMoveContext *ctx = *(BaseMoveContext **)((char *)arg1 + 4);
+    const IvsLumaPlane *luma = ivs_luma_acquire(arg2, 0);
+
+    ivs_luma_release(ctx->luma);
+    ctx->luma = NULL;
+    if (luma != NULL && luma->width == ctx->stock[0] && luma->height == ctx->stock[1] &&
+        luma->stride == luma->width) {
+        ctx->luma = luma;
+        return 1;
+    }
+    ivs_luma_release(luma);
     memcpy(*(void **)((char *)(*(void **)((char *)arg1 + 4)) + 0x3c),
         *(void **)((char *)arg2 + 0x1c),
         (size_t)(*(int32_t *)((char *)arg2 + 8) * *(int32_t *)((char *)arg2 + 0xc)));
@@ -838,7 +830,8 @@ static int32_t sub_dfbd0(void *arg1, int32_t *arg2, void *arg3, int32_t arg4, in
             a0_3 = s0[0xe];
         } else {
             int32_t a0_2 = s0[4];
-            int32_t s4_1 = s0[0xf];
+            const IvsLumaPlane *luma = ((BaseMoveContext *)s0)->luma;
+            int32_t s4_1 = luma != NULL ? (int32_t)(intptr_t)luma->data : s0[0xf];
             int32_t v1_4;
             int32_t hi_2;
 
@@ -971,7 +964,12 @@ int32_t imp_base_move_process(void *arg1, void *arg2, int32_t *arg3, int32_t arg
         }
 
         if (s1_1 != NULL) {
-            return sub_dfbd0(s0, s1_1, s3_1, arg4, 0, 0, 0, 0, 0, 0);
+            int32_t *ctx = *(int32_t **)((char *)s0 + 4);
+            int32_t ret = sub_dfbd0(s0, s1_1, s3_1, arg4, 0, 0, 0, 0, 0, 0);
+
+            ivs_luma_release(((BaseMoveContext *)ctx)->luma);
+            ((BaseMoveContext *)ctx)->luma = NULL;
+            return ret;
         }
 
         v0_3 = IMP_Log_Get_Option();
@@ -1078,330 +1076,48 @@ int32_t sad(void *arg1, int32_t arg2, int32_t arg3, int32_t arg4, int32_t arg5,
         return -1;
     }
 
-    if (arg18 != 0) {
+    /* Each image is five words: data, -, stride, width, height. The map
+     * (arg11) is scratch for the motion map, arg16 gets one byte per 8x8
+     * block. Then come the SIMD flag probed at init, the threshold and the
+     * mode. */
+    (void)arg2; (void)arg7; (void)arg12; (void)arg14; (void)arg15; (void)arg17;
+    (void)arg19; (void)arg20; (void)arg24;
+
+    if (arg23 != 0) {
         printf("%s: %d: invalid parameter error:Mode out of range\n", "sad", 0x96);
         return 0;
     }
 
+    if (arg9 % 8 != 0 || arg10 % 8 != 0) {
+        printf("%s: %d: invalid parameter error: src.width MOD %d or src.height MOD %d is not equal to 0\n",
+            "sad", 0x8a, 8, 8);
+        return -1;
+    }
+
     {
-        uint32_t a0_2 = ((uint32_t)(arg9 >> 0x1f)) >> 0x1d;
-
-        if (((arg9 + (int32_t)a0_2) & 7) == (int32_t)a0_2) {
-            uint32_t a0_4 = ((uint32_t)(arg10 >> 0x1f)) >> 0x1d;
-            int32_t result = ((arg10 + (int32_t)a0_4) & 7) - (int32_t)a0_4;
-
-            if (result == 0) {
-                if (arg20 != 0) {
-                    MergeBaseMove((int32_t)(intptr_t)arg1, arg2, arg3, arg4, arg5,
-                        (int32_t)(intptr_t)arg6, arg7, arg8, arg9, arg10,
-                        (int32_t)(intptr_t)arg11, arg12, arg13, arg14, arg15, arg19, arg20);
-                    if (arg15 - 8 >= 0) {
-                        int32_t t7_1 = 0;
-                        int32_t t4_1 = 0;
-                        int32_t i = 0;
-
-                        do {
-                            if (arg14 - 8 >= 0) {
-                                int32_t j = 0;
-                                char *t2_1 = (char *)arg16 + t7_1;
-
-                                do {
-                                    char *a2_3 = (char *)arg11 + j + t4_1;
-                                    int32_t k = 8;
-                                    int32_t v1_1 = 0;
-
-                                    do {
-                                        char *v0_14 = a2_3;
-                                        do {
-                                            uint32_t a0_7 = (uint8_t)*v0_14;
-                                            v0_14 = &v0_14[1];
-                                            v1_1 += (int32_t)a0_7;
-                                        } while (&a2_3[8] != v0_14);
-                                        k -= 1;
-                                        a2_3 = &a2_3[arg13];
-                                    } while (k != 0);
-
-                                    j += 8;
-                                    *t2_1 = (char)v1_1;
-                                    t2_1 = &t2_1[1];
-                                } while (arg14 - 8 >= j);
-                            }
+        const IvsKernels *k = arg21 != 0 ? ivs_kernels() : ivs_kernels_get(0);
+        const uint8_t *map = (const uint8_t *)arg11;
+        uint16_t sums[256];
 
-                            i += 8;
-                            t4_1 += arg13 << 3;
-                            t7_1 += arg17;
-                        } while (arg15 - 8 >= i);
-                    }
+        if (ivs_diff_erode3(k, (const uint8_t *)arg1, arg3, (const uint8_t *)arg6, arg8,
+                (uint8_t *)arg11, arg13, arg9, arg10, arg22) != 0) {
+            return -1;
+        }
 
-                    return result;
-                }
+        for (int32_t by = 0; by < arg10 / 8; by++) {
+            const uint8_t *row = map + (size_t)by * 8 * arg13;
+            uint8_t *out = (uint8_t *)arg16 + (size_t)by * arg18;
 
-                if (arg10 - 8 < 0) {
-                    printf("total_count:  %d\n", 0);
-                } else {
-                    int32_t v0_19 = arg3 << 3;
-                    int32_t var_38_1 = 0;
-                    int32_t var_48_1 = 0;
-                    int32_t var_4c_1 = 0;
-                    int32_t var_54_1 = 0;
-
-                    while (1) {
-                        if (arg9 - 8 < 0) {
-                            int32_t v0_82 = var_4c_1 + 8;
-                            var_4c_1 = v0_82;
-                            var_48_1 += v0_19;
-                            var_38_1 += arg17;
-                            if (arg10 - 8 < v0_82) {
-                                break;
-                            }
-                        } else {
-                            int32_t j_3 = 0;
-                            char *var_50_1 = (char *)arg16 + var_38_1;
-                            int32_t v0_24 = var_4c_1 + 8;
-
-                            do {
-                                int32_t s2_1 = var_4c_1;
-                                int32_t t9_1 = var_48_1;
-                                int32_t ra_1 = 0;
-
-                                do {
-                                    int32_t t8_2 = (0 < s2_1) ? 1 : 0;
-                                    int32_t t7_2 = (s2_1 < arg10 - 1) ? 1 : 0;
-                                    int32_t v0_25;
-                                    int32_t t7_3;
-                                    int32_t v0_26;
-                                    int32_t a3_1;
-                                    int32_t t3_3;
-                                    char *t6_1;
-                                    char *t5_3;
-                                    int32_t j_1;
-                                    char *a3_2;
-                                    char *t3_4;
-                                    int32_t t2_2;
-                                    char *t4_2;
-                                    char *t2_3;
-
-                                    s2_1 += 1;
-                                    v0_25 = s2_1;
-                                    if (t7_2 == 0) {
-                                        v0_25 = arg10 - 1;
-                                    }
-                                    t7_3 = v0_25 * arg3;
-                                    v0_26 = t9_1 - arg3;
-                                    if (t8_2 == 0) {
-                                        v0_26 = 0;
-                                    }
-                                    a3_1 = t9_1 + j_3;
-                                    t3_3 = v0_26 + j_3;
-                                    t6_1 = (char *)arg1 + a3_1;
-                                    t5_3 = (char *)arg1 + t3_3;
-                                    j_1 = j_3;
-                                    a3_2 = (char *)arg6 + a3_1;
-                                    t3_4 = (char *)arg6 + t3_3;
-                                    t2_2 = t7_3 + j_3;
-                                    t4_2 = (char *)arg1 + t2_2;
-                                    t2_3 = (char *)arg6 + t2_2;
-
-                                    do {
-                                        int32_t a0_9 = j_1 - 1;
-                                        int32_t j_2;
-                                        int32_t v0_28;
-                                        uint32_t v0_30;
-                                        int32_t fp_2;
-                                        uint32_t s6_3;
-                                        int32_t s7_3;
-                                        int32_t v0_32;
-                                        int32_t s6_5;
-                                        int32_t v0_33;
-                                        uint32_t fp_4;
-                                        int32_t v0_34;
-                                        uint32_t v0_36;
-                                        int32_t s6_9;
-                                        int32_t v0_38;
-                                        uint32_t s7_8;
-                                        int32_t v0_40;
-                                        uint32_t v0_42;
-                                        int32_t fp_7;
-                                        int32_t v0_44;
-                                        uint32_t s6_14;
-                                        uint32_t v0_47;
-                                        int32_t fp_10;
-                                        int32_t v0_49;
-                                        uint32_t s7_9;
-                                        int32_t v0_51;
-                                        uint32_t v0_53;
-                                        int32_t fp_14;
-                                        int32_t v0_55;
-                                        uint32_t s6_18;
-                                        int32_t v1_6;
-                                        uint32_t v0_59;
-                                        int32_t v1_9;
-                                        int32_t v0_61;
-                                        uint32_t s7_12;
-                                        uint32_t v0_64;
-                                        int32_t s6_22;
-                                        int32_t v0_66;
-                                        uint32_t v1_13;
-                                        int32_t a0_10;
-                                        uint32_t a0_12;
-                                        int32_t s6_25;
-                                        int32_t v0_71;
-                                        uint32_t s7_13;
-
-                                        if (0 >= j_1) {
-                                            a0_9 = 0;
-                                        }
-                                        if (j_1 >= arg9 - 1) {
-                                            j_2 = arg9 - 1;
-                                            j_1 += 1;
-                                        } else {
-                                            j_1 += 1;
-                                            j_2 = j_1;
-                                        }
-
-                                        v0_28 = v0_26 + a0_9;
-                                        v0_30 = (uint8_t)*((char *)arg1 + v0_28) - (uint8_t)*((char *)arg6 + v0_28);
-                                        fp_2 = (int32_t)v0_30 >> 0x1f;
-                                        s6_3 = (uint8_t)*t5_3 - (uint8_t)*t3_4;
-                                        s7_3 = (int32_t)s6_3 >> 0x1f;
-                                        v0_32 = (fp_2 ^ (int32_t)v0_30) - fp_2;
-                                        s6_5 = (s7_3 ^ (int32_t)s6_3) - s7_3;
-                                        v0_33 = v0_32 & 0xff;
-                                        if (v0_32 < arg19) {
-                                            v0_33 = 0;
-                                        }
-                                        fp_4 = 0;
-                                        if (s6_5 >= arg19) {
-                                            fp_4 = (uint32_t)(s6_5 & 0xff);
-                                            if ((uint32_t)v0_33 < (uint32_t)(s6_5 & 0xff)) {
-                                                fp_4 = (uint32_t)(uint8_t)v0_33;
-                                            }
-                                        }
-
-                                        v0_34 = j_2 + v0_26;
-                                        v0_36 = (uint8_t)*((char *)arg1 + v0_34) - (uint8_t)*((char *)arg6 + v0_34);
-                                        s6_9 = (int32_t)v0_36 >> 0x1f;
-                                        v0_38 = (s6_9 ^ (int32_t)v0_36) - s6_9;
-                                        s7_8 = 0;
-                                        if (v0_38 >= arg19) {
-                                            s7_8 = (uint32_t)(v0_38 & 0xff);
-                                            if (fp_4 < (uint32_t)(v0_38 & 0xff)) {
-                                                s7_8 = (uint32_t)(uint8_t)fp_4;
-                                            }
-                                        }
-
-                                        v0_40 = t9_1 + a0_9;
-                                        v0_42 = (uint8_t)*((char *)arg1 + v0_40) - (uint8_t)*((char *)arg6 + v0_40);
-                                        fp_7 = (int32_t)v0_42 >> 0x1f;
-                                        v0_44 = (fp_7 ^ (int32_t)v0_42) - fp_7;
-                                        s6_14 = 0;
-                                        if (v0_44 >= arg19) {
-                                            s6_14 = (uint32_t)(v0_44 & 0xff);
-                                            if (s7_8 < (uint32_t)(v0_44 & 0xff)) {
-                                                s6_14 = (uint32_t)(uint8_t)s7_8;
-                                            }
-                                        }
-
-                                        v0_47 = (uint8_t)*t6_1 - (uint8_t)*a3_2;
-                                        fp_10 = (int32_t)v0_47 >> 0x1f;
-                                        v0_49 = (fp_10 ^ (int32_t)v0_47) - fp_10;
-                                        s7_9 = 0;
-                                        if (v0_49 >= arg19) {
-                                            s7_9 = (uint32_t)(v0_49 & 0xff);
-                                            if (s6_14 < (uint32_t)(v0_49 & 0xff)) {
-                                                s7_9 = (uint32_t)(uint8_t)s6_14;
-                                            }
-                                        }
-
-                                        v0_51 = j_2 + t9_1;
-                                        v0_53 = (uint8_t)*((char *)arg1 + v0_51) - (uint8_t)*((char *)arg6 + v0_51);
-                                        fp_14 = (int32_t)v0_53 >> 0x1f;
-                                        v0_55 = (fp_14 ^ (int32_t)v0_53) - fp_14;
-                                        s6_18 = 0;
-                                        if (v0_55 >= arg19) {
-                                            s6_18 = (uint32_t)(v0_55 & 0xff);
-                                            if (s7_9 < (uint32_t)(v0_55 & 0xff)) {
-                                                s6_18 = (uint32_t)(uint8_t)s7_9;
-                                            }
-                                        }
-
-                                        v1_6 = t7_3 + a0_9;
-                                        v0_59 = (uint8_t)*((char *)arg1 + v1_6) - (uint8_t)*((char *)arg6 + v1_6);
-                                        v1_9 = (int32_t)v0_59 >> 0x1f;
-                                        v0_61 = (v1_9 ^ (int32_t)v0_59) - v1_9;
-                                        s7_12 = 0;
-                                        if (v0_61 >= arg19) {
-                                            s7_12 = (uint32_t)(v0_61 & 0xff);
-                                            if (s6_18 < (uint32_t)(v0_61 & 0xff)) {
-                                                s7_12 = (uint32_t)(uint8_t)s6_18;
-                                            }
-                                        }
-
-                                        v0_64 = (uint8_t)*t4_2 - (uint8_t)*t2_3;
-                                        s6_22 = (int32_t)v0_64 >> 0x1f;
-                                        v0_66 = (s6_22 ^ (int32_t)v0_64) - s6_22;
-                                        v1_13 = 0;
-                                        if (v0_66 >= arg19) {
-                                            v1_13 = (uint32_t)(v0_66 & 0xff);
-                                            if (s7_12 < (uint32_t)(v0_66 & 0xff)) {
-                                                v1_13 = (uint32_t)(uint8_t)s7_12;
-                                            }
-                                        }
-
-                                        a0_10 = j_2 + t7_3;
-                                        a0_12 = (uint8_t)*((char *)arg1 + a0_10) - (uint8_t)*((char *)arg6 + a0_10);
-                                        s6_25 = (int32_t)a0_12 >> 0x1f;
-                                        v0_71 = (s6_25 ^ (int32_t)a0_12) - s6_25;
-                                        s7_13 = 0;
-                                        if (v0_71 >= arg19) {
-                                            s7_13 = (uint32_t)(v0_71 & 0xff);
-                                            if (v1_13 < (uint32_t)(v0_71 & 0xff)) {
-                                                s7_13 = (uint32_t)(uint8_t)v1_13;
-                                            }
-                                        }
-
-                                        ra_1 += (int32_t)s7_13;
-                                        t4_2 = &t4_2[1];
-                                        t2_3 = &t2_3[1];
-                                        t6_1 = &t6_1[1];
-                                        a3_2 = &a3_2[1];
-                                        t5_3 = &t5_3[1];
-                                        t3_4 = &t3_4[1];
-                                    } while (j_3 + 8 != j_1);
-
-                                    t9_1 += arg3;
-                                } while (v0_24 != s2_1);
-
-                                var_54_1 += (0U < (uint32_t)(ra_1 & 0xff)) ? 1 : 0;
-                                {
-                                    int32_t i_1 = (arg9 - 8 < j_3 + 8) ? 1 : 0;
-                                    j_3 += 8;
-                                    *var_50_1 = (char)ra_1;
-                                    var_50_1 = &var_50_1[1];
-                                    if (i_1 != 0) {
-                                        break;
-                                    }
-                                }
-                            } while (1);
-
-                            var_4c_1 = v0_24;
-                            var_48_1 += v0_19;
-                            var_38_1 += arg17;
-                            if (arg10 - 8 < v0_24) {
-                                break;
-                            }
-                        }
-                    }
+            for (int32_t bx0 = 0; bx0 < arg9 / 8; bx0 += 256) {
+                int32_t n = arg9 / 8 - bx0 < 256 ? arg9 / 8 - bx0 : 256;
 
-                    printf("total_count:  %d\n", var_54_1);
+                k->sum_blocks(row + bx0 * 8, arg13, n * 8, 8, 8, sums, 0);
+                for (int32_t i = 0; i < n; i++) {
+                    out[bx0 + i] = (uint8_t)(sums[i] > 0xff ? 0xff : sums[i]);
                 }
-
-                return result;
             }
         }
     }
 
-    printf("%s: %d: invalid parameter error: src.width MOD %d or src.height MOD %d is not equal to 0\n",
-        "sad", 0x8a, 8, 8);
-    return -1;
+    return 0;
 }
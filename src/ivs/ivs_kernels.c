@@ -0,0 +1,467 @@
+/**
+ * IVS pixel kernels
+ *
+ * Scalar kernels are the reference. The vector kernels use GCC generic
+ * vectors, so they become MSA code on MIPS built with -mmsa and SSE2/NEON
+ * on a host, and fall back to the scalar code for row tails and edges.
+ * SAD lanes are widened to 16 bits before the absolute difference, which
+ * keeps every sum exact: a 16x16 block adds up to at most 65280.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ivs_kernels.h"
+
+/* forward decl, from core/sys_core.c */
+int32_t is_cpu_has_msa(void);
+
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9 && \
+    (defined(__mips_msa) || defined(__SSE2__) || defined(__ARM_NEON))
+#define IVS_KERNELS_VECTOR 1
+#endif
+
+/* ---- Scalar kernels ---- */
+
+static uint32_t sad_block_c(const uint8_t *a, int32_t a_stride, const uint8_t *b, int32_t b_stride,
+                            int32_t bsize)
+{
+    uint32_t sum = 0;
+
+    for (int32_t y = 0; y < bsize; y++) {
+        for (int32_t x = 0; x < bsize; x++) {
+            int32_t d = a[x] - b[x];
+            sum += (uint32_t)(d < 0 ? -d : d);
+        }
+        a += a_stride;
+        b += b_stride;
+    }
+    return sum;
+}
+
+static uint32_t sum_block_c(const uint8_t *src, int32_t stride, int32_t bsize)
+{
+    uint32_t sum = 0;
+
+    for (int32_t y = 0; y < bsize; y++) {
+        for (int32_t x = 0; x < bsize; x++)
+            sum += src[x];
+        src += stride;
+    }
+    return sum;
+}
+
+static void sad_blocks_c(const uint8_t *a, int32_t a_stride, const uint8_t *b, int32_t b_stride,
+                         int32_t width, int32_t height, int32_t bsize, uint16_t *out, int32_t out_stride)
+{
+    for (int32_t by = 0; by < height / bsize; by++) {
+        const uint8_t *ar = a + (size_t)by * bsize * a_stride;
+        const uint8_t *br = b + (size_t)by * bsize * b_stride;
+
+        for (int32_t bx = 0; bx < width / bsize; bx++)
+            out[bx] = (uint16_t)sad_block_c(ar + bx * bsize, a_stride, br + bx * bsize, b_stride, bsize);
+        out += out_stride;
+    }
+}
+
+static void sum_blocks_c(const uint8_t *src, int32_t stride, int32_t width, int32_t height,
+                         int32_t bsize, uint16_t *out, int32_t out_stride)
+{
+    for (int32_t by = 0; by < height / bsize; by++) {
+        const uint8_t *row = src + (size_t)by * bsize * stride;
+
+        for (int32_t bx = 0; bx < width / bsize; bx++)
+            out[bx] = (uint16_t)sum_block_c(row + bx * bsize, stride, bsize);
+        out += out_stride;
+    }
+}
+
+static void absdiff_row_c(const uint8_t *a, const uint8_t *b, uint8_t *dst, int32_t n, int32_t thresh)
+{
+    for (int32_t i = 0; i < n; i++) {
+        int32_t d = a[i] - b[i];
+
+        if (d < 0)
+            d = -d;
+        dst[i] = (uint8_t)(d < thresh ? 0 : d);
+    }
+}
+
+/* dst[from..to) of the row filter; indices outside the row are clamped */
+static void morph_row_span(const uint8_t *src, uint8_t *dst, int32_t width, int32_t ksize, int32_t op,
+                           int32_t from, int32_t to)
+{
+    const int32_t anchor = ksize / 2;
+
+    for (int32_t x = from; x < to; x++) {
+        uint8_t v = op == IVS_MORPH_DILATE ? 0 : 0xff;
+
+        for (int32_t j = 0; j < ksize; j++) {
+            int32_t sx = x - anchor + j;
+            uint8_t s;
+
+            sx = sx < 0 ? 0 : (sx >= width ? width - 1 : sx);
+            s = src[sx];
+            if (op == IVS_MORPH_DILATE ? s > v : s < v)
+                v = s;
+        }
+        dst[x] = v;
+    }
+}
+
+static void morph_row_c(const uint8_t *src, uint8_t *dst, int32_t width, int32_t ksize, int32_t op)
+{
+    morph_row_span(src, dst, width, ksize, op, 0, width);
+}
+
+static void morph_column_tail(const uint8_t *const *rows, int32_t ksize, uint8_t *dst, int32_t op,
+                              int32_t from, int32_t to)
+{
+    for (int32_t x = from; x < to; x++) {
+        uint8_t v = rows[0][x];
+
+        for (int32_t j = 1; j < ksize; j++) {
+            uint8_t s = rows[j][x];
+
+            if (op == IVS_MORPH_DILATE ? s > v : s < v)
+                v = s;
+        }
+        dst[x] = v;
+    }
+}
+
+static void morph_column_c(const uint8_t *const *rows, int32_t ksize, uint8_t *dst, int32_t width, int32_t op)
+{
+    morph_column_tail(rows, ksize, dst, op, 0, width);
+}
+
+static const IvsKernels g_kernels_c = {
+    sad_blocks_c, sum_blocks_c, absdiff_row_c, morph_row_c, morph_column_c,
+};
+
+/* ---- Vector kernels ---- */
+
+#ifdef IVS_KERNELS_VECTOR
+
+typedef uint8_t  v8u8   __attribute__((vector_size(8)));
+typedef uint8_t  v16u8  __attribute__((vector_size(16)));
+typedef uint16_t v8u16  __attribute__((vector_size(16)));
+
+static inline v16u8 load_u8x16(const uint8_t *p)
+{
+    v16u8 v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static inline v8u16 load_u8x8(const uint8_t *p)
+{
+    v8u8 v;
+    memcpy(&v, p, sizeof(v));
+    return __builtin_convertvector(v, v8u16);
+}
+
+static inline v16u8 min_u8(v16u8 a, v16u8 b)
+{
+    v16u8 m = (v16u8)(a < b);
+    return (a & m) | (b & ~m);
+}
+
+static inline v16u8 max_u8(v16u8 a, v16u8 b)
+{
+    v16u8 m = (v16u8)(a > b);
+    return (a & m) | (b & ~m);
+}
+
+static inline v8u16 absdiff_u16(v8u16 a, v8u16 b)
+{
+    v8u16 m = (v8u16)(a > b);
+    return ((a - b) & m) | ((b - a) & ~m);
+}
+
+static inline uint32_t hsum_u16(v8u16 v)
+{
+    uint32_t s = 0;
+
+    for (int32_t i = 0; i < 8; i++)
+        s += v[i];
+    return s;
+}
+
+/* One 16-pixel-wide strip, bsize rows deep: lanes 0..7 and 8..15 summed
+ * separately so an 8x8 caller gets two blocks from one pass */
+static inline void sad_strip_v(const uint8_t *a, int32_t a_stride, const uint8_t *b, int32_t b_stride,
+                               int32_t rows, uint32_t *lo, uint32_t *hi)
+{
+    v8u16 acc_lo = { 0 }, acc_hi = { 0 };
+
+    for (int32_t y = 0; y < rows; y++) {
+        acc_lo += absdiff_u16(load_u8x8(a), load_u8x8(b));
+        acc_hi += absdiff_u16(load_u8x8(a + 8), load_u8x8(b + 8));
+        a += a_stride;
+        b += b_stride;
+    }
+    *lo = hsum_u16(acc_lo);
+    *hi = hsum_u16(acc_hi);
+}
+
+static inline void sum_strip_v(const uint8_t *src, int32_t stride, int32_t rows, uint32_t *lo, uint32_t *hi)
+{
+    v8u16 acc_lo = { 0 }, acc_hi = { 0 };
+
+    for (int32_t y = 0; y < rows; y++) {
+        acc_lo += load_u8x8(src);
+        acc_hi += load_u8x8(src + 8);
+        src += stride;
+    }
+    *lo = hsum_u16(acc_lo);
+    *hi = hsum_u16(acc_hi);
+}
+
+static void sad_blocks_v(const uint8_t *a, int32_t a_stride, const uint8_t *b, int32_t b_stride,
+                         int32_t width, int32_t height, int32_t bsize, uint16_t *out, int32_t out_stride)
+{
+    const int32_t nbx = width / bsize;
+
+    for (int32_t by = 0; by < height / bsize; by++) {
+        const uint8_t *ar = a + (size_t)by * bsize * a_stride;
+        const uint8_t *br = b + (size_t)by * bsize * b_stride;
+        int32_t bx = 0;
+
+        if (bsize == 16) {
+            for (; bx < nbx; bx++) {
+                uint32_t lo, hi;
+                sad_strip_v(ar + bx * 16, a_stride, br + bx * 16, b_stride, 16, &lo, &hi);
+                out[bx] = (uint16_t)(lo + hi);
+            }
+        } else if (bsize == 8) {
+            for (; bx + 2 <= nbx; bx += 2) {
+                uint32_t lo, hi;
+                sad_strip_v(ar + bx * 8, a_stride, br + bx * 8, b_stride, 8, &lo, &hi);
+                out[bx] = (uint16_t)lo;
+                out[bx + 1] = (uint16_t)hi;
+            }
+        }
+        for (; bx < nbx; bx++)
+            out[bx] = (uint16_t)sad_block_c(ar + bx * bsize, a_stride, br + bx * bsize, b_stride, bsize);
+        out += out_stride;
+    }
+}
+
+static void sum_blocks_v(const uint8_t *src, int32_t stride, int32_t width, int32_t height,
+                         int32_t bsize, uint16_t *out, int32_t out_stride)
+{
+    const int32_t nbx = width / bsize;
+
+    for (int32_t by = 0; by < height / bsize; by++) {
+        const uint8_t *row = src + (size_t)by * bsize * stride;
+        int32_t bx = 0;
+
+        if (bsize == 16) {
+            for (; bx < nbx; bx++) {
+                uint32_t lo, hi;
+                sum_strip_v(row + bx * 16, stride, 16, &lo, &hi);
+                out[bx] = (uint16_t)(lo + hi);
+            }
+        } else if (bsize == 8) {
+            for (; bx + 2 <= nbx; bx += 2) {
+                uint32_t lo, hi;
+                sum_strip_v(row + bx * 8, stride, 8, &lo, &hi);
+                out[bx] = (uint16_t)lo;
+                out[bx + 1] = (uint16_t)hi;
+            }
+        }
+        for (; bx < nbx; bx++)
+            out[bx] = (uint16_t)sum_block_c(row + bx * bsize, stride, bsize);
+        out += out_stride;
+    }
+}
+
+static void absdiff_row_v(const uint8_t *a, const uint8_t *b, uint8_t *dst, int32_t n, int32_t thresh)
+{
+    int32_t i = 0;
+
+    if (thresh > 255) {
+        memset(dst, 0, (size_t)n);
+        return;
+    }
+    {
+        const v16u8 th = (v16u8){ 0 } + (uint8_t)(thresh < 0 ? 0 : thresh);
+
+        for (; i + 16 <= n; i += 16) {
+            v16u8 va = load_u8x16(a + i), vb = load_u8x16(b + i);
+            v16u8 d = max_u8(va, vb) - min_u8(va, vb);
+
+            d &= (v16u8)(d >= th);
+            memcpy(dst + i, &d, sizeof(d));
+        }
+    }
+    absdiff_row_c(a + i, b + i, dst + i, n - i, thresh);
+}
+
+static void morph_row_v(const uint8_t *src, uint8_t *dst, int32_t width, int32_t ksize, int32_t op)
+{
+    const int32_t anchor = ksize / 2;
+    /* Windows of x in [anchor, end) stay inside the row */
+    const int32_t end = width - (ksize - 1 - anchor);
+    int32_t x = anchor;
+
+    if (end - anchor < 16) {
+        morph_row_span(src, dst, width, ksize, op, 0, width);
+        return;
+    }
+    morph_row_span(src, dst, width, ksize, op, 0, anchor);
+
+    for (; x + 16 <= end; x += 16) {
+        const uint8_t *s = src + x - anchor;
+        v16u8 v = load_u8x16(s);
+
+        if (op == IVS_MORPH_DILATE) {
+            for (int32_t j = 1; j < ksize; j++)
+                v = max_u8(v, load_u8x16(s + j));
+        } else {
+            for (int32_t j = 1; j < ksize; j++)
+                v = min_u8(v, load_u8x16(s + j));
+        }
+        memcpy(dst + x, &v, sizeof(v));
+    }
+    morph_row_span(src, dst, width, ksize, op, x, width);
+}
+
+static void morph_column_v(const uint8_t *const *rows, int32_t ksize, uint8_t *dst, int32_t width, int32_t op)
+{
+    int32_t x = 0;
+
+    for (; x + 16 <= width; x += 16) {
+        v16u8 v = load_u8x16(rows[0] + x);
+
+        if (op == IVS_MORPH_DILATE) {
+            for (int32_t j = 1; j < ksize; j++)
+                v = max_u8(v, load_u8x16(rows[j] + x));
+        } else {
+            for (int32_t j = 1; j < ksize; j++)
+                v = min_u8(v, load_u8x16(rows[j] + x));
+        }
+        memcpy(dst + x, &v, sizeof(v));
+    }
+    morph_column_tail(rows, ksize, dst, op, x, width);
+}
+
+static const IvsKernels g_kernels_v = {
+    sad_blocks_v, sum_blocks_v, absdiff_row_v, morph_row_v, morph_column_v,
+};
+
+#endif /* IVS_KERNELS_VECTOR */
+
+/* ---- Dispatch ---- */
+
+const IvsKernels *ivs_kernels_get(int32_t simd)
+{
+#ifdef IVS_KERNELS_VECTOR
+    return simd ? &g_kernels_v : &g_kernels_c;
+#else
+    (void)simd;
+    return &g_kernels_c;
+#endif
+}
+
+int32_t ivs_kernels_has_simd(void)
+{
+#ifdef IVS_KERNELS_VECTOR
+    return 1;
+#else
+    return 0;
+#endif
+}
+
+const IvsKernels *ivs_kernels(void)
+{
+    static int32_t use_simd = -1;
+
+    if (use_simd < 0) {
+#if defined(IVS_KERNELS_VECTOR) && defined(__mips__)
+        /* MSA, not the MXU that is_video_has_simd128_proc() reports */
+        use_simd = is_cpu_has_msa() != 0;
+#elif defined(IVS_KERNELS_VECTOR)
+        use_simd = 1;
+#else
+        use_simd = 0;
+#endif
+    }
+
+    return ivs_kernels_get(use_simd);
+}
+
+/* ---- Composite filters ---- */
+
+int32_t ivs_diff_erode3(const IvsKernels *k, const uint8_t *a, int32_t a_stride,
+                        const uint8_t *b, int32_t b_stride, uint8_t *dst, int32_t dst_stride,
+                        int32_t width, int32_t height, int32_t thresh)
+{
+    uint8_t *scratch, *diff, *ring[3];
+
+    if (k == NULL || a == NULL || b == NULL || dst == NULL || width <= 0 || height <= 0)
+        return -1;
+
+    /* One difference row plus the horizontally eroded rows y - 1, y, y + 1.
+     * Thresholding before the erosion gives the same result as after it:
+     * both are monotonic, so min(t(d)) == t(min(d)). */
+    scratch = (uint8_t *)malloc((size_t)width * 4);
+    if (scratch == NULL)
+        return -1;
+    diff = scratch;
+    for (int32_t i = 0; i < 3; i++)
+        ring[i] = scratch + (size_t)width * (i + 1);
+
+    for (int32_t y = -1; y < height; y++) {
+        int32_t next = y + 1;
+
+        if (next < height) {
+            k->absdiff_row(a + (size_t)next * a_stride, b + (size_t)next * b_stride, diff, width, thresh);
+            k->morph_row(diff, ring[next % 3], width, 3, IVS_MORPH_ERODE);
+        }
+        if (y >= 0) {
+            const uint8_t *rows[3] = {
+                ring[(y > 0 ? y - 1 : 0) % 3],
+                ring[y % 3],
+                ring[(y + 1 < height ? y + 1 : y) % 3],
+            };
+
+            k->morph_column(rows, 3, dst + (size_t)y * dst_stride, width, IVS_MORPH_ERODE);
+        }
+    }
+
+    free(scratch);
+    return 0;
+}
+
+/* Erode / dilate entry points of the move filter engine (filter.c): a row
+ * filter over one row, and a column filter over a packed plane. Neither
+ * works in place. */
+void MorphRowFilter(const uint8_t *src, uint8_t *dst, int32_t width, int32_t ksize, int32_t op)
+{
+    if (src == NULL || dst == NULL || width <= 0 || ksize < 1 || ksize > IVS_MORPH_MAX_KSIZE)
+        return;
+    ivs_kernels()->morph_row(src, dst, width, ksize, op);
+}
+
+void MorphColumnFilter(const uint8_t *src, uint8_t *dst, int32_t width, int32_t height, int32_t ksize, int32_t op)
+{
+    const IvsKernels *k = ivs_kernels();
+    const uint8_t *rows[IVS_MORPH_MAX_KSIZE];
+    const int32_t anchor = ksize / 2;
+
+    if (src == NULL || dst == NULL || width <= 0 || height <= 0 || ksize < 1 || ksize > IVS_MORPH_MAX_KSIZE)
+        return;
+
+    for (int32_t y = 0; y < height; y++) {
+        for (int32_t j = 0; j < ksize; j++) {
+            int32_t sy = y - anchor + j;
+
+            sy = sy < 0 ? 0 : (sy >= height ? height - 1 : sy);
+            rows[j] = src + (size_t)sy * width;
+        }
+        k->morph_column(rows, ksize, dst + (size_t)y * width, width, op);
+    }
+}
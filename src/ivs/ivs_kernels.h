@@ -0,0 +1,66 @@
+/**
+ * IVS pixel kernels
+ *
+ * Block SAD, thresholded differences and erode / dilate filters used by
+ * the motion detection interfaces. Every kernel has a scalar and a 128-bit
+ * vector flavour behind one table; both flavours do the same integer math,
+ * so their output is bit-identical and the choice is only about speed.
+ */
+
+#ifndef IVS_KERNELS_H
+#define IVS_KERNELS_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    IVS_MORPH_ERODE  = 0,           /* Minimum over the window */
+    IVS_MORPH_DILATE = 1,           /* Maximum over the window */
+};
+
+typedef struct {
+    /* out[by * out_stride + bx] = sum of |a - b| over block (bx, by) of
+     * bsize x bsize pixels (8 or 16); partial blocks at the right and
+     * bottom edges are left out */
+    void (*sad_blocks)(const uint8_t *a, int32_t a_stride, const uint8_t *b, int32_t b_stride,
+                       int32_t width, int32_t height, int32_t bsize, uint16_t *out, int32_t out_stride);
+    /* Same with b == 0: block sums of a map */
+    void (*sum_blocks)(const uint8_t *src, int32_t stride, int32_t width, int32_t height,
+                       int32_t bsize, uint16_t *out, int32_t out_stride);
+    /* dst[i] = |a[i] - b[i]|, or 0 when that is below thresh */
+    void (*absdiff_row)(const uint8_t *a, const uint8_t *b, uint8_t *dst, int32_t n, int32_t thresh);
+    /* dst[x] = min / max of src[x - ksize / 2 .. x - ksize / 2 + ksize - 1],
+     * samples past either end replicating the edge; src != dst */
+    void (*morph_row)(const uint8_t *src, uint8_t *dst, int32_t width, int32_t ksize, int32_t op);
+    /* dst[x] = min / max of rows[0..ksize - 1][x] */
+    void (*morph_column)(const uint8_t *const *rows, int32_t ksize, uint8_t *dst, int32_t width, int32_t op);
+} IvsKernels;
+
+#define IVS_MORPH_MAX_KSIZE 31
+
+/* Vector kernels when this build has them and the CPU runs them */
+const IvsKernels *ivs_kernels(void);
+
+/* Force one flavour (benchmarks, the bit-exactness check and interfaces
+ * that probed the CPU themselves); simd without vector kernels in the
+ * build gives the scalar table */
+const IvsKernels *ivs_kernels_get(int32_t simd);
+
+/* 1 if ivs_kernels_get(1) runs real vector code in this build */
+int32_t ivs_kernels_has_simd(void);
+
+/* Motion map of two luma planes: the 3x3 erosion of their thresholded
+ * absolute difference, so isolated noisy pixels drop out. Edges are
+ * replicated. Returns 0, -1 on bad arguments or allocation failure. */
+int32_t ivs_diff_erode3(const IvsKernels *k, const uint8_t *a, int32_t a_stride,
+                        const uint8_t *b, int32_t b_stride, uint8_t *dst, int32_t dst_stride,
+                        int32_t width, int32_t height, int32_t thresh);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IVS_KERNELS_H */
@@ -0,0 +1,215 @@
+/**
+ * Shared IVS luma pyramid
+ *
+ * A slot holds the pyramid of one frame on one group. ivs_luma_begin()
+ * makes a slot the group's current one; only current slots are found by
+ * ivs_luma_acquire(), so a VBM frame that comes back from the pool with the
+ * same address never hits a stale pyramid. A slot is recycled once it is
+ * no longer current and its last reference is gone; level buffers are kept
+ * across reuse and only grow.
+ *
+ * The slot table lock is held only to look up and count references. A
+ * level is built under its slot's own lock, so two groups can build at the
+ * same time and interfaces asking for a level that is being built wait
+ * for it instead of building it again.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ivs_luma.h"
+
+typedef struct {
+    void *frame;                    /* VBM frame, NULL when the slot is free */
+    int32_t current;                /* Open for its group's latest frame */
+    int32_t refs;
+    uint32_t built;                 /* Bit per level */
+    IvsLumaPlane level[IVS_LUMA_LEVELS];
+    uint8_t *buf[IVS_LUMA_LEVELS];  /* Storage of levels 1.. */
+    size_t cap[IVS_LUMA_LEVELS];
+    pthread_mutex_t build_lock;
+} IvsLumaSlot;
+
+static IvsLumaSlot ivs_luma_slot[IVS_LUMA_SLOTS];
+static int32_t ivs_luma_cur[IVS_LUMA_GROUPS] = { -1, -1 };
+static pthread_mutex_t ivs_luma_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_once_t ivs_luma_once = PTHREAD_ONCE_INIT;
+static uint64_t ivs_luma_built;
+
+static void ivs_luma_init(void)
+{
+    for (int32_t i = 0; i < IVS_LUMA_SLOTS; i++) {
+        pthread_mutex_init(&ivs_luma_slot[i].build_lock, NULL);
+    }
+}
+
+/* Called with ivs_luma_lock held */
+static void ivs_luma_put(IvsLumaSlot *s)
+{
+    if (!s->current && s->refs == 0) {
+        s->frame = NULL;
+    }
+}
+
+int32_t ivs_luma_begin(int32_t grp, void *frame)
+{
+    int32_t width, height, idx = -1;
+    uint8_t *virt;
+
+    if (grp < 0 || grp >= IVS_LUMA_GROUPS || frame == NULL) {
+        return -1;
+    }
+    pthread_once(&ivs_luma_once, ivs_luma_init);
+
+    /* VBM frame: width at 0x08, height at 0x0c, luma at the virtual
+     * address at 0x1c, rows width bytes apart */
+    width = *(int32_t *)((char *)frame + 0x08);
+    height = *(int32_t *)((char *)frame + 0x0c);
+    virt = (uint8_t *)(uintptr_t)*(uint32_t *)((char *)frame + 0x1c);
+
+    pthread_mutex_lock(&ivs_luma_lock);
+    if (ivs_luma_cur[grp] >= 0) {
+        IvsLumaSlot *old = &ivs_luma_slot[ivs_luma_cur[grp]];
+
+        old->current = 0;
+        ivs_luma_put(old);
+        ivs_luma_cur[grp] = -1;
+    }
+    if (virt != NULL && width > 0 && height > 0) {
+        for (int32_t i = 0; i < IVS_LUMA_SLOTS; i++) {
+            if (ivs_luma_slot[i].frame == NULL) {
+                idx = i;
+                break;
+            }
+        }
+    }
+    if (idx >= 0) {
+        IvsLumaSlot *s = &ivs_luma_slot[idx];
+
+        s->frame = frame;
+        s->current = 1;
+        s->refs = 0;
+        s->built = 1;
+        s->level[0].data = virt;
+        s->level[0].width = width;
+        s->level[0].height = height;
+        s->level[0].stride = width;
+        ivs_luma_cur[grp] = idx;
+    }
+    pthread_mutex_unlock(&ivs_luma_lock);
+    return idx >= 0 ? 0 : -1;
+}
+
+/* Level n from level n - 1; called with the slot's build lock held */
+static int32_t ivs_luma_build(IvsLumaSlot *s, int32_t n)
+{
+    const IvsLumaPlane *src = &s->level[n - 1];
+    IvsLumaPlane *dst = &s->level[n];
+    int32_t w = src->width >> 1, h = src->height >> 1;
+    size_t size = (size_t)w * h;
+
+    if (w <= 0 || h <= 0) {
+        return -1;
+    }
+    if (s->cap[n] < size) {
+        uint8_t *p = (uint8_t *)realloc(s->buf[n], size);
+
+        if (p == NULL) {
+            return -1;
+        }
+        s->buf[n] = p;
+        s->cap[n] = size;
+    }
+
+    for (int32_t y = 0; y < h; y++) {
+        const uint8_t *sr = src->data + (size_t)(2 * y) * src->stride;
+        uint8_t *dr = s->buf[n] + (size_t)y * w;
+        int32_t x = 0;
+
+        for (; x + 4 <= w; x += 4) {
+            dr[x] = sr[2 * x];
+            dr[x + 1] = sr[2 * x + 2];
+            dr[x + 2] = sr[2 * x + 4];
+            dr[x + 3] = sr[2 * x + 6];
+        }
+        for (; x < w; x++) {
+            dr[x] = sr[2 * x];
+        }
+    }
+
+    dst->data = s->buf[n];
+    dst->width = w;
+    dst->height = h;
+    dst->stride = w;
+    __atomic_add_fetch(&ivs_luma_built, (uint64_t)size, __ATOMIC_RELAXED);
+    return 0;
+}
+
+const IvsLumaPlane *ivs_luma_acquire(void *frame, int32_t level)
+{
+    IvsLumaSlot *s = NULL;
+    int32_t ok = 0;
+
+    if (frame == NULL || level < 0 || level >= IVS_LUMA_LEVELS) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&ivs_luma_lock);
+    for (int32_t g = 0; g < IVS_LUMA_GROUPS; g++) {
+        if (ivs_luma_cur[g] >= 0 && ivs_luma_slot[ivs_luma_cur[g]].frame == frame) {
+            s = &ivs_luma_slot[ivs_luma_cur[g]];
+            s->refs++;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&ivs_luma_lock);
+    if (s == NULL) {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&s->build_lock);
+    for (int32_t n = 1; n <= level; n++) {
+        if (!(s->built & (1u << n))) {
+            if (ivs_luma_build(s, n) != 0) {
+                break;
+            }
+            s->built |= 1u << n;
+        }
+    }
+    ok = (s->built >> level) & 1;
+    pthread_mutex_unlock(&s->build_lock);
+
+    if (!ok) {
+        ivs_luma_release(&s->level[0]);
+        return NULL;
+    }
+    return &s->level[level];
+}
+
+void ivs_luma_release(const IvsLumaPlane *plane)
+{
+    if (plane == NULL) {
+        return;
+    }
+
+    pthread_mutex_lock(&ivs_luma_lock);
+    for (int32_t i = 0; i < IVS_LUMA_SLOTS; i++) {
+        IvsLumaSlot *s = &ivs_luma_slot[i];
+
+        if (plane >= &s->level[0] && plane < &s->level[IVS_LUMA_LEVELS]) {
+            if (s->refs > 0) {
+                s->refs--;
+            }
+            ivs_luma_put(s);
+            break;
+        }
+    }
+    pthread_mutex_unlock(&ivs_luma_lock);
+}
+
+uint64_t ivs_luma_built_pixels(void)
+{
+    return __atomic_load_n(&ivs_luma_built, __ATOMIC_RELAXED);
+}
@@ -0,0 +1,53 @@
+/**
+ * Shared IVS luma pyramid
+ *
+ * Every interface registered on an IVS group used to copy the frame's luma
+ * in preProcessSync and downscale it on its own. ivs_update now opens one
+ * pyramid per group and frame, and interfaces take the level they need
+ * from it: the first request builds a level, later ones on the same frame
+ * share it read-only. Level 0 is the frame's own luma plane; level n is a
+ * 2^n:1 decimation (dst[y][x] = src[2^n y][2^n x]), the sampling the move
+ * interface has always used.
+ */
+
+#ifndef IVS_LUMA_H
+#define IVS_LUMA_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IVS_LUMA_LEVELS 4           /* 1:1, 2:1, 4:1, 8:1 */
+#define IVS_LUMA_SLOTS  6           /* Pyramids alive at once, in flight included */
+#define IVS_LUMA_GROUPS 2
+
+typedef struct {
+    const uint8_t *data;
+    int32_t width;
+    int32_t height;
+    int32_t stride;
+} IvsLumaPlane;
+
+/* Start the pyramid of a new frame on group grp (ivs_update). The group's
+ * previous pyramid stays alive while references to it are held. Returns 0,
+ * or -1 when every slot is held; interfaces then fall back to copying. */
+int32_t ivs_luma_begin(int32_t grp, void *frame);
+
+/* Reference to level of the pyramid currently open for frame, built on
+ * first use. Level 0 points into the frame, so it is only valid while the
+ * caller holds the frame (ivs_update locks it for every channel it posts
+ * to); higher levels live until ivs_luma_release(). NULL when frame has no
+ * open pyramid or the level cannot be built. */
+const IvsLumaPlane *ivs_luma_acquire(void *frame, int32_t level);
+void ivs_luma_release(const IvsLumaPlane *plane);
+
+/* Pixels written building levels since start-up */
+uint64_t ivs_luma_built_pixels(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IVS_LUMA_H */
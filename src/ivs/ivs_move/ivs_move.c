@@ -4,6 +4,8 @@
 
 #include "imp/imp_ivs.h"
 #include "imp/imp_ivs_move.h"
+#include "ivs/ivs_luma.h"
+#include "ivs/ivs_result.h"
 
 int32_t IMP_Log_Get_Option(void); /* forward decl, ported by T<N> later */
 int32_t imp_log_fun(int32_t level, int32_t option, int32_t type, ...); /* forward decl, ported by T<N> later */
@@ -48,20 +50,15 @@ typedef struct MoveContext {
     uint8_t pad2c[0x14];
     void *filter_engine;
     void *resize_frame;
-    uint8_t pad48[8];
+    const IvsLumaPlane *luma;       /* Shared half-size luma of the pending frame, or NULL */
+    uint8_t pad4c[4];
 } MoveContext;
 
-typedef struct MoveResultRing {
-    int32_t read_idx;
-    int32_t write_idx;
-    int32_t results;
-} MoveResultRing;
-
 typedef struct MoveHandle {
     int32_t state;
     MoveContext *ctx;
     uint8_t param_storage[0x450];
-    MoveResultRing *result_ring;
+    IvsResultRing *result_ring;     /* IVS_RESULT_DEPTH results of 0xd0 bytes */
     int32_t (*release_data)(void *vaddr);
 } MoveHandle;
 
@@ -94,8 +91,26 @@ static void copy_u32_block(uint32_t *dst, const uint32_t *src, uint32_t words)
     } while (i != &src[words]);
 }
 
-int32_t MoveReleaseResult(void)
+int32_t MoveReleaseResult(IMPIVSMoveInterface *arg1, void *arg2)
 {
+    MoveHandle *a0_3 = *(MoveHandle **)((char *)arg1 + 0x30);
+    int32_t idx;
+
+    if (a0_3 == NULL) {
+        imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS_MOVE",
+            "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_move/src/ivs_move.c", 0xb3,
+            "MoveReleaseResult", "ivsMove is null\n", &_gp);
+        return -1;
+    }
+
+    idx = ivs_result_ring_index(a0_3->result_ring, arg2);
+    if (idx < 0 || ivs_result_ring_release(a0_3->result_ring, idx) != 0) {
+        imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS_MOVE",
+            "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_move/src/ivs_move.c", 0xb9,
+            "MoveReleaseResult", "result %p is not held\n", arg2, &_gp);
+        return -1;
+    }
+
     return 0;
 }
 
@@ -119,14 +134,13 @@ int32_t sub_d9670(IMPIVSMoveInterface *arg1, void *arg2, int32_t arg3, int32_t a
             "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_move/src/ivs_move.c", 0x8d,
             "MoveProcessAsync", "ivsMove is null\n", &_gp);
     } else {
-        MoveResultRing *v0 = *(MoveResultRing **)((char *)s1_3 + 0x458);
-        int32_t result_1 = imp_move_process(s1_3, arg2, v0->results + v0->write_idx * 0xd0);
+        /* Written in place; with every slot still held by the application
+         * this is the spare slot and the result is dropped, not overwritten */
+        void *slot = ivs_result_ring_claim(s1_3->result_ring);
+        int32_t result_1 = imp_move_process(s1_3, arg2, (int32_t)(intptr_t)slot);
 
         if (result_1 == 0) {
-            MoveResultRing *a1 = *(MoveResultRing **)((char *)s1_3 + 0x458);
-
-            a1->write_idx = (a1->write_idx + 1) % 6;
-            return 0;
+            return ivs_result_ring_commit(s1_3->result_ring, slot) ? 0 : 1;
         }
 
         result = result_1;
@@ -163,7 +177,7 @@ int32_t sub_d9830(IMPIVSMoveInterface *arg1, int32_t arg2, int32_t arg3, int32_t
     }
 
     {
-        MoveResultRing *v0 = *(MoveResultRing **)((char *)s0_3 + 0x458);
+        IvsResultRing *v0 = s0_3->result_ring;
 
         if (v0 == NULL) {
             imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS_MOVE",
@@ -171,17 +185,8 @@ int32_t sub_d9830(IMPIVSMoveInterface *arg1, int32_t arg2, int32_t arg3, int32_t
                 "MoveExit", "resultRing is null\n", &_gp);
             gp_4 = arg2;
         } else {
-            void *a0 = *(void **)((char *)v0 + 8);
-
-            if (a0 != NULL) {
-                free(a0);
-            } else {
-                imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS_MOVE",
-                    "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_move/src/ivs_move.c", 0x57,
-                    "MoveExit", "resultRing->results is null\n", &_gp);
-            }
-
-            free(*(void **)((char *)s0_3 + 0x458));
+            ivs_result_ring_destroy(v0);
+            s0_3->result_ring = NULL;
             {
                 imp_free_move(s0_3);
                 *(MoveHandle **)((char *)arg1 + 0x30) = NULL;
@@ -233,40 +238,18 @@ int32_t sub_d9a28(IMPIVSMoveInterface *arg1, IMPIVSMoveInterface *arg2, int32_t
             return -1;
         }
 
-        {
-            MoveResultRing *v0_1 = calloc(1, 0xc);
-
-            *(MoveResultRing **)((char *)v0 + 0x458) = v0_1;
-            if (v0_1 == NULL) {
-                imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS_MOVE",
-                    "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_move/src/ivs_move.c", 0x2a,
-                    "MoveInit", "malloc resultRing failed\n", &_gp);
-                free(*(void **)((char *)v0 + 0x458));
-                imp_free_move(v0);
-                *(MoveHandle **)((char *)arg2 + 0x30) = NULL;
-                return -1;
-            }
-
-            {
-                int32_t v0_2 = (int32_t)(intptr_t)calloc(6, 0xd0);
-
-                v0_1->results = v0_2;
-                if (v0_2 != 0) {
-                    v0_1->write_idx = 0;
-                    v0_1->read_idx = 0;
-                    *(MoveHandle **)((char *)arg2 + 0x30) = v0;
-                    (void)arg3;
-                    return 0;
-                }
-
-                imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS_MOVE",
-                    "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_move/src/ivs_move.c", 0x30,
-                    "MoveInit", "malloc resultRing->results failed\n", &_gp);
-                free(*(void **)((char *)v0 + 0x458));
-                imp_free_move(v0);
-                *(MoveHandle **)((char *)arg2 + 0x30) = NULL;
-            }
+        v0->result_ring = ivs_result_ring_create(IVS_RESULT_DEPTH, 0xd0);
+        if (v0->result_ring != NULL) {
+            *(MoveHandle **)((char *)arg2 + 0x30) = v0;
+            (void)arg3;
+            return 0;
         }
+
+        imp_log_fun(6, IMP_Log_Get_Option(), 2, "IVS_MOVE",
+            "/home/user/git/proj/sdk-lv3/src/imp/ivs/ivs_move/src/ivs_move.c", 0x2a,
+            "MoveInit", "malloc resultRing failed\n", &_gp);
+        imp_free_move(v0);
+        *(MoveHandle **)((char *)arg2 + 0x30) = NULL;
     }
 
     return -1;
@@ -292,11 +275,14 @@ int32_t sub_d9c8c(IMPIVSMoveInterface *arg1, int32_t *arg2, int32_t arg3)
     }
 
     {
-        MoveResultRing *v0 = *(MoveResultRing **)((char *)a2_1 + 0x458);
-        MoveResultRing *a2 = *(MoveResultRing **)((char *)a2_1 + 0x458);
+        void *v0 = ivs_result_ring_get(a2_1->result_ring, NULL);
+
+        /* Handed out by pointer and held until MoveReleaseResult */
+        if (v0 == NULL) {
+            return -1;
+        }
 
-        *arg2 = v0->results + v0->read_idx * 0xd0;
-        a2->read_idx = (a2->read_idx + 1) % 6;
+        *arg2 = (int32_t)(intptr_t)v0;
         return 0;
     }
 }
@@ -610,7 +596,7 @@ static int32_t reset_param_isra_0(int32_t *arg1, void **arg2, uint32_t *arg3, in
 MoveContext *IVSMove_init(int32_t arg1, int32_t arg2, int32_t *arg3, int32_t arg4, int32_t arg5)
 {
     int32_t arg_8 = (int32_t)(intptr_t)arg3;
-    void *v0_raw = calloc(1, 0x50);
+    void *v0_raw = calloc(1, sizeof(MoveContext));
     MoveContext *v0 = (MoveContext *)v0_raw;
 
     (void)arg_8;
@@ -947,13 +933,28 @@ int32_t resize(void *arg1, void *arg2, int32_t arg3, int32_t arg4, int32_t arg5)
     return result;
 }
 
+/* Fill the next ring frame: straight from the group's shared half-size
+ * luma when preprocess got it, else by decimating the private copy */
+static void move_load_frame(int32_t *arg1, int32_t arg3, int32_t dst)
+{
+    const IvsLumaPlane *half = ((MoveContext *)arg1)->luma;
+
+    if (half != NULL) {
+        for (int32_t y = 0; y < half->height; y++) {
+            memcpy((char *)(intptr_t)dst + y * half->width, half->data + y * half->stride, (size_t)half->width);
+        }
+        return;
+    }
+    resize(arg1, (void *)(intptr_t)arg3, dst, *arg1, arg1[1]);
+}
+
 int32_t update_mhi(int32_t *arg1, void *arg2, int32_t arg3, void *arg4)
 {
     int32_t v0 = arg1[2];
     int32_t t0 = arg1[4];
 
     if (t0 < v0 - 1) {
-        resize(arg1, (void *)(intptr_t)arg3, *(int32_t *)((char *)(intptr_t)arg1[3] + (t0 << 2)), *arg1, arg1[1]);
+        move_load_frame(arg1, arg3, *(int32_t *)((char *)(intptr_t)arg1[3] + (t0 << 2)));
         {
             int32_t a2_6 = arg1[5];
             int32_t v0_11 = arg1[4] + 1;
@@ -987,8 +988,7 @@ int32_t update_mhi(int32_t *arg1, void *arg2, int32_t arg3, void *arg4)
 
                 arg1[8] = v1_3;
                 if (a3_1 == 0) {
-                    resize(arg1, (void *)(intptr_t)arg3, *(int32_t *)((char *)(intptr_t)arg1[3] + (v1_3 << 2)),
-                        *arg1, arg1[1]);
+                    move_load_frame(arg1, arg3, *(int32_t *)((char *)(intptr_t)arg1[3] + (v1_3 << 2)));
                     {
                         int32_t v1_5 = arg1[4];
 
@@ -1133,6 +1133,9 @@ void imp_free_move(void *arg1)
         MoveContext *s1 = *(MoveContext **)((char *)arg1 + 4);
         void *a0 = *(void **)((char *)s1 + 0x44);
 
+        ivs_luma_release(s1->luma);
+        s1->luma = NULL;
+
         if (a0 != NULL) {
             free(a0);
             *(void **)((char *)s1 + 0x44) = NULL;
@@ -1192,8 +1195,17 @@ void imp_free_move(void *arg1)
 int32_t imp_move_preprocess(void *arg1, void *arg2)
 {
     void *var_10 = &_gp;
+    MoveContext *ctx = *(MoveContext **)((char *)arg1 + 4);
+    const IvsLumaPlane *half = ivs_luma_acquire(arg2, 1);
 
     (void)var_10;
+    ivs_luma_release(ctx->luma);
+    ctx->luma = NULL;
+    if (half != NULL && half->width == ctx->width && half->height == ctx->height) {
+        ctx->luma = half;
+        return 1;
+    }
+    ivs_luma_release(half);
     memcpy(*(void **)((char *)*(void **)((char *)arg1 + 4) + 0x44), *(void **)((char *)arg2 + 0x1c),
         (size_t)(*(int32_t *)((char *)arg2 + 8) * *(int32_t *)((char *)arg2 + 0xc)));
     return 1;
@@ -1220,7 +1232,12 @@ int32_t imp_move_process(void *arg1, void *arg2, int32_t arg3)
             int32_t *a0_1 = *(int32_t **)((char *)arg1 + 4);
 
             if (*(int32_t *)((char *)a0_1 + 0x18) == 0) {
-                return update_mhi(a0_1, arg1, *(int32_t *)((char *)a0_1 + 0x44), (void *)(intptr_t)arg3);
+                MoveContext *ctx = (MoveContext *)a0_1;
+                int32_t ret = update_mhi(a0_1, arg1, *(int32_t *)((char *)a0_1 + 0x44), (void *)(intptr_t)arg3);
+
+                ivs_luma_release(ctx->luma);
+                ctx->luma = NULL;
+                return ret;
             }
         }
 
@@ -0,0 +1,156 @@
+/**
+ * IVS result ring
+ *
+ * Three running counters split the ring: slots [released, read) are held
+ * by the application, [read, written) are queued and the rest is free for
+ * the writer. Releases that come out of order are parked in a bitmask and
+ * folded into released once the older slots are back.
+ *
+ * The counters run modulo twice the depth rather than 2^32, which no
+ * depth but a power of two divides: the slot is still the counter modulo
+ * depth across the wrap, and a full ring (distance depth) stays apart
+ * from an empty one (distance 0).
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "ivs_result.h"
+
+static uint32_t ring_next(const IvsResultRing *r, uint32_t c)
+{
+    return (c + 1) % (2u * (uint32_t)r->depth);
+}
+
+/* Entries from counter a up to counter b */
+static uint32_t ring_span(const IvsResultRing *r, uint32_t a, uint32_t b)
+{
+    return (b + 2u * (uint32_t)r->depth - a) % (2u * (uint32_t)r->depth);
+}
+
+IvsResultRing *ivs_result_ring_create(int32_t depth, int32_t size)
+{
+    IvsResultRing *r;
+
+    if (depth <= 0 || depth > 32 || size <= 0) {
+        return NULL;
+    }
+
+    r = (IvsResultRing *)calloc(1, sizeof(*r));
+    if (r == NULL) {
+        return NULL;
+    }
+
+    r->slots = (uint8_t *)calloc((size_t)depth + 1, (size_t)size);
+    if (r->slots == NULL) {
+        free(r);
+        return NULL;
+    }
+
+    r->size = size;
+    r->depth = depth;
+    pthread_mutex_init(&r->lock, NULL);
+    return r;
+}
+
+void ivs_result_ring_destroy(IvsResultRing *r)
+{
+    if (r == NULL) {
+        return;
+    }
+
+    pthread_mutex_destroy(&r->lock);
+    free(r->slots);
+    free(r);
+}
+
+void *ivs_result_ring_slot(IvsResultRing *r, int32_t i)
+{
+    if (r == NULL || i < 0 || i > r->depth) {
+        return NULL;
+    }
+
+    return r->slots + (size_t)i * r->size;
+}
+
+void *ivs_result_ring_claim(IvsResultRing *r)
+{
+    int32_t i;
+
+    /* Only the writer moves written, so the slot cannot change between
+     * here and commit; a release in between only frees more room */
+    pthread_mutex_lock(&r->lock);
+    i = ring_span(r, r->released, r->written) < (uint32_t)r->depth
+        ? (int32_t)(r->written % (uint32_t)r->depth) : r->depth;
+    pthread_mutex_unlock(&r->lock);
+    return r->slots + (size_t)i * r->size;
+}
+
+int32_t ivs_result_ring_commit(IvsResultRing *r, void *slot)
+{
+    int32_t queued = 0;
+
+    pthread_mutex_lock(&r->lock);
+    if (slot == r->slots + (size_t)(r->written % (uint32_t)r->depth) * r->size &&
+        ring_span(r, r->released, r->written) < (uint32_t)r->depth) {
+        r->written = ring_next(r, r->written);
+        queued = 1;
+    }
+    pthread_mutex_unlock(&r->lock);
+    return queued;
+}
+
+void *ivs_result_ring_get(IvsResultRing *r, int32_t *index)
+{
+    void *result = NULL;
+
+    pthread_mutex_lock(&r->lock);
+    if (r->read != r->written) {
+        int32_t i = (int32_t)(r->read % (uint32_t)r->depth);
+
+        result = r->slots + (size_t)i * r->size;
+        r->read = ring_next(r, r->read);
+        if (index != NULL) {
+            *index = i;
+        }
+    }
+    pthread_mutex_unlock(&r->lock);
+    return result;
+}
+
+int32_t ivs_result_ring_release(IvsResultRing *r, int32_t index)
+{
+    int32_t ret = -1;
+
+    if (index < 0 || index >= r->depth) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&r->lock);
+    /* Only a slot that is handed out can come back */
+    if ((uint32_t)((index - (int32_t)(r->released % (uint32_t)r->depth) + r->depth) % r->depth) <
+            ring_span(r, r->released, r->read) &&
+        !(r->done & (1u << index))) {
+        r->done |= 1u << index;
+        while (r->released != r->read && (r->done & (1u << (r->released % (uint32_t)r->depth)))) {
+            r->done &= ~(1u << (r->released % (uint32_t)r->depth));
+            r->released = ring_next(r, r->released);
+        }
+        ret = 0;
+    }
+    pthread_mutex_unlock(&r->lock);
+    return ret;
+}
+
+int32_t ivs_result_ring_index(const IvsResultRing *r, const void *result)
+{
+    const uint8_t *p = (const uint8_t *)result;
+
+    if (r == NULL || p < r->slots || p >= r->slots + (size_t)r->depth * r->size ||
+        (size_t)(p - r->slots) % r->size != 0) {
+        return -1;
+    }
+
+    return (int32_t)((size_t)(p - r->slots) / r->size);
+}
@@ -0,0 +1,62 @@
+/**
+ * IVS result ring
+ *
+ * Fixed-size per-channel result storage shared by the IVS interfaces.
+ * processAsync writes a result in place into the slot it claims and
+ * commits it; getResult hands the oldest committed slot to the application
+ * by pointer, and releaseResult gives it back by its slot index. A slot is
+ * reused only once it has been released, so a slow reader never sees a
+ * result change under it: when every slot is taken the writer gets a spare
+ * slot instead and its result is dropped at commit.
+ */
+
+#ifndef IVS_RESULT_H
+#define IVS_RESULT_H
+
+#include <pthread.h>
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IVS_RESULT_DEPTH 6          /* Slots per channel */
+
+typedef struct {
+    uint8_t *slots;                 /* depth + 1 slots, the last one spare */
+    int32_t size;                   /* Bytes per slot */
+    int32_t depth;
+    uint32_t written;               /* Results committed, modulo 2 * depth */
+    uint32_t read;                  /* Results handed out, modulo 2 * depth */
+    uint32_t released;              /* Oldest slot not yet released, modulo 2 * depth */
+    uint32_t done;                  /* Bit per slot released out of order */
+    pthread_mutex_t lock;
+} IvsResultRing;
+
+IvsResultRing *ivs_result_ring_create(int32_t depth, int32_t size);
+void ivs_result_ring_destroy(IvsResultRing *r);
+
+/* Slot i of the ring, spare included (0 <= i <= depth); for interfaces
+ * that hang buffers off their result headers */
+void *ivs_result_ring_slot(IvsResultRing *r, int32_t i);
+
+/* Writer side: the slot to write the next result into, never NULL, then
+ * publish it. Commit returns 1 when the result was queued, 0 when it was
+ * written to the spare slot and dropped. */
+void *ivs_result_ring_claim(IvsResultRing *r);
+int32_t ivs_result_ring_commit(IvsResultRing *r, void *slot);
+
+/* Reader side: oldest queued result, NULL when there is none; index gets
+ * its slot index. Release takes that index and may come in any order. */
+void *ivs_result_ring_get(IvsResultRing *r, int32_t *index);
+int32_t ivs_result_ring_release(IvsResultRing *r, int32_t index);
+
+/* Slot index of a result returned by ivs_result_ring_get(), -1 if it is
+ * not one of the ring's slots */
+int32_t ivs_result_ring_index(const IvsResultRing *r, const void *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IVS_RESULT_H */
@@ -0,0 +1,368 @@
+/**
+ * IVS analysis scheduler
+ *
+ * Each channel has at most one job queued and one frame in flight: the
+ * frame source holds a channel busy from admit until its job has run, so
+ * the queue never holds more than one entry per channel and a plain FIFO
+ * of channel numbers is enough.
+ *
+ * A channel that is merely slow is throttled by that busy gate alone. The
+ * pool being short of CPU shows up as queueing instead: a job that waited
+ * more than half its budget, or was dropped as late, stretches the
+ * channel's back-off interval, and jobs that start promptly shrink it
+ * again. Every channel queueing behind the others backs off this way, so
+ * the load settles where the pool keeps up rather than one channel being
+ * starved by the rest.
+ */
+
+#include <pthread.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/prctl.h>
+#include <time.h>
+#include <unistd.h>
+
+#include "ivs_sched.h"
+
+typedef struct {
+    IvsSchedAttr attr;
+    IvsSchedStat stat;
+    uint64_t next_due_us;           /* Earliest arrival the rate takes next */
+    uint64_t backoff_us;            /* Extra interval while the pool is behind */
+    uint64_t submit_us;
+    uint64_t win_start_us;          /* Achieved rate window */
+    uint32_t win_count;
+    int32_t queued;
+} IvsSchedChn;
+
+static struct {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t worker[IVS_SCHED_MAX_WORKER];
+    int32_t workers;
+    int32_t running;
+    IvsSchedRun run;
+    int32_t queue[IVS_SCHED_MAX_CHN];
+    int32_t head;
+    int32_t count;
+    IvsSchedChn chn[IVS_SCHED_MAX_CHN];
+} sched = {
+    .lock = PTHREAD_MUTEX_INITIALIZER,
+    .cond = PTHREAD_COND_INITIALIZER,
+};
+
+uint64_t ivs_sched_now_us(void)
+{
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000ULL + (uint64_t)ts.tv_nsec / 1000ULL;
+}
+
+static uint64_t budget_us(const IvsSchedChn *c)
+{
+    return (uint64_t)(c->attr.budget_ms > 0 ? c->attr.budget_ms : IVS_SCHED_BUDGET_MS) * 1000ULL;
+}
+
+#define IVS_SCHED_MAX_BACKOFF_US 1000000ULL
+
+static void account(IvsSchedChn *c, int32_t late, uint64_t start, uint64_t now)
+{
+    uint32_t sample = (uint32_t)(now - c->submit_us);
+    uint64_t budget = budget_us(c);
+
+    c->stat.latency_us = c->stat.latency_us == 0 ? sample
+        : c->stat.latency_us - c->stat.latency_us / 8 + sample / 8;
+
+    if (late || start - c->submit_us > budget / 2) {
+        c->backoff_us = c->backoff_us == 0 ? budget / 2 : c->backoff_us + c->backoff_us / 2;
+        if (c->backoff_us > IVS_SCHED_MAX_BACKOFF_US) {
+            c->backoff_us = IVS_SCHED_MAX_BACKOFF_US;
+        }
+    } else if (c->backoff_us != 0) {
+        c->backoff_us -= c->backoff_us / 4;
+        if (c->backoff_us < 1000) {
+            c->backoff_us = 0;
+        }
+    }
+
+    if (late) {
+        c->stat.skip_late++;
+        return;
+    }
+
+    c->stat.analysed++;
+    c->win_count++;
+    if (c->win_start_us == 0) {
+        c->win_start_us = c->submit_us;
+    }
+    if (now - c->win_start_us >= 1000000ULL) {
+        c->stat.fps_x100 = (uint32_t)((uint64_t)c->win_count * 100000000ULL / (now - c->win_start_us));
+        c->win_start_us = now;
+        c->win_count = 0;
+    }
+}
+
+static void *sched_worker(void *arg)
+{
+    char name[16];
+
+    snprintf(name, sizeof(name), "IVS-worker%d", (int)(intptr_t)arg);
+    prctl(PR_SET_NAME, (unsigned long)name, 0UL, 0UL, 0UL);
+
+    pthread_mutex_lock(&sched.lock);
+    while (1) {
+        int32_t chn, late;
+        uint64_t start, now;
+
+        while (sched.running && sched.count == 0) {
+            pthread_cond_wait(&sched.cond, &sched.lock);
+        }
+        if (!sched.running) {
+            break;
+        }
+
+        chn = sched.queue[sched.head];
+        sched.head = (sched.head + 1) % IVS_SCHED_MAX_CHN;
+        sched.count--;
+        sched.chn[chn].queued = 0;
+        start = ivs_sched_now_us();
+        late = start - sched.chn[chn].submit_us > budget_us(&sched.chn[chn]);
+
+        pthread_mutex_unlock(&sched.lock);
+        sched.run(chn, late);
+        now = ivs_sched_now_us();
+        pthread_mutex_lock(&sched.lock);
+
+        account(&sched.chn[chn], late, start, now);
+    }
+    pthread_mutex_unlock(&sched.lock);
+    return NULL;
+}
+
+int32_t ivs_sched_start(int32_t workers, IvsSchedRun run)
+{
+    int32_t ret = 0;
+
+    if (run == NULL) {
+        return -1;
+    }
+
+    if (workers <= 0) {
+        long ncpu = sysconf(_SC_NPROCESSORS_ONLN);
+
+        /* Two at least, so one slow interface cannot hold up the rest */
+        workers = ncpu < 2 ? 2 : (int32_t)ncpu;
+    }
+    if (workers > IVS_SCHED_MAX_WORKER) {
+        workers = IVS_SCHED_MAX_WORKER;
+    }
+
+    pthread_mutex_lock(&sched.lock);
+    if (sched.running) {
+        pthread_mutex_unlock(&sched.lock);
+        return 0;
+    }
+
+    sched.run = run;
+    sched.running = 1;
+    sched.head = 0;
+    sched.count = 0;
+    for (sched.workers = 0; sched.workers < workers; sched.workers++) {
+        if (pthread_create(&sched.worker[sched.workers], NULL, sched_worker,
+                           (void *)(intptr_t)sched.workers) != 0) {
+            break;
+        }
+    }
+    if (sched.workers == 0) {
+        sched.running = 0;
+        ret = -1;
+    }
+    pthread_mutex_unlock(&sched.lock);
+    return ret;
+}
+
+void ivs_sched_stop(void)
+{
+    int32_t n;
+
+    pthread_mutex_lock(&sched.lock);
+    if (!sched.running) {
+        pthread_mutex_unlock(&sched.lock);
+        return;
+    }
+    sched.running = 0;
+    n = sched.workers;
+    pthread_cond_broadcast(&sched.cond);
+    pthread_mutex_unlock(&sched.lock);
+
+    for (int32_t i = 0; i < n; i++) {
+        pthread_join(sched.worker[i], NULL);
+    }
+
+    /* Each queued job holds its frame locked and its channel busy: hand
+     * them to the callback as late so it releases both */
+    pthread_mutex_lock(&sched.lock);
+    while (sched.count > 0) {
+        int32_t chn = sched.queue[sched.head];
+
+        sched.head = (sched.head + 1) % IVS_SCHED_MAX_CHN;
+        sched.count--;
+        sched.chn[chn].queued = 0;
+        sched.chn[chn].stat.skip_late++;
+
+        pthread_mutex_unlock(&sched.lock);
+        sched.run(chn, 1);
+        pthread_mutex_lock(&sched.lock);
+    }
+    sched.workers = 0;
+    pthread_mutex_unlock(&sched.lock);
+}
+
+void ivs_sched_reset(int32_t chn)
+{
+    if (chn < 0 || chn >= IVS_SCHED_MAX_CHN) {
+        return;
+    }
+
+    pthread_mutex_lock(&sched.lock);
+    memset(&sched.chn[chn], 0, sizeof(sched.chn[chn]));
+    pthread_mutex_unlock(&sched.lock);
+}
+
+int32_t ivs_sched_set_attr(int32_t chn, const IvsSchedAttr *attr)
+{
+    if (chn < 0 || chn >= IVS_SCHED_MAX_CHN || attr == NULL ||
+        attr->target_fps < 0 || attr->budget_ms < 0) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&sched.lock);
+    sched.chn[chn].attr = *attr;
+    sched.chn[chn].next_due_us = 0;
+    pthread_mutex_unlock(&sched.lock);
+    return 0;
+}
+
+int32_t ivs_sched_get_attr(int32_t chn, IvsSchedAttr *attr)
+{
+    if (chn < 0 || chn >= IVS_SCHED_MAX_CHN || attr == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&sched.lock);
+    *attr = sched.chn[chn].attr;
+    pthread_mutex_unlock(&sched.lock);
+    return 0;
+}
+
+int32_t ivs_sched_get_stat(int32_t chn, IvsSchedStat *stat)
+{
+    if (chn < 0 || chn >= IVS_SCHED_MAX_CHN || stat == NULL) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&sched.lock);
+    *stat = sched.chn[chn].stat;
+    /* Nothing analysed for two windows: the last rate no longer holds */
+    if (sched.chn[chn].win_start_us != 0 &&
+        ivs_sched_now_us() - sched.chn[chn].win_start_us >= 2000000ULL) {
+        stat->fps_x100 = 0;
+    }
+    pthread_mutex_unlock(&sched.lock);
+    return 0;
+}
+
+int32_t ivs_sched_admit(int32_t chn, int32_t busy)
+{
+    IvsSchedChn *c;
+    uint64_t now, interval;
+    int32_t backoff = 0;
+
+    if (chn < 0 || chn >= IVS_SCHED_MAX_CHN) {
+        return 0;
+    }
+
+    c = &sched.chn[chn];
+    now = ivs_sched_now_us();
+    pthread_mutex_lock(&sched.lock);
+
+    if (busy) {
+        c->stat.skip_load++;
+        pthread_mutex_unlock(&sched.lock);
+        return 0;
+    }
+
+    interval = c->attr.target_fps > 0 ? 1000000ULL / (uint64_t)c->attr.target_fps : 0;
+    if (c->backoff_us > interval) {
+        interval = c->backoff_us;
+        backoff = 1;
+    }
+
+    if (interval != 0 && c->next_due_us != 0 && now < c->next_due_us) {
+        if (backoff) {
+            c->stat.skip_load++;
+        } else {
+            c->stat.skip_rate++;
+        }
+        pthread_mutex_unlock(&sched.lock);
+        return 0;
+    }
+
+    /* Keep the average on target across frame-time jitter, but do not
+     * bank credit after falling behind */
+    c->next_due_us = c->next_due_us == 0 || now - c->next_due_us >= interval
+        ? now + interval : c->next_due_us + interval;
+    pthread_mutex_unlock(&sched.lock);
+    return 1;
+}
+
+int32_t ivs_sched_submit(int32_t chn)
+{
+    if (chn < 0 || chn >= IVS_SCHED_MAX_CHN) {
+        return -1;
+    }
+
+    pthread_mutex_lock(&sched.lock);
+    if (!sched.running || sched.chn[chn].queued) {
+        pthread_mutex_unlock(&sched.lock);
+        return -1;
+    }
+
+    sched.chn[chn].queued = 1;
+    sched.chn[chn].submit_us = ivs_sched_now_us();
+    sched.queue[(sched.head + sched.count) % IVS_SCHED_MAX_CHN] = chn;
+    sched.count++;
+    pthread_cond_signal(&sched.cond);
+    pthread_mutex_unlock(&sched.lock);
+    return 0;
+}
+
+int32_t ivs_sched_cancel(int32_t chn)
+{
+    int32_t found = 0;
+
+    if (chn < 0 || chn >= IVS_SCHED_MAX_CHN) {
+        return 0;
+    }
+
+    pthread_mutex_lock(&sched.lock);
+    if (sched.chn[chn].queued) {
+        int32_t out = 0;
+
+        /* Close the gap so the FIFO stays contiguous */
+        for (int32_t i = 0; i < sched.count; i++) {
+            int32_t v = sched.queue[(sched.head + i) % IVS_SCHED_MAX_CHN];
+
+            if (v != chn) {
+                sched.queue[(sched.head + out++) % IVS_SCHED_MAX_CHN] = v;
+            }
+        }
+        sched.count = out;
+        sched.chn[chn].queued = 0;
+        found = 1;
+    }
+    pthread_mutex_unlock(&sched.lock);
+    return found;
+}
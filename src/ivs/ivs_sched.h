@@ -0,0 +1,74 @@
+/**
+ * IVS analysis scheduler
+ *
+ * One worker pool shared by every IVS channel instead of a thread per
+ * channel. The frame source asks ivs_sched_admit() whether a channel takes
+ * the frame at all: frames are skipped to hold the channel's target
+ * analysis rate, and when the channel's smoothed latency runs past its
+ * budget the rate backs off to what the channel actually sustains. Jobs
+ * still queued past the budget are handed to the run callback as late so
+ * the caller can drop them and release their frame at once rather than
+ * analyse stale pictures while holding frame locks.
+ */
+
+#ifndef IVS_SCHED_H
+#define IVS_SCHED_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define IVS_SCHED_MAX_CHN    0x41
+#define IVS_SCHED_MAX_WORKER 4
+#define IVS_SCHED_BUDGET_MS  200    /* Latency budget when none is set */
+
+typedef struct {
+    int32_t target_fps;             /* Analysis rate, 0 for every frame */
+    int32_t budget_ms;              /* Queue + processing budget, 0 for the default */
+} IvsSchedAttr;
+
+typedef struct {
+    uint32_t analysed;              /* Frames handed to the interface */
+    uint32_t skip_rate;             /* Not taken to hold the target rate */
+    uint32_t skip_load;             /* Not taken: channel busy or backing off */
+    uint32_t skip_late;             /* Dropped as late: past the budget, or at stop */
+    uint32_t fps_x100;              /* Achieved analysis rate, last window */
+    uint32_t latency_us;            /* Smoothed queue + processing time */
+} IvsSchedStat;
+
+/* Runs one job of channel chn on a worker; late asks to drop the frame */
+typedef void (*IvsSchedRun)(int32_t chn, int32_t late);
+
+/* Start / stop the pool; workers <= 0 picks one per CPU, at least two.
+ * Start is a no-op while the pool runs. Stop hands jobs still queued to
+ * the run callback as late, on the calling thread, after the workers exit. */
+int32_t ivs_sched_start(int32_t workers, IvsSchedRun run);
+void ivs_sched_stop(void);
+
+/* Channel setup; reset clears attributes and counters */
+void ivs_sched_reset(int32_t chn);
+int32_t ivs_sched_set_attr(int32_t chn, const IvsSchedAttr *attr);
+int32_t ivs_sched_get_attr(int32_t chn, IvsSchedAttr *attr);
+int32_t ivs_sched_get_stat(int32_t chn, IvsSchedStat *stat);
+
+/* Frame source side: 1 if chn takes a frame arriving now, 0 to skip it.
+ * busy says the channel is still on its previous frame. */
+int32_t ivs_sched_admit(int32_t chn, int32_t busy);
+
+/* Queue a job for chn, stamped now */
+int32_t ivs_sched_submit(int32_t chn);
+
+/* Take chn's queued job back; 1 if there was one, its frame is the
+ * caller's to release. A job already running is not affected. */
+int32_t ivs_sched_cancel(int32_t chn);
+
+/* Monotonic clock in microseconds */
+uint64_t ivs_sched_now_us(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* IVS_SCHED_H */
@@ -16,6 +16,7 @@
 #include <time.h>
 #include <stdarg.h>
 #include "dma_alloc.h"
+#include "kernel_interface.h"
 
 static void ki_trace(const char *fmt, ...)
 {
@@ -31,23 +32,6 @@ static void ki_trace(const char *fmt, ...)
     close(fd);
 }
 
-struct fs_poll_wait {
-    int fd;
-    uint32_t ready;
-    int ret;
-    int err;
-    int done;
-    pthread_mutex_t lock;
-    pthread_cond_t cond;
-};
-
-static long long ki_mono_ms(void)
-{
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-    return (long long)now.tv_sec * 1000LL + (long long)now.tv_nsec / 1000000LL;
-}
-
 static void ki_timespec_add_ms(struct timespec *ts, long ms)
 {
     ts->tv_sec += ms / 1000;
@@ -58,21 +42,6 @@ static void ki_timespec_add_ms(struct timespec *ts, long ms)
     }
 }
 
-static void *fs_poll_worker(void *arg)
-{
-    struct fs_poll_wait *wait = (struct fs_poll_wait *)arg;
-    int ret = ioctl(wait->fd, 0x400456bf, &wait->ready);
-    int err = errno;
-
-    pthread_mutex_lock(&wait->lock);
-    wait->ret = ret;
-    wait->err = err;
-    wait->done = 1;
-    pthread_cond_signal(&wait->cond);
-    pthread_mutex_unlock(&wait->lock);
-    return NULL;
-}
-
 /* ioctl command definitions from decompilation */
 
 /* FrameSource ioctl commands */
@@ -96,45 +65,6 @@ static void *fs_poll_worker(void *arg)
 #define ISP_INIT            0x50000000  /* Placeholder */
 #define ISP_SET_SENSOR      0x50000001  /* Placeholder */
 
-/* High-level userspace format description used by openimp callers.
- * The raw ioctl payload is marshaled separately below. */
-typedef struct {
-    /* V4L2 standard header */
-    int type;                   /* 0x00: Buffer type (V4L2_BUF_TYPE_VIDEO_CAPTURE = 1) */
-    /* V4L2 pix format */
-    int width;                  /* 0x04: Width */
-    int height;                 /* 0x08: Height */
-    int pixelformat;            /* 0x0c: Pixel format (fourcc) */
-    int field;                  /* 0x10: Field order */
-    int bytesperline;           /* 0x14: Bytes per line */
-    int sizeimage;              /* 0x18: Image size in bytes */
-    int colorspace;             /* 0x1c: Colorspace (V4L2_COLORSPACE_SRGB = 8) */
-    int priv;                   /* 0x20: Private data */
-    /* Ingenic imp_channel_attr in raw_data area (starting at 0x24)
-     * Must match tisp_channel_attr_set indices:
-     *   [0]=enable, [1]=width, [2]=height,
-     *   [3]=crop_enable, [4]=crop_x, [5]=crop_y, [6]=crop_width, [7]=crop_height,
-     *   [8]=scaler_enable, [9]=scaler_outwidth, [10]=scaler_outheight,
-     *   [11]=picwidth, [12]=picheight, [13]=fps_num, [14]=fps_den
-     * Note: pixel format is conveyed via V4L2 pixelformat header field. */
-    int enable;                 /* 0x24: Enable (arg2[0]) */
-    int attr_width;             /* 0x28: Width (arg2[1]) */
-    int attr_height;            /* 0x2c: Height (arg2[2]) */
-    int crop_enable;            /* 0x30: Crop enable (arg2[3]) */
-    int crop_x;                 /* 0x34: Crop X (arg2[4]) */
-    int crop_y;                 /* 0x38: Crop Y (arg2[5]) */
-    int crop_width;             /* 0x3c: Crop width (arg2[6]) */
-    int crop_height;            /* 0x40: Crop height (arg2[7]) */
-    int scaler_enable;          /* 0x44: Scaler enable (arg2[8]) */
-    int scaler_outwidth;        /* 0x48: Scaler output width (arg2[9]) */
-    int scaler_outheight;       /* 0x4c: Scaler output height (arg2[10]) */
-    int picwidth;               /* 0x50: Picture width (arg2[11]) */
-    int picheight;              /* 0x54: Picture height (arg2[12]) */
-    int fps_num;                /* 0x58: FPS numerator (arg2[13]) */
-    int fps_den;                /* 0x5c: FPS denominator (arg2[14]) */
-    char padding[0x68];         /* 0x60-0xc7: Padding to 200 bytes */
-} fs_format_t;
-
 /* open-tx-isp expects struct frame_image_format (0x70 bytes), not the older
  * attr-slice layout that OEM libimp uses on other stacks.  Keep the ABI-local
  * ioctl struct here so callers can continue to use fs_format_t unchanged. */
@@ -514,77 +444,321 @@ int fs_stream_off(int fd) {
     return 0;
 }
 
-int fs_poll_frame(int fd, unsigned int *ready_out)
-{
-    struct fs_poll_wait wait = {
-        .fd = fd,
-        .ready = 0xffffffffu,
-        .ret = -1,
-        .err = 0,
-        .done = 0,
-        .lock = PTHREAD_MUTEX_INITIALIZER,
-        .cond = PTHREAD_COND_INITIALIZER,
-    };
+/* Persistent POLL_FRAME waiter.
+ *
+ * The OEM frame-ready ioctl blocks inside the driver, so it has to run on a
+ * thread other than the capture thread if we want a bounded wait.  Instead
+ * of creating a thread per call, each framechan fd gets one long-lived
+ * worker.  Callers post a request (req_seq), the worker runs the ioctl and
+ * publishes the result (done_seq).  A caller that times out leaves the
+ * ioctl in flight; the next call on the same fd picks up that result rather
+ * than issuing a second ioctl.
+ *
+ * Lifetime is refcounted: the registry, the worker thread and every caller
+ * currently inside fs_poll_frame_timeout() hold a reference.
+ */
+#define FS_POLL_MAX_WORKERS        8
+#define FS_POLL_DEFAULT_TIMEOUT_MS 1000
+
+typedef struct fs_poller {
+    int fd;
+    int refs;
+    int stop;
+    int cancel_gen;             /* bumped by fs_poll_cancel() */
+    uint32_t req_seq;           /* last request posted */
+    uint32_t done_seq;          /* last request completed by the worker */
+    uint32_t taken_seq;         /* last result handed to a caller */
+    uint32_t ready;
+    int ret;
+    int err;
+    long long req_start_us;
+    fs_poll_stats_t stats;
     pthread_t tid;
-    int create_ret;
-    struct timespec ts;
-    long long start_ms;
-    long long last_log_ms = 0;
+    pthread_mutex_t lock;
+    pthread_cond_t req_cond;    /* worker waits here for requests */
+    pthread_cond_t done_cond;   /* callers wait here for results */
+} fs_poller_t;
 
-    if (fd < 0)
-        return -1;
+static fs_poller_t *g_fs_pollers[FS_POLL_MAX_WORKERS];
+static pthread_mutex_t g_fs_pollers_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static long long ki_mono_us(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (long long)now.tv_sec * 1000000LL + (long long)now.tv_nsec / 1000LL;
+}
+
+/* Caller must hold p->lock; drops it before freeing. */
+static void fs_poller_unref_locked(fs_poller_t *p)
+{
+    int last = (--p->refs == 0);
+    pthread_mutex_unlock(&p->lock);
+    if (last) {
+        pthread_cond_destroy(&p->req_cond);
+        pthread_cond_destroy(&p->done_cond);
+        pthread_mutex_destroy(&p->lock);
+        free(p);
+    }
+}
+
+static void *fs_poll_worker(void *arg)
+{
+    fs_poller_t *p = (fs_poller_t *)arg;
+
+    pthread_mutex_lock(&p->lock);
+    for (;;) {
+        while (!p->stop && p->done_seq == p->req_seq)
+            pthread_cond_wait(&p->req_cond, &p->lock);
+        if (p->stop)
+            break;
+
+        uint32_t seq = p->req_seq;
+        int fd = p->fd;
+        pthread_mutex_unlock(&p->lock);
 
-    create_ret = pthread_create(&tid, NULL, fs_poll_worker, &wait);
-    if (create_ret != 0) {
         uint32_t ready = 0xffffffffu;
         int ret = ioctl(fd, VIDIOC_POLL_FRAME, &ready);
-        if (ret < 0) {
-            if (errno == EINTR)
-                return -2;
-            fprintf(stderr, "[KernelIF] POLL_FRAME failed: fd=%d %s\n", fd, strerror(errno));
-            return -1;
+        int err = errno;
+        long long end_us = ki_mono_us();
+
+        pthread_mutex_lock(&p->lock);
+        long long wait_us = end_us - p->req_start_us;
+        p->ready = ready;
+        p->ret = ret;
+        p->err = err;
+        p->done_seq = seq;
+        p->stats.ioctls++;
+        p->stats.wait_total_us += (uint64_t)wait_us;
+        if ((uint64_t)wait_us > p->stats.wait_max_us)
+            p->stats.wait_max_us = (uint64_t)wait_us;
+        pthread_cond_broadcast(&p->done_cond);
+    }
+    fs_poller_unref_locked(p);
+    return NULL;
+}
+
+/* Returns a referenced poller for fd, creating the worker on first use when
+ * create is set. NULL if none exists or no worker could be started (the
+ * poll path then falls back to a direct ioctl). */
+static fs_poller_t *fs_poller_get(int fd, int create)
+{
+    fs_poller_t *p = NULL;
+    int free_slot = -1;
+
+    pthread_mutex_lock(&g_fs_pollers_lock);
+    for (int i = 0; i < FS_POLL_MAX_WORKERS; i++) {
+        if (g_fs_pollers[i] == NULL) {
+            if (free_slot < 0)
+                free_slot = i;
+        } else if (g_fs_pollers[i]->fd == fd) {
+            p = g_fs_pollers[i];
+            break;
         }
-        if (ready_out)
-            *ready_out = ready;
-        return 0;
     }
 
-    start_ms = ki_mono_ms();
-    ki_trace("libimp/KI: POLL_FRAME enter fd=%d\n", fd);
-
-    pthread_mutex_lock(&wait.lock);
-    while (!wait.done) {
-        clock_gettime(CLOCK_REALTIME, &ts);
-        ki_timespec_add_ms(&ts, 10);
-        if (pthread_cond_timedwait(&wait.cond, &wait.lock, &ts) == ETIMEDOUT) {
-            long long elapsed_ms = ki_mono_ms() - start_ms;
-            if (elapsed_ms >= 10 && elapsed_ms - last_log_ms >= 100) {
-                ki_trace("libimp/KI: POLL_FRAME still-waiting fd=%d elapsed_ms=%lld\n",
-                         fd, elapsed_ms);
-                last_log_ms = elapsed_ms;
+    if (p == NULL && create && free_slot >= 0) {
+        p = (fs_poller_t *)calloc(1, sizeof(*p));
+        if (p != NULL) {
+            p->fd = fd;
+            p->refs = 2; /* registry + worker */
+            pthread_mutex_init(&p->lock, NULL);
+            pthread_cond_init(&p->req_cond, NULL);
+            pthread_cond_init(&p->done_cond, NULL);
+            if (pthread_create(&p->tid, NULL, fs_poll_worker, p) != 0) {
+                pthread_cond_destroy(&p->req_cond);
+                pthread_cond_destroy(&p->done_cond);
+                pthread_mutex_destroy(&p->lock);
+                free(p);
+                p = NULL;
+            } else {
+                pthread_detach(p->tid);
+                g_fs_pollers[free_slot] = p;
             }
         }
     }
-    pthread_mutex_unlock(&wait.lock);
 
-    pthread_join(tid, NULL);
-    pthread_cond_destroy(&wait.cond);
-    pthread_mutex_destroy(&wait.lock);
+    if (p != NULL) {
+        pthread_mutex_lock(&p->lock);
+        p->refs++;
+        pthread_mutex_unlock(&p->lock);
+    }
+    pthread_mutex_unlock(&g_fs_pollers_lock);
+    return p;
+}
+
+/* Detach the poller for fd from the registry and stop its worker. A worker
+ * blocked in the ioctl exits once the driver returns (STREAM_OFF/close). */
+static void fs_poller_release(int fd)
+{
+    fs_poller_t *p = NULL;
+
+    pthread_mutex_lock(&g_fs_pollers_lock);
+    for (int i = 0; i < FS_POLL_MAX_WORKERS; i++) {
+        if (g_fs_pollers[i] != NULL && g_fs_pollers[i]->fd == fd) {
+            p = g_fs_pollers[i];
+            g_fs_pollers[i] = NULL;
+            break;
+        }
+    }
+    pthread_mutex_unlock(&g_fs_pollers_lock);
+
+    if (p == NULL)
+        return;
+
+    pthread_mutex_lock(&p->lock);
+    p->stop = 1;
+    p->cancel_gen++;
+    pthread_cond_broadcast(&p->req_cond);
+    pthread_cond_broadcast(&p->done_cond);
+    fs_poller_unref_locked(p);
+}
 
-    if (wait.ret < 0) {
-        if (wait.err == EINTR)
+static void fs_poll_cleanup(void *arg)
+{
+    /* Capture threads are stopped with pthread_cancel(); timedwait is a
+     * cancellation point and re-acquires the lock before we get here. */
+    fs_poller_unref_locked((fs_poller_t *)arg);
+}
+
+static int fs_poll_frame_direct(int fd, unsigned int *ready_out)
+{
+    uint32_t ready = 0xffffffffu;
+    int ret = ioctl(fd, VIDIOC_POLL_FRAME, &ready);
+    if (ret < 0) {
+        if (errno == EINTR)
             return -2;
-        fprintf(stderr, "[KernelIF] POLL_FRAME failed: fd=%d %s\n", fd, strerror(wait.err));
+        fprintf(stderr, "[KernelIF] POLL_FRAME failed: fd=%d %s\n", fd, strerror(errno));
+        return -1;
+    }
+    if (ready_out)
+        *ready_out = ready;
+    return 0;
+}
+
+/**
+ * Wait for the framechan driver to report ready frames.
+ * timeout_ms < 0 waits until the ioctl completes or the wait is cancelled.
+ * Returns 0 on success, -2 on timeout/cancel/EINTR (retry), -1 on error.
+ */
+int fs_poll_frame_timeout(int fd, unsigned int *ready_out, int timeout_ms)
+{
+    fs_poller_t *p;
+    struct timespec deadline = {0, 0};
+    uint32_t seq;
+    int cancel_gen;
+    /* Written inside pthread_cleanup_push(), which may be setjmp-based */
+    volatile int timed_out = 0;
+    int ret, err;
+    uint32_t ready;
+
+    if (fd < 0)
+        return -1;
+
+    p = fs_poller_get(fd, 1);
+    if (p == NULL)
+        return fs_poll_frame_direct(fd, ready_out);
+
+    if (timeout_ms >= 0) {
+        clock_gettime(CLOCK_REALTIME, &deadline);
+        ki_timespec_add_ms(&deadline, timeout_ms);
+    }
+
+    pthread_mutex_lock(&p->lock);
+    pthread_cleanup_push(fs_poll_cleanup, p);
+
+    p->stats.calls++;
+    cancel_gen = p->cancel_gen;
+
+    /* Post a request unless one is in flight or a completed result from an
+     * earlier timed-out call is still waiting to be collected. */
+    if (p->done_seq == p->req_seq && p->taken_seq == p->done_seq) {
+        p->req_seq++;
+        p->req_start_us = ki_mono_us();
+        pthread_cond_signal(&p->req_cond);
+    } else if (p->done_seq != p->req_seq) {
+        p->stats.joined++;
+    }
+    seq = p->req_seq;
+
+    while (p->done_seq != seq && !p->stop && p->cancel_gen == cancel_gen) {
+        if (timeout_ms < 0) {
+            pthread_cond_wait(&p->done_cond, &p->lock);
+        } else if (pthread_cond_timedwait(&p->done_cond, &p->lock, &deadline) == ETIMEDOUT) {
+            timed_out = p->done_seq != seq;
+            break;
+        }
+    }
+
+    if (p->done_seq == seq) {
+        p->taken_seq = seq;
+        ret = p->ret;
+        err = p->err;
+        ready = p->ready;
+    } else {
+        if (timed_out)
+            p->stats.timeouts++;
+        else
+            p->stats.cancels++;
+        ret = -2;
+        err = 0;
+        ready = 0;
+    }
+
+    pthread_cleanup_pop(1);
+
+    if (ret == -2) {
+        ki_trace("libimp/KI: POLL_FRAME %s fd=%d\n", timed_out ? "timeout" : "cancelled", fd);
+        return -2;
+    }
+    if (ret < 0) {
+        if (err == EINTR)
+            return -2;
+        fprintf(stderr, "[KernelIF] POLL_FRAME failed: fd=%d %s\n", fd, strerror(err));
         ki_trace("libimp/KI: POLL_FRAME exit fd=%d ret=%d errno=%d ready=%u\n",
-                 fd, wait.ret, wait.err, wait.ready);
+                 fd, ret, err, ready);
         return -1;
     }
 
     if (ready_out)
-        *ready_out = wait.ready;
+        *ready_out = ready;
+    return 0;
+}
+
+int fs_poll_frame(int fd, unsigned int *ready_out)
+{
+    return fs_poll_frame_timeout(fd, ready_out, FS_POLL_DEFAULT_TIMEOUT_MS);
+}
+
+/**
+ * Wake every caller blocked in fs_poll_frame() on fd; they return -2.
+ * The in-flight ioctl (if any) keeps running and its result is kept for the
+ * next poll on the same fd.
+ */
+void fs_poll_cancel(int fd)
+{
+    fs_poller_t *p = fs_poller_get(fd, 0);
+    if (p == NULL)
+        return;
+    pthread_mutex_lock(&p->lock);
+    p->cancel_gen++;
+    pthread_cond_broadcast(&p->done_cond);
+    fs_poller_unref_locked(p);
+}
+
+int fs_poll_get_stats(int fd, fs_poll_stats_t *stats)
+{
+    fs_poller_t *p;
 
-    ki_trace("libimp/KI: POLL_FRAME exit fd=%d ret=%d errno=%d ready=%u\n",
-             fd, wait.ret, wait.err, wait.ready);
+    if (stats == NULL)
+        return -1;
+
+    p = fs_poller_get(fd, 0);
+    if (p == NULL)
+        return -1;
+    pthread_mutex_lock(&p->lock);
+    *stats = p->stats;
+    fs_poller_unref_locked(p);
     return 0;
 }
 
@@ -737,6 +911,7 @@ int fs_dqbuf(int fd, int *index_out) {
  */
 void fs_close_device(int fd) {
     if (fd >= 0) {
+        fs_poller_release(fd);
         close(fd);
         fprintf(stderr, "[KernelIF] Closed device (fd=%d)\n", fd);
     }
@@ -782,30 +957,99 @@ typedef struct {
     pthread_mutex_t queue_mutex; /* Mutex for queue access */
     int fd;                 /* Kernel framechan fd for qbuf/dqbuf (-1 if unused) */
     uint8_t *buf_in_userspace; /* Per-buffer: 1 if DQBUF'd, 0 if in kernel queue */
+    uint32_t *frame_refs;   /* Per-buffer: generation << 16 | reference count */
 } VBMPool;
 
-/* Global VBM state */
-typedef struct {
-    VBMFrame *frame;        /* 0x00: Frame pointer */
-    uint32_t phys_addr;     /* 0x04: Physical address */
-    uint32_t virt_addr;     /* 0x08: Virtual address */
-    int ref_count;          /* 0x0c: Reference count */
-    pthread_mutex_t mutex;  /* 0x10: Mutex */
-} VBMVolume;
+/* Frame references replace the OEM g_framevolumes table: a frame is found
+ * from its own index/chn fields (or its vaddr by pool range) and its
+ * generation and refcount share one word, so lock/unlock is a single CAS
+ * and a stale VBMFrameHandle can never pin a recycled buffer. */
+#define VBM_REF_MASK      0xffffu
+#define VBM_REF_GEN_SHIFT 16
 
 static VBMPool *vbm_instance[MAX_VBM_POOLS] = {NULL};
-static VBMVolume g_framevolumes[30]; /* Global frame volumes array */
 
-static VBMVolume *vbm_find_volume_by_vaddr(uint32_t vaddr)
+static int vbm_return_frame(VBMPool *pool, VBMFrame *vbm_frame);
+
+static VBMFrame *vbm_frame_lookup(const void *frame, VBMPool **pool_out)
 {
-    for (int i = 0; i < 30; ++i) {
-        if (g_framevolumes[i].frame != NULL && g_framevolumes[i].virt_addr == vaddr) {
-            return &g_framevolumes[i];
-        }
+    const VBMFrame *f = (const VBMFrame *)frame;
+
+    if (f == NULL || f->chn < 0 || f->chn >= MAX_VBM_POOLS)
+        return NULL;
+
+    VBMPool *pool = vbm_instance[f->chn];
+    if (pool == NULL || f->index < 0 || f->index >= pool->frame_count ||
+        &pool->frames[f->index] != f)
+        return NULL;
+
+    *pool_out = pool;
+    return &pool->frames[f->index];
+}
+
+static VBMFrame *vbm_frame_lookup_vaddr(uint32_t vaddr, VBMPool **pool_out)
+{
+    for (int chn = 0; chn < MAX_VBM_POOLS; chn++) {
+        VBMPool *pool = vbm_instance[chn];
+        if (pool == NULL || pool->frame_size <= 0 || vaddr < pool->virt_base)
+            continue;
+
+        uint32_t off = vaddr - pool->virt_base;
+        if (off % (uint32_t)pool->frame_size != 0)
+            continue;
+        uint32_t idx = off / (uint32_t)pool->frame_size;
+        if (idx >= (uint32_t)pool->frame_count)
+            continue;
+
+        *pool_out = pool;
+        return &pool->frames[idx];
     }
     return NULL;
 }
 
+/* Take a reference; gen < 0 accepts whatever generation is current */
+static int vbm_frame_ref(VBMPool *pool, VBMFrame *frame, int gen)
+{
+    uint32_t *word = &pool->frame_refs[frame->index];
+    uint32_t old = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+
+    do {
+        if (gen >= 0 && (old >> VBM_REF_GEN_SHIFT) != (uint32_t)gen)
+            return -1;
+        if ((old & VBM_REF_MASK) == VBM_REF_MASK)
+            return -1;
+    } while (!__atomic_compare_exchange_n(word, &old, old + 1, 1,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+    return 0;
+}
+
+/* Drop a reference; the last one bumps the generation and hands the buffer
+ * back to the pool (and the kernel, for DQBUF'd buffers). */
+static int vbm_frame_unref(VBMPool *pool, VBMFrame *frame, int gen)
+{
+    uint32_t *word = &pool->frame_refs[frame->index];
+    uint32_t old = __atomic_load_n(word, __ATOMIC_ACQUIRE);
+    uint32_t next;
+
+    do {
+        if (gen >= 0 && (old >> VBM_REF_GEN_SHIFT) != (uint32_t)gen)
+            return -1;
+        if ((old & VBM_REF_MASK) == 0) {
+            fprintf(stderr, "[VBM] UnLockFrame: chn=%d idx=%d already unlocked\n",
+                    frame->chn, frame->index);
+            return -1;
+        }
+        next = ((old & VBM_REF_MASK) == 1)
+             ? (old & ~VBM_REF_MASK) + (1u << VBM_REF_GEN_SHIFT)
+             : old - 1;
+    } while (!__atomic_compare_exchange_n(word, &old, next, 1,
+                                          __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE));
+
+    if ((next & VBM_REF_MASK) == 0)
+        return vbm_return_frame(pool, frame);
+    return 0;
+}
+
 /* External functions */
 extern int IMP_FrameSource_GetPool(int chn);
 
@@ -1052,18 +1296,6 @@ int VBMCreatePool(int chn, void *fmt, void *ops, void *priv) {
 
         fprintf(stderr, "[VBM] Frame %d: phys=0x%x virt=0x%x fourcc=0x%x fps=%d/%d\n",
                 i, phys, virt, frame_fourcc, fps_num, fps_den);
-
-        /* Register in global frame volumes */
-        for (int j = 0; j < 30; j++) {
-            if (g_framevolumes[j].frame == NULL) {
-                g_framevolumes[j].frame = frame;
-                g_framevolumes[j].phys_addr = frame->phys_addr;
-                g_framevolumes[j].virt_addr = frame->virt_addr;
-                g_framevolumes[j].ref_count = 0;
-                pthread_mutex_init(&g_framevolumes[j].mutex, NULL);
-                break;
-            }
-        }
     }
 
     /* Initialize frame queue */
@@ -1079,6 +1311,15 @@ int VBMCreatePool(int chn, void *fmt, void *ops, void *priv) {
      * VBMReleaseFrame is called multiple times for the same buffer
      * (OEM uses AL_Buffer refcounting; we track explicitly). */
     pool->buf_in_userspace = (uint8_t*)calloc(frame_count, sizeof(uint8_t));
+    pool->frame_refs = (uint32_t*)calloc(frame_count, sizeof(uint32_t));
+    if (pool->frame_refs == NULL) {
+        fprintf(stderr, "[VBM] CreatePool: failed to allocate frame refs\n");
+        free(pool->buf_in_userspace);
+        free(pool->available_queue);
+        DMA_FreePhys(pool->phys_base);
+        free(pool);
+        return -1;
+    }
 
     pool->queue_head = 0;
     pool->queue_tail = 0;
@@ -1103,19 +1344,8 @@ int VBMDestroyPool(int chn) {
 
     fprintf(stderr, "[VBM] DestroyPool: chn=%d\n", chn);
 
-    /* Unregister frames from global volumes */
-    for (int i = 0; i < 30; i++) {
-        if (g_framevolumes[i].frame != NULL) {
-            VBMFrame *frame = g_framevolumes[i].frame;
-            if (frame->chn == chn) {
-                pthread_mutex_destroy(&g_framevolumes[i].mutex);
-                g_framevolumes[i].frame = NULL;
-                g_framevolumes[i].phys_addr = 0;
-                g_framevolumes[i].virt_addr = 0;
-                g_framevolumes[i].ref_count = 0;
-            }
-        }
-    }
+    /* Unpublish first so handle/vaddr lookups stop resolving into it */
+    vbm_instance[chn] = NULL;
 
     /* Destroy queue mutex */
     pthread_mutex_destroy(&pool->queue_mutex);
@@ -1127,6 +1357,7 @@ int VBMDestroyPool(int chn) {
     if (pool->buf_in_userspace != NULL) {
         free(pool->buf_in_userspace);
     }
+    free(pool->frame_refs);
 
     /* Free allocated memory */
     if (pool->phys_base != 0) {
@@ -1135,7 +1366,6 @@ int VBMDestroyPool(int chn) {
 
     /* Free pool structure */
     free(pool);
-    vbm_instance[chn] = NULL;
 
     fprintf(stderr, "[VBM] DestroyPool: chn=%d destroyed\n", chn);
     return 0;
@@ -1413,8 +1643,19 @@ int VBMReleaseFrame(int chn, void *frame) {
 
     fprintf(stderr, "[VBM] ReleaseFrame: chn=%d, frame=%p\n", chn, frame);
 
-    /* Get frame index */
+    /* Direct release bypasses the refcount; invalidate outstanding handles */
     VBMFrame *vbm_frame = (VBMFrame*)frame;
+    if (vbm_frame->index >= 0 && vbm_frame->index < pool->frame_count) {
+        uint32_t *word = &pool->frame_refs[vbm_frame->index];
+        uint32_t gen = __atomic_load_n(word, __ATOMIC_ACQUIRE) >> VBM_REF_GEN_SHIFT;
+        __atomic_store_n(word, (gen + 1) << VBM_REF_GEN_SHIFT, __ATOMIC_RELEASE);
+    }
+
+    return vbm_return_frame(pool, vbm_frame);
+}
+
+static int vbm_return_frame(VBMPool *pool, VBMFrame *vbm_frame)
+{
     int frame_idx = vbm_frame->index;
 
     /* Return frame to available queue */
@@ -1454,58 +1695,94 @@ int VBMReleaseFrame(int chn, void *frame) {
 
 int VBMLockFrameByVaddr(uint32_t vaddr)
 {
-    VBMVolume *vol = vbm_find_volume_by_vaddr(vaddr);
-    if (vol == NULL) {
+    VBMPool *pool = NULL;
+    VBMFrame *frame = vbm_frame_lookup_vaddr(vaddr, &pool);
+    if (frame == NULL) {
         fprintf(stderr, "[VBM] LockFrameByVaddr: vaddr=0x%x not found\n", vaddr);
         return -1;
     }
-
-    pthread_mutex_lock(&vol->mutex);
-    vol->ref_count++;
-    /* fprintf throttled — high-frequency per-frame path */
-    pthread_mutex_unlock(&vol->mutex);
-    return 0;
+    return vbm_frame_ref(pool, frame, -1);
 }
 
 int VBMUnlockFrameByVaddr(uint32_t vaddr)
 {
-    VBMVolume *vol = vbm_find_volume_by_vaddr(vaddr);
-    if (vol == NULL) {
+    VBMPool *pool = NULL;
+    VBMFrame *frame = vbm_frame_lookup_vaddr(vaddr, &pool);
+    if (frame == NULL) {
         fprintf(stderr, "[VBM] UnlockFrameByVaddr: vaddr=0x%x not found\n", vaddr);
         return -1;
     }
+    return vbm_frame_unref(pool, frame, -1);
+}
 
-    pthread_mutex_lock(&vol->mutex);
-    if (vol->ref_count <= 0) {
-        fprintf(stderr, "[VBM] UnlockFrameByVaddr: vaddr=0x%x already unlocked\n", vaddr);
-        pthread_mutex_unlock(&vol->mutex);
-        return -1;
+int VBMLockFrame(void *frame)
+{
+    VBMPool *pool = NULL;
+    VBMFrame *f = vbm_frame_lookup(frame, &pool);
+    if (f == NULL) {
+        if (frame == NULL) return -1;
+        return VBMLockFrameByVaddr(((VBMFrame*)frame)->virt_addr);
     }
+    return vbm_frame_ref(pool, f, -1);
+}
 
-    vol->ref_count--;
-    int ref_count = vol->ref_count;
-    VBMFrame *frame = vol->frame;
-    pthread_mutex_unlock(&vol->mutex);
-
-    fprintf(stderr, "[VBM] UnlockFrameByVaddr: vaddr=0x%x ref=%d\n", vaddr, ref_count);
-
-    if (ref_count == 0 && frame != NULL) {
-        return VBMReleaseFrame(frame->chn, frame);
+int VBMUnLockFrame(void *frame)
+{
+    VBMPool *pool = NULL;
+    VBMFrame *f = vbm_frame_lookup(frame, &pool);
+    if (f == NULL) {
+        if (frame == NULL) return -1;
+        return VBMUnlockFrameByVaddr(((VBMFrame*)frame)->virt_addr);
     }
+    return vbm_frame_unref(pool, f, -1);
+}
+
+int VBMFrame_GetHandle(void *frame, VBMFrameHandle *handle)
+{
+    VBMPool *pool = NULL;
+    VBMFrame *f = vbm_frame_lookup(frame, &pool);
+    if (f == NULL || handle == NULL)
+        return -1;
 
+    handle->chn = (uint16_t)f->chn;
+    handle->index = (uint16_t)f->index;
+    handle->gen = __atomic_load_n(&pool->frame_refs[f->index], __ATOMIC_ACQUIRE) >> VBM_REF_GEN_SHIFT;
     return 0;
 }
 
-int VBMLockFrame(void *frame)
+static VBMFrame *vbm_handle_lookup(VBMFrameHandle handle, VBMPool **pool_out)
 {
-    if (frame == NULL) return -1;
-    return VBMLockFrameByVaddr(((VBMFrame*)frame)->virt_addr);
+    if (handle.chn >= MAX_VBM_POOLS)
+        return NULL;
+    VBMPool *pool = vbm_instance[handle.chn];
+    if (pool == NULL || handle.index >= (uint32_t)pool->frame_count)
+        return NULL;
+    *pool_out = pool;
+    return &pool->frames[handle.index];
 }
 
-int VBMUnLockFrame(void *frame)
+int VBMFrameHandle_Ref(VBMFrameHandle handle)
+{
+    VBMPool *pool = NULL;
+    VBMFrame *f = vbm_handle_lookup(handle, &pool);
+    if (f == NULL)
+        return -1;
+    return vbm_frame_ref(pool, f, (int)handle.gen);
+}
+
+int VBMFrameHandle_Unref(VBMFrameHandle handle)
 {
-    if (frame == NULL) return -1;
-    return VBMUnlockFrameByVaddr(((VBMFrame*)frame)->virt_addr);
+    VBMPool *pool = NULL;
+    VBMFrame *f = vbm_handle_lookup(handle, &pool);
+    if (f == NULL)
+        return -1;
+    return vbm_frame_unref(pool, f, (int)handle.gen);
+}
+
+void *VBMFrameHandle_Frame(VBMFrameHandle handle)
+{
+    VBMPool *pool = NULL;
+    return vbm_handle_lookup(handle, &pool);
 }
 
 
@@ -6,6 +6,8 @@
 #ifndef KERNEL_INTERFACE_H
 #define KERNEL_INTERFACE_H
 
+#include <stdint.h>
+
 #ifdef __cplusplus
 extern "C" {
 #endif
@@ -65,7 +67,33 @@ int fs_stream_off(int fd);
 int fs_poll_frame(int fd, unsigned int *ready_out);
 void fs_close_device(int fd);
 
+/* POLL_FRAME runs on one persistent worker thread per framechan fd.
+ * fs_poll_frame() uses a 1 s timeout; timeout/cancel return -2 (retry). */
+typedef struct {
+    uint64_t calls;             /* fs_poll_frame*() invocations */
+    uint64_t ioctls;            /* POLL_FRAME ioctls completed by the worker */
+    uint64_t joined;            /* calls that reused an in-flight ioctl */
+    uint64_t timeouts;          /* calls that hit their deadline */
+    uint64_t cancels;           /* calls woken by fs_poll_cancel()/close */
+    uint64_t wait_total_us;     /* sum of ioctl wait time */
+    uint64_t wait_max_us;       /* longest single ioctl wait */
+} fs_poll_stats_t;
+
+int fs_poll_frame_timeout(int fd, unsigned int *ready_out, int timeout_ms);
+void fs_poll_cancel(int fd);
+int fs_poll_get_stats(int fd, fs_poll_stats_t *stats);
+
 /* VBM (Video Buffer Manager) operations */
+
+/* Lightweight reference to a pool frame. The generation changes every time
+ * the buffer goes back to the pool, so a handle kept past its frame's
+ * lifetime fails to Ref instead of pinning the next capture. */
+typedef struct {
+    uint16_t chn;           /* VBM pool (FrameSource channel) */
+    uint16_t index;         /* Buffer index within the pool */
+    uint32_t gen;           /* Generation at the time the handle was taken */
+} VBMFrameHandle;
+
 int VBMCreatePool(int chn, void *fmt, void *ops, void *priv);
 int VBMDestroyPool(int chn);
 int VBMFillPool(int chn);
@@ -76,6 +104,12 @@ int VBMLockFrame(void *frame);
 int VBMUnLockFrame(void *frame);
 int VBMLockFrameByVaddr(uint32_t vaddr);
 int VBMUnlockFrameByVaddr(uint32_t vaddr);
+int VBMFrame_GetHandle(void *frame, VBMFrameHandle *handle);
+/* Ref/Unref return -1 if the handle's generation has been recycled; the last
+ * Unref releases the frame (QBUF back to the kernel when DQBUF'd). */
+int VBMFrameHandle_Ref(VBMFrameHandle handle);
+int VBMFrameHandle_Unref(VBMFrameHandle handle);
+void *VBMFrameHandle_Frame(VBMFrameHandle handle);
 int VBMFrame_GetBuffer(void *frame, void **virt, int *size);
 /* Get originating channel from VBM frame (reads offset 0x04) */
 int VBMFrame_GetChannel(void *frame, int *chn_out);
@@ -25,6 +25,7 @@
 
 #include "core/imp_alloc.h"
 #include "core/module.h"
+#include "osd_blend.h"
 
 extern char _gp;
 
@@ -928,29 +929,234 @@ int32_t Convert1555To8888(uint32_t *arg1, const uint16_t *arg2, int32_t arg3)
     return 0;
 }
 
-/* osd_draw_line — stock implements this with MIPS FPU (coprocessor 1) and
- * unresolved mtc1/mfc1/trunc.w.s ops. The function renders a single OSD
- * line into the frame via per-row bresenham with interpolation. To keep
- * the port valid C without MIPS asm, we emit a simplified but
- * behaviorally-matching scalar implementation that consumes the same
- * inputs and produces the same color-conversion side-effect (writes
- * Y/Cb/Cr bytes into the luma + chroma planes at computed coordinates).
- * The stock entry signature is:
+/* Software compositing for LINE / RECT / BITMAP regions.
+ *
+ * Region attr words (osd_rgn_attr_words): [0] type, [1..4] p0.x, p0.y,
+ * p1.x, p1.y (inclusive), [5] pixel format, [6] colour or bitmap data,
+ * [7] line width. Group-region attr words: [0] show, [1..2] offPos,
+ * [5] gAlphaEn, [6] fgAlhpa, [7] bgAlhpa. Frames are the VBM NV12
+ * frames: width at 0x08, height at 0x0c, virtual address at 0x1c. */
+static int32_t osd_sw_frame(void *frame, OsdFrame *out)
+{
+    int32_t width = *(int32_t *)((char *)frame + 0x08);
+    int32_t height = *(int32_t *)((char *)frame + 0x0c);
+    uint8_t *virt = (uint8_t *)(uintptr_t)*(uint32_t *)((char *)frame + 0x1c);
+
+    if (virt == NULL || width <= 0 || height <= 0) {
+        return -1;
+    }
+    out->y = virt;
+    out->uv = virt + width * height;
+    out->width = width;
+    out->height = height;
+    out->stride = width;
+    return 0;
+}
+
+static int32_t osd_draw_rect(void *frame, int32_t *attr, int32_t *grp)
+{
+    OsdFrame f;
+
+    if (osd_sw_frame(frame, &f) != 0) {
+        return -1;
+    }
+    return osd_blend_rect(&f, attr[1] + grp[1], attr[2] + grp[2], attr[3] + grp[1], attr[4] + grp[2],
+                          attr[7], (uint32_t)attr[6]);
+}
+
+/* Bitmaps at even x are blended from a per-region overlay that keeps the
+ * converted picture. IMP_OSD_UpdateRgnAttrData / SetRgnAttr bump the
+ * region's data generation; only then is the source re-read, and only the
+ * tiles whose bytes changed are converted again. Static logos are
+ * converted once. */
+static OsdOverlay *osd_sw_overlay[OSD_MAX_RGN];
+static uint32_t osd_sw_data_gen[OSD_MAX_RGN];
+static uint32_t osd_sw_done_gen[OSD_MAX_RGN];
+static int32_t osd_sw_alpha_key[OSD_MAX_RGN][3];   /* Group alpha the overlay was made with */
+static OsdBlendStats osd_sw_stats[OSD_MAX_GRP];
+
+/* Text regions (OSD_REG_TEXT) draw from a glyph atlas made from the font
+ * given to IMP_OSD_SetRgnFont. The atlas is built on the processing side
+ * when the font generation or group alpha changes; a text update only
+ * re-maps the string to glyph indices. */
+#define OSD_REG_TEXT 7
+#define OSD_TEXT_MAX 64
+
+typedef struct {                    /* Layout of IMPOSDFont */
+    const char *chars;
+    const void *data;
+    int32_t fmt;
+    int32_t glyph_w;
+    int32_t glyph_h;
+    int32_t strip_w;
+} OsdFontDesc;
+
+static OsdFontDesc osd_sw_font[OSD_MAX_RGN];
+static uint32_t osd_sw_font_gen[OSD_MAX_RGN];
+static uint32_t osd_sw_font_done[OSD_MAX_RGN];
+static OsdGlyphAtlas *osd_sw_atlas[OSD_MAX_RGN];
+static uint8_t osd_sw_glyphs[OSD_MAX_RGN][OSD_TEXT_MAX];
+static int32_t osd_sw_nglyphs[OSD_MAX_RGN];
+
+static void osd_sw_mark_dirty(int32_t handle)
+{
+    __atomic_add_fetch(&osd_sw_data_gen[handle], 1, __ATOMIC_RELEASE);
+}
+
+static void osd_sw_release(int32_t handle)
+{
+    osd_overlay_destroy(osd_sw_overlay[handle]);
+    osd_sw_overlay[handle] = NULL;
+    osd_glyph_atlas_destroy(osd_sw_atlas[handle]);
+    osd_sw_atlas[handle] = NULL;
+    memset(&osd_sw_font[handle], 0, sizeof(OsdFontDesc));
+    osd_sw_nglyphs[handle] = 0;
+    osd_sw_mark_dirty(handle);
+}
+
+/* 6 / 0x1a are the 2-byte formats on the IPU path as well */
+static int32_t osd_sw_pic_fmt(int32_t fmt)
+{
+    return (fmt == 6 || fmt == 0x1a) ? OSD_BLEND_FMT_ARGB1555 : OSD_BLEND_FMT_BGRA;
+}
+
+static int32_t osd_draw_bitmap(void *frame, int32_t handle, int32_t *attr, int32_t *grp, OsdBlendStats *st)
+{
+    OsdFrame f;
+    OsdPicture pic;
+    OsdOverlay *ov;
+    int32_t x = (attr[1] < attr[3] ? attr[1] : attr[3]) + grp[1];
+    int32_t y = (attr[2] < attr[4] ? attr[2] : attr[4]) + grp[2];
+    int32_t mode = grp[5] != 0 ? OSD_BLEND_ALPHA_GLOBAL : OSD_BLEND_ALPHA_PIXEL;
+    int32_t ret;
+
+    if (attr[6] == 0 || osd_sw_frame(frame, &f) != 0) {
+        return -1;
+    }
+
+    pic.data = (const void *)(uintptr_t)attr[6];
+    pic.fmt = osd_sw_pic_fmt(attr[5]);
+    pic.width = abs(attr[3] - attr[1]) + 1;
+    pic.height = abs(attr[4] - attr[2]) + 1;
+    pic.stride = pic.width * (pic.fmt == OSD_BLEND_FMT_ARGB1555 ? 2 : 4);
+
+    ov = osd_sw_overlay[handle];
+    if ((x & 1) == 0 && ov == NULL) {
+        ov = osd_sw_overlay[handle] = osd_overlay_create();
+        osd_sw_done_gen[handle] = __atomic_load_n(&osd_sw_data_gen[handle], __ATOMIC_ACQUIRE) - 1;
+    }
+    if ((x & 1) != 0 || ov == NULL) {
+        ret = osd_blend_picture(&f, x, y, &pic, mode, grp[6], grp[7]);
+        if (ret > 0) {
+            st->pixels_converted += (uint32_t)ret;
+            st->pixels_blended += (uint32_t)ret;
+        }
+        return ret;
+    }
+
+    {
+        uint32_t gen = __atomic_load_n(&osd_sw_data_gen[handle], __ATOMIC_ACQUIRE);
+        int32_t *key = osd_sw_alpha_key[handle];
+
+        /* Group alpha comes from SetGrpRgnAttr, which does not bump the
+         * generation; the overlay notices the change and converts it all */
+        if (gen != osd_sw_done_gen[handle] || key[0] != mode || key[1] != grp[6] || key[2] != grp[7]) {
+            if (osd_overlay_update(ov, &pic, mode, grp[6], grp[7], st) < 0) {
+                return -1;
+            }
+            osd_sw_done_gen[handle] = gen;
+            key[0] = mode;
+            key[1] = grp[6];
+            key[2] = grp[7];
+        }
+    }
+    return osd_overlay_blend(ov, &f, x, y, st);
+}
+
+/* Text is drawn from the region's top-left corner, rounded down to an
+ * even column, and cut at the region width */
+static int32_t osd_draw_text(void *frame, int32_t handle, int32_t *attr, int32_t *grp, OsdBlendStats *st)
+{
+    OsdFrame f;
+    OsdGlyphAtlas *at = osd_sw_atlas[handle];
+    const OsdFontDesc *font = &osd_sw_font[handle];
+    int32_t x = ((attr[1] < attr[3] ? attr[1] : attr[3]) + grp[1]) & ~1;
+    int32_t y = (attr[2] < attr[4] ? attr[2] : attr[4]) + grp[2];
+    int32_t mode = grp[5] != 0 ? OSD_BLEND_ALPHA_GLOBAL : OSD_BLEND_ALPHA_PIXEL;
+    uint32_t gen = __atomic_load_n(&osd_sw_data_gen[handle], __ATOMIC_ACQUIRE);
+    uint32_t fgen = __atomic_load_n(&osd_sw_font_gen[handle], __ATOMIC_ACQUIRE);
+    int32_t *key = osd_sw_alpha_key[handle];
+
+    if (font->data == NULL || osd_sw_frame(frame, &f) != 0) {
+        return -1;
+    }
+
+    if (at == NULL || fgen != osd_sw_font_done[handle] || key[0] != mode || key[1] != grp[6] ||
+        key[2] != grp[7]) {
+        OsdPicture pic;
+
+        pic.data = font->data;
+        pic.fmt = osd_sw_pic_fmt(font->fmt);
+        pic.width = font->strip_w;
+        pic.height = font->glyph_h;
+        pic.stride = pic.width * (pic.fmt == OSD_BLEND_FMT_ARGB1555 ? 2 : 4);
+        osd_glyph_atlas_destroy(at);
+        at = osd_sw_atlas[handle] = osd_glyph_atlas_create(&pic, font->chars, font->glyph_w, mode,
+                                                           grp[6], grp[7], st);
+        if (at == NULL) {
+            return -1;
+        }
+        osd_sw_font_done[handle] = fgen;
+        key[0] = mode;
+        key[1] = grp[6];
+        key[2] = grp[7];
+        osd_sw_done_gen[handle] = gen - 1;
+    }
+
+    /* New text: map it to glyphs once, no pixels touched */
+    if (gen != osd_sw_done_gen[handle]) {
+        int32_t max = (abs(attr[3] - attr[1]) + 1) / font->glyph_w;
+
+        osd_sw_nglyphs[handle] = osd_glyph_map(at, (const char *)(uintptr_t)attr[6], osd_sw_glyphs[handle],
+                                               max < OSD_TEXT_MAX ? max : OSD_TEXT_MAX);
+        osd_sw_done_gen[handle] = gen;
+    }
+    return osd_blend_glyphs(at, &f, x, y, osd_sw_glyphs[handle], osd_sw_nglyphs[handle], st);
+}
+
+int32_t osd_get_blend_stats(int32_t grp, OsdBlendStats *out)
+{
+    if (!osd_valid_group(grp) || out == NULL) {
+        return -1;
+    }
+    *out = osd_sw_stats[grp];
+    return 0;
+}
+
+/* osd_draw_line — stock rasterises with the MIPS FPU. The port keeps the
+ * entry signature:
  *   (frame, line_cmd, rect, ystate_out,
  *    arg5 @ $f0 int,   arg6 @ $f3 float,
  *    arg7 @ $f4 float, arg8 @ $a3 int)
- */
+ * and draws the region's p0 -> p1 segment, linewidth thick, through the
+ * integer blend engine. arg2 is the region attr, arg3 the group-region
+ * attr; the FPU state arguments are not needed. Returns the pixels
+ * drawn. */
 uint32_t osd_draw_line(void *arg1, void *arg2, int32_t *arg3, uint32_t *arg4,
                        int32_t arg5, float arg6, float arg7, int32_t arg8)
 {
-    (void)arg1; (void)arg2; (void)arg3; (void)arg4;
-    (void)arg5; (void)arg6; (void)arg7; (void)arg8;
-    /* Stock body is heavy FP + mtc1/mfc1. See HLIL 000cf094.. for full
-     * trace; porting of the MIPS-FPU path is deferred. The line is
-     * composited by writes into frame YUV planes with thickness linewidth
-     * controlled through arg2. Returning 0 matches the empty-line fast
-     * path (arg3 == arg4 degenerate rect). */
-    return 0;
+    int32_t *attr = (int32_t *)arg2;
+    OsdFrame f;
+
+    int32_t n;
+
+    (void)arg4; (void)arg5; (void)arg6; (void)arg7; (void)arg8;
+    if (osd_sw_frame(arg1, &f) != 0) {
+        return 0;
+    }
+    n = osd_blend_line(&f, attr[1] + arg3[1], attr[2] + arg3[2], attr[3] + arg3[1], attr[4] + arg3[2],
+                       attr[7], (uint32_t)attr[6]);
+    return n > 0 ? (uint32_t)n : 0;
 }
 
 /* ============================================================== */
@@ -1166,7 +1372,9 @@ int32_t osd_process(int32_t *arg1, void *arg2, int32_t arg3)
     }
 
     int32_t *v0_11 = *(int32_t **)((char *)v0_base + s0 * 0x9014 + 0x9044);
+    OsdBlendStats st;
 
+    memset(&st, 0, sizeof(st));
     if (v0_11 != NULL) {
         int32_t *s1_1 = v0_11;
 
@@ -1198,24 +1406,20 @@ int32_t osd_process(int32_t *arg1, void *arg2, int32_t arg3)
 
                 if (v0_22 == 1) {
                     /* LINE */
-                    osd_draw_line(arg2, s0_5, &s1_1[2], &s1_1[0xb],
-                                  0, 0.0f, 0.0f, arg3);
+                    st.pixels_blended += osd_draw_line(arg2, s0_5, &s1_1[2], &s1_1[0xb],
+                                                       0, 0.0f, 0.0f, arg3);
                 } else if (v0_22 == 2) {
-                    /* RECT: 4 lines */
-                    osd_draw_line(arg2, s0_5, &s1_1[2], &s1_1[0xc],
-                                  0, 0.0f, 0.0f, arg3);
-                    osd_draw_line(arg2, s0_5, &s1_1[2], &s1_1[0xd],
-                                  0, 0.0f, 0.0f, arg3);
-                    osd_draw_line(arg2, s0_5, &s1_1[2], &s1_1[0xe],
-                                  0, 0.0f, 0.0f, arg3);
-                    osd_draw_line(arg2, s0_5, &s1_1[2], &s1_1[0xf],
-                                  0, 0.0f, 0.0f, arg3);
+                    /* RECT: stock emits 4 lines; one outline pass here */
+                    int32_t n = osd_draw_rect(arg2, s0_5, &s1_1[2]);
+                    if (n > 0) {
+                        st.pixels_blended += (uint32_t)n;
+                    }
                 } else if (v0_22 == 3) {
-                    /* BITMAP: stock composites onto luma+chroma planes
-                     * line-by-line. The HLIL emits a scanline loop; we
-                     * defer the pixel-blit here and rely on ipu_osd for
-                     * formats 4/5/6/11. */
-                    (void)s0_5;
+                    /* BITMAP: composited in software; COVER / PIC
+                     * (formats 4/5/6/11) still go through ipu_osd */
+                    osd_draw_bitmap(arg2, s1_1[0], s0_5, &s1_1[2], &st);
+                } else if (v0_22 == OSD_REG_TEXT) {
+                    osd_draw_text(arg2, s1_1[0], s0_5, &s1_1[2], &st);
                 }
             }
 
@@ -1223,6 +1427,9 @@ int32_t osd_process(int32_t *arg1, void *arg2, int32_t arg3)
         }
     }
 
+    if (osd_valid_group(s0)) {
+        osd_sw_stats[s0] = st;
+    }
     OSD_Draw_Layer_Cover_Pic(arg2, v0_11, (char *)v0_base + 0x40, arg3);
     return sem_post((sem_t *)((char *)v0_base + 0x2b0a0));
 }
@@ -1654,6 +1861,7 @@ int32_t IMP_OSD_DestroyRgn(int32_t arg1)
         *(int32_t *)(gosd_1 + v1 + 0xb8) > 0) {
         return sem_post((sem_t *)(gosd_1 + 0x2b060));
     }
+    osd_sw_release(arg1);
 
     uintptr_t s0_1 = gosd_1 + v1 + 0x24050;
     uintptr_t v1_2 = *(uintptr_t *)(gosd_1 + 0x2b07c);
@@ -1875,6 +2083,7 @@ int32_t IMP_OSD_UpdateRgnAttrData(int32_t arg1, void **arg2)
     sem_wait((sem_t *)(gosd + 0x2b060));
     int32_t *attr = osd_rgn_attr_words(arg1);
     attr[6] = arg2 != NULL ? (int32_t)(uintptr_t)arg2[0] : 0;
+    osd_sw_mark_dirty(arg1);
     sem_post((sem_t *)(gosd + 0x2b060));
     return 0;
 
@@ -1932,6 +2141,36 @@ int32_t IMP_OSD_UpdateRgnAttrData(int32_t arg1, void **arg2)
     return 0;
 }
 
+int32_t IMP_OSD_SetRgnFont(int32_t arg1, const void *arg2)
+{
+    const OsdFontDesc *font = (const OsdFontDesc *)arg2;
+
+    if (!osd_valid_handle(arg1) || !osd_rgn_created(arg1)) {
+        imp_log_fun(6, IMP_Log_Get_Option(), 2, OSD_MODULE_TAG, OSD_SRC_PATH,
+                    __LINE__, "IMP_OSD_SetRgnFont",
+                    "%s, the region %d hasn't been created\n",
+                    "IMP_OSD_SetRgnFont", arg1);
+        return -1;
+    }
+    if (font != NULL && (font->chars == NULL || font->data == NULL || font->glyph_w <= 0 ||
+                         (font->glyph_w & 1) || font->glyph_h <= 0 || font->strip_w < font->glyph_w)) {
+        imp_log_fun(6, IMP_Log_Get_Option(), 2, OSD_MODULE_TAG, OSD_SRC_PATH,
+                    __LINE__, "IMP_OSD_SetRgnFont",
+                    "%s, invalid font: glyph %dx%d strip %d\n",
+                    "IMP_OSD_SetRgnFont", font->glyph_w, font->glyph_h, font->strip_w);
+        return -1;
+    }
+    sem_wait((sem_t *)(gosd + 0x2b060));
+    if (font != NULL) {
+        osd_sw_font[arg1] = *font;
+    } else {
+        memset(&osd_sw_font[arg1], 0, sizeof(OsdFontDesc));
+    }
+    __atomic_add_fetch(&osd_sw_font_gen[arg1], 1, __ATOMIC_RELEASE);
+    sem_post((sem_t *)(gosd + 0x2b060));
+    return 0;
+}
+
 int32_t IMP_OSD_GetRgnAttr(int32_t arg1, int32_t *arg2)
 {
     if (arg1 >= 0x200) {
@@ -1982,6 +2221,7 @@ int32_t IMP_OSD_SetRgnAttr(int32_t arg1, int32_t *arg2)
     for (int i = 0; i < 8; i++) {
         dst[i] = arg2[i];
     }
+    osd_sw_mark_dirty(arg1);
     sem_post((sem_t *)(gosd + 0x2b060));
     imp_log_fun(4, IMP_Log_Get_Option(), 2, OSD_MODULE_TAG, OSD_SRC_PATH,
                 0x63d, "IMP_OSD_SetRgnAttr",
@@ -0,0 +1,1039 @@
+/**
+ * OSD software blend engine
+ *
+ * Colour conversion is BT.601 limited range in 8.8 fixed point, and the
+ * blend is (s * a + d * (255 - a)) / 255 with rounding, so a fully opaque
+ * pixel lands exactly on its converted value. Overlay rows run through
+ * osd_span_kernels[fmt][mode]: one inline template instantiated with a
+ * constant format and alpha mode, walking the row in 8-pixel blocks, then a
+ * 4-pixel block, then pairs. Each block looks at its source alpha first;
+ * fully transparent blocks (the background of rendered text) are skipped
+ * and fully opaque ones take the copy path. Luma is blended per pixel,
+ * chroma per horizontal pixel pair on even frame rows.
+ *
+ * Fills, lines and rectangles convert their colour once and blend whole
+ * rectangles: luma row by row, then every chroma sample the rectangle
+ * touches once.
+ */
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "osd_blend.h"
+
+#define OSD_INLINE static inline __attribute__((always_inline))
+
+/* Generic vectors for the overlay blend rows, as in codec_c/nv12_resize.c */
+#if defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9 && \
+    (defined(__mips_msa) || defined(__SSE2__) || defined(__ARM_NEON))
+#define OSD_BLEND_VECTOR 1
+#endif
+
+typedef struct {
+    uint32_t fg_alpha;
+    uint32_t bg_alpha;
+} OsdAlphaParam;
+
+typedef struct {
+    uint8_t y;
+    uint8_t u;
+    uint8_t v;
+    uint8_t a;
+} OsdColor;
+
+/* Blend n pixels of one source row; uv is NULL on rows without chroma */
+typedef void (*OsdSpanKernel)(uint8_t *y, uint8_t *uv, const uint8_t *src, int32_t n,
+                              const OsdAlphaParam *ap);
+
+/* ---- Pixel math ---- */
+
+OSD_INLINE uint32_t osd_div255(uint32_t x)
+{
+    return ((x + 128) * 257) >> 16;
+}
+
+OSD_INLINE uint8_t osd_mix(uint32_t d, uint32_t s, uint32_t a)
+{
+    return (uint8_t)osd_div255(s * a + d * (255 - a));
+}
+
+OSD_INLINE int32_t osd_rgb_y(int32_t r, int32_t g, int32_t b)
+{
+    return ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16;
+}
+
+OSD_INLINE int32_t osd_rgb_u(int32_t r, int32_t g, int32_t b)
+{
+    return ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128;
+}
+
+OSD_INLINE int32_t osd_rgb_v(int32_t r, int32_t g, int32_t b)
+{
+    return ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128;
+}
+
+/* ---- Source access, folded per format ---- */
+
+OSD_INLINE uint32_t osd_src_alpha(const uint8_t *src, int32_t i, const int32_t fmt)
+{
+    if (fmt == OSD_BLEND_FMT_ARGB1555) {
+        return (((const uint16_t *)src)[i] & 0x8000) ? 255 : 0;
+    }
+    if (fmt == OSD_BLEND_FMT_ARGB8888) {
+        return ((const uint32_t *)src)[i] >> 24;
+    }
+    return src[4 * i + 3];
+}
+
+OSD_INLINE void osd_src_rgb(const uint8_t *src, int32_t i, const int32_t fmt,
+                            int32_t *r, int32_t *g, int32_t *b)
+{
+    if (fmt == OSD_BLEND_FMT_ARGB1555) {
+        uint32_t v = ((const uint16_t *)src)[i];
+        uint32_t r5 = (v >> 10) & 0x1f, g5 = (v >> 5) & 0x1f, b5 = v & 0x1f;
+
+        *r = (int32_t)((r5 << 3) | (r5 >> 2));
+        *g = (int32_t)((g5 << 3) | (g5 >> 2));
+        *b = (int32_t)((b5 << 3) | (b5 >> 2));
+    } else if (fmt == OSD_BLEND_FMT_ARGB8888) {
+        uint32_t v = ((const uint32_t *)src)[i];
+
+        *r = (int32_t)((v >> 16) & 0xff);
+        *g = (int32_t)((v >> 8) & 0xff);
+        *b = (int32_t)(v & 0xff);
+    } else {
+        *b = src[4 * i];
+        *g = src[4 * i + 1];
+        *r = src[4 * i + 2];
+    }
+}
+
+OSD_INLINE uint32_t osd_eff_alpha(uint32_t a, const int32_t fmt, const int32_t mode, const OsdAlphaParam *ap)
+{
+    if (mode == OSD_BLEND_ALPHA_NONE) {
+        return 255;
+    }
+    if (mode == OSD_BLEND_ALPHA_GLOBAL) {
+        if (fmt == OSD_BLEND_FMT_ARGB1555) {
+            return a ? ap->fg_alpha : ap->bg_alpha;
+        }
+        return osd_div255(a * ap->fg_alpha);
+    }
+    return a;
+}
+
+/* OR and AND of the source alpha of n pixels from i */
+OSD_INLINE void osd_block_alpha(const uint8_t *src, int32_t i, const int32_t n, const int32_t fmt,
+                                uint32_t *any, uint32_t *all)
+{
+    uint32_t o = 0, a = ~0u;
+
+    for (int32_t k = 0; k < n; k++) {
+        uint32_t v;
+
+        if (fmt == OSD_BLEND_FMT_ARGB1555) {
+            v = ((const uint16_t *)src)[i + k] & 0x8000;
+        } else if (fmt == OSD_BLEND_FMT_ARGB8888) {
+            v = ((const uint32_t *)src)[i + k] >> 24;
+        } else {
+            v = src[4 * (i + k) + 3];
+        }
+        o |= v;
+        a &= v;
+    }
+    *any = o != 0;
+    *all = fmt == OSD_BLEND_FMT_ARGB1555 ? a != 0 : a == 255;
+}
+
+/* ---- Span kernels ---- */
+
+/* Pixel i, plus i + 1 when cnt is 2; i is even in frame coordinates, so
+ * the pair's chroma sample sits at uv[i], uv[i + 1] */
+OSD_INLINE void osd_blend_pair(uint8_t *y, uint8_t *uv, const uint8_t *src, int32_t i, const int32_t cnt,
+                               const int32_t fmt, const int32_t mode, const OsdAlphaParam *ap)
+{
+    int32_t r0, g0, b0, r1, g1, b1;
+    uint32_t a0, a1;
+
+    osd_src_rgb(src, i, fmt, &r0, &g0, &b0);
+    a0 = osd_eff_alpha(osd_src_alpha(src, i, fmt), fmt, mode, ap);
+    if (cnt == 2) {
+        osd_src_rgb(src, i + 1, fmt, &r1, &g1, &b1);
+        a1 = osd_eff_alpha(osd_src_alpha(src, i + 1, fmt), fmt, mode, ap);
+    } else {
+        r1 = r0;
+        g1 = g0;
+        b1 = b0;
+        a1 = a0;
+    }
+
+    if (mode == OSD_BLEND_ALPHA_NONE) {
+        y[i] = (uint8_t)osd_rgb_y(r0, g0, b0);
+        if (cnt == 2) {
+            y[i + 1] = (uint8_t)osd_rgb_y(r1, g1, b1);
+        }
+    } else {
+        y[i] = osd_mix(y[i], (uint32_t)osd_rgb_y(r0, g0, b0), a0);
+        if (cnt == 2) {
+            y[i + 1] = osd_mix(y[i + 1], (uint32_t)osd_rgb_y(r1, g1, b1), a1);
+        }
+    }
+
+    if (uv != NULL) {
+        int32_t r = (r0 + r1 + 1) >> 1, g = (g0 + g1 + 1) >> 1, b = (b0 + b1 + 1) >> 1;
+
+        if (mode == OSD_BLEND_ALPHA_NONE) {
+            uv[i] = (uint8_t)osd_rgb_u(r, g, b);
+            uv[i + 1] = (uint8_t)osd_rgb_v(r, g, b);
+        } else {
+            uint32_t a = (a0 + a1 + 1) >> 1;
+
+            uv[i] = osd_mix(uv[i], (uint32_t)osd_rgb_u(r, g, b), a);
+            uv[i + 1] = osd_mix(uv[i + 1], (uint32_t)osd_rgb_v(r, g, b), a);
+        }
+    }
+}
+
+/* n (8 or 4) pixels from i: skip when clear, copy when opaque */
+OSD_INLINE void osd_blend_block(uint8_t *y, uint8_t *uv, const uint8_t *src, int32_t i, const int32_t n,
+                                const int32_t fmt, const int32_t mode, const OsdAlphaParam *ap,
+                                int32_t clear_skips)
+{
+    if (mode != OSD_BLEND_ALPHA_NONE) {
+        uint32_t any, all;
+
+        osd_block_alpha(src, i, n, fmt, &any, &all);
+        if (!any && clear_skips) {
+            return;
+        }
+        if (all && (mode == OSD_BLEND_ALPHA_PIXEL || ap->fg_alpha == 255)) {
+            for (int32_t k = 0; k < n; k += 2) {
+                osd_blend_pair(y, uv, src, i + k, 2, fmt, OSD_BLEND_ALPHA_NONE, ap);
+            }
+            return;
+        }
+    }
+    for (int32_t k = 0; k < n; k += 2) {
+        osd_blend_pair(y, uv, src, i + k, 2, fmt, mode, ap);
+    }
+}
+
+OSD_INLINE void osd_span(uint8_t *y, uint8_t *uv, const uint8_t *src, int32_t n,
+                         const int32_t fmt, const int32_t mode, const OsdAlphaParam *ap)
+{
+    /* A clear ARGB1555 pixel still shows bg_alpha in global mode */
+    int32_t clear_skips = mode == OSD_BLEND_ALPHA_PIXEL || fmt != OSD_BLEND_FMT_ARGB1555 || ap->bg_alpha == 0;
+    int32_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        osd_blend_block(y, uv, src, i, 8, fmt, mode, ap, clear_skips);
+    }
+    if (i + 4 <= n) {
+        osd_blend_block(y, uv, src, i, 4, fmt, mode, ap, clear_skips);
+        i += 4;
+    }
+    for (; i + 2 <= n; i += 2) {
+        osd_blend_pair(y, uv, src, i, 2, fmt, mode, ap);
+    }
+    if (i < n) {
+        osd_blend_pair(y, uv, src, i, 1, fmt, mode, ap);
+    }
+}
+
+#define OSD_SPAN_KERNEL(name, fmt, mode)                                                       \
+    static void name(uint8_t *y, uint8_t *uv, const uint8_t *src, int32_t n, const OsdAlphaParam *ap) \
+    {                                                                                          \
+        osd_span(y, uv, src, n, fmt, mode, ap);                                                \
+    }
+
+OSD_SPAN_KERNEL(span_1555_pixel, OSD_BLEND_FMT_ARGB1555, OSD_BLEND_ALPHA_PIXEL)
+OSD_SPAN_KERNEL(span_1555_global, OSD_BLEND_FMT_ARGB1555, OSD_BLEND_ALPHA_GLOBAL)
+OSD_SPAN_KERNEL(span_1555_none, OSD_BLEND_FMT_ARGB1555, OSD_BLEND_ALPHA_NONE)
+OSD_SPAN_KERNEL(span_8888_pixel, OSD_BLEND_FMT_ARGB8888, OSD_BLEND_ALPHA_PIXEL)
+OSD_SPAN_KERNEL(span_8888_global, OSD_BLEND_FMT_ARGB8888, OSD_BLEND_ALPHA_GLOBAL)
+OSD_SPAN_KERNEL(span_8888_none, OSD_BLEND_FMT_ARGB8888, OSD_BLEND_ALPHA_NONE)
+OSD_SPAN_KERNEL(span_bgra_pixel, OSD_BLEND_FMT_BGRA, OSD_BLEND_ALPHA_PIXEL)
+OSD_SPAN_KERNEL(span_bgra_global, OSD_BLEND_FMT_BGRA, OSD_BLEND_ALPHA_GLOBAL)
+OSD_SPAN_KERNEL(span_bgra_none, OSD_BLEND_FMT_BGRA, OSD_BLEND_ALPHA_NONE)
+
+static const OsdSpanKernel osd_span_kernels[OSD_BLEND_FMT_NUM][OSD_BLEND_ALPHA_NUM] = {
+    { span_1555_pixel, span_1555_global, span_1555_none },
+    { span_8888_pixel, span_8888_global, span_8888_none },
+    { span_bgra_pixel, span_bgra_global, span_bgra_none },
+};
+
+/* ---- Solid fills ---- */
+
+static void osd_color(uint32_t argb, OsdColor *c)
+{
+    int32_t r = (int32_t)((argb >> 16) & 0xff), g = (int32_t)((argb >> 8) & 0xff), b = (int32_t)(argb & 0xff);
+
+    c->y = (uint8_t)osd_rgb_y(r, g, b);
+    c->u = (uint8_t)osd_rgb_u(r, g, b);
+    c->v = (uint8_t)osd_rgb_v(r, g, b);
+    c->a = (uint8_t)(argb >> 24);
+    if (c->a == 0) {
+        c->a = 255;
+    }
+}
+
+/* Clip (x, y, w, h) to the frame; 0 when nothing is left */
+static int32_t osd_clip(const OsdFrame *dst, int32_t *x, int32_t *y, int32_t *w, int32_t *h)
+{
+    if (*x < 0) {
+        *w += *x;
+        *x = 0;
+    }
+    if (*y < 0) {
+        *h += *y;
+        *y = 0;
+    }
+    if (*w > dst->width - *x) {
+        *w = dst->width - *x;
+    }
+    if (*h > dst->height - *y) {
+        *h = dst->height - *y;
+    }
+    return *w > 0 && *h > 0;
+}
+
+/* Returns the luma pixels written */
+static int32_t osd_fill_color(const OsdFrame *dst, int32_t x, int32_t y, int32_t w, int32_t h, const OsdColor *c)
+{
+    int32_t cx, cw, cy0, cy1;
+
+    if (!osd_clip(dst, &x, &y, &w, &h)) {
+        return 0;
+    }
+
+    for (int32_t r = y; r < y + h; r++) {
+        uint8_t *p = dst->y + r * dst->stride + x;
+
+        if (c->a == 255) {
+            memset(p, c->y, (size_t)w);
+        } else {
+            for (int32_t i = 0; i < w; i++) {
+                p[i] = osd_mix(p[i], c->y, c->a);
+            }
+        }
+    }
+
+    /* Every chroma sample the rectangle touches, once */
+    cx = x >> 1;
+    cw = ((x + w - 1) >> 1) - cx + 1;
+    cy0 = y >> 1;
+    cy1 = (y + h - 1) >> 1;
+    for (int32_t r = cy0; r <= cy1; r++) {
+        uint8_t *p = dst->uv + r * dst->stride + 2 * cx;
+
+        if (c->a == 255) {
+            for (int32_t i = 0; i < cw; i++) {
+                p[2 * i] = c->u;
+                p[2 * i + 1] = c->v;
+            }
+        } else {
+            for (int32_t i = 0; i < cw; i++) {
+                p[2 * i] = osd_mix(p[2 * i], c->u, c->a);
+                p[2 * i + 1] = osd_mix(p[2 * i + 1], c->v, c->a);
+            }
+        }
+    }
+    return w * h;
+}
+
+/* ---- Public entry points ---- */
+
+int32_t osd_blend_picture(const OsdFrame *dst, int32_t x, int32_t y, const OsdPicture *pic,
+                          int32_t alpha_mode, int32_t fg_alpha, int32_t bg_alpha)
+{
+    OsdSpanKernel kernel;
+    OsdAlphaParam ap;
+    const uint8_t *src;
+    int32_t bpp, w, h;
+
+    if (dst == NULL || pic == NULL || pic->data == NULL || pic->fmt < 0 || pic->fmt >= OSD_BLEND_FMT_NUM ||
+        alpha_mode < 0 || alpha_mode >= OSD_BLEND_ALPHA_NUM) {
+        return -1;
+    }
+
+    bpp = pic->fmt == OSD_BLEND_FMT_ARGB1555 ? 2 : 4;
+    src = (const uint8_t *)pic->data;
+    w = pic->width;
+    h = pic->height;
+    if (x < 0) {
+        src -= x * bpp;
+    }
+    if (y < 0) {
+        src -= y * pic->stride;
+    }
+    if (!osd_clip(dst, &x, &y, &w, &h)) {
+        return 0;
+    }
+
+    kernel = osd_span_kernels[pic->fmt][alpha_mode];
+    ap.fg_alpha = (uint32_t)(fg_alpha < 0 ? 0 : (fg_alpha > 255 ? 255 : fg_alpha));
+    ap.bg_alpha = (uint32_t)(bg_alpha < 0 ? 0 : (bg_alpha > 255 ? 255 : bg_alpha));
+
+    for (int32_t r = 0; r < h; r++, src += pic->stride) {
+        int32_t fy = y + r;
+        uint8_t *yrow = dst->y + fy * dst->stride + x;
+        const uint8_t *s = src;
+        int32_t xs = x, n = w;
+
+        /* An odd first column has no chroma pair of its own */
+        if (xs & 1) {
+            kernel(yrow, NULL, s, 1, &ap);
+            yrow++;
+            s += bpp;
+            xs++;
+            n--;
+        }
+        kernel(yrow, (fy & 1) ? NULL : dst->uv + (fy >> 1) * dst->stride + xs, s, n, &ap);
+    }
+    return w * h;
+}
+
+int32_t osd_blend_fill(const OsdFrame *dst, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t argb)
+{
+    OsdColor c;
+
+    if (dst == NULL) {
+        return -1;
+    }
+    osd_color(argb, &c);
+    return osd_fill_color(dst, x, y, w, h, &c);
+}
+
+int32_t osd_blend_line(const OsdFrame *dst, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                       int32_t width, uint32_t argb)
+{
+    OsdColor c;
+    int32_t dx, dy, half, drawn = 0;
+
+    if (dst == NULL) {
+        return -1;
+    }
+    if (width < 1) {
+        width = 1;
+    }
+    osd_color(argb, &c);
+    half = (width - 1) / 2;
+    dx = abs(x1 - x0);
+    dy = abs(y1 - y0);
+
+    /* Bresenham, emitting each run of constant minor coordinate as one
+     * width-thick rectangle; axis-aligned segments are a single run */
+    if (dx >= dy) {
+        int32_t step, err, cy, start;
+
+        if (x0 > x1) {
+            int32_t t = x0; x0 = x1; x1 = t;
+            t = y0; y0 = y1; y1 = t;
+        }
+        step = y1 > y0 ? 1 : -1;
+        err = dx / 2;
+        cy = y0;
+        start = x0;
+        for (int32_t cx = x0; cx <= x1; cx++) {
+            err -= dy;
+            if (err < 0 || cx == x1) {
+                drawn += osd_fill_color(dst, start, cy - half, cx - start + 1, width, &c);
+                if (err < 0) {
+                    cy += step;
+                    err += dx;
+                }
+                start = cx + 1;
+            }
+        }
+    } else {
+        int32_t step, err, cx, start;
+
+        if (y0 > y1) {
+            int32_t t = x0; x0 = x1; x1 = t;
+            t = y0; y0 = y1; y1 = t;
+        }
+        step = x1 > x0 ? 1 : -1;
+        err = dy / 2;
+        cx = x0;
+        start = y0;
+        for (int32_t cy = y0; cy <= y1; cy++) {
+            err -= dx;
+            if (err < 0 || cy == y1) {
+                drawn += osd_fill_color(dst, cx - half, start, width, cy - start + 1, &c);
+                if (err < 0) {
+                    cx += step;
+                    err += dy;
+                }
+                start = cy + 1;
+            }
+        }
+    }
+    return drawn;
+}
+
+int32_t osd_blend_rect(const OsdFrame *dst, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                       int32_t width, uint32_t argb)
+{
+    OsdColor c;
+    int32_t w, h;
+
+    if (dst == NULL) {
+        return -1;
+    }
+    if (x0 > x1) {
+        int32_t t = x0; x0 = x1; x1 = t;
+    }
+    if (y0 > y1) {
+        int32_t t = y0; y0 = y1; y1 = t;
+    }
+    if (width < 1) {
+        width = 1;
+    }
+    osd_color(argb, &c);
+    w = x1 - x0 + 1;
+    h = y1 - y0 + 1;
+
+    if (2 * width >= w || 2 * width >= h) {
+        return osd_fill_color(dst, x0, y0, w, h, &c);
+    }
+    return osd_fill_color(dst, x0, y0, w, width, &c) +
+           osd_fill_color(dst, x0, y1 - width + 1, w, width, &c) +
+           osd_fill_color(dst, x0, y0 + width, width, h - 2 * width, &c) +
+           osd_fill_color(dst, x1 - width + 1, y0 + width, width, h - 2 * width, &c);
+}
+
+/* ---- Pre-converted overlays ---- */
+
+enum {
+    OSD_TILE_CLEAR  = 0,
+    OSD_TILE_OPAQUE = 1,
+    OSD_TILE_MIXED  = 2,
+};
+
+struct OsdOverlay {
+    uint8_t *y;                     /* Luma, width bytes per row */
+    uint8_t *ya;                    /* Luma alpha */
+    uint8_t *uv;                    /* CbCr of each pixel pair, every row, 2 * pairs bytes per row */
+    uint8_t *uva;                   /* Chroma alpha, repeated for Cb and Cr */
+    uint8_t *shadow;                /* Source rows as last converted */
+    uint8_t *tile;                  /* OSD_TILE_* */
+    int32_t width;
+    int32_t height;
+    int32_t fmt;
+    int32_t mode;
+    uint32_t fg_alpha;
+    uint32_t bg_alpha;
+    int32_t row_bytes;              /* Source bytes per row */
+    int32_t pairs;
+    int32_t tiles_x;
+    int32_t tiles_y;
+    int32_t valid;
+};
+
+/* Convert columns [c0, c1) of one source row; c0 is even */
+typedef void (*OsdConvertKernel)(OsdOverlay *ov, int32_t row, int32_t c0, int32_t c1, const uint8_t *src,
+                                 const OsdAlphaParam *ap);
+
+OSD_INLINE void osd_convert(OsdOverlay *ov, int32_t row, int32_t c0, int32_t c1, const uint8_t *src,
+                            const int32_t fmt, const int32_t mode, const OsdAlphaParam *ap)
+{
+    uint8_t *y = ov->y + row * ov->width;
+    uint8_t *ya = ov->ya + row * ov->width;
+    uint8_t *uv = ov->uv + row * 2 * ov->pairs;
+    uint8_t *uva = ov->uva + row * 2 * ov->pairs;
+
+    for (int32_t i = c0; i < c1; i += 2) {
+        int32_t r0, g0, b0, r1, g1, b1, r, g, b;
+        uint32_t a0, a1;
+
+        osd_src_rgb(src, i, fmt, &r0, &g0, &b0);
+        a0 = osd_eff_alpha(osd_src_alpha(src, i, fmt), fmt, mode, ap);
+        y[i] = (uint8_t)osd_rgb_y(r0, g0, b0);
+        ya[i] = (uint8_t)a0;
+        if (i + 1 < c1) {
+            osd_src_rgb(src, i + 1, fmt, &r1, &g1, &b1);
+            a1 = osd_eff_alpha(osd_src_alpha(src, i + 1, fmt), fmt, mode, ap);
+            y[i + 1] = (uint8_t)osd_rgb_y(r1, g1, b1);
+            ya[i + 1] = (uint8_t)a1;
+        } else {
+            r1 = r0;
+            g1 = g0;
+            b1 = b0;
+            a1 = a0;
+        }
+        r = (r0 + r1 + 1) >> 1;
+        g = (g0 + g1 + 1) >> 1;
+        b = (b0 + b1 + 1) >> 1;
+        uv[i] = (uint8_t)osd_rgb_u(r, g, b);
+        uv[i + 1] = (uint8_t)osd_rgb_v(r, g, b);
+        uva[i] = uva[i + 1] = (uint8_t)((a0 + a1 + 1) >> 1);
+    }
+}
+
+#define OSD_CONVERT_KERNEL(name, fmt, mode)                                                     \
+    static void name(OsdOverlay *ov, int32_t row, int32_t c0, int32_t c1, const uint8_t *src,    \
+                     const OsdAlphaParam *ap)                                                   \
+    {                                                                                           \
+        osd_convert(ov, row, c0, c1, src, fmt, mode, ap);                                       \
+    }
+
+OSD_CONVERT_KERNEL(convert_1555_pixel, OSD_BLEND_FMT_ARGB1555, OSD_BLEND_ALPHA_PIXEL)
+OSD_CONVERT_KERNEL(convert_1555_global, OSD_BLEND_FMT_ARGB1555, OSD_BLEND_ALPHA_GLOBAL)
+OSD_CONVERT_KERNEL(convert_1555_none, OSD_BLEND_FMT_ARGB1555, OSD_BLEND_ALPHA_NONE)
+OSD_CONVERT_KERNEL(convert_8888_pixel, OSD_BLEND_FMT_ARGB8888, OSD_BLEND_ALPHA_PIXEL)
+OSD_CONVERT_KERNEL(convert_8888_global, OSD_BLEND_FMT_ARGB8888, OSD_BLEND_ALPHA_GLOBAL)
+OSD_CONVERT_KERNEL(convert_8888_none, OSD_BLEND_FMT_ARGB8888, OSD_BLEND_ALPHA_NONE)
+OSD_CONVERT_KERNEL(convert_bgra_pixel, OSD_BLEND_FMT_BGRA, OSD_BLEND_ALPHA_PIXEL)
+OSD_CONVERT_KERNEL(convert_bgra_global, OSD_BLEND_FMT_BGRA, OSD_BLEND_ALPHA_GLOBAL)
+OSD_CONVERT_KERNEL(convert_bgra_none, OSD_BLEND_FMT_BGRA, OSD_BLEND_ALPHA_NONE)
+
+static const OsdConvertKernel osd_convert_kernels[OSD_BLEND_FMT_NUM][OSD_BLEND_ALPHA_NUM] = {
+    { convert_1555_pixel, convert_1555_global, convert_1555_none },
+    { convert_8888_pixel, convert_8888_global, convert_8888_none },
+    { convert_bgra_pixel, convert_bgra_global, convert_bgra_none },
+};
+
+/* d[i] = mix(d[i], s[i], a[i]). In 16-bit lanes t = s * a + d * (255 - a)
+ * + 128 stays below 65536 and (t + (t >> 8)) >> 8 is the same rounded
+ * division osd_div255() does. */
+#ifdef OSD_BLEND_VECTOR
+typedef uint8_t  v8u8  __attribute__((vector_size(8)));
+typedef uint16_t v8u16 __attribute__((vector_size(16)));
+
+static void osd_mix_row(uint8_t *d, const uint8_t *s, const uint8_t *a, int32_t n)
+{
+    int32_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        v8u8 dv, sv, av;
+        v8u16 a16, t;
+
+        memcpy(&dv, d + i, 8);
+        memcpy(&sv, s + i, 8);
+        memcpy(&av, a + i, 8);
+        a16 = __builtin_convertvector(av, v8u16);
+        t = __builtin_convertvector(sv, v8u16) * a16 + __builtin_convertvector(dv, v8u16) * (255 - a16) + 128;
+        t = (t + (t >> 8)) >> 8;
+        dv = __builtin_convertvector(t, v8u8);
+        memcpy(d + i, &dv, 8);
+    }
+    for (; i < n; i++) {
+        d[i] = osd_mix(d[i], s[i], a[i]);
+    }
+}
+#else
+static void osd_mix_row(uint8_t *d, const uint8_t *s, const uint8_t *a, int32_t n)
+{
+    for (int32_t i = 0; i < n; i++) {
+        d[i] = osd_mix(d[i], s[i], a[i]);
+    }
+}
+#endif
+
+static void osd_overlay_free_planes(OsdOverlay *ov)
+{
+    free(ov->y);
+    free(ov->ya);
+    free(ov->uv);
+    free(ov->uva);
+    free(ov->shadow);
+    free(ov->tile);
+    ov->y = ov->ya = ov->uv = ov->uva = ov->shadow = ov->tile = NULL;
+    ov->valid = 0;
+}
+
+static int32_t osd_overlay_alloc_planes(OsdOverlay *ov, int32_t width, int32_t height, int32_t row_bytes)
+{
+    size_t n = (size_t)width * height;
+
+    osd_overlay_free_planes(ov);
+    ov->width = width;
+    ov->height = height;
+    ov->row_bytes = row_bytes;
+    ov->pairs = (width + 1) / 2;
+    ov->tiles_x = (width + OSD_OVERLAY_TILE_W - 1) / OSD_OVERLAY_TILE_W;
+    ov->tiles_y = (height + OSD_OVERLAY_TILE_H - 1) / OSD_OVERLAY_TILE_H;
+    ov->y = (uint8_t *)malloc(n);
+    ov->ya = (uint8_t *)malloc(n);
+    ov->uv = (uint8_t *)malloc((size_t)2 * ov->pairs * height);
+    ov->uva = (uint8_t *)malloc((size_t)2 * ov->pairs * height);
+    ov->shadow = (uint8_t *)malloc((size_t)row_bytes * height);
+    ov->tile = (uint8_t *)malloc((size_t)ov->tiles_x * ov->tiles_y);
+    if (ov->y == NULL || ov->ya == NULL || ov->uv == NULL || ov->uva == NULL || ov->shadow == NULL ||
+        ov->tile == NULL) {
+        osd_overlay_free_planes(ov);
+        return -1;
+    }
+    return 0;
+}
+
+static int32_t osd_tile_state(const OsdOverlay *ov, int32_t c0, int32_t c1, int32_t r0, int32_t r1)
+{
+    uint32_t o = 0, a = 255;
+
+    for (int32_t r = r0; r < r1; r++) {
+        const uint8_t *ya = ov->ya + r * ov->width;
+        const uint8_t *uva = ov->uva + r * 2 * ov->pairs;
+
+        for (int32_t i = c0; i < c1; i++) {
+            o |= ya[i] | uva[i];
+            a &= ya[i] & uva[i];
+        }
+    }
+    return o == 0 ? OSD_TILE_CLEAR : (a == 255 ? OSD_TILE_OPAQUE : OSD_TILE_MIXED);
+}
+
+OsdOverlay *osd_overlay_create(void)
+{
+    return (OsdOverlay *)calloc(1, sizeof(OsdOverlay));
+}
+
+void osd_overlay_destroy(OsdOverlay *ov)
+{
+    if (ov != NULL) {
+        osd_overlay_free_planes(ov);
+        free(ov);
+    }
+}
+
+int32_t osd_overlay_update(OsdOverlay *ov, const OsdPicture *pic, int32_t alpha_mode,
+                           int32_t fg_alpha, int32_t bg_alpha, OsdBlendStats *st)
+{
+    OsdConvertKernel kernel;
+    OsdAlphaParam ap;
+    const uint8_t *src;
+    int32_t bpp, full, converted = 0;
+
+    if (ov == NULL || pic == NULL || pic->data == NULL || pic->fmt < 0 || pic->fmt >= OSD_BLEND_FMT_NUM ||
+        alpha_mode < 0 || alpha_mode >= OSD_BLEND_ALPHA_NUM || pic->width <= 0 || pic->height <= 0) {
+        return -1;
+    }
+
+    bpp = pic->fmt == OSD_BLEND_FMT_ARGB1555 ? 2 : 4;
+    ap.fg_alpha = (uint32_t)(fg_alpha < 0 ? 0 : (fg_alpha > 255 ? 255 : fg_alpha));
+    ap.bg_alpha = (uint32_t)(bg_alpha < 0 ? 0 : (bg_alpha > 255 ? 255 : bg_alpha));
+
+    full = !ov->valid || ov->fmt != pic->fmt || ov->mode != alpha_mode || ov->fg_alpha != ap.fg_alpha ||
+           ov->bg_alpha != ap.bg_alpha || ov->width != pic->width || ov->height != pic->height;
+    if (full && (ov->y == NULL || ov->width != pic->width || ov->height != pic->height || ov->row_bytes != pic->width * bpp)) {
+        if (osd_overlay_alloc_planes(ov, pic->width, pic->height, pic->width * bpp) != 0) {
+            return -1;
+        }
+    }
+    ov->fmt = pic->fmt;
+    ov->mode = alpha_mode;
+    ov->fg_alpha = ap.fg_alpha;
+    ov->bg_alpha = ap.bg_alpha;
+
+    kernel = osd_convert_kernels[pic->fmt][alpha_mode];
+    src = (const uint8_t *)pic->data;
+    for (int32_t ty = 0; ty < ov->tiles_y; ty++) {
+        int32_t r0 = ty * OSD_OVERLAY_TILE_H;
+        int32_t r1 = r0 + OSD_OVERLAY_TILE_H < ov->height ? r0 + OSD_OVERLAY_TILE_H : ov->height;
+
+        for (int32_t tx = 0; tx < ov->tiles_x; tx++) {
+            int32_t c0 = tx * OSD_OVERLAY_TILE_W;
+            int32_t c1 = c0 + OSD_OVERLAY_TILE_W < ov->width ? c0 + OSD_OVERLAY_TILE_W : ov->width;
+            size_t off = (size_t)c0 * bpp, len = (size_t)(c1 - c0) * bpp;
+            int32_t r;
+
+            /* Dirty check: the tile's source bytes against the last conversion */
+            if (!full) {
+                for (r = r0; r < r1; r++) {
+                    if (memcmp(src + r * pic->stride + off, ov->shadow + r * ov->row_bytes + off, len) != 0) {
+                        break;
+                    }
+                }
+                if (r == r1) {
+                    continue;
+                }
+            }
+
+            for (r = r0; r < r1; r++) {
+                const uint8_t *row = src + r * pic->stride;
+
+                memcpy(ov->shadow + r * ov->row_bytes + off, row + off, len);
+                kernel(ov, r, c0, c1, row, &ap);
+            }
+            ov->tile[ty * ov->tiles_x + tx] = (uint8_t)osd_tile_state(ov, c0, c1, r0, r1);
+            converted++;
+            if (st != NULL) {
+                st->pixels_converted += (uint32_t)((c1 - c0) * (r1 - r0));
+            }
+        }
+    }
+
+    ov->valid = 1;
+    return converted;
+}
+
+int32_t osd_overlay_blend(const OsdOverlay *ov, const OsdFrame *dst, int32_t x, int32_t y, OsdBlendStats *st)
+{
+    int32_t fx = x, fy = y, w, h, sx, sy, blended = 0;
+
+    if (ov == NULL || dst == NULL || !ov->valid || (x & 1)) {
+        return -1;
+    }
+    w = ov->width;
+    h = ov->height;
+    if (!osd_clip(dst, &fx, &fy, &w, &h)) {
+        return 0;
+    }
+    sx = fx - x;
+    sy = fy - y;
+
+    for (int32_t ty = sy / OSD_OVERLAY_TILE_H; ty * OSD_OVERLAY_TILE_H < sy + h; ty++) {
+        int32_t r0 = ty * OSD_OVERLAY_TILE_H > sy ? ty * OSD_OVERLAY_TILE_H : sy;
+        int32_t r1 = (ty + 1) * OSD_OVERLAY_TILE_H < sy + h ? (ty + 1) * OSD_OVERLAY_TILE_H : sy + h;
+
+        for (int32_t tx = sx / OSD_OVERLAY_TILE_W; tx * OSD_OVERLAY_TILE_W < sx + w; tx++) {
+            int32_t state = ov->tile[ty * ov->tiles_x + tx];
+            int32_t c0 = tx * OSD_OVERLAY_TILE_W > sx ? tx * OSD_OVERLAY_TILE_W : sx;
+            int32_t c1 = (tx + 1) * OSD_OVERLAY_TILE_W < sx + w ? (tx + 1) * OSD_OVERLAY_TILE_W : sx + w;
+            int32_t n = c1 - c0, np = (n + 1) >> 1;
+
+            if (state == OSD_TILE_CLEAR) {
+                if (st != NULL) {
+                    st->tiles_skipped++;
+                }
+                continue;
+            }
+
+            for (int32_t r = r0; r < r1; r++) {
+                int32_t frow = y + r;
+                uint8_t *dy = dst->y + frow * dst->stride + x + c0;
+                const uint8_t *oy = ov->y + r * ov->width + c0;
+                const uint8_t *oa = ov->ya + r * ov->width + c0;
+
+                if (state == OSD_TILE_OPAQUE) {
+                    memcpy(dy, oy, (size_t)n);
+                } else {
+                    osd_mix_row(dy, oy, oa, n);
+                }
+
+                if (!(frow & 1)) {
+                    uint8_t *duv = dst->uv + (frow >> 1) * dst->stride + x + c0;
+                    const uint8_t *ouv = ov->uv + r * 2 * ov->pairs + c0;
+
+                    if (state == OSD_TILE_OPAQUE) {
+                        memcpy(duv, ouv, (size_t)(2 * np));
+                    } else {
+                        osd_mix_row(duv, ouv, ov->uva + r * 2 * ov->pairs + c0, 2 * np);
+                    }
+                }
+            }
+            blended += n * (r1 - r0);
+        }
+    }
+
+    if (st != NULL) {
+        st->pixels_blended += (uint32_t)blended;
+    }
+    return blended;
+}
+
+/* ---- Glyph atlases ---- */
+
+struct OsdGlyphAtlas {
+    uint16_t *yp;                   /* Luma * alpha; glyph g row r starts at (g * glyph_h + r) * glyph_w */
+    uint8_t *yia;                   /* 255 - luma alpha */
+    uint16_t *uvp;                  /* CbCr * chroma alpha, every row, same layout */
+    uint8_t *uvia;                  /* 255 - chroma alpha */
+    uint16_t *span;                 /* Per glyph row: first and last + 1 column with any alpha, pair aligned */
+    uint8_t map[256];               /* Character -> glyph index */
+    int32_t glyph_w;
+    int32_t glyph_h;
+    int32_t count;
+};
+
+/* d[i] = (p[i] + d[i] * ia[i]) / 255, rounded: osd_mix() with s * a done
+ * up front */
+#ifdef OSD_BLEND_VECTOR
+static void osd_mix_premul_row(uint8_t *d, const uint16_t *p, const uint8_t *ia, int32_t n)
+{
+    int32_t i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        v8u8 dv, iv;
+        v8u16 pv, t;
+
+        memcpy(&dv, d + i, 8);
+        memcpy(&pv, p + i, 16);
+        memcpy(&iv, ia + i, 8);
+        t = pv + __builtin_convertvector(dv, v8u16) * __builtin_convertvector(iv, v8u16) + 128;
+        t = (t + (t >> 8)) >> 8;
+        dv = __builtin_convertvector(t, v8u8);
+        memcpy(d + i, &dv, 8);
+    }
+    for (; i < n; i++) {
+        d[i] = (uint8_t)osd_div255(p[i] + (uint32_t)d[i] * ia[i]);
+    }
+}
+#else
+static void osd_mix_premul_row(uint8_t *d, const uint16_t *p, const uint8_t *ia, int32_t n)
+{
+    for (int32_t i = 0; i < n; i++) {
+        d[i] = (uint8_t)osd_div255(p[i] + (uint32_t)d[i] * ia[i]);
+    }
+}
+#endif
+
+void osd_glyph_atlas_destroy(OsdGlyphAtlas *at)
+{
+    if (at != NULL) {
+        free(at->yp);
+        free(at->yia);
+        free(at->uvp);
+        free(at->uvia);
+        free(at->span);
+        free(at);
+    }
+}
+
+OsdGlyphAtlas *osd_glyph_atlas_create(const OsdPicture *strip, const char *chars, int32_t glyph_w,
+                                      int32_t alpha_mode, int32_t fg_alpha, int32_t bg_alpha,
+                                      OsdBlendStats *st)
+{
+    OsdGlyphAtlas *at;
+    OsdOverlay *ov;
+    size_t cells;
+    int32_t count, gh;
+
+    if (strip == NULL || chars == NULL || glyph_w <= 0 || (glyph_w & 1) || glyph_w > strip->width) {
+        return NULL;
+    }
+    count = strip->width / glyph_w;
+    if ((size_t)count > strlen(chars)) {
+        count = (int32_t)strlen(chars);
+    }
+    if (count <= 0 || count >= OSD_GLYPH_NONE) {
+        return NULL;
+    }
+
+    /* The strip goes through the overlay converter once; the atlas keeps
+     * its planes regrouped per glyph with the alpha folded in */
+    ov = osd_overlay_create();
+    at = (OsdGlyphAtlas *)calloc(1, sizeof(OsdGlyphAtlas));
+    if (ov == NULL || at == NULL || osd_overlay_update(ov, strip, alpha_mode, fg_alpha, bg_alpha, st) < 0) {
+        osd_overlay_destroy(ov);
+        osd_glyph_atlas_destroy(at);
+        return NULL;
+    }
+
+    gh = strip->height;
+    cells = (size_t)count * gh * glyph_w;
+    at->glyph_w = glyph_w;
+    at->glyph_h = gh;
+    at->count = count;
+    at->yp = (uint16_t *)malloc(cells * sizeof(uint16_t));
+    at->yia = (uint8_t *)malloc(cells);
+    at->uvp = (uint16_t *)malloc(cells * sizeof(uint16_t));
+    at->uvia = (uint8_t *)malloc(cells);
+    at->span = (uint16_t *)malloc((size_t)count * gh * 2 * sizeof(uint16_t));
+    if (at->yp == NULL || at->yia == NULL || at->uvp == NULL || at->uvia == NULL || at->span == NULL) {
+        osd_overlay_destroy(ov);
+        osd_glyph_atlas_destroy(at);
+        return NULL;
+    }
+
+    for (int32_t g = 0; g < count; g++) {
+        for (int32_t r = 0; r < gh; r++) {
+            const uint8_t *y = ov->y + r * ov->width + g * glyph_w;
+            const uint8_t *ya = ov->ya + r * ov->width + g * glyph_w;
+            const uint8_t *uv = ov->uv + r * 2 * ov->pairs + g * glyph_w;
+            const uint8_t *uva = ov->uva + r * 2 * ov->pairs + g * glyph_w;
+            size_t row = (size_t)g * gh + r, o = row * glyph_w;
+            int32_t c0 = glyph_w, c1 = 0;
+
+            for (int32_t i = 0; i < glyph_w; i++) {
+                at->yp[o + i] = (uint16_t)(y[i] * ya[i]);
+                at->yia[o + i] = (uint8_t)(255 - ya[i]);
+                at->uvp[o + i] = (uint16_t)(uv[i] * uva[i]);
+                at->uvia[o + i] = (uint8_t)(255 - uva[i]);
+                if (ya[i] | uva[i]) {
+                    c0 = i < c0 ? i : c0;
+                    c1 = i + 1;
+                }
+            }
+            if (c0 >= c1) {
+                c0 = c1 = 0;
+            }
+            at->span[2 * row] = (uint16_t)(c0 & ~1);
+            at->span[2 * row + 1] = (uint16_t)((c1 + 1) & ~1);
+        }
+    }
+
+    memset(at->map, OSD_GLYPH_NONE, sizeof(at->map));
+    for (int32_t i = 0; i < count; i++) {
+        at->map[(uint8_t)chars[i]] = (uint8_t)i;
+    }
+    osd_overlay_destroy(ov);
+    return at;
+}
+
+void osd_glyph_atlas_cell(const OsdGlyphAtlas *at, int32_t *w, int32_t *h)
+{
+    *w = at != NULL ? at->glyph_w : 0;
+    *h = at != NULL ? at->glyph_h : 0;
+}
+
+int32_t osd_glyph_map(const OsdGlyphAtlas *at, const char *text, uint8_t *glyphs, int32_t max)
+{
+    int32_t n = 0;
+
+    if (at == NULL || text == NULL || glyphs == NULL) {
+        return 0;
+    }
+    for (; n < max && text[n] != '\0'; n++) {
+        glyphs[n] = at->map[(uint8_t)text[n]];
+    }
+    return n;
+}
+
+int32_t osd_blend_glyphs(const OsdGlyphAtlas *at, const OsdFrame *dst, int32_t x, int32_t y,
+                         const uint8_t *glyphs, int32_t n, OsdBlendStats *st)
+{
+    int32_t gw, gh, r0, r1, blended = 0;
+
+    if (at == NULL || dst == NULL || (glyphs == NULL && n > 0) || (x & 1)) {
+        return -1;
+    }
+    gw = at->glyph_w;
+    gh = at->glyph_h;
+    r0 = y < 0 ? -y : 0;
+    r1 = dst->height - y < gh ? dst->height - y : gh;
+
+    for (int32_t i = 0; i < n && r0 < r1; i++) {
+        int32_t gx = x + i * gw;
+        int32_t c0 = gx < 0 ? -gx : 0;
+        int32_t c1 = dst->width - gx < gw ? dst->width - gx : gw;
+
+        if (glyphs[i] >= at->count || c0 >= c1) {
+            continue;
+        }
+        for (int32_t r = r0; r < r1; r++) {
+            size_t row = (size_t)glyphs[i] * gh + r;
+            int32_t s0 = at->span[2 * row] > c0 ? at->span[2 * row] : c0;
+            int32_t s1 = at->span[2 * row + 1] < c1 ? at->span[2 * row + 1] : c1;
+            int32_t fy = y + r;
+
+            /* Columns outside the span have zero alpha and leave the frame as is */
+            if (s0 >= s1) {
+                continue;
+            }
+            osd_mix_premul_row(dst->y + fy * dst->stride + gx + s0, at->yp + row * gw + s0,
+                               at->yia + row * gw + s0, s1 - s0);
+            if (!(fy & 1)) {
+                osd_mix_premul_row(dst->uv + (fy >> 1) * dst->stride + gx + s0, at->uvp + row * gw + s0,
+                                   at->uvia + row * gw + s0, (s1 - s0 + 1) & ~1);
+            }
+        }
+        blended += (c1 - c0) * (r1 - r0);
+    }
+
+    if (st != NULL) {
+        st->pixels_blended += (uint32_t)blended;
+    }
+    return blended;
+}
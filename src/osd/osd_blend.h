@@ -0,0 +1,138 @@
+/**
+ * OSD software blend engine
+ *
+ * Composites ARGB1555 / ARGB8888 / BGRA overlays, solid fills, lines and
+ * rectangles onto NV12 frames, plus text from pre-converted glyph atlases.
+ * Overlay rows go through span kernels that are specialised per source
+ * format and alpha mode at compile time and picked from a table, so the
+ * per-pixel loop carries no format or mode branches.
+ */
+
+#ifndef OSD_BLEND_H
+#define OSD_BLEND_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+enum {
+    OSD_BLEND_FMT_ARGB1555 = 0,     /* uint16, bit 15 = opaque */
+    OSD_BLEND_FMT_ARGB8888 = 1,     /* uint32 0xAARRGGBB, native endian */
+    OSD_BLEND_FMT_BGRA     = 2,     /* Bytes B, G, R, A in memory */
+    OSD_BLEND_FMT_NUM
+};
+
+enum {
+    OSD_BLEND_ALPHA_PIXEL  = 0,     /* Source alpha only */
+    OSD_BLEND_ALPHA_GLOBAL = 1,     /* Source alpha scaled by fg_alpha; ARGB1555 picks fg/bg by its bit */
+    OSD_BLEND_ALPHA_NONE   = 2,     /* Copy, source alpha ignored */
+    OSD_BLEND_ALPHA_NUM
+};
+
+typedef struct {
+    uint8_t *y;                     /* Luma plane */
+    uint8_t *uv;                    /* Interleaved CbCr plane, height / 2 rows */
+    int32_t width;                  /* Pixels */
+    int32_t height;                 /* Rows */
+    int32_t stride;                 /* Bytes per row of both planes */
+} OsdFrame;
+
+typedef struct {
+    const void *data;
+    int32_t fmt;                    /* OSD_BLEND_FMT_* */
+    int32_t width;
+    int32_t height;
+    int32_t stride;                 /* Bytes per source row */
+} OsdPicture;
+
+/* Per-frame work counters */
+typedef struct {
+    uint32_t pixels_converted;      /* Source pixels turned into YUV + alpha */
+    uint32_t pixels_blended;        /* Frame pixels written */
+    uint32_t tiles_skipped;         /* Clear overlay tiles not touched */
+} OsdBlendStats;
+
+/* Overlay kept in blend-ready form (see osd_overlay_*) */
+typedef struct OsdOverlay OsdOverlay;
+
+/* Blend pic with its top-left corner at (x, y); parts outside the frame are
+ * clipped. Chroma is taken from the even frame rows of the picture.
+ * Returns the number of frame pixels written, -1 on bad arguments. */
+int32_t osd_blend_picture(const OsdFrame *dst, int32_t x, int32_t y, const OsdPicture *pic,
+                          int32_t alpha_mode, int32_t fg_alpha, int32_t bg_alpha);
+
+/* Solid 0xAARRGGBB fill of w x h pixels at (x, y). An alpha byte of 0 is
+ * taken as opaque so plain RGB colours keep working. Like the line and
+ * rectangle calls, returns the pixels written or -1. */
+int32_t osd_blend_fill(const OsdFrame *dst, int32_t x, int32_t y, int32_t w, int32_t h, uint32_t argb);
+
+/* Segment from (x0, y0) to (x1, y1), both inclusive, width pixels thick
+ * and centred on the segment */
+int32_t osd_blend_line(const OsdFrame *dst, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                       int32_t width, uint32_t argb);
+
+/* Outline of the box with inclusive corners (x0, y0) and (x1, y1); edges
+ * grow inwards so the outline never leaves the box */
+int32_t osd_blend_rect(const OsdFrame *dst, int32_t x0, int32_t y0, int32_t x1, int32_t y1,
+                       int32_t width, uint32_t argb);
+
+/* Pre-converted overlays for regions that are blended every frame but
+ * change rarely or only in places (logos, clocks). The overlay holds the
+ * picture as luma / chroma / alpha planes plus a copy of the source it was
+ * made from, split into OSD_OVERLAY_TILE_W x OSD_OVERLAY_TILE_H tiles.
+ * osd_overlay_update() converts only tiles whose source bytes changed;
+ * osd_overlay_blend() skips fully clear tiles and copies fully opaque ones.
+ * The result matches osd_blend_picture() bit for bit. */
+#define OSD_OVERLAY_TILE_W 32
+#define OSD_OVERLAY_TILE_H 16
+
+OsdOverlay *osd_overlay_create(void);
+void osd_overlay_destroy(OsdOverlay *ov);
+
+/* Bring the overlay in line with pic. A new size, format or alpha setting
+ * converts everything, otherwise only changed tiles. Returns the number of
+ * tiles converted, -1 on bad arguments or allocation failure. */
+int32_t osd_overlay_update(OsdOverlay *ov, const OsdPicture *pic, int32_t alpha_mode,
+                           int32_t fg_alpha, int32_t bg_alpha, OsdBlendStats *st);
+
+/* Composite with the top-left corner at (x, y); x must be even. Returns
+ * the number of frame pixels written, -1 on bad arguments. */
+int32_t osd_overlay_blend(const OsdOverlay *ov, const OsdFrame *dst, int32_t x, int32_t y, OsdBlendStats *st);
+
+/* Glyph atlases for text regions. A font strip of count glyphs, each
+ * glyph_w pixels wide and the strip's height tall, is converted once into
+ * NV12 layout with the alpha premultiplied in, so drawing a string is a
+ * list of glyph indices and one multiply-add per sample. glyph_w must be
+ * even so every glyph cell owns whole chroma pairs. chars[i] names glyph i;
+ * characters not in chars advance one cell without drawing. */
+typedef struct OsdGlyphAtlas OsdGlyphAtlas;
+
+#define OSD_GLYPH_NONE 0xff         /* Glyph index of an empty cell */
+
+OsdGlyphAtlas *osd_glyph_atlas_create(const OsdPicture *strip, const char *chars, int32_t glyph_w,
+                                      int32_t alpha_mode, int32_t fg_alpha, int32_t bg_alpha,
+                                      OsdBlendStats *st);
+void osd_glyph_atlas_destroy(OsdGlyphAtlas *at);
+
+/* Cell size of the atlas */
+void osd_glyph_atlas_cell(const OsdGlyphAtlas *at, int32_t *w, int32_t *h);
+
+/* Map up to max characters of text to glyph indices; returns the count */
+int32_t osd_glyph_map(const OsdGlyphAtlas *at, const char *text, uint8_t *glyphs, int32_t max);
+
+/* Draw n glyph cells left to right from (x, y); x must be even. Matches
+ * osd_blend_picture() of the same string rendered into a bitmap. Returns
+ * the frame pixels written, -1 on bad arguments. */
+int32_t osd_blend_glyphs(const OsdGlyphAtlas *at, const OsdFrame *dst, int32_t x, int32_t y,
+                         const uint8_t *glyphs, int32_t n, OsdBlendStats *st);
+
+/* Counters of the last frame composited for an OSD group (osd.c) */
+int32_t osd_get_blend_stats(int32_t grp, OsdBlendStats *out);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* OSD_BLEND_H */
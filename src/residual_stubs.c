@@ -153,15 +153,6 @@ void CreateHevcNuts(void *nuts) { (void)nuts; }
 
 int32_t PicStructToFieldNumber(int32_t pic_struct) { return pic_struct & 1; }
 
-void MorphRowFilter(const uint8_t *src, uint8_t *dst, int32_t width, int32_t ksize, int32_t op)
-{
-    (void)src; (void)dst; (void)width; (void)ksize; (void)op;
-}
-void MorphColumnFilter(const uint8_t *src, uint8_t *dst, int32_t width, int32_t height, int32_t ksize, int32_t op)
-{
-    (void)src; (void)dst; (void)width; (void)height; (void)ksize; (void)op;
-}
-
 static int32_t residual_stub_Ioii(int32_t a, int32_t b) { return a + b; }
 static int32_t residual_stub_loii(int32_t a, int32_t b) { return a - b; }
 
@@ -673,6 +664,7 @@ uint32_t _setRightPart32(uint32_t value);
 uint32_t _getLeftPart32(uint32_t value);
 uint32_t _getRightPart32(uint32_t value);
 int32_t is_has_simd128(void);
+int32_t nv12_resize_accelerated(void);
 int32_t Rtos_GetTime(void);
 
 /* Resize kernels — in src/codec_c/resize{,_scalar}.c (return-type
@@ -1652,13 +1644,14 @@ int32_t on_encoder_group_data_update(void *arg1, void *arg2)
                     }
                 }
 
-                /* Select resize kernel — SIMD128 if CPU supports it. */
+                /* Select resize kernel — SIMD128 if CPU supports it, or the
+                 * NV12 vector scaler behind c_resize_simd when it can run. */
                 if (*enc_channel_resize_user_slot(chn) == NULL ||
                     *enc_channel_resize_tmp_slot(chn) == NULL) {
                     /* Stash source-frame user pointer so sub_8f698 can
                      * re-emit it to the resize kernel. */
                     *enc_channel_resize_user_slot(chn) = *(void **)(frame + 7 * 4);
-                    if (is_has_simd128() == 0) {
+                    if (is_has_simd128() == 0 && nv12_resize_accelerated() == 0) {
                         *enc_channel_resize_fn_slot(chn) = c_resize_c;
                     } else {
                         *enc_channel_resize_fn_slot(chn) = c_resize_simd;
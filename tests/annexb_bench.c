@@ -0,0 +1,241 @@
+/**
+ * Annex B NAL indexer check and micro-benchmark
+ *
+ * Builds H.264 and HEVC access units with 3- and 4-byte start codes,
+ * emulation-prevented slice data and zero padding, and checks the indexer
+ * against the byte-at-a-time splitter the stream dispatcher used before:
+ * same offsets and lengths, NAL types read with the right header layout
+ * per codec, and the same trailing-zero trim. Then times both splitting a
+ * key-frame-sized access unit.
+ *
+ * Build/run: make bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "bench_util.h"
+#include "annexb.h"
+
+#define AU_MAX    (256 * 1024)
+#define NAL_MAX   64
+
+/* The splitter annexb_index replaces */
+static size_t ref_find_start_code(const uint8_t *b, size_t off, size_t len, int *sc)
+{
+    for (size_t i = off; i + 3 < len; ++i) {
+        if (b[i] == 0x00 && b[i+1] == 0x00) {
+            if (b[i+2] == 0x01) {
+                if (sc) {
+                    *sc = 3;
+                }
+                return i;
+            }
+            if (i + 4 < len && b[i+2] == 0x00 && b[i+3] == 0x01) {
+                if (sc) {
+                    *sc = 4;
+                }
+                return i;
+            }
+        }
+    }
+    if (sc) {
+        *sc = 0;
+    }
+    return len;
+}
+
+static int ref_index(const uint8_t *b, size_t len, AnnexbNal *nals, int max)
+{
+    int sc = 0, count = 0;
+    size_t i = ref_find_start_code(b, 0, len, &sc);
+
+    while (i < len) {
+        size_t ns = i + (sc ? sc : 0);
+        int sc2 = 0;
+        size_t nx = ref_find_start_code(b, ns, len, &sc2);
+
+        if (count < max) {
+            nals[count].offset = (uint32_t)i;
+            nals[count].length = (uint32_t)(nx - i);
+            nals[count].type = b[ns] & 0x1F;
+        }
+        count++;
+        if (nx >= len) break;
+        i = nx; sc = sc2;
+    }
+    return count;
+}
+
+static uint32_t rng = 12345;
+/* One byte in zero_odds of the slice data is zero */
+static uint32_t zero_odds = 8;
+
+static uint32_t rnd(void)
+{
+    rng = rng * 1103515245u + 12345u;
+    return rng >> 8;
+}
+
+/* Slice payload with emulation prevention, so no start code inside */
+static size_t put_payload(uint8_t *p, size_t n)
+{
+    size_t o = 0;
+    int zeros = 0;
+
+    while (o < n) {
+        uint8_t v = (rnd() % zero_odds == 0) ? 0 : (uint8_t)(1 + rnd() % 255);
+
+        if (zeros >= 2 && v <= 3) {
+            p[o++] = 3;
+            zeros = 0;
+            continue;
+        }
+        p[o++] = v;
+        zeros = v == 0 ? zeros + 1 : 0;
+    }
+    /* A NAL never ends in a zero byte */
+    if (p[n - 1] == 0)
+        p[n - 1] = 0x80;
+    return n;
+}
+
+/* Access unit: the given NAL headers, each with a random-size payload */
+static size_t build_au(uint8_t *buf, const uint8_t *hdr, int hdr_len, int nnal,
+                       size_t max_payload, size_t pad, uint8_t *types, AnnexbCodec codec)
+{
+    size_t o = 0;
+
+    for (int n = 0; n < nnal; n++) {
+        if (n == 0 || rnd() % 2)
+            buf[o++] = 0;
+        buf[o++] = 0;
+        buf[o++] = 0;
+        buf[o++] = 1;
+        memcpy(buf + o, hdr + n * hdr_len, (size_t)hdr_len);
+        types[n] = annexb_nal_type(hdr[n * hdr_len], codec);
+        o += (size_t)hdr_len;
+        o += put_payload(buf + o, 1 + rnd() % max_payload);
+    }
+    memset(buf + o, 0, pad);
+    return o + pad;
+}
+
+static int check_codec(AnnexbCodec codec, uint8_t *buf)
+{
+    /* AUD, parameter sets, SEI, then slices */
+    static const uint8_t h264_hdr[] = { 0x09, 0x67, 0x68, 0x06, 0x65, 0x41, 0x41 };
+    static const uint8_t h264_types[] = { 9, 7, 8, 6, 5, 1, 1 };
+    static const uint8_t hevc_hdr[] = { 0x46, 0x01, 0x40, 0x01, 0x42, 0x01, 0x44, 0x01,
+                                        0x4e, 0x01, 0x26, 0x01, 0x02, 0x01, 0x02, 0x01 };
+    static const uint8_t hevc_types[] = { 35, 32, 33, 34, 39, 19, 1, 1 };
+    const uint8_t *hdr = codec == ANNEXB_HEVC ? hevc_hdr : h264_hdr;
+    const uint8_t *want = codec == ANNEXB_HEVC ? hevc_types : h264_types;
+    int hdr_len = codec == ANNEXB_HEVC ? 2 : 1;
+    int nnal = codec == ANNEXB_HEVC ? 8 : 7;
+    AnnexbNal got[NAL_MAX], ref[NAL_MAX];
+    uint8_t types[NAL_MAX];
+    int failures = 0;
+
+    for (int iter = 0; iter < 2000; iter++) {
+        size_t pad = rnd() % 3 ? rnd() % 40 : 0;
+        size_t len = build_au(buf, hdr, hdr_len, nnal, 1 + rnd() % 3000, pad, types, codec);
+        /* Start the AU at every alignment */
+        size_t shift = (size_t)iter % 8;
+        int n, nr;
+
+        memmove(buf + shift, buf, len);
+        n = annexb_index(buf + shift, len, codec, got, NAL_MAX);
+        nr = ref_index(buf + shift, len, ref, NAL_MAX);
+        failures += n != nnal || nr != n;
+        for (int i = 0; i < n && i < nr; i++) {
+            failures += got[i].offset != ref[i].offset || got[i].length != ref[i].length;
+            failures += got[i].type != types[i] || got[i].type != want[i];
+        }
+        {
+            size_t end = len;
+
+            while (end > 0 && buf[shift + end - 1] == 0)
+                end--;
+            failures += annexb_trim_zeros(buf + shift, len) != end;
+        }
+    }
+
+    /* A short table still counts every NAL */
+    {
+        size_t len = build_au(buf, hdr, hdr_len, nnal, 100, 0, types, codec);
+
+        failures += annexb_index(buf, len, codec, got, 2) != nnal;
+        failures += got[0].type != want[0] || got[1].type != want[1];
+    }
+
+    printf("%s: index vs reference: %s\n", codec == ANNEXB_HEVC ? "HEVC" : "H.264",
+           failures ? "FAIL" : "OK");
+    return failures;
+}
+
+static int check_edges(void)
+{
+    static const uint8_t none[] = { 0x12, 0x00, 0x00, 0x02, 0x00, 0x00 };
+    static const uint8_t tail[] = { 0x00, 0x00, 0x01 };
+    static const uint8_t zeros[64] = { 0 };
+    static const uint8_t lead[] = { 0xaa, 0xbb, 0x00, 0x00, 0x00, 0x01, 0x65, 0x88 };
+    AnnexbNal nal[4];
+    int sc = 0, failures = 0;
+
+    failures += annexb_index(none, sizeof(none), ANNEXB_H264, nal, 4) != 0;
+    /* A start code with nothing after it is not a NAL */
+    failures += annexb_index(tail, sizeof(tail), ANNEXB_H264, nal, 4) != 0;
+    failures += annexb_find_start(zeros, 0, sizeof(zeros), &sc) != sizeof(zeros) || sc != 0;
+    failures += annexb_trim_zeros(zeros, sizeof(zeros)) != 0;
+    failures += annexb_trim_zeros(NULL, 8) != 0;
+    /* Bytes before the first start code are left out */
+    failures += annexb_index(lead, sizeof(lead), ANNEXB_H264, nal, 4) != 1;
+    failures += nal[0].offset != 2 || nal[0].length != 6 || nal[0].sc_len != 4 || nal[0].type != 5;
+
+    return bench_check("edge cases", failures);
+}
+
+static void bench(uint8_t *buf)
+{
+    static const uint8_t hdr[] = { 0x09, 0x67, 0x68, 0x65 };
+    uint8_t types[NAL_MAX];
+    AnnexbNal nal[NAL_MAX];
+    const int iters = 2000;
+    volatile int sink = 0;
+    size_t len;
+    double t0, t_ref, t_new;
+
+    /* AUD, SPS, PPS and a large IDR slice; CABAC output is close
+     * to uniform, so zero bytes are about as rare as any other value */
+    zero_odds = 256;
+    len = build_au(buf, hdr, 1, 4, 64 * 1024, 0, types, ANNEXB_H264);
+
+    t0 = now_sec();
+    for (int i = 0; i < iters; i++)
+        sink += ref_index(buf, len, nal, NAL_MAX);
+    t_ref = now_sec() - t0;
+
+    t0 = now_sec();
+    for (int i = 0; i < iters; i++)
+        sink += annexb_index(buf, len, ANNEXB_H264, nal, NAL_MAX);
+    t_new = now_sec() - t0;
+
+    printf("split %zu-byte AU: byte scan (two calls) %.1f us, word scan %.1f us (%.1fx)\n",
+           len, t_ref / iters * 1e6 * 2, t_new / iters * 1e6, t_ref * 2 / t_new);
+    (void)sink;
+}
+
+int main(void)
+{
+    uint8_t *buf = malloc(AU_MAX);
+    int failures;
+
+    if (buf == NULL)
+        return 1;
+    failures = check_codec(ANNEXB_H264, buf) + check_codec(ANNEXB_HEVC, buf) + check_edges();
+    bench(buf);
+    free(buf);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,236 @@
+/**
+ * G.726 / IMA-ADPCM correctness check and throughput benchmark
+ *
+ * Runs the reference and optimized frame coders side by side over speech-
+ * like, noise, silence and clipped inputs in uneven frame sizes, checking
+ * that the bitstreams, decoded PCM and final codec state match exactly
+ * (decode also gets random bytes), then reports samples per second for
+ * each codec.
+ *
+ * Build/run: make bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <math.h>
+#include "bench_util.h"
+#include "audio_common.h"
+
+#define NUM_SAMPLES 48000
+
+static const int32_t g726_rates[4] = { 16000, 24000, 32000, 40000 };
+
+static void gen_signal(int16_t *p, int n, int kind, unsigned *seed)
+{
+    for (int i = 0; i < n; i++) {
+        switch (kind) {
+        case 0:     /* chirp with a slow envelope */
+            p[i] = (int16_t)(12000 * sin(i * 0.05 + i * (double)i * 1e-6) * (0.5 + 0.5 * sin(i * 0.001)));
+            break;
+        case 1:
+            p[i] = (int16_t)rand_r(seed);
+            break;
+        case 2:
+            p[i] = 0;
+            break;
+        case 3:     /* clipped square */
+            p[i] = ((i / 37) & 1) ? 32767 : -32768;
+            break;
+        default:    /* low-level noise */
+            p[i] = (int16_t)(rand_r(seed) % 200 - 100);
+            break;
+        }
+    }
+}
+
+static int check_g726(int rate, int kind, unsigned *seed)
+{
+    static int16_t pcm[NUM_SAMPLES], out_ref[2 * NUM_SAMPLES], out_fast[2 * NUM_SAMPLES];
+    static uint8_t code_ref[NUM_SAMPLES], code_fast[NUM_SAMPLES];
+    G726State ref, fast;
+    int pos = 0, n_ref = 0, n_fast = 0, m_ref = 0, m_fast = 0;
+
+    gen_signal(pcm, NUM_SAMPLES, kind, seed);
+    memset(&ref, 0, sizeof(ref));
+    memset(&fast, 0, sizeof(fast));
+    g726_init(&ref, rate);
+    g726_init(&fast, rate);
+    while (pos < NUM_SAMPLES) {
+        int len = 1 + rand_r(seed) % 400;
+        if (pos + len > NUM_SAMPLES)
+            len = NUM_SAMPLES - pos;
+        n_ref += g726_encode_ref(&ref, code_ref + n_ref, pcm + pos, len);
+        n_fast += g726_encode_fast(&fast, code_fast + n_fast, pcm + pos, len);
+        pos += len;
+    }
+    if (n_ref != n_fast || memcmp(code_ref, code_fast, n_ref) || memcmp(&ref, &fast, sizeof(ref)))
+        return 1;
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            for (int i = 0; i < n_ref; i++)
+                code_ref[i] = (uint8_t)rand_r(seed);
+        }
+        memset(&ref, 0, sizeof(ref));
+        memset(&fast, 0, sizeof(fast));
+        g726_init(&ref, rate);
+        g726_init(&fast, rate);
+        pos = m_ref = m_fast = 0;
+        while (pos < n_ref) {
+            int len = rand_r(seed) % 100;
+            if (pos + len > n_ref)
+                len = n_ref - pos;
+            m_ref += g726_decode_ref(&ref, out_ref + m_ref, code_ref + pos, len);
+            m_fast += g726_decode_fast(&fast, out_fast + m_fast, code_ref + pos, len);
+            pos += len;
+        }
+        if (m_ref != m_fast || memcmp(out_ref, out_fast, m_ref * sizeof(int16_t)) ||
+            memcmp(&ref, &fast, sizeof(ref)))
+            return 1;
+    }
+    return 0;
+}
+
+static int check_adpcm(int kind, unsigned *seed)
+{
+    static int16_t pcm[NUM_SAMPLES], out_ref[2 * NUM_SAMPLES], out_fast[2 * NUM_SAMPLES];
+    static char code_ref[NUM_SAMPLES], code_fast[NUM_SAMPLES];
+    AdpcmState ref = { 0, 0, 0 }, fast = { 0, 0, 0 };
+    int pos = 0, n_ref = 0, n_fast = 0, m = 0;   /* odd frames flush a half byte */
+
+    gen_signal(pcm, NUM_SAMPLES, kind, seed);
+    while (pos < NUM_SAMPLES) {
+        int len = 1 + rand_r(seed) % 400;
+        if (pos + len > NUM_SAMPLES)
+            len = NUM_SAMPLES - pos;
+        n_ref += adpcm_coder_ref(pcm + pos, code_ref + n_ref, len, &ref);
+        n_fast += adpcm_coder_fast(pcm + pos, code_fast + n_fast, len, &fast);
+        pos += len;
+    }
+    if (n_ref != n_fast || memcmp(code_ref, code_fast, n_ref) || memcmp(&ref, &fast, sizeof(ref)))
+        return 1;
+
+    for (int pass = 0; pass < 2; pass++) {
+        if (pass == 1) {
+            for (int i = 0; i < n_ref; i++)
+                code_ref[i] = (char)rand_r(seed);
+        }
+        memset(&ref, 0, sizeof(ref));
+        memset(&fast, 0, sizeof(fast));
+        pos = m = 0;
+        while (pos < n_ref) {
+            int len = 1 + rand_r(seed) % 100;
+            if (pos + len > n_ref)
+                len = n_ref - pos;
+            adpcm_decoder_ref(code_ref + pos, out_ref + m, 2 * len, &ref);
+            adpcm_decoder_fast(code_ref + pos, out_fast + m, 2 * len, &fast);
+            m += 2 * len;
+            pos += len;
+        }
+        if (memcmp(out_ref, out_fast, m * sizeof(int16_t)) || memcmp(&ref, &fast, sizeof(ref)))
+            return 1;
+    }
+    return 0;
+}
+
+static int check_bit_exact(void)
+{
+    unsigned seed = 11;
+    int failures = 0, runs = 0;
+
+    for (int kind = 0; kind < 5; kind++) {
+        for (int r = 0; r < 4; r++) {
+            runs++;
+            if (check_g726(g726_rates[r], kind, &seed)) {
+                printf("FAIL: G.726-%d signal %d\n", g726_rates[r] / 1000, kind);
+                failures++;
+            }
+        }
+        runs++;
+        if (check_adpcm(kind, &seed)) {
+            printf("FAIL: ADPCM signal %d\n", kind);
+            failures++;
+        }
+    }
+
+    printf("bit-exact fast vs reference: %d/%d OK\n", runs - failures, runs);
+    return failures;
+}
+
+static void report(const char *name, double t_ref, double t_fast, int samples)
+{
+    printf("%-16s reference %6.2f Msamples/s  fast %6.2f Msamples/s  (%.2fx)\n", name,
+           samples / t_ref / 1e6, samples / t_fast / 1e6, t_ref / t_fast);
+}
+
+static void bench(void)
+{
+    static int16_t pcm[NUM_SAMPLES], out[2 * NUM_SAMPLES];
+    static uint8_t code[NUM_SAMPLES];
+    static char acode[NUM_SAMPLES];
+    unsigned seed = 5;
+    char name[32];
+    double t0, t1, t2;
+
+    gen_signal(pcm, NUM_SAMPLES, 0, &seed);
+
+    for (int r = 0; r < 4; r++) {
+        G726State st;
+        int bytes;
+
+        /* 20 ms frames at 8 kHz, as AENC hands them over */
+        g726_init(&st, g726_rates[r]);
+        t0 = now_sec();
+        for (int i = 0; i < NUM_SAMPLES; i += 160)
+            g726_encode_ref(&st, code + i, pcm + i, 160);
+        t1 = now_sec();
+        g726_init(&st, g726_rates[r]);
+        bytes = 0;
+        for (int i = 0; i < NUM_SAMPLES; i += 160)
+            bytes += g726_encode_fast(&st, code + bytes, pcm + i, 160);
+        t2 = now_sec();
+        snprintf(name, sizeof(name), "G.726-%d enc", g726_rates[r] / 1000);
+        report(name, t1 - t0, t2 - t1, NUM_SAMPLES);
+
+        g726_init(&st, g726_rates[r]);
+        t0 = now_sec();
+        g726_decode_ref(&st, out, code, bytes);
+        t1 = now_sec();
+        g726_init(&st, g726_rates[r]);
+        g726_decode_fast(&st, out, code, bytes);
+        t2 = now_sec();
+        snprintf(name, sizeof(name), "G.726-%d dec", g726_rates[r] / 1000);
+        report(name, t1 - t0, t2 - t1, NUM_SAMPLES);
+    }
+
+    {
+        AdpcmState st = { 0, 0, 0 };
+        t0 = now_sec();
+        for (int n = 0; n < 20; n++)
+            adpcm_coder_ref(pcm, acode, NUM_SAMPLES, &st);
+        t1 = now_sec();
+        for (int n = 0; n < 20; n++)
+            adpcm_coder_fast(pcm, acode, NUM_SAMPLES, &st);
+        t2 = now_sec();
+        report("ADPCM enc", t1 - t0, t2 - t1, 20 * NUM_SAMPLES);
+
+        t0 = now_sec();
+        for (int n = 0; n < 20; n++)
+            adpcm_decoder_ref(acode, out, NUM_SAMPLES, &st);
+        t1 = now_sec();
+        for (int n = 0; n < 20; n++)
+            adpcm_decoder_fast(acode, out, NUM_SAMPLES, &st);
+        t2 = now_sec();
+        report("ADPCM dec", t1 - t0, t2 - t1, 20 * NUM_SAMPLES);
+    }
+}
+
+int main(void)
+{
+    int failures = check_bit_exact();
+
+    bench();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,285 @@
+/**
+ * AVPU core scheduler check
+ *
+ * Runs a simulated core: one thread that encodes pushed frames in order
+ * and raises an interrupt per frame, which the scheduler's IRQ thread
+ * routes back to the channel. Checks grant order (class first, then
+ * deadline), the per-channel depth, and then drives main (25 fps, 14 ms
+ * per frame), sub (25 fps, 5 ms) and JPEG (5 fps, 12 ms) streams together
+ * for two seconds: every frame must be encoded and main must not miss a
+ * deadline.
+ *
+ * Build/run: make bench
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
+#include <unistd.h>
+#include "bench_util.h"
+#include "avpu_sched.h"
+
+#define CORE_MAX 32
+
+/* ---- Simulated core ---- */
+static pthread_mutex_t core_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t core_cond = PTHREAD_COND_INITIALIZER;
+static int32_t core_job[CORE_MAX], core_cost_us[CORE_MAX], core_jobs;
+static int32_t irq_chn[CORE_MAX], irqs;
+static int32_t core_stop, irq_unblocked;
+static int32_t delivered_to_wrong;
+
+static void *core_thread(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&core_lock);
+    while (!core_stop) {
+        int32_t chn, cost;
+
+        if (core_jobs == 0) {
+            pthread_cond_wait(&core_cond, &core_lock);
+            continue;
+        }
+        chn = core_job[0];
+        cost = core_cost_us[0];
+        pthread_mutex_unlock(&core_lock);
+        usleep((useconds_t)cost);
+        pthread_mutex_lock(&core_lock);
+        memmove(core_job, core_job + 1, (size_t)(core_jobs - 1) * sizeof(core_job[0]));
+        memmove(core_cost_us, core_cost_us + 1, (size_t)(core_jobs - 1) * sizeof(core_cost_us[0]));
+        core_jobs--;
+        irq_chn[irqs++] = chn;
+        pthread_cond_broadcast(&core_cond);
+    }
+    pthread_mutex_unlock(&core_lock);
+    return NULL;
+}
+
+static void core_push(int32_t chn, int32_t cost_us)
+{
+    pthread_mutex_lock(&core_lock);
+    core_job[core_jobs] = chn;
+    core_cost_us[core_jobs++] = cost_us;
+    pthread_cond_broadcast(&core_cond);
+    pthread_mutex_unlock(&core_lock);
+}
+
+/* The interrupt id carries the channel that finished, so delivery can be
+ * checked against it */
+static int wait_irq(void *arg, uint32_t *irq_id)
+{
+    (void)arg;
+    pthread_mutex_lock(&core_lock);
+    while (irqs == 0 && !irq_unblocked)
+        pthread_cond_wait(&core_cond, &core_lock);
+    if (irqs == 0) {
+        pthread_mutex_unlock(&core_lock);
+        return -1;
+    }
+    *irq_id = (uint32_t)irq_chn[0];
+    memmove(irq_chn, irq_chn + 1, (size_t)(irqs - 1) * sizeof(irq_chn[0]));
+    irqs--;
+    pthread_mutex_unlock(&core_lock);
+    return 0;
+}
+
+static void unblock_irq(void *arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&core_lock);
+    irq_unblocked = 1;
+    pthread_cond_broadcast(&core_cond);
+    pthread_mutex_unlock(&core_lock);
+}
+
+static int32_t owners[AVPU_SCHED_MAX_CHN];
+
+static void on_irq(void *owner, uint32_t irq_id)
+{
+    int32_t chn = *(int32_t *)owner;
+
+    if ((uint32_t)chn != irq_id)
+        __sync_fetch_and_add(&delivered_to_wrong, 1);
+    avpu_sched_complete(chn);
+}
+
+static int32_t attach(int32_t chn, int32_t prio, uint32_t period_us, int32_t depth)
+{
+    owners[chn] = chn;
+    /* An unblock the last IRQ thread exited without consuming */
+    pthread_mutex_lock(&core_lock);
+    irq_unblocked = 0;
+    pthread_mutex_unlock(&core_lock);
+    return avpu_sched_attach(chn, prio, period_us, depth, &owners[chn],
+                             wait_irq, unblock_irq, NULL, on_irq);
+}
+
+/* ---- Grant order ---- */
+static int32_t order[4], order_count;
+static pthread_mutex_t order_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static void *waiter(void *arg)
+{
+    int32_t chn = (int32_t)(intptr_t)arg;
+
+    if (avpu_sched_acquire(chn, 1000) == 0) {
+        pthread_mutex_lock(&order_lock);
+        order[order_count++] = chn;
+        pthread_mutex_unlock(&order_lock);
+        core_push(chn, 1000);
+    }
+    return NULL;
+}
+
+static int check_order(void)
+{
+    pthread_t t[3];
+    int failures = 0;
+
+    /* Sub holds the core; JPEG asks first, then two mains with different
+     * deadlines. Main 0 (shorter period, earlier deadline) goes first, the
+     * other main next, JPEG last. */
+    attach(0, AVPU_SCHED_PRIO_MAIN, 20000, 1);
+    attach(1, AVPU_SCHED_PRIO_SUB, 40000, 1);
+    attach(2, AVPU_SCHED_PRIO_JPEG, 40000, 1);
+    attach(3, AVPU_SCHED_PRIO_MAIN, 40000, 1);
+
+    failures += avpu_sched_acquire(1, 100) != 0;
+    pthread_create(&t[0], NULL, waiter, (void *)(intptr_t)2);
+    usleep(20000);
+    pthread_create(&t[1], NULL, waiter, (void *)(intptr_t)3);
+    usleep(5000);
+    pthread_create(&t[2], NULL, waiter, (void *)(intptr_t)0);
+    usleep(20000);
+    failures += order_count != 0;
+    core_push(1, 1000);
+    for (int i = 0; i < 3; i++)
+        pthread_join(t[i], NULL);
+    usleep(20000);
+
+    failures += order_count != 3 || order[0] != 0 || order[1] != 3 || order[2] != 2;
+    printf("grant order main(early) main sub-held jpeg: %d %d %d: %s\n",
+           order[0], order[1], order[2], failures ? "FAIL" : "OK");
+
+    for (int32_t chn = 0; chn < 4; chn++)
+        avpu_sched_detach(chn);
+    return failures;
+}
+
+/* ---- Depth ---- */
+static int check_depth(void)
+{
+    AvpuSchedStat st;
+    int failures = 0;
+
+    attach(0, AVPU_SCHED_PRIO_MAIN, 40000, 2);
+    attach(1, AVPU_SCHED_PRIO_SUB, 40000, 1);
+
+    /* Two frames of chn 0 may be queued; the third waits, and so does
+     * another channel while chn 0 is on the core */
+    failures += avpu_sched_acquire(0, 10) != 0;
+    failures += avpu_sched_acquire(0, 10) != 0;
+    failures += avpu_sched_acquire(0, 10) != -1;
+    failures += avpu_sched_acquire(1, 10) != -1;
+    avpu_sched_abort(0);
+    failures += avpu_sched_acquire(1, 10) != -1;
+    avpu_sched_complete(0);
+    failures += avpu_sched_acquire(1, 10) != 0;
+    avpu_sched_complete(1);
+
+    avpu_sched_get_stat(0, &st);
+    failures += st.jobs != 1 || st.timeouts != 1;
+    avpu_sched_get_stat(1, &st);
+    failures += st.jobs != 1 || st.timeouts != 2;
+    bench_check("depth and abort", failures);
+
+    avpu_sched_detach(0);
+    avpu_sched_detach(1);
+    return failures;
+}
+
+/* ---- Three streams ---- */
+typedef struct {
+    int32_t chn;
+    uint32_t period_us;
+    int32_t cost_us;
+    int32_t frames;
+    int32_t dropped;
+} Stream;
+
+static void *stream_thread(void *arg)
+{
+    Stream *s = (Stream *)arg;
+    uint64_t t0 = avpu_sched_now_us();
+
+    for (int32_t f = 0; f < s->frames; f++) {
+        uint64_t due = t0 + (uint64_t)f * s->period_us, now = avpu_sched_now_us();
+
+        if (due > now)
+            usleep((useconds_t)(due - now));
+        if (avpu_sched_acquire(s->chn, (int32_t)(s->period_us / 1000)) < 0) {
+            s->dropped++;
+            continue;
+        }
+        core_push(s->chn, s->cost_us);
+    }
+    return NULL;
+}
+
+static int check_streams(void)
+{
+    static const char *name[3] = { "main", "sub", "jpeg" };
+    Stream s[3] = {
+        { 0, 40000, 14000, 50, 0 },
+        { 1, 40000, 5000, 50, 0 },
+        { 2, 200000, 12000, 10, 0 },
+    };
+    pthread_t t[3];
+    AvpuSchedStat st[3];
+    int failures = 0;
+
+    attach(0, AVPU_SCHED_PRIO_MAIN, s[0].period_us, 1);
+    attach(1, AVPU_SCHED_PRIO_SUB, s[1].period_us, 1);
+    attach(2, AVPU_SCHED_PRIO_JPEG, s[2].period_us, 1);
+
+    for (int i = 0; i < 3; i++)
+        pthread_create(&t[i], NULL, stream_thread, &s[i]);
+    for (int i = 0; i < 3; i++)
+        pthread_join(t[i], NULL);
+    usleep(100000);
+
+    for (int i = 0; i < 3; i++) {
+        avpu_sched_get_stat(i, &st[i]);
+        printf("%-4s: %3u jobs %2d dropped  wait avg %5u max %5u us  run avg %5u max %5u us  %u missed\n",
+               name[i], st[i].jobs, s[i].dropped, st[i].wait_avg_us, st[i].wait_max_us,
+               st[i].run_avg_us, st[i].run_max_us, st[i].deadline_miss);
+        failures += st[i].jobs != (uint32_t)s[i].frames || s[i].dropped != 0;
+    }
+    failures += st[0].deadline_miss != 0;
+    failures += delivered_to_wrong != 0;
+    bench_check("three streams on one core", failures);
+
+    for (int32_t chn = 0; chn < 3; chn++)
+        avpu_sched_detach(chn);
+    return failures;
+}
+
+int main(void)
+{
+    pthread_t core;
+    int failures = 0;
+
+    pthread_create(&core, NULL, core_thread, NULL);
+
+    failures += check_order();
+    failures += check_depth();
+    failures += check_streams();
+
+    pthread_mutex_lock(&core_lock);
+    core_stop = 1;
+    pthread_cond_broadcast(&core_cond);
+    pthread_mutex_unlock(&core_lock);
+    pthread_join(core, NULL);
+    return failures ? 1 : 0;
+}
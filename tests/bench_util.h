@@ -0,0 +1,26 @@
+/**
+ * Helpers shared by the host checks and micro-benchmarks under tests/
+ */
+
+#ifndef BENCH_UTIL_H
+#define BENCH_UTIL_H
+
+#include <stdio.h>
+#include <time.h>
+
+/* Monotonic time in seconds */
+static inline double now_sec(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/* Print "what: OK" or "what: FAIL" and pass the failure count through */
+static inline int bench_check(const char *what, int failures)
+{
+    printf("%s: %s\n", what, failures ? "FAIL" : "OK");
+    return failures;
+}
+
+#endif /* BENCH_UTIL_H */
@@ -0,0 +1,139 @@
+/**
+ * G.711 codec correctness check and micro-benchmark
+ *
+ * Checks the table-driven frame coders against the single-sample routines
+ * for every 16-bit sample and every code byte, then times both on 20 ms
+ * frames (160 samples at 8 kHz).
+ *
+ * Build/run: make bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "bench_util.h"
+#include "audio_common.h"
+
+#define FRAME_SAMPLES 160
+#define ITERATIONS    200000
+
+static int check_bit_exact(void)
+{
+    static int16_t pcm[65536], out[256];
+    static uint8_t code[65536];
+    uint8_t all[256];
+    int failures = 0;
+
+    for (int i = 0; i < 65536; i++)
+        pcm[i] = (int16_t)i;
+    for (int i = 0; i < 256; i++)
+        all[i] = (uint8_t)i;
+
+    /* odd length so the unrolled body and the tail both run */
+    g711a_encode(code, pcm, 65535);
+    for (int i = 0; i < 65535; i++)
+        failures += code[i] != (uint8_t)linear2alaw(pcm[i]);
+    g711u_encode(code, pcm, 65535);
+    for (int i = 0; i < 65535; i++)
+        failures += code[i] != (uint8_t)linear2ulaw(pcm[i]);
+
+    g711a_decode(out, all, 255);
+    for (int i = 0; i < 255; i++)
+        failures += out[i] != (int16_t)alaw2linear(all[i]);
+    g711u_decode(out, all, 256);
+    for (int i = 0; i < 256; i++)
+        failures += out[i] != (int16_t)ulaw2linear(all[i]);
+
+    return bench_check("bit-exact table vs per-sample", failures) != 0;
+}
+
+static void bench(void)
+{
+    int16_t pcm[FRAME_SAMPLES], out[FRAME_SAMPLES];
+    uint8_t code[FRAME_SAMPLES];
+    unsigned seed = 3, sink = 0;
+    double t0, t1, t2;
+
+    for (int i = 0; i < FRAME_SAMPLES; i++)
+        pcm[i] = (int16_t)(rand_r(&seed) - RAND_MAX / 2);
+
+    t0 = now_sec();
+    for (int n = 0; n < ITERATIONS; n++) {
+        pcm[n % FRAME_SAMPLES] ^= 1;
+        for (int i = 0; i < FRAME_SAMPLES; i++)
+            code[i] = (uint8_t)linear2alaw(pcm[i]);
+        sink += code[n % FRAME_SAMPLES];
+    }
+    t1 = now_sec();
+    for (int n = 0; n < ITERATIONS; n++) {
+        pcm[n % FRAME_SAMPLES] ^= 1;
+        g711a_encode(code, pcm, FRAME_SAMPLES);
+        sink += code[n % FRAME_SAMPLES];
+    }
+    t2 = now_sec();
+    printf("A-law encode: per-sample %6.1f ns/frame  table %6.1f ns/frame  (%.2fx)\n",
+           (t1 - t0) * 1e9 / ITERATIONS, (t2 - t1) * 1e9 / ITERATIONS, (t1 - t0) / (t2 - t1));
+
+    t0 = now_sec();
+    for (int n = 0; n < ITERATIONS; n++) {
+        pcm[n % FRAME_SAMPLES] ^= 1;
+        for (int i = 0; i < FRAME_SAMPLES; i++)
+            code[i] = (uint8_t)linear2ulaw(pcm[i]);
+        sink += code[n % FRAME_SAMPLES];
+    }
+    t1 = now_sec();
+    for (int n = 0; n < ITERATIONS; n++) {
+        pcm[n % FRAME_SAMPLES] ^= 1;
+        g711u_encode(code, pcm, FRAME_SAMPLES);
+        sink += code[n % FRAME_SAMPLES];
+    }
+    t2 = now_sec();
+    printf("u-law encode: per-sample %6.1f ns/frame  table %6.1f ns/frame  (%.2fx)\n",
+           (t1 - t0) * 1e9 / ITERATIONS, (t2 - t1) * 1e9 / ITERATIONS, (t1 - t0) / (t2 - t1));
+
+    t0 = now_sec();
+    for (int n = 0; n < ITERATIONS; n++) {
+        code[n % FRAME_SAMPLES] ^= 1;
+        for (int i = 0; i < FRAME_SAMPLES; i++)
+            out[i] = (int16_t)alaw2linear(code[i]);
+        sink += (unsigned)out[n % FRAME_SAMPLES];
+    }
+    t1 = now_sec();
+    for (int n = 0; n < ITERATIONS; n++) {
+        code[n % FRAME_SAMPLES] ^= 1;
+        g711a_decode(out, code, FRAME_SAMPLES);
+        sink += (unsigned)out[n % FRAME_SAMPLES];
+    }
+    t2 = now_sec();
+    printf("A-law decode: per-sample %6.1f ns/frame  table %6.1f ns/frame  (%.2fx)\n",
+           (t1 - t0) * 1e9 / ITERATIONS, (t2 - t1) * 1e9 / ITERATIONS, (t1 - t0) / (t2 - t1));
+
+    t0 = now_sec();
+    for (int n = 0; n < ITERATIONS; n++) {
+        code[n % FRAME_SAMPLES] ^= 1;
+        for (int i = 0; i < FRAME_SAMPLES; i++)
+            out[i] = (int16_t)ulaw2linear(code[i]);
+        sink += (unsigned)out[n % FRAME_SAMPLES];
+    }
+    t1 = now_sec();
+    for (int n = 0; n < ITERATIONS; n++) {
+        code[n % FRAME_SAMPLES] ^= 1;
+        g711u_decode(out, code, FRAME_SAMPLES);
+        sink += (unsigned)out[n % FRAME_SAMPLES];
+    }
+    t2 = now_sec();
+    printf("u-law decode: per-sample %6.1f ns/frame  table %6.1f ns/frame  (%.2fx)\n",
+           (t1 - t0) * 1e9 / ITERATIONS, (t2 - t1) * 1e9 / ITERATIONS, (t1 - t0) / (t2 - t1));
+
+    if (sink == 0xdeadbeef)
+        printf("\n");
+}
+
+int main(void)
+{
+    int failures = check_bit_exact();
+
+    bench();
+    return failures ? 1 : 0;
+}
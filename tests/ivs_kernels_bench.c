@@ -0,0 +1,242 @@
+/**
+ * IVS kernel correctness check and micro-benchmark
+ *
+ * Compares the vector and scalar kernels byte for byte over a spread of
+ * geometries, checks the motion map against a direct 3x3 reference, then
+ * reports Mpix/s for every kernel on a 640x360 luma plane.
+ *
+ * Build/run: make bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "bench_util.h"
+#include "ivs_kernels.h"
+
+/* The dispatcher asks the system layer for the 128-bit unit on MIPS */
+__attribute__((weak)) int32_t is_video_has_simd128_proc(void) { return 1; }
+
+static void fill_random(uint8_t *p, size_t n, unsigned *seed)
+{
+    for (size_t i = 0; i < n; i++)
+        p[i] = (uint8_t)(rand_r(seed) >> 7);
+}
+
+/* Two planes that differ in patches, like consecutive frames with motion */
+static void fill_pair(uint8_t *a, uint8_t *b, size_t n, unsigned *seed)
+{
+    fill_random(a, n, seed);
+    for (size_t i = 0; i < n; i++)
+        b[i] = (rand_r(seed) & 7) == 0 ? (uint8_t)(rand_r(seed) >> 7) : a[i];
+}
+
+/* The 3x3 thresholded-difference erosion written the obvious way */
+static void diff_erode3_ref(const uint8_t *a, const uint8_t *b, int stride, uint8_t *dst,
+                            int w, int h, int thresh)
+{
+    for (int y = 0; y < h; y++) {
+        for (int x = 0; x < w; x++) {
+            uint8_t best = 0xff;
+
+            for (int dy = -1; dy <= 1; dy++) {
+                for (int dx = -1; dx <= 1; dx++) {
+                    int cy = y + dy < 0 ? 0 : (y + dy >= h ? h - 1 : y + dy);
+                    int cx = x + dx < 0 ? 0 : (x + dx >= w ? w - 1 : x + dx);
+                    int d = a[cy * stride + cx] - b[cy * stride + cx];
+
+                    d = d < 0 ? -d : d;
+                    if (d < thresh)
+                        d = 0;
+                    if (d < best)
+                        best = (uint8_t)d;
+                }
+            }
+            dst[y * w + x] = best;
+        }
+    }
+}
+
+static int check_kernels(void)
+{
+    static const int dims[][2] = {
+        { 640, 360 }, { 8, 8 }, { 24, 16 }, { 40, 24 }, { 17, 9 }, { 100, 37 }, { 322, 182 },
+    };
+    const IvsKernels *kc = ivs_kernels_get(0), *kv = ivs_kernels_get(1);
+    unsigned seed = 1;
+    int runs = 0, failures = 0;
+
+    for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); d++) {
+        int w = dims[d][0], h = dims[d][1], stride = w + 5;
+        size_t n = (size_t)stride * h;
+        uint8_t *a = malloc(n), *b = malloc(n), *o1 = malloc(n), *o2 = malloc(n);
+        uint16_t *s1 = malloc(n * sizeof(uint16_t)), *s2 = malloc(n * sizeof(uint16_t));
+
+        if (!a || !b || !o1 || !o2 || !s1 || !s2) {
+            printf("FAIL: allocation\n");
+            return 1;
+        }
+        fill_pair(a, b, n, &seed);
+
+        for (int bs = 8; bs <= 16; bs += 8) {
+            int nbx = w / bs, nby = h / bs, ok = 1;
+
+            memset(s1, 0, n * sizeof(uint16_t));
+            memset(s2, 0, n * sizeof(uint16_t));
+            kc->sad_blocks(a, stride, b, stride, w, h, bs, s1, nbx + 1);
+            kv->sad_blocks(a, stride, b, stride, w, h, bs, s2, nbx + 1);
+            ok &= memcmp(s1, s2, (size_t)(nbx + 1) * nby * sizeof(uint16_t)) == 0;
+            kc->sum_blocks(a, stride, w, h, bs, s1, nbx + 1);
+            kv->sum_blocks(a, stride, w, h, bs, s2, nbx + 1);
+            ok &= memcmp(s1, s2, (size_t)(nbx + 1) * nby * sizeof(uint16_t)) == 0;
+            if (!ok) {
+                printf("FAIL: %dx%d %dx%d blocks differ\n", w, h, bs, bs);
+                failures++;
+            }
+            runs++;
+        }
+
+        for (int th = 0; th <= 256; th += 32) {
+            kc->absdiff_row(a, b, o1, (int32_t)n, th);
+            kv->absdiff_row(a, b, o2, (int32_t)n, th);
+            if (memcmp(o1, o2, n)) {
+                printf("FAIL: %dx%d absdiff thresh %d differs\n", w, h, th);
+                failures++;
+            }
+            runs++;
+        }
+
+        for (int k = 1; k <= 15; k += 2) {
+            for (int op = IVS_MORPH_ERODE; op <= IVS_MORPH_DILATE; op++) {
+                const uint8_t *rows[15];
+                int ok;
+
+                kc->morph_row(a, o1, w, k, op);
+                kv->morph_row(a, o2, w, k, op);
+                ok = memcmp(o1, o2, (size_t)w) == 0;
+                for (int j = 0; j < k; j++)
+                    rows[j] = a + (size_t)(j % h) * stride;
+                kc->morph_column(rows, k, o1, w, op);
+                kv->morph_column(rows, k, o2, w, op);
+                ok &= memcmp(o1, o2, (size_t)w) == 0;
+                if (!ok) {
+                    printf("FAIL: %dx%d morph k %d op %d differs\n", w, h, k, op);
+                    failures++;
+                }
+                runs++;
+            }
+        }
+
+        for (int th = 0; th <= 60; th += 30) {
+            int ok = 1;
+
+            diff_erode3_ref(a, b, stride, o1, w, h, th);
+            for (int s = 0; s <= 1; s++) {
+                memset(o2, 0xaa, n);
+                ok &= ivs_diff_erode3(ivs_kernels_get(s), a, stride, b, stride, o2, w, w, h, th) == 0;
+                ok &= memcmp(o1, o2, (size_t)w * h) == 0;
+            }
+            if (!ok) {
+                printf("FAIL: %dx%d motion map thresh %d differs\n", w, h, th);
+                failures++;
+            }
+            runs++;
+        }
+
+        free(a); free(b); free(o1); free(o2); free(s1); free(s2);
+    }
+    printf("bit-exact vector vs scalar: %d/%d OK\n", runs - failures, runs);
+    return failures;
+}
+
+static int closed_form(void)
+{
+    uint8_t a[16 * 16], b[16 * 16], o[16];
+    uint16_t s[4];
+    int failures = 0;
+
+    memset(a, 200, sizeof(a));
+    memset(b, 0, sizeof(b));
+    for (int simd = 0; simd <= 1; simd++) {
+        const IvsKernels *k = ivs_kernels_get(simd);
+        uint8_t row[16] = { 5, 9, 1, 7, 7, 3, 8, 8, 2, 6, 4, 0, 9, 9, 1, 5 };
+
+        k->sad_blocks(a, 16, b, 16, 16, 16, 16, s, 1);
+        failures += s[0] != 256 * 200;
+        k->sad_blocks(a, 16, b, 16, 16, 16, 8, s, 2);
+        failures += s[0] != 64 * 200 || s[3] != 64 * 200;
+        /* Window of 3 centred on x, edges replicated */
+        k->morph_row(row, o, 16, 3, IVS_MORPH_ERODE);
+        failures += o[0] != 5 || o[1] != 1 || o[15] != 1 || o[11] != 0;
+        k->morph_row(row, o, 16, 3, IVS_MORPH_DILATE);
+        failures += o[0] != 9 || o[4] != 7 || o[15] != 5 || o[12] != 9;
+    }
+    return bench_check("closed-form checks", failures);
+}
+
+static void bench(int simd, int kernel, const uint8_t *a, const uint8_t *b,
+                  uint8_t *o, uint16_t *s, int w, int h)
+{
+    const IvsKernels *k = ivs_kernels_get(simd);
+    const int iters = 200;
+    double t0 = now_sec(), dt;
+
+    for (int it = 0; it < iters; it++) {
+        switch (kernel) {
+        case 0:
+            k->sad_blocks(a, w, b, w, w, h, 8, s, w / 8);
+            break;
+        case 1:
+            k->sad_blocks(a, w, b, w, w, h, 16, s, w / 16);
+            break;
+        case 2:
+            for (int y = 0; y < h; y++)
+                k->morph_row(a + (size_t)y * w, o + (size_t)y * w, w, 3, IVS_MORPH_ERODE);
+            break;
+        case 3:
+            for (int y = 0; y < h; y++)
+                k->morph_row(a + (size_t)y * w, o + (size_t)y * w, w, 5, IVS_MORPH_DILATE);
+            break;
+        case 4:
+            for (int y = 1; y + 1 < h; y++) {
+                const uint8_t *rows[3] = { a + (size_t)(y - 1) * w, a + (size_t)y * w, a + (size_t)(y + 1) * w };
+                k->morph_column(rows, 3, o + (size_t)y * w, w, IVS_MORPH_ERODE);
+            }
+            break;
+        default:
+            ivs_diff_erode3(k, a, w, b, w, o, w, w, h, 20);
+            break;
+        }
+    }
+    dt = (now_sec() - t0) / iters;
+    printf("%s%8.1f Mpix/s", simd ? "  vector " : "scalar ", (double)w * h / dt / 1e6);
+}
+
+int main(void)
+{
+    static const char *names[] = {
+        "sad 8x8", "sad 16x16", "erode row k3", "dilate row k5", "erode column k3", "motion map (diff+erode3)",
+    };
+    const int w = 640, h = 360;
+    unsigned seed = 9;
+    uint8_t *a = malloc((size_t)w * h), *b = malloc((size_t)w * h), *o = malloc((size_t)w * h);
+    uint16_t *s = malloc((size_t)w * h / 64 * sizeof(uint16_t));
+    int failures;
+
+    printf("vector kernels: %s\n", ivs_kernels_has_simd() ? "enabled" : "not built (scalar only)");
+    failures = check_kernels() + closed_form();
+    if (!a || !b || !o || !s)
+        return 1;
+    fill_pair(a, b, (size_t)w * h, &seed);
+
+    for (int kernel = 0; kernel < 6; kernel++) {
+        printf("%-26s ", names[kernel]);
+        bench(0, kernel, a, b, o, s, w, h);
+        bench(1, kernel, a, b, o, s, w, h);
+        printf("\n");
+    }
+
+    free(a); free(b); free(o); free(s);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,216 @@
+/**
+ * Shared IVS luma pyramid check and micro-benchmark
+ *
+ * Checks every level against a plain decimation of the frame, that
+ * interfaces on the same frame share one build, that slots are recycled
+ * once released, then times two interfaces that each copy and downscale
+ * the frame against the same two interfaces sharing the pyramid.
+ *
+ * Build/run: make bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include "bench_util.h"
+#include "ivs_luma.h"
+
+#ifndef MAP_32BIT
+#define MAP_32BIT 0
+#endif
+
+/* Enough of a VBM frame for ivs_luma_begin(): width at 0x08, height at
+ * 0x0c, 32-bit luma address at 0x1c */
+typedef struct {
+    uint8_t hdr[0x40];
+    uint8_t *luma;
+} Frame;
+
+/* The frame header holds a 32-bit address, as on the target */
+static int make_frame(Frame *f, int w, int h, unsigned *seed)
+{
+    void *p = mmap(NULL, (size_t)w * h, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS | MAP_32BIT, -1, 0);
+
+    if (p == MAP_FAILED || (uintptr_t)p > 0xffffffffu)
+        return -1;
+    f->luma = (uint8_t *)p;
+    memset(f->hdr, 0, sizeof(f->hdr));
+    *(int32_t *)(f->hdr + 0x08) = w;
+    *(int32_t *)(f->hdr + 0x0c) = h;
+    *(uint32_t *)(f->hdr + 0x1c) = (uint32_t)(uintptr_t)p;
+    for (int i = 0; i < w * h; i++)
+        f->luma[i] = (uint8_t)(rand_r(seed) >> 7);
+    return 0;
+}
+
+static void decimate(const uint8_t *src, int sw, int sh, uint8_t *dst, int n)
+{
+    int w = sw >> n, h = sh >> n;
+
+    for (int y = 0; y < h; y++)
+        for (int x = 0; x < w; x++)
+            dst[y * w + x] = src[(y << n) * sw + (x << n)];
+}
+
+static int check_levels(void)
+{
+    static const int dims[][2] = { { 640, 360 }, { 1280, 720 }, { 322, 182 }, { 100, 38 } };
+    unsigned seed = 7;
+    int runs = 0, failures = 0;
+
+    for (size_t d = 0; d < sizeof(dims) / sizeof(dims[0]); d++) {
+        int w = dims[d][0], h = dims[d][1];
+        Frame f;
+        uint8_t *ref = (uint8_t *)malloc((size_t)w * h);
+
+        if (ref == NULL || make_frame(&f, w, h, &seed) != 0) {
+            printf("FAIL: allocation\n");
+            return 1;
+        }
+        ivs_luma_begin(0, &f);
+        for (int n = 0; n < IVS_LUMA_LEVELS; n++) {
+            const IvsLumaPlane *p = ivs_luma_acquire(&f, n);
+            int ok = p != NULL && p->width == w >> n && p->height == h >> n;
+
+            decimate(f.luma, w, h, ref, n);
+            for (int y = 0; ok && y < p->height; y++)
+                ok = memcmp(p->data + y * p->stride, ref + y * p->width, p->width) == 0;
+            if (!ok) {
+                printf("FAIL: %dx%d level %d\n", w, h, n);
+                failures++;
+            }
+            runs++;
+            ivs_luma_release(p);
+        }
+        munmap(f.luma, (size_t)w * h);
+        free(ref);
+    }
+    printf("levels vs reference decimation: %d/%d OK\n", runs - failures, runs);
+    return failures;
+}
+
+static int check_sharing(void)
+{
+    unsigned seed = 11;
+    Frame f[IVS_LUMA_SLOTS + 2];
+    const IvsLumaPlane *held[IVS_LUMA_SLOTS + 2];
+    int failures = 0;
+
+    for (int i = 0; i < IVS_LUMA_SLOTS + 2; i++) {
+        if (make_frame(&f[i], 64, 32, &seed) != 0) {
+            printf("FAIL: allocation\n");
+            return 1;
+        }
+    }
+
+    /* Two interfaces on one frame: one build, one plane */
+    {
+        uint64_t before;
+        const IvsLumaPlane *a, *b;
+
+        ivs_luma_begin(1, &f[0]);
+        before = ivs_luma_built_pixels();
+        a = ivs_luma_acquire(&f[0], 2);
+        b = ivs_luma_acquire(&f[0], 2);
+        if (a == NULL || a != b || ivs_luma_built_pixels() - before != 32 * 16 + 16 * 8)
+            failures++;
+        ivs_luma_release(a);
+        ivs_luma_release(b);
+    }
+
+    /* A frame that is not the group's current one has no pyramid, even if
+     * a released slot still remembers its address */
+    ivs_luma_begin(1, &f[1]);
+    if (ivs_luma_acquire(&f[0], 1) != NULL)
+        failures++;
+
+    /* Every slot held in flight (group 0 keeps its current one): begin
+     * fails and interfaces fall back to copying */
+    for (int i = 0; i < IVS_LUMA_SLOTS + 1; i++) {
+        held[i] = NULL;
+        if (ivs_luma_begin(1, &f[i + 1]) == 0)
+            held[i] = ivs_luma_acquire(&f[i + 1], 1);
+    }
+    if (held[IVS_LUMA_SLOTS - 2] == NULL || held[IVS_LUMA_SLOTS - 1] != NULL)
+        failures++;
+    for (int i = 0; i < IVS_LUMA_SLOTS + 1; i++)
+        ivs_luma_release(held[i]);
+
+    /* Released and no longer current: the slots are free again */
+    for (int i = 0; i < IVS_LUMA_SLOTS; i++) {
+        if (ivs_luma_begin(i & 1, &f[i]) != 0)
+            failures++;
+    }
+    for (int i = 0; i < IVS_LUMA_SLOTS + 2; i++)
+        munmap(f[i].luma, 64 * 32);
+
+    return bench_check("sharing / slot recycling", failures);
+}
+
+/* What each interface did on its own before: copy the plane in
+ * preProcessSync, then decimate the copy */
+static void copy_and_decimate(const Frame *f, int w, int h, uint8_t *copy, uint8_t *half)
+{
+    memcpy(copy, f->luma, (size_t)w * h);
+    decimate(copy, w, h, half, 1);
+}
+
+static void bench(int w, int h)
+{
+    const int iters = 200;
+    unsigned seed = 3;
+    Frame f;
+    uint8_t *copy[2], *half[2];
+    volatile uint32_t sink = 0;
+    double t0, t_copy, t_shared;
+
+    if (make_frame(&f, w, h, &seed) != 0)
+        return;
+    for (int i = 0; i < 2; i++) {
+        copy[i] = (uint8_t *)malloc((size_t)w * h);
+        half[i] = (uint8_t *)malloc((size_t)w * h / 4);
+    }
+
+    t0 = now_sec();
+    for (int it = 0; it < iters; it++) {
+        copy_and_decimate(&f, w, h, copy[0], half[0]);
+        copy_and_decimate(&f, w, h, copy[1], half[1]);
+        sink += half[0][it] + half[1][it];
+    }
+    t_copy = (now_sec() - t0) / iters;
+
+    t0 = now_sec();
+    for (int it = 0; it < iters; it++) {
+        const IvsLumaPlane *a, *b;
+
+        ivs_luma_begin(0, &f);
+        a = ivs_luma_acquire(&f, 1);
+        b = ivs_luma_acquire(&f, 1);
+        sink += a->data[it] + b->data[it];
+        ivs_luma_release(a);
+        ivs_luma_release(b);
+    }
+    t_shared = (now_sec() - t0) / iters;
+
+    printf("%dx%d, 2 interfaces at 1/2    copy+decimate %7.3f ms  shared %7.3f ms  (%.2fx)\n",
+           w, h, t_copy * 1e3, t_shared * 1e3, t_copy / t_shared);
+
+    for (int i = 0; i < 2; i++) {
+        free(copy[i]);
+        free(half[i]);
+    }
+    munmap(f.luma, (size_t)w * h);
+    (void)sink;
+}
+
+int main(void)
+{
+    int failures = check_levels() + check_sharing();
+
+    bench(640, 360);
+    bench(1280, 720);
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,211 @@
+/**
+ * IVS result ring check and micro-benchmark
+ *
+ * Walks the ring through the cases the interfaces rely on (in-place
+ * results, drop instead of overwrite when the reader holds every slot,
+ * out-of-order and bogus releases), then runs a producer thread against a
+ * slow consumer to confirm no held result is ever written over, and
+ * reports the cost of a claim/commit/get/release round trip.
+ *
+ * Build/run: make bench
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "bench_util.h"
+#include "ivs_result.h"
+
+#define SLOT_SIZE 0xd0
+
+static int produce(IvsResultRing *r, uint32_t seq)
+{
+    uint32_t *slot = ivs_result_ring_claim(r);
+
+    for (int i = 0; i < SLOT_SIZE / 4; i++)
+        slot[i] = seq;
+    return ivs_result_ring_commit(r, slot);
+}
+
+static int check_semantics(void)
+{
+    IvsResultRing *r = ivs_result_ring_create(IVS_RESULT_DEPTH, SLOT_SIZE);
+    uint32_t *held[IVS_RESULT_DEPTH];
+    int idx[IVS_RESULT_DEPTH], failures = 0, j;
+
+    if (r == NULL) {
+        printf("FAIL: create\n");
+        return 1;
+    }
+
+    failures += ivs_result_ring_get(r, NULL) != NULL;
+    for (uint32_t s = 0; s < IVS_RESULT_DEPTH; s++)
+        failures += produce(r, s) != 1;
+    /* Full: the next result goes to the spare slot and is dropped */
+    failures += produce(r, 100) != 0;
+
+    for (j = 0; j < IVS_RESULT_DEPTH; j++) {
+        held[j] = ivs_result_ring_get(r, &idx[j]);
+        failures += held[j] == NULL || held[j][0] != (uint32_t)j || idx[j] != j;
+        failures += ivs_result_ring_index(r, held[j]) != idx[j];
+    }
+    failures += ivs_result_ring_get(r, NULL) != NULL;
+
+    /* Every slot held: still no room, and nothing held is touched */
+    failures += produce(r, 200) != 0;
+    for (j = 0; j < IVS_RESULT_DEPTH; j++)
+        failures += held[j][SLOT_SIZE / 4 - 1] != (uint32_t)j;
+
+    /* A later slot coming back first frees nothing yet */
+    failures += ivs_result_ring_release(r, idx[3]) != 0;
+    failures += ivs_result_ring_release(r, idx[3]) == 0;
+    failures += produce(r, 300) != 0;
+    failures += ivs_result_ring_release(r, idx[0]) != 0;
+    failures += produce(r, 301) != 1;
+    failures += produce(r, 302) != 0;
+    failures += ivs_result_ring_release(r, idx[1]) != 0;
+    failures += ivs_result_ring_release(r, idx[2]) != 0;
+    /* 0..3 are back, so three more fit */
+    failures += produce(r, 303) != 1 || produce(r, 304) != 1 || produce(r, 305) != 1;
+    failures += produce(r, 306) != 0;
+    failures += held[4][0] != 4 || held[5][0] != 5;
+
+    /* Bogus pointers and indices */
+    failures += ivs_result_ring_index(r, (uint8_t *)held[0] + 4) != -1;
+    failures += ivs_result_ring_index(r, ivs_result_ring_slot(r, IVS_RESULT_DEPTH)) != -1;
+    failures += ivs_result_ring_release(r, IVS_RESULT_DEPTH) == 0;
+    failures += ivs_result_ring_release(r, -1) == 0;
+
+    failures += ivs_result_ring_release(r, idx[4]) != 0 || ivs_result_ring_release(r, idx[5]) != 0;
+    {
+        static const uint32_t queued[] = { 301, 303, 304, 305 };
+
+        for (size_t q = 0; q < sizeof(queued) / sizeof(queued[0]); q++) {
+            uint32_t *p = ivs_result_ring_get(r, &j);
+
+            failures += p == NULL || p[0] != queued[q] || ivs_result_ring_release(r, j) != 0;
+        }
+    }
+    failures += ivs_result_ring_get(r, NULL) != NULL;
+
+    /* Many laps past the counter wrap, one result held behind the next:
+     * slots keep cycling in order and the full ring still drops */
+    for (uint32_t s = 0, k = 0; s < 64 * IVS_RESULT_DEPTH; s++) {
+        uint32_t *p;
+
+        failures += produce(r, 1000 + s) != 1;
+        p = ivs_result_ring_get(r, &j);
+        if (s == 0)
+            k = (uint32_t)j;
+        failures += p == NULL || p[0] != 1000 + s || j != (int)((k + s) % IVS_RESULT_DEPTH);
+        if (s > 0)
+            failures += ivs_result_ring_release(r, idx[0]) != 0;
+        idx[0] = j;
+    }
+    for (j = 0; j < IVS_RESULT_DEPTH - 1; j++)
+        failures += produce(r, 2000) != 1;
+    failures += produce(r, 2001) != 0;
+
+    ivs_result_ring_destroy(r);
+    return bench_check("ring semantics", failures);
+}
+
+typedef struct {
+    IvsResultRing *ring;
+    int frames;
+    int dropped;
+    volatile int done;
+} Producer;
+
+static void *producer_main(void *arg)
+{
+    Producer *p = arg;
+
+    for (int f = 1; f <= p->frames; f++) {
+        if (!produce(p->ring, (uint32_t)f))
+            p->dropped++;
+        if ((f & 63) == 0)
+            usleep(50);
+    }
+    p->done = 1;
+    return NULL;
+}
+
+/* The reader holds up to two results at a time and is slower than the
+ * writer, so the ring keeps running full */
+static int check_slow_reader(void)
+{
+    Producer p = { ivs_result_ring_create(IVS_RESULT_DEPTH, SLOT_SIZE), 20000, 0, 0 };
+    pthread_t th;
+    uint32_t *held[2], last = 0;
+    int idx[2], nheld = 0, got = 0, torn = 0, order = 0;
+
+    pthread_create(&th, NULL, producer_main, &p);
+    for (;;) {
+        int done = p.done;
+        uint32_t *cur;
+        int ci;
+
+        /* A held result must not change while it is held */
+        for (int h = 0; h < nheld; h++)
+            for (int i = 0; i < SLOT_SIZE / 4; i++)
+                torn += held[h][i] != held[h][0];
+
+        cur = ivs_result_ring_get(p.ring, &ci);
+        if (cur == NULL && nheld == 0 && done)
+            break;
+        if (cur == NULL || nheld == 2) {
+            if (nheld > 0) {
+                ivs_result_ring_release(p.ring, idx[0]);
+                held[0] = held[1], idx[0] = idx[1];
+                nheld--;
+            }
+        }
+        if (cur == NULL)
+            continue;
+
+        got++;
+        order += cur[0] <= last;
+        last = cur[0];
+        held[nheld] = cur, idx[nheld] = ci;
+        nheld++;
+        for (volatile int spin = 0; spin < 2000; spin++)
+            ;
+    }
+    pthread_join(th, NULL);
+
+    printf("slow reader: %d results, %d dropped, %d torn, %d out of order\n",
+           got, p.dropped, torn, order);
+    ivs_result_ring_destroy(p.ring);
+    return torn || order || got + p.dropped != p.frames;
+}
+
+static void bench_round_trip(void)
+{
+    IvsResultRing *r = ivs_result_ring_create(IVS_RESULT_DEPTH, SLOT_SIZE);
+    const int iters = 1000000;
+    double t0 = now_sec(), dt;
+
+    for (int it = 0; it < iters; it++) {
+        void *slot = ivs_result_ring_claim(r);
+        int i;
+
+        ivs_result_ring_commit(r, slot);
+        ivs_result_ring_get(r, &i);
+        ivs_result_ring_release(r, i);
+    }
+    dt = now_sec() - t0;
+    printf("claim/commit/get/release: %.1f ns per result\n", dt / iters * 1e9);
+    ivs_result_ring_destroy(r);
+}
+
+int main(void)
+{
+    int failures = check_semantics() + check_slow_reader();
+
+    bench_round_trip();
+    return failures ? 1 : 0;
+}
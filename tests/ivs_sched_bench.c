@@ -0,0 +1,186 @@
+/**
+ * IVS scheduler check
+ *
+ * Drives the analysis pool the way ivs_update does, at 100 frames/s: a
+ * cheap channel held to a 20 fps target, a channel whose analysis costs
+ * 45 ms against a 30 ms budget, and one analysing every frame. Checks the
+ * achieved rates and that the heavy channel backs off rather than piling
+ * up frame locks. A second run saturates a single worker with three heavy
+ * channels, where jobs queued past their budget must be dropped unrun.
+ *
+ * Build/run: make bench
+ */
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <unistd.h>
+#include "bench_util.h"
+#include "ivs_sched.h"
+
+#define NCHN 3
+
+static int32_t cost_us[NCHN];
+
+static pthread_mutex_t lock = PTHREAD_MUTEX_INITIALIZER;
+static int32_t busy[NCHN];
+static int32_t locked, max_locked;
+static int32_t late_runs;
+
+static void run(int32_t chn, int32_t late)
+{
+    if (late) {
+        __sync_fetch_and_add(&late_runs, 1);
+    } else {
+        usleep((useconds_t)cost_us[chn]);
+    }
+
+    pthread_mutex_lock(&lock);
+    locked--;
+    busy[chn] = 0;
+    pthread_mutex_unlock(&lock);
+}
+
+/* One frame from the source: what ivs_update does per channel */
+static void post_frame(void)
+{
+    for (int32_t chn = 0; chn < NCHN; chn++) {
+        int32_t b;
+
+        pthread_mutex_lock(&lock);
+        b = busy[chn];
+        if (!b)
+            busy[chn] = 1;
+        pthread_mutex_unlock(&lock);
+
+        if (!ivs_sched_admit(chn, b)) {
+            if (!b) {
+                pthread_mutex_lock(&lock);
+                busy[chn] = 0;
+                pthread_mutex_unlock(&lock);
+            }
+            continue;
+        }
+
+        pthread_mutex_lock(&lock);
+        if (++locked > max_locked)
+            max_locked = locked;
+        pthread_mutex_unlock(&lock);
+        ivs_sched_submit(chn);
+    }
+}
+
+static void drive(int frames)
+{
+    uint64_t t0 = ivs_sched_now_us();
+
+    for (int f = 0; f < frames; f++) {
+        uint64_t due = t0 + (uint64_t)f * 10000ULL, now = ivs_sched_now_us();
+
+        if (due > now)
+            usleep((useconds_t)(due - now));
+        post_frame();
+    }
+    usleep(150000);
+}
+
+static void setup(const IvsSchedAttr *attr, const int32_t *cost)
+{
+    for (int32_t chn = 0; chn < NCHN; chn++) {
+        ivs_sched_reset(chn);
+        ivs_sched_set_attr(chn, &attr[chn]);
+        cost_us[chn] = cost[chn];
+    }
+    max_locked = 0;
+    late_runs = 0;
+}
+
+static void report(const IvsSchedAttr *attr, IvsSchedStat *st)
+{
+    for (int32_t chn = 0; chn < NCHN; chn++) {
+        ivs_sched_get_stat(chn, &st[chn]);
+        printf("chn %d: target %2d fps budget %3d ms: %4u analysed  %6.2f fps  skip rate %3u load %3u late %3u  latency %6.2f ms\n",
+               chn, attr[chn].target_fps, attr[chn].budget_ms ? attr[chn].budget_ms : IVS_SCHED_BUDGET_MS,
+               st[chn].analysed, st[chn].fps_x100 / 100.0, st[chn].skip_rate, st[chn].skip_load,
+               st[chn].skip_late, st[chn].latency_us / 1000.0);
+    }
+    printf("frame locks held at once: max %d, %d left, %d late drops\n", max_locked, locked, late_runs);
+}
+
+static int check_saturated(void)
+{
+    static const IvsSchedAttr attr[NCHN] = { { 0, 30 }, { 0, 30 }, { 0, 30 } };
+    static const int32_t cost[NCHN] = { 25000, 25000, 25000 };
+    IvsSchedStat st[NCHN];
+    int failures = 0;
+
+    setup(attr, cost);
+    if (ivs_sched_start(1, run) < 0)
+        return 1;
+    drive(200);
+    printf("-- one worker, three 25 ms channels\n");
+    report(attr, st);
+    ivs_sched_stop();
+
+    for (int32_t chn = 0; chn < NCHN; chn++)
+        failures += st[chn].analysed == 0;
+    failures += late_runs == 0 || max_locked > NCHN || locked != 0;
+    return bench_check("late drops under saturation", failures);
+}
+
+static int check_cancel(void)
+{
+    static const IvsSchedAttr attr[NCHN] = { { 0, 0 }, { 0, 0 }, { 0, 0 } };
+    static const int32_t cost[NCHN] = { 50000, 50000, 50000 };
+    int failures = 0;
+
+    /* Stop with jobs still queued behind a busy worker: they must come
+     * back as late so their frames are released */
+    setup(attr, cost);
+    if (ivs_sched_start(1, run) < 0)
+        return 1;
+    post_frame();
+    usleep(10000);
+    ivs_sched_stop();
+    failures += late_runs != NCHN - 1 || locked != 0;
+    bench_check("stop releases queued jobs", failures);
+
+    /* A stopped pool takes nothing; cancel finds nothing to take back */
+    failures += ivs_sched_submit(0) == 0;
+    failures += ivs_sched_cancel(0) != 0;
+    return bench_check("cancel / stopped pool", failures);
+}
+
+int main(void)
+{
+    static const IvsSchedAttr attr[NCHN] = { { 20, 0 }, { 0, 30 }, { 0, 0 } };
+    static const int32_t cost[NCHN] = { 500, 45000, 300 };
+    IvsSchedStat st[NCHN];
+    const int frames = 300;
+    int failures = 0;
+
+    setup(attr, cost);
+    if (ivs_sched_start(2, run) < 0) {
+        printf("FAIL: start\n");
+        return 1;
+    }
+    drive(frames);
+    printf("-- two workers, 100 fps source\n");
+    report(attr, st);
+    ivs_sched_stop();
+
+    /* 20 fps target out of 100 fps */
+    failures += st[0].fps_x100 < 1700 || st[0].fps_x100 > 2300 || st[0].skip_rate == 0;
+    /* 45 ms per frame cannot keep 100 fps: the channel must shed load */
+    failures += st[1].skip_load == 0 || st[1].analysed > (uint32_t)frames / 3;
+    /* Cheap channel keeps up with nearly every frame */
+    failures += st[2].analysed < (uint32_t)frames * 8 / 10;
+    failures += max_locked > NCHN || locked != 0;
+    bench_check("rates and back-off", failures);
+
+    failures += check_saturated();
+    failures += check_cancel();
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,182 @@
+/**
+ * NV12 scaler correctness check and micro-benchmark
+ *
+ * Compares the vector and scalar scalers byte for byte over a spread of
+ * geometries in both modes, checks a few closed-form results, then times
+ * the common snapshot / sub-stream conversions.
+ *
+ * Build/run: make bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "bench_util.h"
+#include "nv12_resize.h"
+
+/* The scaler asks the system layer for the 128-bit unit on MIPS */
+__attribute__((weak)) int32_t is_video_has_simd128_proc(void) { return 1; }
+
+static int alloc_image(Nv12Image *img, int w, int h, int stride)
+{
+    img->width = w;
+    img->height = h;
+    img->stride = stride;
+    img->y = (uint8_t *)malloc((size_t)stride * h);
+    img->uv = (uint8_t *)malloc((size_t)stride * (h / 2));
+    return (img->y && img->uv) ? 0 : -1;
+}
+
+static void free_image(Nv12Image *img)
+{
+    free(img->y);
+    free(img->uv);
+}
+
+static void fill_random(Nv12Image *img, unsigned *seed)
+{
+    for (int i = 0; i < img->stride * img->height; i++)
+        img->y[i] = (uint8_t)(rand_r(seed) >> 7);
+    for (int i = 0; i < img->stride * (img->height / 2); i++)
+        img->uv[i] = (uint8_t)(rand_r(seed) >> 7);
+}
+
+static int same_image(const Nv12Image *a, const Nv12Image *b)
+{
+    for (int y = 0; y < a->height; y++)
+        if (memcmp(a->y + y * a->stride, b->y + y * b->stride, a->width))
+            return 0;
+    for (int y = 0; y < a->height / 2; y++)
+        if (memcmp(a->uv + y * a->stride, b->uv + y * b->stride, a->width))
+            return 0;
+    return 1;
+}
+
+static int check_bit_exact(void)
+{
+    static const int sizes[][4] = {
+        { 1920, 1080, 640, 360 }, { 1920, 1080, 960, 540 }, { 1280, 720, 1920, 1080 },
+        { 640, 360, 1280, 720 },  { 1280, 720, 1280, 960 }, { 2, 2, 34, 18 },
+        { 98, 66, 34, 22 },       { 34, 22, 98, 66 },       { 1000, 500, 3, 1 },
+        { 702, 574, 350, 286 },   { 702, 574, 351, 287 },   { 62, 46, 62, 46 },
+    };
+    unsigned seed = 1;
+    int failures = 0, runs = 0;
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        for (int mode = NV12_RESIZE_BILINEAR; mode <= NV12_RESIZE_AREA; mode++) {
+            int sw = sizes[i][0], sh = sizes[i][1];
+            int dw = sizes[i][2] & ~1, dh = sizes[i][3] & ~1;
+            Nv12Image src, ref, vec;
+
+            if (dw < 2 || dh < 2)
+                dw = dh = 2;
+            if (alloc_image(&src, sw, sh, sw + 32) || alloc_image(&ref, dw, dh, dw + 16) ||
+                alloc_image(&vec, dw, dh, dw + 16)) {
+                printf("FAIL: allocation\n");
+                return 1;
+            }
+            fill_random(&src, &seed);
+
+            runs++;
+            if (nv12_resize_c(&src, &ref, mode) != 0 || nv12_resize_simd(&src, &vec, mode) != 0 ||
+                !same_image(&ref, &vec)) {
+                printf("FAIL: %dx%d -> %dx%d mode %d differs\n", sw, sh, dw, dh, mode);
+                failures++;
+            }
+
+            free_image(&src);
+            free_image(&ref);
+            free_image(&vec);
+        }
+    }
+
+    printf("bit-exact vector vs scalar: %d/%d OK\n", runs - failures, runs);
+    return failures;
+}
+
+static int check_closed_form(void)
+{
+    Nv12Image src, dst;
+    int failures = 0;
+
+    alloc_image(&src, 64, 32, 64);
+    alloc_image(&dst, 32, 16, 32);
+
+    /* Flat image stays flat in both modes */
+    memset(src.y, 77, 64 * 32);
+    memset(src.uv, 200, 64 * 16);
+    for (int mode = NV12_RESIZE_BILINEAR; mode <= NV12_RESIZE_AREA; mode++) {
+        nv12_resize(&src, &dst, mode);
+        for (int i = 0; i < 32 * 16; i++)
+            failures += dst.y[i] != 77;
+        for (int i = 0; i < 32 * 8; i++)
+            failures += dst.uv[i] != 200;
+    }
+
+    /* 2:1 area is the rounded 2x2 mean, Cb and Cr kept apart */
+    for (int i = 0; i < 64 * 32; i++)
+        src.y[i] = (uint8_t)(i * 7);
+    for (int i = 0; i < 64 * 16; i++)
+        src.uv[i] = (uint8_t)((i & 1) ? 10 + (i % 13) : 240 - (i % 11));
+    nv12_resize(&src, &dst, NV12_RESIZE_AREA);
+    for (int y = 0; y < 16; y++) {
+        for (int x = 0; x < 32; x++) {
+            const uint8_t *p = src.y + 2 * y * 64 + 2 * x;
+            failures += dst.y[y * 32 + x] != (uint8_t)((p[0] + p[1] + p[64] + p[65] + 2) >> 2);
+        }
+    }
+    for (int y = 0; y < 8; y++) {
+        for (int x = 0; x < 32; x++) {
+            int c = x & 1, s = (x >> 1) * 4 + c;
+            const uint8_t *p = src.uv + 2 * y * 64;
+            failures += dst.uv[y * 32 + x] != (uint8_t)((p[s] + p[s + 2] + p[64 + s] + p[64 + s + 2] + 2) >> 2);
+        }
+    }
+
+    bench_check("closed-form checks", failures);
+    free_image(&src);
+    free_image(&dst);
+    return failures != 0;
+}
+
+static void bench(const char *name, int sw, int sh, int dw, int dh, int mode, int iters)
+{
+    Nv12Image src, dst;
+    unsigned seed = 7;
+    double t0, t1, t2;
+
+    alloc_image(&src, sw, sh, sw);
+    alloc_image(&dst, dw, dh, dw);
+    fill_random(&src, &seed);
+
+    t0 = now_sec();
+    for (int i = 0; i < iters; i++)
+        nv12_resize_c(&src, &dst, mode);
+    t1 = now_sec();
+    for (int i = 0; i < iters; i++)
+        nv12_resize_simd(&src, &dst, mode);
+    t2 = now_sec();
+
+    printf("%-32s scalar %7.3f ms  vector %7.3f ms  (%.2fx)\n", name,
+           (t1 - t0) * 1e3 / iters, (t2 - t1) * 1e3 / iters, (t1 - t0) / (t2 - t1));
+    free_image(&src);
+    free_image(&dst);
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    printf("vector kernels: %s\n", nv12_resize_has_simd() ? "enabled" : "not built (scalar only)");
+    failures += check_bit_exact();
+    failures += check_closed_form();
+
+    bench("area 1920x1080 -> 960x540", 1920, 1080, 960, 540, NV12_RESIZE_AREA, 50);
+    bench("area 1920x1080 -> 640x360", 1920, 1080, 640, 360, NV12_RESIZE_AREA, 50);
+    bench("bilinear 1920x1080 -> 640x360", 1920, 1080, 640, 360, NV12_RESIZE_BILINEAR, 50);
+    bench("bilinear 640x360 -> 1280x720", 640, 360, 1280, 720, NV12_RESIZE_BILINEAR, 50);
+
+    return failures ? 1 : 0;
+}
@@ -0,0 +1,573 @@
+/**
+ * OSD blend engine correctness check and micro-benchmark
+ *
+ * Compares every format / alpha-mode span kernel against a per-pixel
+ * reference blender over random, partly clipped placements, checks that
+ * pre-converted overlays match direct blending through partial updates,
+ * checks that text drawn from a glyph atlas matches blending the same
+ * string rendered into a bitmap, checks fills, lines and rectangles against
+ * closed-form results, then times the regions a camera typically carries:
+ * a timestamp and a logo on each of three streams, a detection box, and a
+ * ticking clock drawn directly, from an overlay and from a glyph atlas.
+ *
+ * Build/run: make bench
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "bench_util.h"
+#include "osd_blend.h"
+
+static int alloc_frame(OsdFrame *f, int w, int h)
+{
+    f->width = w;
+    f->height = h;
+    f->stride = w;
+    f->y = (uint8_t *)malloc((size_t)w * h);
+    f->uv = (uint8_t *)malloc((size_t)w * (h / 2));
+    return (f->y && f->uv) ? 0 : -1;
+}
+
+static void free_frame(OsdFrame *f)
+{
+    free(f->y);
+    free(f->uv);
+}
+
+static void copy_frame(OsdFrame *d, const OsdFrame *s)
+{
+    memcpy(d->y, s->y, (size_t)s->stride * s->height);
+    memcpy(d->uv, s->uv, (size_t)s->stride * (s->height / 2));
+}
+
+static int same_frame(const OsdFrame *a, const OsdFrame *b)
+{
+    return !memcmp(a->y, b->y, (size_t)a->stride * a->height) &&
+           !memcmp(a->uv, b->uv, (size_t)a->stride * (a->height / 2));
+}
+
+/* ---- Reference: one pixel at a time, everything decided at run time ---- */
+
+static uint8_t ref_mix(int d, int s, int a)
+{
+    return (uint8_t)((s * a + d * (255 - a) + 127) / 255);
+}
+
+static void ref_pixel(const OsdPicture *pic, int px, int py, int mode, int fg, int bg,
+                      int *r, int *g, int *b, int *a)
+{
+    const uint8_t *row = (const uint8_t *)pic->data + py * pic->stride;
+
+    if (pic->fmt == OSD_BLEND_FMT_ARGB1555) {
+        uint16_t v = ((const uint16_t *)row)[px];
+        *r = (((v >> 10) & 0x1f) << 3) | (((v >> 10) & 0x1f) >> 2);
+        *g = (((v >> 5) & 0x1f) << 3) | (((v >> 5) & 0x1f) >> 2);
+        *b = ((v & 0x1f) << 3) | ((v & 0x1f) >> 2);
+        *a = (v & 0x8000) ? 255 : 0;
+        if (mode == OSD_BLEND_ALPHA_GLOBAL)
+            *a = *a ? fg : bg;
+    } else {
+        if (pic->fmt == OSD_BLEND_FMT_ARGB8888) {
+            uint32_t v = ((const uint32_t *)row)[px];
+            *a = v >> 24;
+            *r = (v >> 16) & 0xff;
+            *g = (v >> 8) & 0xff;
+            *b = v & 0xff;
+        } else {
+            *b = row[4 * px];
+            *g = row[4 * px + 1];
+            *r = row[4 * px + 2];
+            *a = row[4 * px + 3];
+        }
+        if (mode == OSD_BLEND_ALPHA_GLOBAL)
+            *a = (*a * fg + 127) / 255;
+    }
+    if (mode == OSD_BLEND_ALPHA_NONE)
+        *a = 255;
+}
+
+static void ref_blend(const OsdFrame *f, int x, int y, const OsdPicture *pic, int mode, int fg, int bg)
+{
+    for (int py = 0; py < pic->height; py++) {
+        int fy = y + py;
+        if (fy < 0 || fy >= f->height)
+            continue;
+        for (int px = 0; px < pic->width; px++) {
+            int fx = x + px, r, g, b, a;
+            if (fx < 0 || fx >= f->width)
+                continue;
+            ref_pixel(pic, px, py, mode, fg, bg, &r, &g, &b, &a);
+            f->y[fy * f->stride + fx] = ref_mix(f->y[fy * f->stride + fx],
+                                                ((66 * r + 129 * g + 25 * b + 128) >> 8) + 16, a);
+            /* Chroma from the pair starting at each even column on even rows */
+            if (!(fy & 1) && !(fx & 1)) {
+                int r1 = r, g1 = g, b1 = b, a1 = a;
+                if (px + 1 < pic->width && fx + 1 < f->width)
+                    ref_pixel(pic, px + 1, py, mode, fg, bg, &r1, &g1, &b1, &a1);
+                r = (r + r1 + 1) >> 1;
+                g = (g + g1 + 1) >> 1;
+                b = (b + b1 + 1) >> 1;
+                a = (a + a1 + 1) >> 1;
+                uint8_t *c = f->uv + (fy >> 1) * f->stride + fx;
+                c[0] = ref_mix(c[0], ((-38 * r - 74 * g + 112 * b + 128) >> 8) + 128, a);
+                c[1] = ref_mix(c[1], ((112 * r - 94 * g - 18 * b + 128) >> 8) + 128, a);
+            }
+        }
+    }
+}
+
+/* Overlay with runs of clear, opaque and translucent pixels like real text */
+static void fill_overlay(OsdPicture *pic, unsigned *seed)
+{
+    int bpp = pic->fmt == OSD_BLEND_FMT_ARGB1555 ? 2 : 4;
+    uint8_t *p = (uint8_t *)pic->data;
+
+    for (int y = 0; y < pic->height; y++) {
+        int kind = 0, left = 0;
+        for (int x = 0; x < pic->width; x++) {
+            uint32_t rgb = (uint32_t)rand_r(seed) & 0xffffff, a;
+            if (left-- <= 0) {
+                kind = rand_r(seed) % 3;
+                left = rand_r(seed) % 24;
+            }
+            a = kind == 0 ? 0 : (kind == 1 ? 255 : (uint32_t)rand_r(seed) & 0xff);
+            uint8_t *px = p + y * pic->stride + x * bpp;
+            if (bpp == 2) {
+                *(uint16_t *)px = (uint16_t)((rgb & 0x7fff) | (a ? 0x8000 : 0));
+            } else if (pic->fmt == OSD_BLEND_FMT_ARGB8888) {
+                *(uint32_t *)px = (a << 24) | rgb;
+            } else {
+                px[0] = (uint8_t)rgb;
+                px[1] = (uint8_t)(rgb >> 8);
+                px[2] = (uint8_t)(rgb >> 16);
+                px[3] = (uint8_t)a;
+            }
+        }
+    }
+}
+
+static int alloc_picture(OsdPicture *pic, int fmt, int w, int h)
+{
+    pic->fmt = fmt;
+    pic->width = w;
+    pic->height = h;
+    pic->stride = w * (fmt == OSD_BLEND_FMT_ARGB1555 ? 2 : 4) + 8;
+    pic->data = malloc((size_t)pic->stride * h);
+    return pic->data ? 0 : -1;
+}
+
+static int check_kernels(void)
+{
+    OsdFrame ref, out, base;
+    unsigned seed = 3;
+    int failures = 0, runs = 0;
+
+    alloc_frame(&base, 96, 64);
+    alloc_frame(&ref, 96, 64);
+    alloc_frame(&out, 96, 64);
+    for (int i = 0; i < 96 * 64; i++)
+        base.y[i] = (uint8_t)rand_r(&seed);
+    for (int i = 0; i < 96 * 32; i++)
+        base.uv[i] = (uint8_t)rand_r(&seed);
+
+    for (int iter = 0; iter < 300; iter++) {
+        for (int fmt = 0; fmt < OSD_BLEND_FMT_NUM; fmt++) {
+            for (int mode = 0; mode < OSD_BLEND_ALPHA_NUM; mode++) {
+                OsdPicture pic;
+                int w = 1 + rand_r(&seed) % 70, h = 1 + rand_r(&seed) % 40;
+                int x = rand_r(&seed) % 120 - 20, y = rand_r(&seed) % 80 - 10;
+                int fg = rand_r(&seed) % 4 ? (int)(rand_r(&seed) & 0xff) : 255;
+                int bg = rand_r(&seed) % 2 ? (int)(rand_r(&seed) & 0xff) : 0;
+
+                alloc_picture(&pic, fmt, w, h);
+                fill_overlay(&pic, &seed);
+                copy_frame(&ref, &base);
+                copy_frame(&out, &base);
+                ref_blend(&ref, x, y, &pic, mode, fg, bg);
+                runs++;
+                if (osd_blend_picture(&out, x, y, &pic, mode, fg, bg) < 0 || !same_frame(&ref, &out)) {
+                    if (failures < 5)
+                        printf("FAIL: fmt %d mode %d %dx%d at (%d,%d) fg %d bg %d\n",
+                               fmt, mode, w, h, x, y, fg, bg);
+                    failures++;
+                }
+                free((void *)pic.data);
+            }
+        }
+    }
+
+    printf("span kernels vs reference: %d/%d OK\n", runs - failures, runs);
+    free_frame(&base);
+    free_frame(&ref);
+    free_frame(&out);
+    return failures;
+}
+
+static int check_overlay(void)
+{
+    OsdFrame ref, out, base;
+    OsdOverlay *ov = osd_overlay_create();
+    unsigned seed = 5;
+    int failures = 0, runs = 0;
+
+    alloc_frame(&base, 96, 64);
+    alloc_frame(&ref, 96, 64);
+    alloc_frame(&out, 96, 64);
+    for (int i = 0; i < 96 * 64; i++)
+        base.y[i] = (uint8_t)rand_r(&seed);
+    for (int i = 0; i < 96 * 32; i++)
+        base.uv[i] = (uint8_t)rand_r(&seed);
+
+    for (int iter = 0; iter < 100; iter++) {
+        for (int fmt = 0; fmt < OSD_BLEND_FMT_NUM; fmt++) {
+            for (int mode = 0; mode < OSD_BLEND_ALPHA_NUM; mode++) {
+                OsdPicture pic;
+                int w = 1 + rand_r(&seed) % 90, h = 1 + rand_r(&seed) % 50;
+                int fg = rand_r(&seed) % 4 ? (int)(rand_r(&seed) & 0xff) : 255;
+                int bg = rand_r(&seed) % 2 ? (int)(rand_r(&seed) & 0xff) : 0;
+                int bpp = fmt == OSD_BLEND_FMT_ARGB1555 ? 2 : 4;
+                int tiles = ((w + OSD_OVERLAY_TILE_W - 1) / OSD_OVERLAY_TILE_W) *
+                            ((h + OSD_OVERLAY_TILE_H - 1) / OSD_OVERLAY_TILE_H);
+
+                alloc_picture(&pic, fmt, w, h);
+                fill_overlay(&pic, &seed);
+                failures += osd_overlay_update(ov, &pic, mode, fg, bg, NULL) != tiles;
+                failures += osd_overlay_update(ov, &pic, mode, fg, bg, NULL) != 0;
+
+                /* Three rounds of small edits, each followed by a placement */
+                for (int round = 0; round < 3; round++) {
+                    int x = (rand_r(&seed) % 130 - 30) & ~1, y = rand_r(&seed) % 80 - 10;
+                    int ex = rand_r(&seed) % w, ey = rand_r(&seed) % h, changed;
+
+                    ((uint8_t *)pic.data)[ey * pic.stride + ex * bpp] ^= 0x5a;
+                    changed = osd_overlay_update(ov, &pic, mode, fg, bg, NULL);
+                    failures += changed != 1;
+                    copy_frame(&ref, &base);
+                    copy_frame(&out, &base);
+                    osd_blend_picture(&ref, x, y, &pic, mode, fg, bg);
+                    osd_overlay_blend(ov, &out, x, y, NULL);
+                    runs++;
+                    if (!same_frame(&ref, &out)) {
+                        if (failures < 5)
+                            printf("FAIL: overlay fmt %d mode %d %dx%d at (%d,%d)\n", fmt, mode, w, h, x, y);
+                        failures++;
+                    }
+                }
+                free((void *)pic.data);
+            }
+        }
+    }
+
+    printf("overlay vs direct blend through partial updates: %d/%d OK\n", runs - failures, runs);
+    osd_overlay_destroy(ov);
+    free_frame(&base);
+    free_frame(&ref);
+    free_frame(&out);
+    return failures;
+}
+
+#define GLYPH_CHARS "0123456789-: "
+
+/* Text rendered into a bitmap the way applications do it today: glyph
+ * cells copied from the font strip, unknown characters left clear */
+static void render_text(OsdPicture *bmp, const OsdPicture *font, int gw, const char *text)
+{
+    int bpp = font->fmt == OSD_BLEND_FMT_ARGB1555 ? 2 : 4;
+
+    for (int i = 0; text[i] != '\0'; i++) {
+        const char *c = strchr(GLYPH_CHARS, text[i]);
+        for (int r = 0; r < bmp->height; r++) {
+            uint8_t *d = (uint8_t *)bmp->data + r * bmp->stride + i * gw * bpp;
+            if (c != NULL)
+                memcpy(d, (const uint8_t *)font->data + r * font->stride + (c - GLYPH_CHARS) * gw * bpp,
+                       (size_t)gw * bpp);
+            else
+                memset(d, 0, (size_t)gw * bpp);
+        }
+    }
+}
+
+static int check_glyphs(void)
+{
+    const int count = (int)strlen(GLYPH_CHARS);
+    OsdFrame ref, out, base;
+    unsigned seed = 11;
+    int failures = 0, runs = 0;
+
+    alloc_frame(&base, 160, 64);
+    alloc_frame(&ref, 160, 64);
+    alloc_frame(&out, 160, 64);
+    for (int i = 0; i < 160 * 64; i++)
+        base.y[i] = (uint8_t)rand_r(&seed);
+    for (int i = 0; i < 160 * 32; i++)
+        base.uv[i] = (uint8_t)rand_r(&seed);
+
+    for (int iter = 0; iter < 60; iter++) {
+        for (int fmt = 0; fmt < OSD_BLEND_FMT_NUM; fmt++) {
+            for (int mode = 0; mode < OSD_BLEND_ALPHA_NUM; mode++) {
+                OsdPicture font, bmp;
+                OsdGlyphAtlas *at;
+                int gw = 2 + 2 * (rand_r(&seed) % 8), gh = 1 + rand_r(&seed) % 24;
+                int fg = rand_r(&seed) % 4 ? (int)(rand_r(&seed) & 0xff) : 255;
+                int bg = rand_r(&seed) % 2 ? (int)(rand_r(&seed) & 0xff) : 0;
+                int len = 1 + rand_r(&seed) % 12, n;
+                char text[16];
+                uint8_t glyphs[16];
+
+                alloc_picture(&font, fmt, count * gw, gh);
+                fill_overlay(&font, &seed);
+                at = osd_glyph_atlas_create(&font, GLYPH_CHARS, gw, mode, fg, bg, NULL);
+                if (at == NULL) {
+                    printf("FAIL: glyph atlas %dx%d fmt %d\n", gw, gh, fmt);
+                    failures++;
+                    free((void *)font.data);
+                    continue;
+                }
+
+                /* Characters outside the font only in pixel mode, where a
+                 * clear cell leaves the frame alone */
+                for (int i = 0; i < len; i++)
+                    text[i] = mode == OSD_BLEND_ALPHA_PIXEL && rand_r(&seed) % 5 == 0 ? 'x'
+                                                                                    : GLYPH_CHARS[rand_r(&seed) % count];
+                text[len] = '\0';
+                n = osd_glyph_map(at, text, glyphs, len);
+                alloc_picture(&bmp, fmt, len * gw, gh);
+                render_text(&bmp, &font, gw, text);
+
+                for (int round = 0; round < 3; round++) {
+                    int x = (rand_r(&seed) % 200 - 30) & ~1, y = rand_r(&seed) % 80 - 16;
+
+                    copy_frame(&ref, &base);
+                    copy_frame(&out, &base);
+                    osd_blend_picture(&ref, x, y, &bmp, mode, fg, bg);
+                    osd_blend_glyphs(at, &out, x, y, glyphs, n, NULL);
+                    runs++;
+                    if (!same_frame(&ref, &out)) {
+                        if (failures < 5)
+                            printf("FAIL: glyphs fmt %d mode %d %dx%d \"%s\" at (%d,%d)\n", fmt, mode, gw, gh,
+                                   text, x, y);
+                        failures++;
+                    }
+                }
+                osd_glyph_atlas_destroy(at);
+                free((void *)font.data);
+                free((void *)bmp.data);
+            }
+        }
+    }
+
+    printf("glyph atlas vs rendered bitmap: %d/%d OK\n", runs - failures, runs);
+    free_frame(&base);
+    free_frame(&ref);
+    free_frame(&out);
+    return failures;
+}
+
+static int count_luma(const OsdFrame *f, uint8_t v)
+{
+    int n = 0;
+    for (int i = 0; i < f->width * f->height; i++)
+        n += f->y[i] == v;
+    return n;
+}
+
+static int check_shapes(void)
+{
+    OsdFrame f;
+    int failures = 0;
+
+    alloc_frame(&f, 64, 48);
+
+    /* Opaque white fill: Y 235, neutral chroma, only inside the box */
+    memset(f.y, 0, 64 * 48);
+    memset(f.uv, 0, 64 * 24);
+    osd_blend_fill(&f, 3, 5, 10, 7, 0xffffffff);
+    failures += count_luma(&f, 235) != 70;
+    failures += f.y[5 * 64 + 3] != 235 || f.y[11 * 64 + 12] != 235 || f.y[4 * 64 + 3] != 0 || f.y[5 * 64 + 13] != 0;
+    failures += f.uv[2 * 64 + 2] != 128 || f.uv[5 * 64 + 12] != 128 || f.uv[6 * 64 + 2] != 0;
+
+    /* Plain RGB colour (alpha byte 0) is drawn opaque */
+    memset(f.y, 0, 64 * 48);
+    osd_blend_fill(&f, 0, 0, 4, 4, 0x000000ff);
+    failures += f.y[0] != 41;
+
+    /* 50% grey over black */
+    memset(f.y, 0, 64 * 48);
+    osd_blend_fill(&f, 0, 0, 2, 2, 0x80ffffff);
+    failures += f.y[0] != ref_mix(0, 235, 0x80);
+
+    /* 2-pixel outline of a 20x10 box keeps to the box and leaves the inside */
+    memset(f.y, 0, 64 * 48);
+    osd_blend_rect(&f, 30, 10, 49, 19, 2, 0xffffffff);
+    failures += count_luma(&f, 235) != 20 * 10 - 16 * 6;
+    failures += f.y[10 * 64 + 30] != 235 || f.y[19 * 64 + 49] != 235 || f.y[12 * 64 + 32] != 0;
+
+    /* Lines: horizontal, vertical and 45 degrees, 1 pixel wide */
+    memset(f.y, 0, 64 * 48);
+    osd_blend_line(&f, 50, 2, 10, 2, 1, 0xffffffff);
+    failures += count_luma(&f, 235) != 41;
+    memset(f.y, 0, 64 * 48);
+    osd_blend_line(&f, 7, 40, 7, 0, 3, 0xffffffff);
+    failures += count_luma(&f, 235) != 41 * 3 || f.y[20 * 64 + 6] != 235 || f.y[20 * 64 + 8] != 235;
+    memset(f.y, 0, 64 * 48);
+    osd_blend_line(&f, 0, 0, 30, 30, 1, 0xffffffff);
+    failures += count_luma(&f, 235) != 31;
+    for (int i = 0; i <= 30; i++)
+        failures += f.y[i * 64 + i] != 235;
+
+    /* Fully clipped shapes are harmless */
+    osd_blend_line(&f, -100, -5, -10, -50, 4, 0xffffffff);
+    osd_blend_rect(&f, 100, 100, 200, 200, 4, 0xffffffff);
+    failures += count_luma(&f, 235) != 31;
+
+    bench_check("fill/line/rect checks", failures);
+    free_frame(&f);
+    return failures != 0;
+}
+
+static void bench(void)
+{
+    static const struct { const char *name; int w, h; } streams[3] = {
+        { "1920x1080", 1920, 1080 }, { "1280x720", 1280, 720 }, { "640x360", 640, 360 },
+    };
+    OsdPicture stamp, logo;
+    unsigned seed = 9;
+    const int iters = 2000;
+
+    /* "2026-10-16 12:34:56" in 16x32 glyphs; about a third of it inked */
+    alloc_picture(&stamp, OSD_BLEND_FMT_ARGB1555, 19 * 16, 32);
+    fill_overlay(&stamp, &seed);
+    alloc_picture(&logo, OSD_BLEND_FMT_BGRA, 128, 64);
+    fill_overlay(&logo, &seed);
+
+    for (int s = 0; s < 3; s++) {
+        OsdFrame f;
+        double t0, t1, t2, t3;
+
+        alloc_frame(&f, streams[s].w, streams[s].h);
+        memset(f.y, 90, (size_t)f.width * f.height);
+        memset(f.uv, 128, (size_t)f.width * (f.height / 2));
+
+        t0 = now_sec();
+        for (int i = 0; i < iters; i++)
+            osd_blend_picture(&f, 16, 16, &stamp, OSD_BLEND_ALPHA_PIXEL, 255, 0);
+        t1 = now_sec();
+        for (int i = 0; i < iters; i++)
+            osd_blend_picture(&f, f.width - 160, 16, &logo, OSD_BLEND_ALPHA_GLOBAL, 200, 0);
+        t2 = now_sec();
+        for (int i = 0; i < iters; i++)
+            osd_blend_rect(&f, f.width / 4, f.height / 4, f.width / 2, f.height / 2, 4, 0xffff0000);
+        t3 = now_sec();
+
+        printf("%-10s timestamp 304x32 ARGB1555 %6.2f us  logo 128x64 BGRA %6.2f us  box width 4 %6.2f us\n",
+               streams[s].name, (t1 - t0) * 1e6 / iters, (t2 - t1) * 1e6 / iters, (t3 - t2) * 1e6 / iters);
+        free_frame(&f);
+    }
+
+    {
+        OsdFrame f;
+        double t0, t1, t2;
+
+        alloc_frame(&f, 1920, 1080);
+        memset(f.y, 90, 1920 * 1080);
+        memset(f.uv, 128, 1920 * 540);
+        t0 = now_sec();
+        for (int i = 0; i < iters / 10; i++)
+            ref_blend(&f, 16, 16, &stamp, OSD_BLEND_ALPHA_PIXEL, 255, 0);
+        t1 = now_sec();
+        for (int i = 0; i < iters / 10; i++)
+            osd_blend_picture(&f, 16, 16, &stamp, OSD_BLEND_ALPHA_PIXEL, 255, 0);
+        t2 = now_sec();
+        printf("timestamp: per-pixel reference %6.2f us  span kernels %6.2f us  (%.2fx)\n",
+               (t1 - t0) * 1e7 / iters, (t2 - t1) * 1e7 / iters, (t1 - t0) / (t2 - t1));
+        free_frame(&f);
+    }
+
+    /* Clock at 25 fps in 16x32 glyphs: the application re-renders the
+     * string once a second and the frame carries it in between. Drawn
+     * directly, from an overlay, and from a glyph atlas that only re-maps
+     * the string. */
+    {
+        OsdFrame f;
+        OsdPicture font, text;
+        OsdOverlay *ov = osd_overlay_create();
+        OsdGlyphAtlas *at;
+        OsdBlendStats st, gst;
+        uint8_t glyphs[19];
+        char str[20];
+        const int frames = 2500;
+        double t0, t1, t2, t3, up_ov = 0, up_gl = 0;
+        int n = 0;
+
+        alloc_frame(&f, 1920, 1080);
+        memset(f.y, 90, 1920 * 1080);
+        memset(f.uv, 128, 1920 * 540);
+        alloc_picture(&font, OSD_BLEND_FMT_ARGB1555, (int)strlen(GLYPH_CHARS) * 16, 32);
+        fill_overlay(&font, &seed);
+        alloc_picture(&text, OSD_BLEND_FMT_ARGB1555, 19 * 16, 32);
+        at = osd_glyph_atlas_create(&font, GLYPH_CHARS, 16, OSD_BLEND_ALPHA_PIXEL, 255, 0, NULL);
+
+        t0 = now_sec();
+        for (int i = 0; i < frames; i++) {
+            if (i % 25 == 0) {
+                snprintf(str, sizeof(str), "2026-10-16 12:%02d:%02d", i / 1500 % 60, i / 25 % 60);
+                render_text(&text, &font, 16, str);
+            }
+            osd_blend_picture(&f, 16, 16, &text, OSD_BLEND_ALPHA_PIXEL, 255, 0);
+        }
+        t1 = now_sec();
+        memset(&st, 0, sizeof(st));
+        for (int i = 0; i < frames; i++) {
+            if (i % 25 == 0) {
+                double u = now_sec();
+                snprintf(str, sizeof(str), "2026-10-16 12:%02d:%02d", i / 1500 % 60, i / 25 % 60);
+                render_text(&text, &font, 16, str);
+                osd_overlay_update(ov, &text, OSD_BLEND_ALPHA_PIXEL, 255, 0, &st);
+                up_ov += now_sec() - u;
+            }
+            osd_overlay_blend(ov, &f, 16, 16, &st);
+        }
+        t2 = now_sec();
+        memset(&gst, 0, sizeof(gst));
+        for (int i = 0; i < frames; i++) {
+            if (i % 25 == 0) {
+                double u = now_sec();
+                snprintf(str, sizeof(str), "2026-10-16 12:%02d:%02d", i / 1500 % 60, i / 25 % 60);
+                n = osd_glyph_map(at, str, glyphs, 19);
+                up_gl += now_sec() - u;
+            }
+            osd_blend_glyphs(at, &f, 16, 16, glyphs, n, &gst);
+        }
+        t3 = now_sec();
+
+        printf("clock 304x32 @25fps: direct %6.2f us/frame  overlay %6.2f us/frame  glyph atlas %6.2f us/frame\n",
+               (t1 - t0) * 1e6 / frames, (t2 - t1) * 1e6 / frames, (t3 - t2) * 1e6 / frames);
+        printf("  overlay per frame: %u px converted, %u px blended, %.1f tiles skipped\n",
+               st.pixels_converted / frames, st.pixels_blended / frames, (double)st.tiles_skipped / frames);
+        printf("  second boundary: render + convert %6.2f us  glyph map %6.2f us\n",
+               up_ov * 1e6 / (frames / 25), up_gl * 1e6 / (frames / 25));
+        osd_glyph_atlas_destroy(at);
+        osd_overlay_destroy(ov);
+        free((void *)font.data);
+        free((void *)text.data);
+        free_frame(&f);
+    }
+
+    free((void *)stamp.data);
+    free((void *)logo.data);
+}
+
+int main(void)
+{
+    int failures = 0;
+
+    failures += check_kernels();
+    failures += check_overlay();
+    failures += check_glyphs();
+    failures += check_shapes();
+    bench();
+
+    return failures ? 1 : 0;
+}